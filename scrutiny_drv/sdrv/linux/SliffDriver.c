@@ -701,6 +701,108 @@ static int sdiDriverRead (struct pci_dev *PtrDev, SCRUTINY_DRIVER_PCI_CFG_SPACE
 }
 
 
+static int sdiDriverBatch (unsigned long arg)
+{
+    struct pci_dev *ptrDev = NULL;
+    SCRUTINY_DRIVER_PCI_CFG_BATCH karg;
+    SCRUTINY_DRIVER_PCI_CFG_SPACE location;
+    PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION ptrOperations = NULL;
+    U32 index;
+    U32 size;
+    int ret = 0;
+
+    if (copy_from_user (&karg, (void __user *) arg, sizeof (SCRUTINY_DRIVER_PCI_CFG_BATCH)))
+    {
+        printk (KERN_ERR "SliffDriver - failure at %s:%d/%s()!\n", __FILE__, __LINE__, __func__);
+
+        return (-EFAULT);
+    }
+
+    if ((karg.Count == 0) || (karg.Count > SCRUTINY_DRIVER_PCI_BATCH_MAX_OPERATIONS))
+    {
+        printk (KERN_ERR "SliffDriver - %s: Invalid operation count %d\n", __FUNCTION__, karg.Count);
+
+        return (-EINVAL);
+    }
+
+    size = karg.Count * sizeof (SCRUTINY_DRIVER_PCI_CFG_OPERATION);
+
+    ptrOperations = kmalloc (size, GFP_KERNEL);
+
+    if (ptrOperations == NULL)
+    {
+        return (-ENOMEM);
+    }
+
+    if (copy_from_user (ptrOperations, (void __user *) (unsigned long) karg.PtrOperations, size))
+    {
+        printk (KERN_ERR "SliffDriver - failure at %s:%d/%s()!\n", __FILE__, __LINE__, __func__);
+
+        kfree (ptrOperations);
+
+        return (-EFAULT);
+    }
+
+    memset (&location, 0, sizeof (SCRUTINY_DRIVER_PCI_CFG_SPACE));
+
+    location.Domain = karg.Domain;
+    location.Bus = karg.Bus;
+    location.Device = karg.Device;
+    location.Function = karg.Function;
+    location.Slot = karg.Slot;
+
+    /* Resolve the device once for all the operations */
+
+    if (sdDriverDiscoverPciDevices (&ptrDev, location) != 0)
+    {
+        kfree (ptrOperations);
+
+        return (-ENODEV);
+    }
+
+    for (index = 0; index < karg.Count; index++)
+    {
+        if (ptrOperations[index].Offset > 0xFF)
+        {
+            sdDriverProbeForEcam();
+            break;
+        }
+    }
+
+    for (index = 0; index < karg.Count; index++)
+    {
+        location.Offset = ptrOperations[index].Offset;
+
+        if (ptrOperations[index].Operation == SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE)
+        {
+            location.Data[0] = ptrOperations[index].Data;
+
+            ptrOperations[index].Status = (S8) sdiDriverWrite (ptrDev, location);
+        }
+
+        else
+        {
+            ptrOperations[index].Status = (S8) sdiDriverRead (ptrDev, &location);
+
+            ptrOperations[index].Data = (ptrOperations[index].Status == 0) ? location.Data[0] : 0xFFFFFFFF;
+        }
+    }
+
+    pci_dev_put (ptrDev);
+
+    if (copy_to_user ((void __user *) (unsigned long) karg.PtrOperations, ptrOperations, size))
+    {
+        printk (KERN_ERR "SliffDriver - failure at %s:%d/%s()!\n", __FILE__, __LINE__, __func__);
+
+        ret = -EFAULT;
+    }
+
+    kfree (ptrOperations);
+
+    return (ret);
+}
+
+
 static long sdiDriverIoctl (struct file *file, unsigned int cmd, unsigned long arg)
 {
     long ret_val = 0;
@@ -929,6 +1031,11 @@ static long sdiDriverIoctl (struct file *file, unsigned int cmd, unsigned long a
         }
 
 
+        case SCRUTINY_DRIVER_IOCTL_BATCH_PCI:
+        {
+            return (sdiDriverBatch (arg));
+        }
+
         case SCRUTINY_DRIVER_IOCTL_ALLOCATE_MEMORY:
         {
             PTR_SLIFF_DRIVER_MEMORY ptrMemory = (PTR_SLIFF_DRIVER_MEMORY) arg;
@@ -948,7 +1055,7 @@ static long sdiDriverIoctl (struct file *file, unsigned int cmd, unsigned long a
         {
             printk (KERN_ERR "SliffDriver - %s: IOCTL (%x) not supported\n", __FUNCTION__, cmd);
 
-            ret_val = -1;
+            ret_val = -ENOTTY;
         }
     }
 
@@ -113,12 +113,12 @@ typedef VOID * PVOID;
 typedef U8 BOOLEAN;
 #endif
 
-#define SLIFF_DRIVER_VERSION		"00.00.01.02"
+#define SLIFF_DRIVER_VERSION		"00.00.01.03"
 
 #define SLIFF_DRIVER_VERSION_MAJOR   00
 #define SLIFF_DRIVER_VERSION_MINOR   00
 #define SLIFF_DRIVER_VERSION_BUILD   01
-#define SLIFF_DRIVER_VERSION_DEV     02
+#define SLIFF_DRIVER_VERSION_DEV     03
 
 
 /*
@@ -173,6 +173,42 @@ typedef struct __SCRUTINY_DRIVER_PCI_CFG_SPACE
 
 } SCRUTINY_DRIVER_PCI_CFG_SPACE, *PTR_SCRUTINY_DRIVER_PCI_CFG_SPACE;
 
+/*
+ * Vectored configuration space access. One ioctl carries an array of read/write
+ * operations against a single bus/dev/func, the device is resolved only once.
+ */
+#define SCRUTINY_DRIVER_PCI_BATCH_MAX_OPERATIONS        (1024)
+
+#define SCRUTINY_DRIVER_PCI_BATCH_OPERATION_READ        (0)
+#define SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE       (1)
+
+typedef struct __SCRUTINY_DRIVER_PCI_CFG_OPERATION
+{
+    U16      Offset;
+    U8       Operation;
+    S8       Status;
+
+    U32      Data;
+
+} SCRUTINY_DRIVER_PCI_CFG_OPERATION, *PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION;
+
+typedef struct __SCRUTINY_DRIVER_PCI_CFG_BATCH
+{
+    U8       Domain;
+    U8       Bus;
+    U8       Device;
+    U8       Function;
+    U8       Slot;
+    U8       Reserved;
+    U16      Reserved1;
+
+    U32      Count;
+    U32      Reserved2;
+
+    unsigned long long  PtrOperations;
+
+} SCRUTINY_DRIVER_PCI_CFG_BATCH, *PTR_SCRUTINY_DRIVER_PCI_CFG_BATCH;
+
 #define SLIFF_MAGIC_NUMBER  'S'
 
 /**
@@ -270,6 +306,7 @@ typedef struct _ACPI_RSDT_v1_0
 #define SCRUTINY_DRIVER_IOCTL_ENABLE_PCI                0x1003
 #define SCRUTINY_DRIVER_IOCTL_ALLOCATE_MEMORY           0x1004
 #define SCRUTINY_DRIVER_IOCTL_FREE_MEMORY               0x1005
+#define SCRUTINY_DRIVER_IOCTL_BATCH_PCI                 0x1006
 
 
 /***********************************************************
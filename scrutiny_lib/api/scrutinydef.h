@@ -116,7 +116,8 @@ typedef enum __SCRUTINY_HANDLE_TYPE
     SCRUTINY_HANDLE_TYPE_MPT                        = SCRUTINY_HANDLE_TYPE_MASK_INBAND | 0x8,
     SCRUTINY_HANDLE_TYPE_MFI                        = SCRUTINY_HANDLE_TYPE_MASK_INBAND | 0x9,
     SCRUTINY_HANDLE_TYPE_MCTP_I2C                   = SCRUTINY_HANDLE_TYPE_MASK_BMC    | SCRUTINY_HANDLE_TYPE_MASK_SCSI | 0xA,
-    SCRUTINY_HANDLE_TYPE_MCTP_PCIE                  = SCRUTINY_HANDLE_TYPE_MASK_BMC    | SCRUTINY_HANDLE_TYPE_MASK_SCSI | 0xB
+    SCRUTINY_HANDLE_TYPE_MCTP_PCIE                  = SCRUTINY_HANDLE_TYPE_MASK_BMC    | SCRUTINY_HANDLE_TYPE_MASK_SCSI | 0xB,
+    SCRUTINY_HANDLE_TYPE_SIMULATED                  = 0xC
 
 } SCRUTINY_HANDLE_TYPE;
 
@@ -150,10 +151,22 @@ typedef enum __SCRUTINY_DISCOVERY_TYPE
     SCRUTINY_DISCOVERY_TYPE_INBAND          = 1,  /**< Performs all inband discovery (includes PCIe, MPI and SG) will be happening */
     SCRUTINY_DISCOVERY_TYPE_SERIAL_DEBUG    = 2,   /**< SDB interface/ Serial Debug interface in Expander/Switch products */
     SCRUTINY_DISCOVERY_TYPE_OOB_I2C         = 3,  /** Performs I2C discovery from OOB*/
-    SCRUTINY_DISCOVERY_TYPE_OOB_PCI         = 4  /**Perform OOB disocvery of PCIe devices*/
+    SCRUTINY_DISCOVERY_TYPE_OOB_PCI         = 4,  /**Perform OOB disocvery of PCIe devices*/
+    SCRUTINY_DISCOVERY_TYPE_SIMULATED       = 5   /**< Simulated device backed by a file, see SCRUTINY_SIMULATOR_TYPE, no hardware is touched */
 
 } SCRUTINY_DISCOVERY_TYPE;
 
+/**
+ *
+ * @brief Modifier for SCRUTINY_DISCOVERY_TYPE_INBAND. Devices found by the previous discovery which
+ *        are still present keep their product handle and are not qualified again, only new or changed
+ *        devices are. Handles of devices which went away report SCRUTINY_STATUS_INVALID_HANDLE.
+ *
+ */
+
+#define SCRUTINY_DISCOVERY_FLAG_INCREMENTAL     (0x00010000)
+#define SCRUTINY_DISCOVERY_TYPE_MASK            (0x0000FFFF)
+
 
 /**
  *
@@ -546,6 +559,42 @@ typedef struct __SCRUTINY_OOB_CONFIG
 
 }SCRUTINY_IAL_OOB_CONFIG , PTR_SCRUTINY_IAL_OOB_CONFIG;
 
+/**
+ *
+ * @brief What the file of a SCRUTINY_DISCOVERY_TYPE_SIMULATED discovery holds. A switch snapshot
+ *        holds the register contents of a simulated switch, its format is described in
+ *        libregmodel.h. An expander profile describes an enclosure emulated on the SCSI generic
+ *        path, see sgemulator.h. A replay file is a trace taken with RECORD_FILE in scrutiny.ini,
+ *        see librecord.h. An SDB profile describes a debug port simulated behind a pseudo
+ *        terminal, see sdbsimulator.h.
+ *
+ */
+
+typedef enum __SCRUTINY_SIMULATOR_TYPE
+{
+    SCRUTINY_SIMULATOR_TYPE_SWITCH_SNAPSHOT     = 0,    /**< Register snapshot of a simulated switch */
+    SCRUTINY_SIMULATOR_TYPE_EXPANDER_PROFILE    = 1,    /**< Enclosure emulated on the SCSI generic path (Linux only) */
+    SCRUTINY_SIMULATOR_TYPE_REPLAY              = 2,    /**< Recorded trace to replay */
+    SCRUTINY_SIMULATOR_TYPE_SDB_PROFILE         = 3     /**< SDB debug port simulated behind a pseudo terminal (Linux only) */
+
+} SCRUTINY_SIMULATOR_TYPE;
+
+/**
+ *
+ * @brief Parameters of SCRUTINY_DISCOVERY_TYPE_SIMULATED. One discovery brings up one kind of
+ *        simulated device. The structure has to stay within the size of SCRUTINY_IAL_SERIAL_CONFIG,
+ *        the largest member of SCRUTINY_DISCOVERY_PARAMS.
+ *
+ */
+
+typedef struct __SCRUTINY_SIMULATOR_CONFIG
+{
+    SCRUTINY_SIMULATOR_TYPE SimulatorType;          /** What SimulationFile holds */
+    char                    SimulationFile[1024];   /** Name/Path of the snapshot, profile or trace */
+    BOOLEAN                 ReplayRecordedLatency;  /** Replay only, TRUE to hold each exchange for its recorded time, FALSE for full speed */
+
+} SCRUTINY_SIMULATOR_CONFIG, *PTR_SCRUTINY_SIMULATOR_CONFIG;
+
 typedef struct __SCRUTINY_DISCOVERY_PARAMS
 {
     union
@@ -553,6 +602,7 @@ typedef struct __SCRUTINY_DISCOVERY_PARAMS
         SCRUTINY_IAL_OOB_CONFIG             OobConfigIAL;
         SCRUTINY_IAL_SERIAL_CONFIG          SerialConfig;
         SCRUTINY_IAL_PCI_CONFIG             PCIConfig;
+        SCRUTINY_SIMULATOR_CONFIG           SimulatorConfig;
     } u;
 
 } SCRUTINY_DISCOVERY_PARAMS, *PTR_SCRUTINY_DISCOVERY_PARAMS;
@@ -1686,7 +1736,10 @@ typedef enum _SCRUTINY_SWITCH_PCIE_PERF_OP_CMD
     SWITCH_PCIE_PERF_OP_CMD_NOTHING = 0, // No operation
     SWITCH_PCIE_PERF_OP_CMD_START,       // Start the performance counters running
     SWITCH_PCIE_PERF_OP_CMD_READ,        // Read the performance result
-    SWITCH_PCIE_PERF_OP_CMD_STOP         // Stop the performance counters running
+    SWITCH_PCIE_PERF_OP_CMD_STOP,        // Stop the performance counters running
+    SWITCH_PCIE_PERF_OP_CMD_SAMPLER_START, // Start the counters and a background sampler, StatisticElapsedTimeMs is the sampling interval
+    SWITCH_PCIE_PERF_OP_CMD_SAMPLER_READ,  // Statistic of the last StatisticElapsedTimeMs from the sampler, does not block
+    SWITCH_PCIE_PERF_OP_CMD_SAMPLER_STOP   // Stop the background sampler and the counters
     
 } SCRUTINY_SWITCH_PCIE_PERF_OP_CMD;
 
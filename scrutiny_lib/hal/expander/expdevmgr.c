@@ -128,9 +128,9 @@ SCRUTINY_STATUS edmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
     gPtrLoggerExpanders->logiDebug ("Close Expander Device HandleType=%x", PtrDevice->HandleType);
 
 #if defined (OS_LINUX) && !defined (OS_VMWARE)
-    if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
+    if ((PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB) && (!lrciIsReplaying (PtrDevice)))
     {
-        /* We need to close the serial port. */
+        /* We need to close the serial port, a replayed device never opened one. */
         spiClosePort (&PtrDevice->Handle.SdbHandle);
     }
 
@@ -140,6 +140,11 @@ SCRUTINY_STATUS edmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
     {
         /* We have got SCSI Generic interface */
         sgiCloseDevice (PtrDevice);
+
+#if defined (OS_LINUX)
+        sgiFreeTransferBuffer (PtrDevice);
+        sgemiFreeEmulator (PtrDevice);
+#endif
     }
 
     else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_MPT_INTERFACE ||
@@ -724,6 +724,16 @@ SCRUTINY_STATUS ehliGetHealthLogs (
             gPtrLoggerExpanders->logiFunctionExit ("ehliGetHealthLogs (status=0x%x)", SCRUTINY_STATUS_UNSUPPORTED);
             return (SCRUTINY_STATUS_UNSUPPORTED);
         }
+
+        if (ptrFile != NULL)
+        {
+            /* The decoded log goes to the file as is, no need to hold all of it */
+            status = bsdiStreamRegionToFile (PtrDevice, BRCM_SCSI_BUFFER_ID_ACTIVE_LOGS_DECODED, ptrFile, &bufferSize);
+
+            sosiFileClose (ptrFile);
+            gPtrLoggerExpanders->logiFunctionExit ("ehliGetHealthLogs (status=0x%x)", status);
+            return (status);
+        }
         
         status = ehlUploadLogsRegion (PtrDevice, BRCM_SCSI_BUFFER_ID_ACTIVE_LOGS_DECODED, &ptrHealthLogsBuffer, &bufferSize);
 
@@ -785,8 +785,6 @@ SCRUTINY_STATUS etUploadTraceBuffer (
 {
     SCRUTINY_STATUS             status;
     PU8                         ptrBuffer;
-    U32                         index, tempSize = 0;
-    SCRUTINY_SCSI_PASSTHROUGH   scsiRequest = { 0 };
 
     gPtrLoggerExpanders->logiFunctionEntry ("etUploadTraceBuffer (PtrExpander=%x, PtrTraceBuffer=%x, PtrBufferSize=%x)", 
             PtrExpander != NULL, PtrTraceBuffer != NULL, PtrBufferSize != NULL);
@@ -811,37 +809,14 @@ SCRUTINY_STATUS etUploadTraceBuffer (
 
     sosiMemSet (ptrBuffer, 0, *PtrBufferSize);
 
-    scsiRequest.CdbLength = 10;
+    /* Pipelined on sg nodes, the chunks are queued back to back */
+    status = bsdiReadRegion (PtrExpander, BRCM_SCSI_BUFFER_ID_ACTIVE_TRACES, 0, ptrBuffer, *PtrBufferSize);
 
-    scsiRequest.Cdb[0x00]  = SCSI_COMMAND_READ_BUFFER;
-    scsiRequest.Cdb[0x01]  = SCSI_READ_MODE_DATA;
-    scsiRequest.Cdb[0x02]  = BRCM_SCSI_BUFFER_ID_ACTIVE_TRACES;
-    scsiRequest.Cdb[0x09]  = 0x00;
-
-    for (index = 0; index < *PtrBufferSize; index += 0x80000)
+    if (status != SCRUTINY_STATUS_SUCCESS)
     {
-        tempSize = (0x80000 < ((*PtrBufferSize) - index)) ? 0x80000 : ((*PtrBufferSize) - index);
-
-        scsiRequest.Cdb[0x03]  = (U8) ((index >> 16) & 0xFF);
-        scsiRequest.Cdb[0x04]  = (U8) ((index >> 8) & 0xFF);
-        scsiRequest.Cdb[0x05]  = (U8) (index & 0xFF);
-        scsiRequest.Cdb[0x06]  = (U8) ((tempSize >> 16) & 0xFF);
-        scsiRequest.Cdb[0x07]  = (U8) ((tempSize >> 8) & 0xFF);
-        scsiRequest.Cdb[0x08]  = (U8) (tempSize & 0xFF);
-
-        scsiRequest.DataDirection = DIRECTION_READ;
-        scsiRequest.PtrDataBuffer = (PVOID) (ptrBuffer + index);
-        scsiRequest.DataBufferLength = tempSize;
-
-        status = bsdiPerformScsiPassthrough (PtrExpander, &scsiRequest);
-
-        if (status != SCRUTINY_STATUS_SUCCESS)
-        {
-            sosiMemFree (ptrBuffer);
-            gPtrLoggerExpanders->logiFunctionExit ("etUploadTraceBuffer (status=0x%x)", status);
-            return (status);
-        }
-
+        sosiMemFree (ptrBuffer);
+        gPtrLoggerExpanders->logiFunctionExit ("etUploadTraceBuffer (status=0x%x)", status);
+        return (status);
     }
 
     *PtrTraceBuffer = ptrBuffer;
@@ -93,26 +93,28 @@ SCRUTINY_STATUS bsdiQualifyBroadcomScsiDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDev
 SCRUTINY_STATUS bsdiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __OUT__ PU32 PtrData, __IN__ U32 SizeInBytes)
 {
 
-    U32 index, offset;
     SCRUTINY_STATUS status = SCRUTINY_STATUS_FAILED;
+    LRC_EXCHANGE exchange;
 
     gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryRead32 (PtrDevice=%x, Address=%x, PtrData=%x, SizeInBytes=%x)",
                                           PtrDevice != NULL, Address, PtrData != NULL, SizeInBytes);
 
+    lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_MEMORY_READ, Address, PtrData, SizeInBytes, TRUE);
+
+    ldmiLockDevice (PtrDevice);
+
+    if (lrciBeginExchange (PtrDevice, &exchange, &status))
+    {
+        ldmiUnlockDevice (PtrDevice);
+        return (status);
+    }
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
 
-        /* We have SDB interface, so issue SDB interface call */
-        for (index = 0, offset = 0; index < (SizeInBytes / 4); index++, offset += 4)
-        {
-            status = sdbiMemoryRead32 (&PtrDevice->Handle.SdbHandle, (Address + offset), &PtrData[index]);
-
-            if (status)
-            {
-                break;
-            }
-        }
+        /* We have SDB interface, keep a window of dword reads on the wire */
+        status = sdbiMemoryReadBlock32 (&PtrDevice->Handle.SdbHandle, Address, PtrData, (SizeInBytes / 4));
 
     }
 
@@ -124,18 +126,14 @@ SCRUTINY_STATUS bsdiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
 #if !defined (OS_VMWARE)
     else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_PCI)
     {
-
-        /* We have SDB interface, so issue SDB interface call */
-        for (index = 0, offset = 0; index < (SizeInBytes / 4); index++, offset += 4)
-        {
-            status = atlasiPciChimeToAxiReadRegister (PtrDevice, (Address + offset), &PtrData[index]);
-
-            if (status)
-            {
-                break;
-            }
-        }
-
+        /* Stream the consecutive DWORDs through the Chime to AXI FSM */
+        status = atlasiPciChimeToAxiReadBlock (PtrDevice, Address, PtrData, (SizeInBytes / 4));
+    }
+#endif
+#if defined (LIB_SUPPORT_SWITCH)
+    else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SIMULATED)
+    {
+        status = ssimiMemoryRead32 (PtrDevice, Address, PtrData, SizeInBytes);
     }
 #endif
     else
@@ -144,6 +142,10 @@ SCRUTINY_STATUS bsdiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    lrciEndExchange (PtrDevice, &exchange, status);
+
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory Read failed for Address=%x, SizeInBytes=%x, Status=%x",
@@ -171,6 +173,8 @@ SCRUTINY_STATUS bsdiMemoryRead8 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U3
     //gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryRead8 (PtrDevice=%x, Address=%x, PtrData=%x, SizeInBytes=%x)",
     //                                      PtrDevice != NULL, Address, PtrData != NULL, SizeInBytes);
 
+    ldmiLockDevice (PtrDevice);
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
@@ -193,6 +197,8 @@ SCRUTINY_STATUS bsdiMemoryRead8 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U3
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory Read failed for Address=%x, SizeInBytes=%x, Status=%x",
@@ -220,6 +226,8 @@ SCRUTINY_STATUS bsdiMemoryRead16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
     //gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryRead16 (PtrDevice=%x, Address=%x, PtrData=%x, SizeInBytes=%x)",
     //                                      PtrDevice != NULL, Address, PtrData != NULL, SizeInBytes);
 
+    ldmiLockDevice (PtrDevice);
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
@@ -242,6 +250,8 @@ SCRUTINY_STATUS bsdiMemoryRead16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory Read failed for Address=%x, SizeInBytes=%x, Status=%x",
@@ -260,14 +270,295 @@ SCRUTINY_STATUS bsdiMemoryRead16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
 
 }
 
+/**
+ *
+ *  @method  bsdiMemoryReadScatter32()
+ *
+ *  @param   PtrDevice          Pointer to the device
+ *
+ *  @param   PtrAddressList     List of DWORD aligned register addresses, in any order
+ *
+ *  @param   PtrData            PtrData[i] receives the value of PtrAddressList[i]
+ *
+ *  @param   Count              Number of entries in the address list
+ *
+ *  @param   MaxGapInBytes      Largest hole between two addresses that may be read
+ *                              through to merge them into one span. Use
+ *                              BRCM_SCSI_SCATTER_READ_NO_GAP when the registers in
+ *                              between have read side effects.
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Reads a list of scattered registers. For SCSI devices the addresses are
+ *           sorted and coalesced into spans, so only one READ BUFFER is issued per
+ *           span and the results are scattered back. Other interfaces fall back to
+ *           one bsdiMemoryRead32 per address.
+ *
+ */
+
+SCRUTINY_STATUS bsdiMemoryReadScatter32 (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  PU32 PtrAddressList,
+                          __OUT__ PU32 PtrData,
+                          __IN__  U32 Count,
+                          __IN__  U32 MaxGapInBytes)
+{
+
+    U32 index, first, last, key;
+    U32 spanStart, spanLast, address;
+    U32 spanCount = 0;
+    PU32 ptrOrder = NULL;
+    PU32 ptrSpan = NULL;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryReadScatter32 (PtrDevice=%x, PtrAddressList=%x, PtrData=%x, Count=%x, MaxGapInBytes=%x)",
+                                          PtrDevice != NULL, PtrAddressList != NULL, PtrData != NULL, Count, MaxGapInBytes);
+
+    if ((PtrAddressList == NULL) || (PtrData == NULL) || (Count == 0))
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadScatter32 (Status=%x)", SCRUTINY_STATUS_INVALID_PARAMETER);
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    for (index = 0; index < Count; index++)
+    {
+        if (PtrAddressList[index] & 0x3)
+        {
+            gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadScatter32 (Unaligned Address=%x)", PtrAddressList[index]);
+            return (SCRUTINY_STATUS_INVALID_PARAMETER);
+        }
+    }
+
+    if (!(PtrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_SCSI))
+    {
+        /* Only READ BUFFER can fetch a span, the other interfaces go register by register */
+        for (index = 0; index < Count; index++)
+        {
+            status = bsdiMemoryRead32 (PtrDevice, PtrAddressList[index], &PtrData[index], sizeof (U32));
+
+            if (status)
+            {
+                break;
+            }
+        }
+
+        gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadScatter32 (Status=%x)", status);
+        return (status);
+    }
+
+    if (MaxGapInBytes > BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES)
+    {
+        MaxGapInBytes = BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES;
+    }
+
+    ptrOrder = (PU32) sosiMemAlloc (Count * sizeof (U32));
+    ptrSpan = (PU32) sosiMemAlloc (BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES);
+
+    if ((ptrOrder == NULL) || (ptrSpan == NULL))
+    {
+        sosiMemFree (ptrOrder);
+        sosiMemFree (ptrSpan);
+
+        gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadScatter32 (Memory Allocation)");
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    /* Sort the indices by address, the lists are short so an insertion sort is enough */
+    for (index = 0; index < Count; index++)
+    {
+        key = index;
+        first = index;
+
+        while ((first > 0) && (PtrAddressList[ptrOrder[first - 1]] > PtrAddressList[key]))
+        {
+            ptrOrder[first] = ptrOrder[first - 1];
+            first--;
+        }
+
+        ptrOrder[first] = key;
+    }
+
+    first = 0;
+
+    while (first < Count)
+    {
+        spanStart = PtrAddressList[ptrOrder[first]];
+        spanLast = spanStart;
+        last = first;
+
+        /* Grow the span while the next address is within the gap and the span still fits */
+        while ((last + 1) < Count)
+        {
+            address = PtrAddressList[ptrOrder[last + 1]];
+
+            if (((address - spanLast) > (MaxGapInBytes + sizeof (U32))) ||
+                ((address - spanStart) >= BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES))
+            {
+                break;
+            }
+
+            spanLast = address;
+            last++;
+        }
+
+        status = bsdScsiMemoryRead32 (PtrDevice, spanStart, ptrSpan, (spanLast - spanStart) + sizeof (U32));
+
+        if (status)
+        {
+            gPtrLoggerScsi->logiDebug ("Scatter read failed for span Address=%x, SizeInBytes=%x, Status=%x",
+                                          spanStart, (U32) ((spanLast - spanStart) + sizeof (U32)), status);
+            break;
+        }
+
+        for (index = first; index <= last; index++)
+        {
+            PtrData[ptrOrder[index]] = ptrSpan[(PtrAddressList[ptrOrder[index]] - spanStart) / sizeof (U32)];
+        }
+
+        spanCount++;
+        first = last + 1;
+    }
+
+    sosiMemFree (ptrOrder);
+    sosiMemFree (ptrSpan);
+
+    gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadScatter32 (Status=%x, Registers=%x, Spans=%x)", status, Count, spanCount);
+
+    return (status);
+
+}
+
+/**
+ *
+ *  @method  bsdiMemoryReadFifo32()
+ *
+ *  @param   PtrDevice          Pointer to the device
+ *
+ *  @param   Address            DWORD aligned address of the FIFO register
+ *
+ *  @param   PtrData            Receives Count values popped from the FIFO
+ *
+ *  @param   Count              Number of reads of the FIFO register
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Reads the same register Count times. A READ BUFFER span always
+ *           advances the address, so for SCSI devices one request is built
+ *           and reissued for every DWORD. PCI devices drain the FIFO with one
+ *           Chime to AXI burst. Nothing is logged per DWORD.
+ *
+ */
+
+SCRUTINY_STATUS bsdiMemoryReadFifo32 (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U32 Address,
+                          __OUT__ PU32 PtrData,
+                          __IN__  U32 Count)
+{
+
+    U32 index = 0;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+    SCRUTINY_SCSI_PASSTHROUGH scsiRequest = { 0 };
+    LRC_EXCHANGE exchange;
+
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryReadFifo32 (PtrDevice=%x, Address=%x, PtrData=%x, Count=%x)",
+                                          PtrDevice != NULL, Address, PtrData != NULL, Count);
+
+    if ((PtrData == NULL) || (Count == 0) || (Address & 0x3))
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadFifo32 (Status=%x)", SCRUTINY_STATUS_INVALID_PARAMETER);
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    /* The FIFO is popped as one burst, nobody else may read it in between */
+    ldmiLockDevice (PtrDevice);
+
+    if (PtrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_SCSI)
+    {
+
+        scsiRequest.CdbLength = 10;
+        scsiRequest.DataBufferLength = sizeof (U32);
+        scsiRequest.DataDirection = DIRECTION_READ;
+
+        scsiRequest.Cdb[0x00]  = SCSI_COMMAND_READ_BUFFER;
+        scsiRequest.Cdb[0x01]  = SCSI_READ_MODE_VENDOR_SPECIFIC;
+        scsiRequest.Cdb[0x02]  = BRCM_SCSI_BUFFER_ID_MEMORY_RW_DWORD;
+        scsiRequest.Cdb[0x03]  = (U8) ((Address >> 24) & 0xFF);
+        scsiRequest.Cdb[0x04]  = (U8) ((Address >> 16) & 0xFF);
+        scsiRequest.Cdb[0x05]  = (U8) ((Address >>  8) & 0xFF);
+        scsiRequest.Cdb[0x06]  = (U8) ((Address      ) & 0xFF);
+        scsiRequest.Cdb[0x07]  = 0x00;
+        scsiRequest.Cdb[0x08]  = (U8) sizeof (U32);
+        scsiRequest.Cdb[0x09]  = 0x00;
+
+        for (index = 0; index < Count; index++)
+        {
+            /* Let the FIFO land straight in the caller buffer */
+            scsiRequest.PtrDataBuffer = (PVOID) &PtrData[index];
+
+            status = bsdiPerformScsiPassthrough (PtrDevice, &scsiRequest);
+
+            if (status)
+            {
+                break;
+            }
+        }
+
+    }
+#if !defined (OS_VMWARE)
+    else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_PCI)
+    {
+        lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_FIFO_READ, Address, PtrData, Count * sizeof (U32), TRUE);
+
+        if (!lrciBeginExchange (PtrDevice, &exchange, &status))
+        {
+            status = atlasiPciChimeToAxiReadFifo (PtrDevice, Address, PtrData, Count);
+
+            lrciEndExchange (PtrDevice, &exchange, status);
+        }
+    }
+#endif
+    else
+    {
+        for (index = 0; index < Count; index++)
+        {
+            status = bsdiMemoryRead32 (PtrDevice, Address, &PtrData[index], sizeof (U32));
+
+            if (status)
+            {
+                break;
+            }
+        }
+    }
+
+    ldmiUnlockDevice (PtrDevice);
+
+    gPtrLoggerScsi->logiFunctionExit ("bsdiMemoryReadFifo32 (Status=%x)", status);
+
+    return (status);
+
+}
+
 SCRUTINY_STATUS bsdiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __IN__ PU32 PtrData)
 {
 
     SCRUTINY_STATUS status;
+    LRC_EXCHANGE exchange;
 
     //gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryWrite32 (PtrDevice=%x, Address=%x, PtrData=%x)",
     //                                      PtrDevice != NULL, Address, PtrData != NULL);
 
+    lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_MEMORY_WRITE, Address, PtrData, sizeof (U32), FALSE);
+    exchange.Value = *PtrData;
+
+    ldmiLockDevice (PtrDevice);
+
+    if (lrciBeginExchange (PtrDevice, &exchange, &status))
+    {
+        ldmiUnlockDevice (PtrDevice);
+        return (status);
+    }
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
@@ -285,6 +576,12 @@ SCRUTINY_STATUS bsdiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
     {
         status = atlasiPciChimeToAxiWriteRegister (PtrDevice, Address, *PtrData);
     }
+#endif
+#if defined (LIB_SUPPORT_SWITCH)
+    else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SIMULATED)
+    {
+        status = ssimiMemoryWrite32 (PtrDevice, Address, *PtrData);
+    }
 #endif
     else
     {
@@ -292,6 +589,10 @@ SCRUTINY_STATUS bsdiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    lrciEndExchange (PtrDevice, &exchange, status);
+
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory write failed for Address=%x, Status=%x",
@@ -317,6 +618,8 @@ SCRUTINY_STATUS bsdiMemoryWrite16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
     //gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryWrite16 (PtrDevice=%x, Address=%x, PtrData=%x)",
     //                                      PtrDevice != NULL, Address, PtrData != NULL);
 
+    ldmiLockDevice (PtrDevice);
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
@@ -330,6 +633,8 @@ SCRUTINY_STATUS bsdiMemoryWrite16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory write failed for Address=%x, Status=%x",
@@ -355,6 +660,8 @@ SCRUTINY_STATUS bsdiMemoryWrite8 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
     //gPtrLoggerScsi->logiFunctionEntry ("bsdiMemoryWrite8 (PtrDevice=%x, Address=%x, PtrData=%x)",
     //                                   PtrDevice != NULL, Address, PtrData != NULL);
 
+    ldmiLockDevice (PtrDevice);
+
     /* Check if we have SDB or SCSI Depending on that appropriately call the memory reads */
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {
@@ -368,6 +675,8 @@ SCRUTINY_STATUS bsdiMemoryWrite8 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    ldmiUnlockDevice (PtrDevice);
+
     if (status)
     {
         gPtrLoggerScsi->logiDebug ("Memory write failed for Address=%x, Status=%x",
@@ -390,10 +699,29 @@ SCRUTINY_STATUS bsdiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice
 
     SCRUTINY_STATUS status = SCRUTINY_STATUS_FAILED;
     //SCRUTINY_IOC_STATUS  iocStatus = { 0 };
+    LRC_EXCHANGE exchange;
 
     gPtrLoggerScsi->logiFunctionEntry ("bsdiPerformScsiPassthrough (PtrDevice=%x, PtrScsiRequest=%x)",
                                          PtrDevice != NULL, PtrScsiRequest != NULL);
 
+    lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_SCSI, 0, PtrScsiRequest->PtrDataBuffer, PtrScsiRequest->DataBufferLength,
+                            (PtrScsiRequest->DataDirection == DIRECTION_READ) ? TRUE : FALSE);
+
+    exchange.PtrCdb = PtrScsiRequest->Cdb;
+    exchange.CdbLength = PtrScsiRequest->CdbLength;
+
+    ldmiLockDevice (PtrDevice);
+
+    if (lrciBeginExchange (PtrDevice, &exchange, &status))
+    {
+        PtrScsiRequest->ScsiStatus = (U8) exchange.Value;
+
+        ldmiUnlockDevice (PtrDevice);
+
+        gPtrLoggerScsi->logiFunctionExit ("bsdiPerformScsiPassthrough (Replayed Status=%x)", status);
+        return (status);
+    }
+
     /*
      * Check what device we are sending to. If we are having MPT Interface, we need to send with the device ID as a parameter.
      * Otherwise we can just send to the SCSI Device.
@@ -425,6 +753,12 @@ SCRUTINY_STATUS bsdiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice
         status = SCRUTINY_STATUS_UNSUPPORTED;
     }
 
+    exchange.Value = PtrScsiRequest->ScsiStatus;
+
+    lrciEndExchange (PtrDevice, &exchange, status);
+
+    ldmiUnlockDevice (PtrDevice);
+
     gPtrLoggerScsi->logiFunctionExit ("bsdiPerformScsiPassthrough (Status=%x)", status);
 
     return (status);
@@ -434,55 +768,38 @@ SCRUTINY_STATUS bsdiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice
 SCRUTINY_STATUS bsdScsiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrExpander, __IN__ U32 Address, __OUT__ PU32 PtrValue, __IN__ U32 SizeInBytes)
 {
 
-    SCRUTINY_STATUS status ;
-    PTR_SCRUTINY_SCSI_PASSTHROUGH ptrScsiRequest = NULL;
-
-    ptrScsiRequest = (PTR_SCRUTINY_SCSI_PASSTHROUGH) sosiMemAlloc (sizeof (SCRUTINY_SCSI_PASSTHROUGH));
-
-    ptrScsiRequest->CdbLength = 10;
-    ptrScsiRequest->PtrDataBuffer = (PVOID) sosiMemAlloc (SizeInBytes);
-    ptrScsiRequest->DataBufferLength = SizeInBytes;
-
-    *((PU32) ptrScsiRequest->PtrDataBuffer) = 0xDEADBEEF;
-
-    ptrScsiRequest->Cdb[0x00]  = SCSI_COMMAND_READ_BUFFER;
-    ptrScsiRequest->Cdb[0x01]  = SCSI_READ_MODE_VENDOR_SPECIFIC;
-    ptrScsiRequest->Cdb[0x02]  = BRCM_SCSI_BUFFER_ID_MEMORY_RW_DWORD;
-    ptrScsiRequest->Cdb[0x03]  = (U8) ((Address >> 24) & 0xFF);
-    ptrScsiRequest->Cdb[0x04]  = (U8) ((Address >> 16) & 0xFF);
-    ptrScsiRequest->Cdb[0x05]  = (U8) ((Address >>  8) & 0xFF);
-    ptrScsiRequest->Cdb[0x06]  = (U8) ((Address      ) & 0xFF);
-    ptrScsiRequest->Cdb[0x07]  = (U8) ((SizeInBytes >> 8) & 0xFF);
-    ptrScsiRequest->Cdb[0x08]  = (U8) ((SizeInBytes & 0xFF));
-    ptrScsiRequest->Cdb[0x09]  = 0x00;
-
-    ptrScsiRequest->DataDirection = DIRECTION_READ;
-
-    /* Copy the data buffer into the memory. */
+    SCRUTINY_SCSI_PASSTHROUGH scsiRequest = { 0 };
 
-    status = bsdiPerformScsiPassthrough (PtrExpander, ptrScsiRequest);
+    /* The data phase goes straight to the caller, there is nothing to stage */
+    scsiRequest.CdbLength = 10;
+    scsiRequest.PtrDataBuffer = (PVOID) PtrValue;
+    scsiRequest.DataBufferLength = SizeInBytes;
 
-    if (SCRUTINY_STATUS_SUCCESS == status)
-    {
-        sosiMemCopy (PtrValue, ptrScsiRequest->PtrDataBuffer, SizeInBytes);
-    }
+    scsiRequest.Cdb[0x00]  = SCSI_COMMAND_READ_BUFFER;
+    scsiRequest.Cdb[0x01]  = SCSI_READ_MODE_VENDOR_SPECIFIC;
+    scsiRequest.Cdb[0x02]  = BRCM_SCSI_BUFFER_ID_MEMORY_RW_DWORD;
+    scsiRequest.Cdb[0x03]  = (U8) ((Address >> 24) & 0xFF);
+    scsiRequest.Cdb[0x04]  = (U8) ((Address >> 16) & 0xFF);
+    scsiRequest.Cdb[0x05]  = (U8) ((Address >>  8) & 0xFF);
+    scsiRequest.Cdb[0x06]  = (U8) ((Address      ) & 0xFF);
+    scsiRequest.Cdb[0x07]  = (U8) ((SizeInBytes >> 8) & 0xFF);
+    scsiRequest.Cdb[0x08]  = (U8) ((SizeInBytes & 0xFF));
+    scsiRequest.Cdb[0x09]  = 0x00;
 
-    sosiMemFree (ptrScsiRequest->PtrDataBuffer);
-    sosiMemFree (ptrScsiRequest);
+    scsiRequest.DataDirection = DIRECTION_READ;
 
-    return (status);
+    return (bsdiPerformScsiPassthrough (PtrExpander, &scsiRequest));
 
 }
 
 SCRUTINY_STATUS bsdScsiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrExpander, __IN__ U32 Address, __IN__ PU32 PtrValue, __IN__ U32 SizeInBytes)
 {
 
-    SCRUTINY_STATUS status;
-
     SCRUTINY_SCSI_PASSTHROUGH scsiRequest = { 0 };
 
+    /* The device only reads the data phase, no need for a copy of the caller buffer */
     scsiRequest.CdbLength = 10;
-    scsiRequest.PtrDataBuffer = (PVOID) sosiMemAlloc (SizeInBytes);
+    scsiRequest.PtrDataBuffer = (PVOID) PtrValue;
     scsiRequest.DataBufferLength = SizeInBytes;
 
     scsiRequest.Cdb[0x00]  = SCSI_COMMAND_WRITE_BUFFER;
@@ -498,13 +815,7 @@ SCRUTINY_STATUS bsdScsiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrExpander, __
 
     scsiRequest.DataDirection = DIRECTION_WRITE;
 
-    sosiMemCopy (scsiRequest.PtrDataBuffer, PtrValue, SizeInBytes);
-
-    status = bsdiPerformScsiPassthrough (PtrExpander, &scsiRequest);
-
-    sosiMemFree (scsiRequest.PtrDataBuffer);
-
-    return (status);
+    return (bsdiPerformScsiPassthrough (PtrExpander, &scsiRequest));
 
 }
 
@@ -667,84 +978,478 @@ SCRUTINY_STATUS bsdiGetRegionSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
 
 }
 
-SCRUTINY_STATUS bsdiGetRegion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 BufferId, __OUT__ PU8 *PtrBuffer, __OUT__ PU32 PtrRegionSize)
+/*
+ *
+ *  @method  bsdReadRegionChunk()
+ *
+ *  @param   PtrDevice          pointer to the device
+ *
+ *  @param   BufferId           Buffer id
+ *
+ *  @param   Offset             offset in the region
+ *
+ *  @param   PtrData            buffer receiving the data
+ *
+ *  @param   ChunkSize          bytes to read, at most what fits the 24 bit CDB length
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief                      issue one READ BUFFER (data mode) against a region
+ *
+ */
+
+static SCRUTINY_STATUS bsdReadRegionChunk (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  U32 Offset,
+                          __OUT__ PU8 PtrData,
+                          __IN__  U32 ChunkSize)
+{
+
+    SCRUTINY_SCSI_PASSTHROUGH scsiRequest = { 0 };
+
+    scsiRequest.CdbLength = 10;
+    scsiRequest.DataDirection = DIRECTION_READ;
+    scsiRequest.PtrDataBuffer = (PVOID) PtrData;
+    scsiRequest.DataBufferLength = ChunkSize;
+
+    scsiRequest.Cdb[0] = SCSI_COMMAND_READ_BUFFER;
+    scsiRequest.Cdb[1] = SCSI_READ_MODE_DATA;
+    scsiRequest.Cdb[2] = BufferId;
+    scsiRequest.Cdb[3] = (U8) (Offset >> 16);
+    scsiRequest.Cdb[4] = (U8) (Offset >> 8);
+    scsiRequest.Cdb[5] = (U8) (Offset & 0xff);
+    scsiRequest.Cdb[6] = (U8) (ChunkSize >> 16);
+    scsiRequest.Cdb[7] = (U8) (ChunkSize >> 8);
+    scsiRequest.Cdb[8] = (U8) (ChunkSize & 0xFF);
+    scsiRequest.Cdb[9] = 0;
+
+    return (bsdiPerformScsiPassthrough (PtrDevice, &scsiRequest));
+
+}
+
+/*
+ *
+ *  @method  bsdiGetTransferSize()
+ *
+ *  @param   PtrDevice          pointer to the device
+ *
+ *  @return  bytes to move per READ BUFFER command on this device
+ *
+ *  @brief                      tune the chunk size once per device. The limit of
+ *                              the sg node and its queue bounds the size, then a
+ *                              READ BUFFER of that size from the running image
+ *                              checks the firmware takes it, halving down to
+ *                              SCSI_TRANSFER_SIZE_MIN until it does. The size is
+ *                              clamped to what the probe read. The probe latency
+ *                              and throughput are kept on the device.
+ *
+ */
+
+U32 bsdiGetTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    U32 candidate = SCSI_TRANSFER_SIZE_MAX;
+    U32 regionSize = 0;
+    U32 probeSize;
+    U32 startTime;
+    U32 elapsed;
+    PU8 ptrProbe = NULL;
+    PTR_SCRUTINY_SCSI_HANDLE ptrScsiHandle;
+#if defined (OS_LINUX)
+    LRC_EXCHANGE exchange;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+#endif
+
+    if ((PtrDevice->HandleType != SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC) &&
+        (PtrDevice->HandleType != SCRUTINY_HANDLE_TYPE_SCSI_ON_MPT_INTERFACE) &&
+        (PtrDevice->HandleType != SCRUTINY_HANDLE_TYPE_SCSI_ON_MFI_INTERFACE))
+    {
+        return (EXPANDER_SCSI_GENERIC_CHUNK_SIZE);
+    }
+
+    ptrScsiHandle = &PtrDevice->Handle.ScsiHandle;
+
+    if (ptrScsiHandle->MaxTransferSize != 0)
+    {
+        return (ptrScsiHandle->MaxTransferSize);
+    }
+
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiGetTransferSize (PtrDevice=%x)", PtrDevice != NULL);
+
+#if defined (OS_LINUX)
+    if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC)
+    {
+        /* The limit comes from the host, a replay has to take the recorded one */
+        lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_VALUE, LRC_VALUE_TAG_MAX_TRANSFER_SIZE, &probeSize, sizeof (U32), TRUE);
+
+        if (!lrciBeginExchange (PtrDevice, &exchange, &status))
+        {
+            probeSize = sgiGetMaxTransferSize (PtrDevice);
+
+            lrciEndExchange (PtrDevice, &exchange, SCRUTINY_STATUS_SUCCESS);
+        }
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            probeSize = 0;
+        }
+
+        if ((probeSize != 0) && (probeSize < candidate))
+        {
+            candidate = probeSize;
+        }
+    }
+#endif
+
+    /* Keep whole pages, and never go below what always worked */
+    candidate = candidate & ~0xFFF;
+
+    if (candidate < SCSI_TRANSFER_SIZE_MIN)
+    {
+        candidate = SCSI_TRANSFER_SIZE_MIN;
+    }
+
+    if (bsdiGetRegionSize (PtrDevice, BRCM_SCSI_BUFFER_ID_RUNNING_FIRMWARE, &regionSize) == SCRUTINY_STATUS_SUCCESS)
+    {
+        ptrProbe = (PU8) sosiMemAlloc (candidate);
+    }
+
+    while (candidate > SCSI_TRANSFER_SIZE_MIN)
+    {
+        probeSize = (candidate < regionSize) ? candidate : regionSize;
+
+        /* Without an image larger than the minimum the size can't be verified */
+        if ((ptrProbe == NULL) || (probeSize <= SCSI_TRANSFER_SIZE_MIN))
+        {
+            candidate = SCSI_TRANSFER_SIZE_MIN;
+            break;
+        }
+
+        startTime = sosiGetMicroSeconds ();
+
+        if (bsdReadRegionChunk (PtrDevice, BRCM_SCSI_BUFFER_ID_RUNNING_FIRMWARE, 0, ptrProbe, probeSize) == SCRUTINY_STATUS_SUCCESS)
+        {
+            elapsed = sosiGetMicroSeconds () - startTime;
+
+            ptrScsiHandle->TransferLatencyMicroSeconds = elapsed;
+            ptrScsiHandle->TransferKBytesPerSecond = (elapsed == 0) ? 0 : (U32) (((probeSize / 1024) * 1000000ULL) / elapsed);
+
+            /* A small image only verified a part of the candidate, keep what was actually read */
+            candidate = probeSize & ~0xFFF;
+
+            break;
+        }
+
+        gPtrLoggerScsi->logiDebug ("READ BUFFER of %x bytes refused, trying half of it", probeSize);
+
+        candidate = candidate / 2;
+    }
+
+    /* Halving a size which is not a power of two steps over the minimum */
+    if (candidate < SCSI_TRANSFER_SIZE_MIN)
+    {
+        candidate = SCSI_TRANSFER_SIZE_MIN;
+    }
+
+    if (ptrProbe != NULL)
+    {
+        sosiMemFree (ptrProbe);
+    }
+
+    ptrScsiHandle->MaxTransferSize = candidate;
+
+    gPtrLoggerScsi->logiFunctionExit ("bsdiGetTransferSize (Size=%x, Latency=%d us, Throughput=%d KB/s)",
+                                         candidate, ptrScsiHandle->TransferLatencyMicroSeconds,
+                                         ptrScsiHandle->TransferKBytesPerSecond);
+
+    return (candidate);
+
+}
+
+/*
+ *
+ *  @method  bsdiStreamRegion()
+ *
+ *  @param   PtrDevice          pointer to the device
+ *
+ *  @param   BufferId           Buffer id
+ *
+ *  @param   Sink               called for every chunk, in region order
+ *
+ *  @param   PtrContext         passed through to the sink
+ *
+ *  @param   PtrRegionSize      The region size
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief                      upload a region through a single chunk sized buffer,
+ *                              each chunk is handed to the sink as soon as it
+ *                              arrives, a sink failure stops the upload
+ *
+ */
+
+SCRUTINY_STATUS bsdiStreamRegion (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  BSDI_REGION_SINK Sink,
+                          __IN__  PVOID PtrContext,
+                          __OUT__ PU32 PtrRegionSize)
 {
 
     U32 sizeTotal = 0, chunkSize = 0;
     U32 offset = 0;
-    PU8 ptrBuffer = NULL;
-    SCRUTINY_STATUS status;
-    SCRUTINY_SCSI_PASSTHROUGH scsiRequest = { 0 };
+    U32 transferSize;
+    PU8 ptrChunk = NULL;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
 
-    gPtrLoggerScsi->logiFunctionEntry ("bsdiGetRegion (PtrDevice=%x, BufferId=%x)",
-                                          PtrDevice != NULL, BufferId);
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiStreamRegion (PtrDevice=%x, BufferId=%x, Sink=%x)",
+                                          PtrDevice != NULL, BufferId, Sink != NULL);
 
-    *PtrBuffer = NULL;
+    *PtrRegionSize = 0;
 
     if (bsdiGetRegionSize (PtrDevice, BufferId, &sizeTotal) != SCRUTINY_STATUS_SUCCESS)
     {
-        gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Region Size Failed)");
+        gPtrLoggerScsi->logiFunctionExit ("bsdiStreamRegion (Region Size Failed)");
         return (SCRUTINY_STATUS_FAILED);
     }
 
-    ptrBuffer = (PU8) sosiMemAlloc (sizeTotal);
     *PtrRegionSize = sizeTotal;
 
-    if (ptrBuffer == NULL)
+    transferSize = bsdiGetTransferSize (PtrDevice);
+
+#if defined (OS_LINUX)
+    if ((PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC) && (PtrDevice->PtrRecordReplay == NULL))
     {
-        gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Memory Allocation)");
-        return (SCRUTINY_STATUS_FAILED);
-    }
+        /* The sink of one chunk runs while the next chunks are being transferred */
+        ldmiLockDevice (PtrDevice);
 
-    scsiRequest.CdbLength = 10;
-    scsiRequest.DataDirection = DIRECTION_READ;
+        status = sgiPipelinedReadBuffer (PtrDevice, BufferId, 0, sizeTotal, transferSize,
+                                         NULL, Sink, PtrContext);
 
-    scsiRequest.Cdb[0] = SCSI_COMMAND_READ_BUFFER;
-    scsiRequest.Cdb[1] = SCSI_READ_MODE_DATA;
-    scsiRequest.Cdb[2] = BufferId;
-    scsiRequest.Cdb[9] = 0;
+        ldmiUnlockDevice (PtrDevice);
 
-    scsiRequest.DataDirection = DIRECTION_READ;
+        gPtrLoggerScsi->logiFunctionExit ("bsdiStreamRegion (Status=%x, Size=%x)", status, *PtrRegionSize);
+        return (status);
+    }
+#endif
+
+    ptrChunk = (PU8) sosiMemAlloc (sizeTotal < transferSize ? sizeTotal : transferSize);
+
+    if ((ptrChunk == NULL) && (sizeTotal != 0))
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiStreamRegion (Memory Allocation)");
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
 
     while (sizeTotal)
     {
-        if (sizeTotal < EXPANDER_SCSI_GENERIC_CHUNK_SIZE)
+        chunkSize = (sizeTotal < transferSize) ? sizeTotal : transferSize;
+
+        status = bsdReadRegionChunk (PtrDevice, BufferId, offset, ptrChunk, chunkSize);
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
         {
-            chunkSize = sizeTotal;
+            gPtrLoggerScsi->logiDebug ("BRCM SCSI Stream region failed. BufferId=%x, Offset=%x, ChunkSize=%x, TotalSize=%x, Status=%x.",
+                                         BufferId, offset, chunkSize, *PtrRegionSize, status);
+            break;
         }
 
-        else
+        status = Sink (PtrContext, offset, ptrChunk, chunkSize);
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
         {
-            chunkSize = EXPANDER_SCSI_GENERIC_CHUNK_SIZE;
+            gPtrLoggerScsi->logiDebug ("BRCM SCSI Stream region sink failed. Offset=%x, Status=%x.", offset, status);
+            break;
         }
 
-        scsiRequest.PtrDataBuffer = (PVOID) &ptrBuffer[offset];
-        scsiRequest.DataBufferLength = chunkSize;
+        sizeTotal = sizeTotal - chunkSize;
+        offset = offset + chunkSize;
+    }
+
+    if (ptrChunk != NULL)
+    {
+        sosiMemFree (ptrChunk);
+    }
 
-        scsiRequest.Cdb[3] = (U8) (offset >> 16);
-        scsiRequest.Cdb[4] = (U8) (offset >> 8);
-        scsiRequest.Cdb[5] = (U8) (offset & 0xff);
-        scsiRequest.Cdb[6] = (U8) (chunkSize >> 16);
-        scsiRequest.Cdb[7] = (U8) (chunkSize >> 8);
-        scsiRequest.Cdb[8] = (U8) (chunkSize & 0xFF);
+    gPtrLoggerScsi->logiFunctionExit ("bsdiStreamRegion (Status=%x, Size=%x)", status, *PtrRegionSize);
 
-        status = bsdiPerformScsiPassthrough (PtrDevice, &scsiRequest);
+    return (status);
 
-        if (status)
-        {
+}
+
+static SCRUTINY_STATUS bsdRegionFileSink (
+                          __IN__ PVOID PtrContext,
+                          __IN__ U32 Offset,
+                          __IN__ PU8 PtrChunk,
+                          __IN__ U32 ChunkSize)
+{
+    return (sosiFileWrite ((SOSI_FILE_HANDLE) PtrContext, PtrChunk, ChunkSize));
+}
 
-            gPtrLoggerScsi->logiDebug ("BRCM SCSI Get region failed. BufferId=%x, Offset=%x, ChunkSize=%x, TotalSize=%x, Status=%x, Scsistatus=%x.",
-                                         BufferId, offset, chunkSize, *PtrRegionSize, status, scsiRequest.ScsiStatus);
+/*
+ *
+ *  @method  bsdiStreamRegionToFile()
+ *
+ *  @param   PtrDevice          pointer to the device
+ *
+ *  @param   BufferId           Buffer id
+ *
+ *  @param   FileHandle         open file the region is appended to
+ *
+ *  @param   PtrRegionSize      The region size
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief                      upload a region straight into a file
+ *
+ */
 
-            gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Scsi Failed=%x)");
+SCRUTINY_STATUS bsdiStreamRegionToFile (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  SOSI_FILE_HANDLE FileHandle,
+                          __OUT__ PU32 PtrRegionSize)
+{
+    return (bsdiStreamRegion (PtrDevice, BufferId, bsdRegionFileSink, (PVOID) FileHandle, PtrRegionSize));
+}
 
-            sosiMemFree (ptrBuffer);
-            return (status);
+/*
+ *
+ *  @method  bsdiReadRegion()
+ *
+ *  @param   PtrDevice          pointer to the device
+ *
+ *  @param   BufferId           Buffer id
+ *
+ *  @param   Offset             offset in the region to start at
+ *
+ *  @param   PtrBuffer          buffer receiving the data
+ *
+ *  @param   Length             bytes to read
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief                      read part of a region, the region size is not
+ *                              queried so a read past the end fails on the device.
+ *                              On sg nodes the driver only maps a page aligned
+ *                              PtrBuffer for direct IO, others take the driver copy
+ *
+ */
+
+SCRUTINY_STATUS bsdiReadRegion (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  U32 Offset,
+                          __OUT__ PU8 PtrBuffer,
+                          __IN__  U32 Length)
+{
+
+    U32 chunkSize;
+    U32 transferSize;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiReadRegion (PtrDevice=%x, BufferId=%x, Offset=%x, Length=%x)",
+                                          PtrDevice != NULL, BufferId, Offset, Length);
+
+    /* The CDB carries a 24 bit buffer offset */
+    if ((Offset > 0xFFFFFF) || (Length > (0x1000000 - Offset)))
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiReadRegion (Status=%x)", SCRUTINY_STATUS_INVALID_PARAMETER);
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    /* A small read, like a firmware header, is not worth the tuning probe */
+    transferSize = (Length <= SCSI_TRANSFER_SIZE_MIN) ? SCSI_TRANSFER_SIZE_MIN : bsdiGetTransferSize (PtrDevice);
+
+#if defined (OS_LINUX)
+    if ((PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC) && (PtrDevice->PtrRecordReplay == NULL))
+    {
+        /* Chunks land in place, more than one READ BUFFER is kept queued on the sg node, traced devices go command by command */
+        ldmiLockDevice (PtrDevice);
+
+        status = sgiPipelinedReadBuffer (PtrDevice, BufferId, Offset, Length, transferSize,
+                                         PtrBuffer, NULL, NULL);
+
+        ldmiUnlockDevice (PtrDevice);
+
+        gPtrLoggerScsi->logiFunctionExit ("bsdiReadRegion (Status=%x)", status);
+        return (status);
+    }
+#endif
+
+    while (Length)
+    {
+        chunkSize = (Length < transferSize) ? Length : transferSize;
+
+        status = bsdReadRegionChunk (PtrDevice, BufferId, Offset, PtrBuffer, chunkSize);
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
         }
 
-        sizeTotal = sizeTotal - chunkSize;
-        offset = offset + chunkSize;
+        Length = Length - chunkSize;
+        Offset = Offset + chunkSize;
+        PtrBuffer = PtrBuffer + chunkSize;
+    }
 
+    gPtrLoggerScsi->logiFunctionExit ("bsdiReadRegion (Status=%x)", status);
+
+    return (status);
+
+}
+
+SCRUTINY_STATUS bsdiGetRegion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 BufferId, __OUT__ PU8 *PtrBuffer, __OUT__ PU32 PtrRegionSize)
+{
+
+    U32 sizeTotal = 0;
+    PU8 ptrBuffer = NULL;
+    SCRUTINY_STATUS status;
+
+    gPtrLoggerScsi->logiFunctionEntry ("bsdiGetRegion (PtrDevice=%x, BufferId=%x)",
+                                          PtrDevice != NULL, BufferId);
+
+    *PtrBuffer = NULL;
+
+    if (bsdiGetRegionSize (PtrDevice, BufferId, &sizeTotal) != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Region Size Failed)");
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+#if defined (OS_LINUX)
+    if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC)
+    {
+        /* Page aligned, with chunks of whole pages every READ BUFFER lands in place without the driver copy */
+        ptrBuffer = sgiAllocAlignedBuffer (sizeTotal);
+    }
+    else
+#endif
+    {
+        ptrBuffer = (PU8) sosiMemAlloc (sizeTotal);
+    }
+
+    *PtrRegionSize = sizeTotal;
+
+    if (ptrBuffer == NULL)
+    {
+        gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Memory Allocation)");
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    status = bsdiReadRegion (PtrDevice, BufferId, 0, ptrBuffer, sizeTotal);
+
+    if (status)
+    {
+
+        gPtrLoggerScsi->logiDebug ("BRCM SCSI Get region failed. BufferId=%x, TotalSize=%x, Status=%x.",
+                                     BufferId, *PtrRegionSize, status);
+
+        gPtrLoggerScsi->logiFunctionExit ("bsdiGetRegion (Scsi Failed=%x)", status);
+
+        sosiMemFree (ptrBuffer);
+        return (status);
     }
 
     *PtrBuffer = ptrBuffer;
@@ -780,7 +1485,9 @@ SCRUTINY_STATUS bsdiDownloadRegion (
     SCRUTINY_STATUS                 status;
     SCRUTINY_SCSI_PASSTHROUGH       scsiRequest = { 0 };
     PU8 ptrTemp = NULL;
+    PU8 ptrStaging = NULL;
     U32 offset = 0;
+    /* The tuned size is only verified for READ BUFFER, writes keep the size the firmware was always given */
     U32 chunkSize = (256 * 1024);
 
     gPtrLoggerGeneric->logiFunctionEntry ("bsdiDownloadRegion (BufferId=0x%x, PtrBuffer=0x%x, BufferSize=0x%x)", 
@@ -797,6 +1504,25 @@ SCRUTINY_STATUS bsdiDownloadRegion (
     ptrTemp = PtrBuffer;
     scsiRequest.DataDirection = DIRECTION_WRITE;
 
+#if defined (OS_LINUX)
+    if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC)
+    {
+        /*
+         * The image comes from the caller, stage the chunks through the aligned
+         * device buffer so the sg driver maps it instead of copying. The device
+         * stays locked as the buffer is shared with the pipelined reads.
+         */
+        ldmiLockDevice (PtrDevice);
+
+        ptrStaging = sgiGetTransferBuffer (PtrDevice, chunkSize);
+
+        if (ptrStaging == NULL)
+        {
+            ldmiUnlockDevice (PtrDevice);
+        }
+    }
+#endif
+
     while (BufferSize)
     {
         if (BufferSize < chunkSize)
@@ -804,6 +1530,11 @@ SCRUTINY_STATUS bsdiDownloadRegion (
             chunkSize = BufferSize;
         }
 
+        if (ptrStaging != NULL)
+        {
+            sosiMemCopy (ptrStaging, ptrTemp, chunkSize);
+        }
+
         scsiRequest.Cdb[0x03]  = (U8) ((offset >> 16) & 0xFF);;
         scsiRequest.Cdb[0x04]  = (U8) ((offset >> 8) & 0xFF);
         scsiRequest.Cdb[0x05]  = (U8) (offset & 0xFF);
@@ -812,13 +1543,18 @@ SCRUTINY_STATUS bsdiDownloadRegion (
         scsiRequest.Cdb[0x08]  = (U8) (chunkSize & 0xFF);
         
 
-        scsiRequest.PtrDataBuffer = (PVOID) ptrTemp;
+        scsiRequest.PtrDataBuffer = (ptrStaging != NULL) ? (PVOID) ptrStaging : (PVOID) ptrTemp;
         scsiRequest.DataBufferLength = chunkSize;
 
         status = bsdiPerformScsiPassthrough (PtrDevice, &scsiRequest);
 
         if (status != SCRUTINY_STATUS_SUCCESS)
         {
+            if (ptrStaging != NULL)
+            {
+                ldmiUnlockDevice (PtrDevice);
+            }
+
             gPtrLoggerGeneric->logiFunctionExit ("bsdiDownloadRegion (chunkSize=0x%x, offset=0x%x)", 
                                           chunkSize, offset);
             return (status);
@@ -829,6 +1565,11 @@ SCRUTINY_STATUS bsdiDownloadRegion (
         ptrTemp = ptrTemp + chunkSize;
     }
 
+    if (ptrStaging != NULL)
+    {
+        ldmiUnlockDevice (PtrDevice);
+    }
+
     gPtrLoggerGeneric->logiFunctionExit("bsdiDownloadRegion ()");
     return (SCRUTINY_STATUS_SUCCESS);
 }
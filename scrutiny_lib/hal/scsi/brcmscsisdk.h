@@ -72,6 +72,13 @@
 #define BRCM_SCSI_DEVICE_CONFIG_PAGE_REGION_PERSISTENT      (1)
 #define BRCM_SCSI_DEVICE_CONFIG_PAGE_REGION_MFG             (2)
 
+/*
+ * Scatter/gather register reads. Addresses are coalesced into spans of at most
+ * BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES, each fetched by a single READ BUFFER.
+ */
+#define BRCM_SCSI_SCATTER_READ_MAX_SPAN_BYTES               (4 * 1024)
+#define BRCM_SCSI_SCATTER_READ_NO_GAP                       (0)
+
 
 SCRUTINY_STATUS bsdiDiscoverDevices();
 
@@ -81,6 +88,19 @@ SCRUTINY_STATUS bsdiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U
 SCRUTINY_STATUS bsdiMemoryRead16 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __OUT__ PU16 PtrData, __IN__ U32 SizeInBytes);
 SCRUTINY_STATUS bsdiMemoryRead8 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __OUT__ PU8 PtrData, __IN__ U32 SizeInBytes);
 
+SCRUTINY_STATUS bsdiMemoryReadScatter32 (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  PU32 PtrAddressList,
+                          __OUT__ PU32 PtrData,
+                          __IN__  U32 Count,
+                          __IN__  U32 MaxGapInBytes);
+
+SCRUTINY_STATUS bsdiMemoryReadFifo32 (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U32 Address,
+                          __OUT__ PU32 PtrData,
+                          __IN__  U32 Count);
+
 SCRUTINY_STATUS bsdiGetCurrentFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PU32 PtrVersion);
 
 SCRUTINY_STATUS bsdiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __IN__ PU32 PtrData);
@@ -100,6 +120,38 @@ SCRUTINY_STATUS bsdiGetRegion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 B
 
 SCRUTINY_STATUS bsdiGetRegionSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 BufferId, __OUT__ PU32 PtrSize);
 
+U32 bsdiGetTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+/*
+ * Receives the chunks of a streamed region in order. The chunk buffer is
+ * reused for the next chunk once the sink returns.
+ */
+typedef SCRUTINY_STATUS (*BSDI_REGION_SINK) (
+                          __IN__ PVOID PtrContext,
+                          __IN__ U32 Offset,
+                          __IN__ PU8 PtrChunk,
+                          __IN__ U32 ChunkSize);
+
+SCRUTINY_STATUS bsdiStreamRegion (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  BSDI_REGION_SINK Sink,
+                          __IN__  PVOID PtrContext,
+                          __OUT__ PU32 PtrRegionSize);
+
+SCRUTINY_STATUS bsdiReadRegion (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  U32 Offset,
+                          __OUT__ PU8 PtrBuffer,
+                          __IN__  U32 Length);
+
+SCRUTINY_STATUS bsdiStreamRegionToFile (
+                          __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+                          __IN__  U8 BufferId,
+                          __IN__  SOSI_FILE_HANDLE FileHandle,
+                          __OUT__ PU32 PtrRegionSize);
+
 SCRUTINY_STATUS bsdiDownloadRegion (
                           __IN__ PTR_SCRUTINY_DEVICE PtrDevice, 
                           __IN__ U8 BufferId, 
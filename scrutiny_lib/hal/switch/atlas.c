@@ -46,6 +46,8 @@ SCRUTINY_STATUS atlasiRegisterBasedQualifSwitch (__IN__ PTR_SCRUTINY_DEVICE PtrD
 
     U32 chip;
     U32 revision;
+    U32 addressList[] = { REGISTER_ADDRESS_ATLAS_CCR_CHIP_DEVICE_ID, REGISTER_ADDRESS_ATLAS_CCR_CHIP_REVISION };
+    U32 valueList[2] = { 0 };
 
     SCRUTINY_STATUS status;
 
@@ -53,27 +55,21 @@ SCRUTINY_STATUS atlasiRegisterBasedQualifSwitch (__IN__ PTR_SCRUTINY_DEVICE PtrD
 
     gPtrLoggerGeneric->logiVerbose ("Qualify Atlas Switch with Handle type = %x", PtrDevice->HandleType);
 
-    status = bsdiMemoryRead32 (PtrDevice,
-                               REGISTER_ADDRESS_ATLAS_CCR_CHIP_DEVICE_ID,
-                               &chip,
-                               sizeof (U32));
+    /* Device ID and revision are adjacent, fetch both with one access */
+    status = bsdiMemoryReadScatter32 (PtrDevice,
+                                      addressList,
+                                      valueList,
+                                      sizeof (addressList) / sizeof (U32),
+                                      BRCM_SCSI_SCATTER_READ_NO_GAP);
 
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
-        gPtrLoggerGeneric->logiFunctionExit ("atlasiRegisterBasedQualifSwitch (DevId Read Failed=%x)", status);
+        gPtrLoggerGeneric->logiFunctionExit ("atlasiRegisterBasedQualifSwitch (DevId/Revision Read Failed=%x)", status);
         return (SCRUTINY_STATUS_IGNORE);
     }
 
-    status = bsdiMemoryRead32 (PtrDevice,
-                               REGISTER_ADDRESS_ATLAS_CCR_CHIP_REVISION,
-                               &revision,
-                               sizeof (U32));
-
-    if (status != SCRUTINY_STATUS_SUCCESS)
-    {
-        gPtrLoggerGeneric->logiFunctionExit ("atlasiRegisterBasedQualifSwitch (Revision Failed=%x)", status);
-        return (SCRUTINY_STATUS_IGNORE);
-    }
+    chip = valueList[0];
+    revision = valueList[1];
 
     gPtrLoggerGeneric->logiDebug ("Atlas component signatures ChipId=%x, RevisonId=%x", chip, revision);
 
@@ -150,12 +146,45 @@ SCRUTINY_STATUS atlasiQualifySGSwitch (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
 
 }
 
+/**
+ *
+ *  @method  atlasSGGetRegionFirmwareVersion()
+ *
+ *  @param   PtrDevice          pointer to Switch device
+ *
+ *  @param   Region             buffer ID of the firmware region
+ *
+ *  @param   PtrVersion         version found in the image header
+ *
+ *  @return  STATUS_SUCCESS if the header could be read, otherwise the
+ *           status of the READ BUFFER is returned.
+ *
+ *  @brief   This method reads only the firmware header of a region
+ *
+ */
+
+SCRUTINY_STATUS atlasSGGetRegionFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 Region, __OUT__ PU32 PtrVersion)
+{
+
+    ATLAS_FW_HEADER fwHeader;
+    SCRUTINY_STATUS status;
+
+    status = bsdiReadRegion (PtrDevice, Region, 0, (PU8) &fwHeader, sizeof (ATLAS_FW_HEADER));
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (status);
+    }
+
+    *PtrVersion = fwHeader.FWVersion.Word;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
 SCRUTINY_STATUS atlasSGAssignFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PU32 PtrVersion)
 {
 
-    U32 regionSize = 0;
-    PU8 ptrFirmware = NULL;
-    PTR_ATLAS_FW_HEADER ptrFwHeader = NULL;
     U32 version = 0xFFFFFFFF;
     U32 index;
 
@@ -168,19 +197,13 @@ SCRUTINY_STATUS atlasSGAssignFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDevi
 
     for (index = 0; index < 4; index++)
     {
-        /* We can get the firmware version by getting the current firmware */
+        /* The version sits in the image header, there is no need for the whole image */
 
-        if (bsdiGetRegion (PtrDevice, region[index], &ptrFirmware, &regionSize))
+        if (atlasSGGetRegionFirmwareVersion (PtrDevice, region[index], &version))
         {
             continue;
         }
 
-        ptrFwHeader = (PTR_ATLAS_FW_HEADER) ptrFirmware;
-
-        version = ptrFwHeader->FWVersion.Word;
-
-        sosiMemFree (ptrFirmware);
-
         if ((version != 0xFFFFFFFF) && (version != 0x00000000))
         {
             gPtrLoggerGeneric->logiDebug ("Atlas SCSI Device - Firmware Version=%x", version);
@@ -732,6 +755,93 @@ SCRUTINY_STATUS atlasPCIeConfigurationSpaceRead (
 
 }
 
+/**
+ *
+ * @method  atlasPCIeConfigurationSpaceReadScatter()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @param   Port           port for the registers
+ *
+ * @param   PtrOffsetList  register offsets to be retrieved
+ *
+ * @param   PtrValues      PtrValues[i] receives the value of PtrOffsetList[i]
+ *
+ * @param   Count          number of offsets
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   read several configuration registers of a port with as few
+ *          device accesses as possible
+ *
+ *
+ */
+SCRUTINY_STATUS atlasPCIeConfigurationSpaceReadScatter (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __IN__  U32 Port,
+    __IN__  PU32 PtrOffsetList,
+    __OUT__ PU32 PtrValues,
+    __IN__  U32 Count
+)
+{
+
+    U32 index;
+    U32 addressList[ATLAS_PCIE_CONFIG_SPACE_SCATTER_MAX_REGS];
+    U32 baseAddress = ATLAS_REGISTER_BASE_ADDRESS_PSB_PORT_CONFIG_SPACE + (Port * ATLAS_REGISTER_SIZE_PORT_CONFIG_SPACE_SIZE);
+
+    if (Count > ATLAS_PCIE_CONFIG_SPACE_SCATTER_MAX_REGS)
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    for (index = 0; index < Count; index++)
+    {
+        addressList[index] = baseAddress + PtrOffsetList[index];
+    }
+
+    return (bsdiMemoryReadScatter32 (PtrDevice, addressList, PtrValues, Count, ATLAS_PCIE_CONFIG_SPACE_SCATTER_MAX_GAP));
+
+}
+
+/**
+ *
+ * @method  atlasPCIeConfigurationSpaceReadFifo()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @param   Port           port for the register
+ *
+ * @param   Offset         offset of the FIFO register
+ *
+ * @param   PtrValues      receives Count values popped from the FIFO
+ *
+ * @param   Count          number of values to pop
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   read a FIFO configuration register Count times in one burst
+ *
+ *
+ */
+SCRUTINY_STATUS atlasPCIeConfigurationSpaceReadFifo (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __IN__  U32 Port,
+    __IN__  U32 Offset,
+    __OUT__ PU32 PtrValues,
+    __IN__  U32 Count
+)
+{
+
+    U32 baseAddress = ATLAS_REGISTER_BASE_ADDRESS_PSB_PORT_CONFIG_SPACE + (Port * ATLAS_REGISTER_SIZE_PORT_CONFIG_SPACE_SIZE);
+
+    baseAddress += Offset;
+
+    return (bsdiMemoryReadFifo32 (PtrDevice, baseAddress, PtrValues, Count));
+
+}
+
 /**
  *
  * @method  atlasPCIeConfigurationSpaceWrite()
@@ -33,8 +33,30 @@
 #ifndef __ATLAS__H__
 #define __ATLAS__H__
 
+/*
+ * PCIe configuration space reads have no side effects, so short holes between
+ * requested offsets can be read through when coalescing scattered reads.
+ */
+#define ATLAS_PCIE_CONFIG_SPACE_SCATTER_MAX_GAP     (0x40)
+#define ATLAS_PCIE_CONFIG_SPACE_SCATTER_MAX_REGS    (16)
+
+/*
+ * Chime to AXI polling. The control status register is spun on for a few reads
+ * and then polled with an exponential micro-second back-off until the timeout.
+ */
+#define ATLAS_CHIME_TO_AXI_SPIN_POLLS               (32)
+#define ATLAS_CHIME_TO_AXI_MAX_BACKOFF_US           (64)
+#define ATLAS_CHIME_TO_AXI_BUSY_TIMEOUT_US          (10000)
+#define ATLAS_CHIME_TO_AXI_DONE_TIMEOUT_US          (1000)
+
+#define ATLAS_CHIME_TO_AXI_STATUS_BUSY              (1 << 2)
+#define ATLAS_CHIME_TO_AXI_STATUS_READ_DONE         (1 << 3)
+#define ATLAS_CHIME_TO_AXI_COMMAND_WRITE            (0x01)
+#define ATLAS_CHIME_TO_AXI_COMMAND_READ             (0x02)
+
 
 SCRUTINY_STATUS atlasSGAssignFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDeviceEntry, __OUT__ PU32 PtrVersion);
+SCRUTINY_STATUS atlasSGGetRegionFirmwareVersion (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 Region, __OUT__ PU32 PtrVersion);
 
 SCRUTINY_STATUS atlasSGAssignSASAddress (__IN__ PTR_SCRUTINY_DEVICE PtrDeviceEntry);
 
@@ -54,6 +76,9 @@ SCRUTINY_STATUS atlasiQualifyPCIDevice (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDevic
 
 SCRUTINY_STATUS atlasiPciChimeToAxiWriteRegister (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __IN__ U32 Data);
 SCRUTINY_STATUS atlasiPciChimeToAxiReadRegister (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData);
+SCRUTINY_STATUS atlasiPciChimeToAxiReadBlock (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData, __IN__ U32 Count);
+SCRUTINY_STATUS atlasiPciChimeToAxiReadFifo (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData, __IN__ U32 Count);
+SCRUTINY_STATUS atlasiGetChimeToAxiStatistics (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __OUT__ PTR_SCRUTINY_PCI_ACCESS_STATISTICS PtrStatistics, __IN__ BOOLEAN Reset);
 
 SCRUTINY_STATUS atlasiFSMFallBackRegisterWrite (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 Data);
 SCRUTINY_STATUS atlasiFSMFallBackRegisterRead (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData);
@@ -65,6 +90,22 @@ SCRUTINY_STATUS atlasGetSwitchMode (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
 
 SCRUTINY_STATUS atlasPCIeConfigurationSpaceRead (PTR_SCRUTINY_DEVICE PtrDevice, U32 Port, U32 Offset, PU32 PtrValue);
 
+SCRUTINY_STATUS atlasPCIeConfigurationSpaceReadScatter (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __IN__  U32 Port,
+    __IN__  PU32 PtrOffsetList,
+    __OUT__ PU32 PtrValues,
+    __IN__  U32 Count
+);
+
+SCRUTINY_STATUS atlasPCIeConfigurationSpaceReadFifo (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __IN__  U32 Port,
+    __IN__  U32 Offset,
+    __OUT__ PU32 PtrValues,
+    __IN__  U32 Count
+);
+
 SCRUTINY_STATUS atlasPCIeConfigurationSpaceWrite (  
     __IN__  PTR_SCRUTINY_DEVICE PtrDevice, 
     __IN__  U32 Port, 
@@ -85,6 +85,15 @@ SCRUTINY_STATUS atlasiQualifyPCIDevice (PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocati
         return (SCRUTINY_STATUS_FAILED);
     }
 
+    /*
+     * The downstream ports of a switch we already have carry the same ids,
+     * drop them before atlasAddDevice sizes and maps their BARs.
+     */
+    if (atlasIsDeviceExist (PtrDeviceLocation) == SCRUTINY_STATUS_SUCCESS)
+    {
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
     /* We have got the device now, we can now add the device into the tree. */
     return (atlasAddDevice (PtrDeviceLocation, &configSpace));
 
@@ -124,10 +133,12 @@ SCRUTINY_STATUS atlasAddDevice (PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocation, PTR_
     ptrDevice->Handle.PciHandle.PciLocation.BusNumber = PtrDeviceLocation->BusNumber;
     ptrDevice->Handle.PciHandle.PciLocation.DeviceNumber = PtrDeviceLocation->DeviceNumber;
     ptrDevice->Handle.PciHandle.PciLocation.FunctionNumber = PtrDeviceLocation->FunctionNumber;
+    ptrDevice->Handle.PciHandle.PciLocation.SegmentNumber = PtrDeviceLocation->SegmentNumber;
 
     ptrDevice->DeviceInfo.u.SwitchInfo.PciAddress.BusNumber = PtrDeviceLocation->BusNumber;
     ptrDevice->DeviceInfo.u.SwitchInfo.PciAddress.DeviceNumber = PtrDeviceLocation->DeviceNumber;
     ptrDevice->DeviceInfo.u.SwitchInfo.PciAddress.FunctionNumber = PtrDeviceLocation->FunctionNumber;
+    ptrDevice->DeviceInfo.u.SwitchInfo.PciAddress.SegmentNumber = PtrDeviceLocation->SegmentNumber;
 
     sosiMemCopy (&ptrDevice->Handle.PciHandle.ConfigSpace, PtrConfigSpace, sizeof(IAL_PCI_CONFIG_SPACE));
 
@@ -164,16 +175,6 @@ SCRUTINY_STATUS atlasAddDevice (PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocation, PTR_
 
     }
 
-    if (atlasIsDeviceExist (PtrDeviceLocation) == SCRUTINY_STATUS_SUCCESS)
-    {
-
-        sosiMemFree (ptrDevice);
-
-        /* We don't need to add again. */
-        return (SCRUTINY_STATUS_IGNORE);
-    }
-
-
     if (!status)
     {
         status = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice);
@@ -262,6 +263,12 @@ SCRUTINY_STATUS atlasIsParentFound (PTR_SCRUTINY_PCI_ADDRESS PtrRootDevice, PTR_
     IAL_PCI_CONFIG_SPACE configSpace, rootConfigSpace;
     SCRUTINY_PCI_ADDRESS child;
 
+    /* Bus numbers are only unique inside a PCI segment */
+    if (PtrRootDevice->SegmentNumber != PtrDeviceLocation->SegmentNumber)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
     if (pdiGetConfigurationSpace (PtrDeviceLocation, &configSpace))
     {
         return (SCRUTINY_STATUS_FAILED);
@@ -285,6 +292,9 @@ SCRUTINY_STATUS atlasIsParentFound (PTR_SCRUTINY_PCI_ADDRESS PtrRootDevice, PTR_
         return (SCRUTINY_STATUS_SUCCESS);
     }
 
+    sosiMemSet (&child, 0, sizeof (SCRUTINY_PCI_ADDRESS));
+
+    child.SegmentNumber = PtrRootDevice->SegmentNumber;
     child.BusNumber = rootConfigSpace.P2PConfig.SecondaryBusNumber;
 
     if (child.BusNumber == 0)
@@ -304,6 +314,21 @@ SCRUTINY_STATUS pdiGetConfigurationSpace (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDev
 
     sosiMemSet (PtrConfigSpace, 0, sizeof (IAL_PCI_CONFIG_SPACE));
 
+#if defined (OS_LINUX)
+
+    /* Snapshot the whole header with a single driver request */
+    if (pcsiReadConfigSpace (*PtrDeviceLocation, 0, PtrConfigSpace->Dwords, 64) == SCRUTINY_STATUS_SUCCESS)
+    {
+        if (PtrConfigSpace->Dwords[0] == 0xFFFFFFFF)
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+#endif
+
     for (index = 0; index < 256; index += 4)
     {
         pcsiReadDword (*PtrDeviceLocation, index, &dword);
@@ -457,47 +482,128 @@ SCRUTINY_STATUS atlasPciDiagWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN_
 
 }
 
-SCRUTINY_STATUS atlasFSMBusyClearCheck (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch)
+#define ATLAS_CHIME_TO_AXI_REGISTER(Offset)     (ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS + \
+                                                 ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET + \
+                                                 (Offset))
+
+/**
+ *
+ * @method  atlasChimeToAxiPollStatus()
+ *
+ * @param   PtrSwitch       Pointer to the switch
+ *
+ * @param   Mask            Control status bit to wait on
+ *
+ * @param   WaitForSet      TRUE to wait for the bit to be set, FALSE for cleared
+ *
+ * @param   TimeoutMicro    Give up after this many micro-seconds
+ *
+ * @return  SCRUTINY_STATUS      SCRUTINY_STATUS_SUCCESS when the bit reached the state
+ *
+ * @brief   Spin on the Chime to AXI control status register for a few reads and
+ *          then back off in micro-second steps, instead of milli-second sleeps.
+ *          The time slept is counted as well, so the wait ends on hosts where
+ *          sosiGetMicroSeconds () has no clock to read.
+ *
+ */
+
+SCRUTINY_STATUS atlasChimeToAxiPollStatus (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Mask, __IN__ BOOLEAN WaitForSet, __IN__ U32 TimeoutMicro)
 {
 
-    U32 registerAddress;
-    U32 data;
-    U32 retryCount = 10;
+    U32 data = 0;
+    U32 polls = 0;
+    U32 backOff = 1;
+    U32 slept = 0;
+    U32 startTime;
 
-    registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                      ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                      ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET;
+    startTime = sosiGetMicroSeconds ();
 
-    while (retryCount--)
+    while (TRUE)
     {
-        atlasPciDiagRead32 (PtrSwitch, registerAddress, &data);
+        atlasPciDiagRead32 (PtrSwitch, ATLAS_CHIME_TO_AXI_REGISTER (ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET), &data);
 
-        if ((data >> 2) & 1)                //BIT[2] is set
+        if (((data & Mask) != 0) == WaitForSet)
         {
-            sosiSleep (1);
-            continue;
+            return (SCRUTINY_STATUS_SUCCESS);
         }
 
-        else
+        if (((sosiGetMicroSeconds () - startTime) >= TimeoutMicro) || (slept >= TimeoutMicro))
         {
-            return (SCRUTINY_STATUS_SUCCESS);
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        if (++polls < ATLAS_CHIME_TO_AXI_SPIN_POLLS)
+        {
+            continue;
         }
 
+        sosiMicroSleep (backOff);
+
+        slept += backOff;
+
+        if (backOff < ATLAS_CHIME_TO_AXI_MAX_BACKOFF_US)
+        {
+            backOff <<= 1;
+        }
     }
 
-    registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                      ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                      ATLAS_REGISTER_CHIME_TO_AXI_ADDRESS_OFFSET;
+}
 
-    atlasPciDiagRead32 (PtrSwitch, registerAddress, &data);
+SCRUTINY_STATUS atlasFSMBusyClearCheck (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch)
+{
+
+    U32 data;
+
+    if (atlasChimeToAxiPollStatus (PtrSwitch, ATLAS_CHIME_TO_AXI_STATUS_BUSY, FALSE, ATLAS_CHIME_TO_AXI_BUSY_TIMEOUT_US) == SCRUTINY_STATUS_SUCCESS)
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    atlasPciDiagRead32 (PtrSwitch, ATLAS_CHIME_TO_AXI_REGISTER (ATLAS_REGISTER_CHIME_TO_AXI_ADDRESS_OFFSET), &data);
 
     gPtrLoggerGeneric->logiDebug ("ChimeToAxi FSM bit is not cleared for the outstanding address in Chime is '%x'",
                                    data);
 
+    PtrSwitch->Handle.PciHandle.AccessStatistics.TimeoutCount++;
+
     return (SCRUTINY_STATUS_FAILED);
 
 }
 
+/**
+ *
+ * @method  atlasChimeToAxiRecordLatency()
+ *
+ * @param   PtrSwitch       Pointer to the switch
+ *
+ * @param   StartTime       Time stamp taken before the access
+ *
+ * @return  U32             Latency of this access in micro-seconds
+ *
+ * @brief   Account one register access in the switch access statistics
+ *
+ */
+
+U32 atlasChimeToAxiRecordLatency (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 StartTime)
+{
+
+    U32 latency;
+    PTR_SCRUTINY_PCI_ACCESS_STATISTICS ptrStatistics = &PtrSwitch->Handle.PciHandle.AccessStatistics;
+
+    latency = sosiGetMicroSeconds () - StartTime;
+
+    ptrStatistics->LastLatency = latency;
+    ptrStatistics->TotalLatency += latency;
+
+    if (latency > ptrStatistics->MaxLatency)
+    {
+        ptrStatistics->MaxLatency = latency;
+    }
+
+    return (latency);
+
+}
+
 SCRUTINY_STATUS atlasiFSMFallBackRegisterRead (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData)
 {
 
@@ -556,75 +662,199 @@ SCRUTINY_STATUS atlasiFSMFallBackRegisterWrite (__IN__ PTR_SCRUTINY_DEVICE PtrSw
 
 }
 
-SCRUTINY_STATUS atlasiPciChimeToAxiReadRegister (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData)
+/**
+ *
+ * @method  atlasChimeToAxiReadCycle()
+ *
+ * @param   PtrSwitch   Pointer to the switch
+ *
+ * @param   Address     AXI address to read
+ *
+ * @param   PtrData     Data read from the address
+ *
+ * @return  SCRUTINY_STATUS      SCRUTINY_STATUS_SUCCESS for the success and non-zero if failed.
+ *
+ * @brief   Perform one read cycle. The caller must have made sure the FSM is not
+ *          busy, a completed cycle leaves it idle for the next one.
+ *
+ */
+
+SCRUTINY_STATUS atlasChimeToAxiReadCycle (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData)
 {
 
     U32 registerAddress;
-    U32 data;
-    U32 retryCount = 100;
 
-    if (atlasFSMBusyClearCheck (PtrSwitch))
+    registerAddress = ATLAS_CHIME_TO_AXI_REGISTER (ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET);
+
+    /* First we will clear the data in the Control status */
+
+    atlasPciDiagWrite32 (PtrSwitch, registerAddress, 0x00);
+
+    /* Now we will write the address */
+
+    atlasPciDiagWrite32 (PtrSwitch, ATLAS_CHIME_TO_AXI_REGISTER (ATLAS_REGISTER_CHIME_TO_AXI_ADDRESS_OFFSET), Address);
+
+    /* Now we will have to perform the cycle read register command which is offset 1 */
+
+    atlasPciDiagWrite32 (PtrSwitch, registerAddress, ATLAS_CHIME_TO_AXI_COMMAND_READ);
+
+    /* Wait for the control status to report the data read successfully done */
+
+    if (atlasChimeToAxiPollStatus (PtrSwitch, ATLAS_CHIME_TO_AXI_STATUS_READ_DONE, TRUE, ATLAS_CHIME_TO_AXI_DONE_TIMEOUT_US))
     {
-        gPtrLoggerGeneric->logiDebug ("FSM Generator bit is not cleared and trying with BAR0 mapped mode.");
-        return (atlasiFSMFallBackRegisterRead (PtrSwitch, Address, PtrData));
+        PtrSwitch->Handle.PciHandle.AccessStatistics.TimeoutCount++;
+        return (SCRUTINY_STATUS_FAILED);
     }
 
-    registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                      ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                      ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET;
+    /* We have a data which is good */
 
-    /* First we will clear the data in the Control status */
+    return (atlasPciDiagRead32 (PtrSwitch, ATLAS_CHIME_TO_AXI_REGISTER (ATLAS_REGISTER_CHIME_TO_AXI_DATA_OFFSET), PtrData));
 
-    atlasPciDiagWrite32 (PtrSwitch, registerAddress, 0x00);
+}
 
-    registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                      ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                      ATLAS_REGISTER_CHIME_TO_AXI_ADDRESS_OFFSET;
+/**
+ *
+ * @method  atlasiPciChimeToAxiReadBlock()
+ *
+ * @param   PtrSwitch   Pointer to the switch
+ *
+ * @param   Address     AXI address of the first DWORD
+ *
+ * @param   PtrData     Buffer for Count DWORDs
+ *
+ * @param   Count       Number of consecutive DWORDs to read
+ *
+ * @return  SCRUTINY_STATUS      SCRUTINY_STATUS_SUCCESS for the success and non-zero if failed.
+ *
+ * @brief   Read consecutive DWORDs through the Chime to AXI FSM. The busy check is
+ *          done once for the block, after that each cycle is issued as soon as the
+ *          previous one has completed.
+ *
+ */
 
-    /* Now we will write the address */
+SCRUTINY_STATUS atlasiPciChimeToAxiReadBlock (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData, __IN__ U32 Count)
+{
 
-    atlasPciDiagWrite32 (PtrSwitch, registerAddress, Address);
+    U32 index;
+    U32 startTime;
+    U32 latency;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
 
-    registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                      ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                      ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET;
+    if (atlasFSMBusyClearCheck (PtrSwitch))
+    {
+        gPtrLoggerGeneric->logiDebug ("FSM Generator bit is not cleared and trying with BAR0 mapped mode.");
 
-    /* Now we will have to perform the cycle read register command which is offset 1 */
+        for (index = 0; index < Count; index++)
+        {
+            PtrSwitch->Handle.PciHandle.AccessStatistics.FallbackCount++;
 
-    atlasPciDiagWrite32 (PtrSwitch, registerAddress, 0x02);
+            status = atlasiFSMFallBackRegisterRead (PtrSwitch, Address + (index * sizeof (U32)), &PtrData[index]);
 
-    while (retryCount--)
+            if (status)
+            {
+                break;
+            }
+        }
+
+        return (status);
+    }
+
+    for (index = 0; index < Count; index++)
     {
+        startTime = sosiGetMicroSeconds ();
+
+        status = atlasChimeToAxiReadCycle (PtrSwitch, Address + (index * sizeof (U32)), &PtrData[index]);
+
+        latency = atlasChimeToAxiRecordLatency (PtrSwitch, startTime);
+
+        if (status)
+        {
+            PtrData[index] = 0;
+            break;
+        }
+
+        PtrSwitch->Handle.PciHandle.AccessStatistics.ReadCount++;
+
+        gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] MR32 %08x, Data=%08x, Latency=%dus", Address + (index * sizeof (U32)), PtrData[index], latency);
+    }
+
+    return (status);
+
+}
 
+/**
+ *
+ * @method  atlasiPciChimeToAxiReadFifo()
+ *
+ * @param   PtrSwitch   Pointer to the switch
+ *
+ * @param   Address     AXI address of the FIFO register
+ *
+ * @param   PtrData     Buffer for Count DWORDs
+ *
+ * @param   Count       Number of times the FIFO register is read
+ *
+ * @return  SCRUTINY_STATUS      SCRUTINY_STATUS_SUCCESS for the success and non-zero if failed.
+ *
+ * @brief   Drain a FIFO register through the Chime to AXI FSM. Same as the
+ *          block read but the address does not advance, and only one debug
+ *          line is logged for the whole burst.
+ *
+ */
 
-        /* Read the control status and see if we have the data read successfully done */
+SCRUTINY_STATUS atlasiPciChimeToAxiReadFifo (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData, __IN__ U32 Count)
+{
 
-        atlasPciDiagRead32 (PtrSwitch, registerAddress, &data);
+    U32 index;
+    U32 startTime;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
 
-        if ((data >> 3) & 0x1)
+    if (atlasFSMBusyClearCheck (PtrSwitch))
+    {
+        gPtrLoggerGeneric->logiDebug ("FSM Generator bit is not cleared and trying with BAR0 mapped mode.");
+
+        for (index = 0; index < Count; index++)
         {
+            PtrSwitch->Handle.PciHandle.AccessStatistics.FallbackCount++;
 
-            /* We have a data which is good */
+            status = atlasiFSMFallBackRegisterRead (PtrSwitch, Address, &PtrData[index]);
 
-            registerAddress = ATLAS_REGISTER_GEP_BAR0_PSB_CHIME_BASE_ADDRESS +
-                              ATLAS_REGISTER_CHIME_GLOBAL_CHIP_REGISTER_OFFSET +
-                              ATLAS_REGISTER_CHIME_TO_AXI_DATA_OFFSET;
+            if (status)
+            {
+                break;
+            }
+        }
 
-            atlasPciDiagRead32 (PtrSwitch, registerAddress, &data);
+        return (status);
+    }
 
-            gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] MR32 %08x, Data=%08x", Address, data);
+    for (index = 0; index < Count; index++)
+    {
+        startTime = sosiGetMicroSeconds ();
 
-            *PtrData = data;
+        status = atlasChimeToAxiReadCycle (PtrSwitch, Address, &PtrData[index]);
 
-            return (SCRUTINY_STATUS_SUCCESS);
+        atlasChimeToAxiRecordLatency (PtrSwitch, startTime);
+
+        if (status)
+        {
+            PtrData[index] = 0;
+            break;
         }
 
+        PtrSwitch->Handle.PciHandle.AccessStatistics.ReadCount++;
     }
 
-    *PtrData = 0;
+    gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] MR32 FIFO %08x, Count=%x, Read=%x", Address, Count, index);
 
-    return (SCRUTINY_STATUS_FAILED);
+    return (status);
+
+}
+
+SCRUTINY_STATUS atlasiPciChimeToAxiReadRegister (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __IN__ U32 Address, __OUT__ U32 *PtrData)
+{
 
+    return (atlasiPciChimeToAxiReadBlock (PtrSwitch, Address, PtrData, 1));
 
 }
 
@@ -632,10 +862,15 @@ SCRUTINY_STATUS atlasiPciChimeToAxiWriteRegister (__IN__ PTR_SCRUTINY_DEVICE Ptr
 {
 
     U32 registerAddress;
+    U32 startTime;
+    U32 latency;
+
+    startTime = sosiGetMicroSeconds ();
 
     if (atlasFSMBusyClearCheck (PtrSwitch))
     {
         gPtrLoggerGeneric->logiDebug ("FSM Generator bit is not cleared and trying with BAR0 mapped mode.");
+        PtrSwitch->Handle.PciHandle.AccessStatistics.FallbackCount++;
         return (atlasiFSMFallBackRegisterWrite (PtrSwitch, Address, Data));
     }
 
@@ -670,9 +905,51 @@ SCRUTINY_STATUS atlasiPciChimeToAxiWriteRegister (__IN__ PTR_SCRUTINY_DEVICE Ptr
                       ATLAS_REGISTER_CHIME_TO_AXI_CONTROL_STATUS_OFFSET;
 
 
-    atlasPciDiagWrite32 (PtrSwitch, registerAddress, 0x01);
+    atlasPciDiagWrite32 (PtrSwitch, registerAddress, ATLAS_CHIME_TO_AXI_COMMAND_WRITE);
+
+    latency = atlasChimeToAxiRecordLatency (PtrSwitch, startTime);
+    PtrSwitch->Handle.PciHandle.AccessStatistics.WriteCount++;
+
+    gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] MW32 %08x, Data=%08x, Latency=%dus", Address, Data, latency);
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  atlasiGetChimeToAxiStatistics()
+ *
+ * @param   PtrSwitch       Pointer to the switch
+ *
+ * @param   PtrStatistics   Copy of the register access statistics
+ *
+ * @param   Reset           TRUE to clear the statistics after the copy
+ *
+ * @return  SCRUTINY_STATUS      SCRUTINY_STATUS_SUCCESS for the success and non-zero if failed.
+ *
+ * @brief   Report the Chime to AXI access counts and latencies of a switch
+ *
+ */
+
+SCRUTINY_STATUS atlasiGetChimeToAxiStatistics (__IN__ PTR_SCRUTINY_DEVICE PtrSwitch, __OUT__ PTR_SCRUTINY_PCI_ACCESS_STATISTICS PtrStatistics, __IN__ BOOLEAN Reset)
+{
+
+    if ((PtrSwitch == NULL) || (PtrStatistics == NULL) || (PtrSwitch->HandleType != SCRUTINY_HANDLE_TYPE_PCI))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    sosiMemCopy (PtrStatistics, &PtrSwitch->Handle.PciHandle.AccessStatistics, sizeof (SCRUTINY_PCI_ACCESS_STATISTICS));
+
+    if (Reset)
+    {
+        sosiMemSet (&PtrSwitch->Handle.PciHandle.AccessStatistics, 0, sizeof (SCRUTINY_PCI_ACCESS_STATISTICS));
+    }
 
-    gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] MW32 %08x, Data=%08x", Address, Data);
+    gPtrLoggerGeneric->logiDebug ("[CHIME-AXI] Reads=%d, Writes=%d, Fallbacks=%d, Timeouts=%d, TotalLatency=%lluus, MaxLatency=%dus",
+                                   PtrStatistics->ReadCount, PtrStatistics->WriteCount, PtrStatistics->FallbackCount,
+                                   PtrStatistics->TimeoutCount, PtrStatistics->TotalLatency, PtrStatistics->MaxLatency);
 
     return (SCRUTINY_STATUS_SUCCESS);
 
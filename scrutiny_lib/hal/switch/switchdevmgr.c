@@ -45,6 +45,9 @@ SCRUTINY_STATUS sdmiResetDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
     
     gPtrLoggerSwitch->logiFunctionEntry ("sdmiResetDevice (PtrDevice=%x)", PtrDevice != NULL);
 
+    /* Port clocks may come up differently after the reset */
+    sdmiInvalidateDevice (PtrDevice);
+
 
     if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC ||
         PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_MPT_INTERFACE ||
@@ -151,14 +154,43 @@ SCRUTINY_STATUS sdmiScsiResetDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
 
 
 
+/**
+ *
+ * @method  sdmiInvalidateDevice()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @return  none
+ *
+ * @brief   drop whatever the switch layer cached about the device, the port
+ *          state and the capability index are read again on the next lookup
+ *
+ *
+ */
+VOID sdmiInvalidateDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+    spcInvalidatePortState (PtrDevice);
+    sppInvalidateCapabilityIndex (PtrDevice, SPP_CAPABILITY_INDEX_ALL_PORTS);
+}
+
 SCRUTINY_STATUS sdmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
 {
 
+#if !defined (OS_BMC) && !defined (OS_VMWARE)
+    SCRUTINY_PCI_ACCESS_STATISTICS statistics;
+#endif
+
+    /* The sampler uses the device, it has to go before the handle is closed */
+    sppPerfSamplerStop (PtrDevice);
+
+    sppFreeCapabilityIndex (PtrDevice);
+
 #if defined (OS_LINUX) && !defined (OS_VMWARE)
 
-    if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
+    if ((PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB) && (!lrciIsReplaying (PtrDevice)))
     {
-        /* We need to close the serial port. */
+        /* We need to close the serial port, a replayed device never opened one. */
         spiClosePort (&PtrDevice->Handle.SdbHandle);
     }
 
@@ -168,6 +200,11 @@ SCRUTINY_STATUS sdmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
     {
         /* We have got SCSI Generic interface */
         sgiCloseDevice (PtrDevice);
+
+#if defined (OS_LINUX)
+        sgiFreeTransferBuffer (PtrDevice);
+        sgemiFreeEmulator (PtrDevice);
+#endif
     }
 
     else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SCSI_ON_MPT_INTERFACE ||
@@ -176,6 +213,21 @@ SCRUTINY_STATUS sdmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice)
         /* We don't have anything to close on this interface. */
     }
 
+    else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SIMULATED)
+    {
+        ssimiCloseDevice (PtrDevice);
+    }
+
+#if !defined (OS_BMC) && !defined (OS_VMWARE)
+
+    else if (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_PCI)
+    {
+        /* Nothing to close on this interface, report how the register accesses went */
+        atlasiGetChimeToAxiStatistics (PtrDevice, &statistics, FALSE);
+    }
+
+#endif
+
     else
     {
         return (SCRUTINY_STATUS_UNSUPPORTED);
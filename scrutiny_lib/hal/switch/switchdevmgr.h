@@ -37,6 +37,7 @@ SCRUTINY_STATUS sdmiDiscoverDevices();
 SCRUTINY_STATUS sdmiResetDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice);
 SCRUTINY_STATUS sdmiScsiResetDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice);
 SCRUTINY_STATUS sdmiCloseDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice);
+VOID sdmiInvalidateDevice (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice);
 
 SCRUTINY_STATUS sdmiIsBroadcomSwitch (__INOUT__ PTR_SCRUTINY_DEVICE PtrDevice);
 
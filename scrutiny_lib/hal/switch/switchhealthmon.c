@@ -31,6 +31,7 @@
 */
 
 #include "libincludes.h"
+#include "atlas.h"
 #include "switchhealthmon.h"
 
 
@@ -96,31 +97,24 @@ SCRUTINY_STATUS shmFillPortLinkStatus (
 )
 {
     SCRUTINY_STATUS   status = SCRUTINY_STATUS_SUCCESS;
-	U32 dword = 0;
+    U32 offsetList[] = { ATLAS_REGISTER_PMG_REG_PORT_LINK_STATUS, ATLAS_REGISTER_PMG_REG_PORT_LINK_CAP };
+    U32 dwords[2] = { 0 };
 
     gPtrLoggerSwitch->logiFunctionEntry ("shmFillPortLinkStatus (PtrDevice=%x, PortNum=0x%x, PtrSwHealthInfo=%x)", 
             PtrDevice != NULL, PortNum, PtrSwHealthInfo != NULL);
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, ATLAS_REGISTER_PMG_REG_PORT_LINK_STATUS, &dword);
+    status = atlasPCIeConfigurationSpaceReadScatter (PtrDevice, PortNum, offsetList, dwords, sizeof (offsetList) / sizeof (U32));
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
-        gPtrLoggerSwitch->logiDebug ("Failed to read Configuration Space register 0x%x", ATLAS_REGISTER_PMG_REG_PORT_LINK_STATUS);
+        gPtrLoggerSwitch->logiDebug ("Failed to read Configuration Space registers 0x%x/0x%x", ATLAS_REGISTER_PMG_REG_PORT_LINK_STATUS, ATLAS_REGISTER_PMG_REG_PORT_LINK_CAP);
         gPtrLoggerSwitch->logiFunctionExit ("shmFillPortLinkStatus (status=0x%x)", status);
         return (status);
     }
 
-    PtrSwHealthInfo->PortStatus[PortNum].NegotiatedLinkWidth = (PCI_DEVICE_LINK_WIDTH)((dword & 0x3F00000) >> 20);
-    PtrSwHealthInfo->PortStatus[PortNum].NegotiatedLinkSpeed = (PCI_DEVICE_LINK_SPEED)((dword & 0xF0000) >> 16);
+    PtrSwHealthInfo->PortStatus[PortNum].NegotiatedLinkWidth = (PCI_DEVICE_LINK_WIDTH)((dwords[0] & 0x3F00000) >> 20);
+    PtrSwHealthInfo->PortStatus[PortNum].NegotiatedLinkSpeed = (PCI_DEVICE_LINK_SPEED)((dwords[0] & 0xF0000) >> 16);
 
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, ATLAS_REGISTER_PMG_REG_PORT_LINK_CAP, &dword);
-    if (status != SCRUTINY_STATUS_SUCCESS)
-    {
-        gPtrLoggerSwitch->logiDebug ("Failed to read Configuration Space register 0x%x", ATLAS_REGISTER_PMG_REG_PORT_LINK_CAP);
-        gPtrLoggerSwitch->logiFunctionExit ("shmFillPortLinkStatus (status=0x%x)", status);
-        return (status);
-    }
-
-    PtrSwHealthInfo->PortStatus[PortNum].MaxLinkWidth = (PCI_DEVICE_LINK_WIDTH)((dword & 0x3F0) >> 4); 
-    PtrSwHealthInfo->PortStatus[PortNum].MaxLinkSpeed = (PCI_DEVICE_LINK_SPEED)(dword & 0xF);
+    PtrSwHealthInfo->PortStatus[PortNum].MaxLinkWidth = (PCI_DEVICE_LINK_WIDTH)((dwords[1] & 0x3F0) >> 4); 
+    PtrSwHealthInfo->PortStatus[PortNum].MaxLinkSpeed = (PCI_DEVICE_LINK_SPEED)(dwords[1] & 0xF);
     
 
     gPtrLoggerSwitch->logiFunctionExit ("shmFillPortLinkStatus (status=0x%x)", status);
@@ -364,6 +364,9 @@ SCRUTINY_STATUS slmSetHwAutoSpeed (
     dword = ((dword & ~0x20) | ((HwAutoSpeed & 0x1) << 5));
     
     status = atlasPCIeConfigurationSpaceWrite (PtrDevice, PortNum, ATLAS_REGISTER_PMG_REG_LINK_STS_CTRL_2, dword);
+
+    /* The link retrains with the new setting, read the capabilities of the port again */
+    sppInvalidateCapabilityIndex (PtrDevice, PortNum);
     
     gPtrLoggerSwitch->logiFunctionExit ("slmSetHwAutoSpeed (status=0x%x)", status);
     return (status);
@@ -453,6 +456,9 @@ SCRUTINY_STATUS slmSetHwAutoWidth (
     dword = ((dword & ~0x200) | ((HwAutoWidth & 0x1) << 9));
     
     status = atlasPCIeConfigurationSpaceWrite (PtrDevice, PortNum, ATLAS_REGISTER_PMG_REG_PORT_LINK_STATUS, dword);
+
+    /* The link retrains with the new setting, read the capabilities of the port again */
+    sppInvalidateCapabilityIndex (PtrDevice, PortNum);
     
     gPtrLoggerSwitch->logiFunctionExit ("slmSetHwAutoWidth (status=0x%x)", status);
     return (status);
@@ -37,6 +37,127 @@
 
 
 
+/**
+ *
+ * @method  spcGetPortState()
+ *
+ *
+ * @param   PtrDevice           pointer to the device
+ *
+ * @param   PtrPtrPortState     returns the cached port state of the device
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   read the chip ID and all PORT_CLOCK_EN registers once, later calls
+ *          are served from the device until spcInvalidatePortState()
+ *
+ *
+ */
+SCRUTINY_STATUS spcGetPortState (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __OUT__ PTR_SCRUTINY_SWITCH_PORT_STATE *PtrPtrPortState
+)
+{
+
+    SCRUTINY_STATUS   status;
+    PTR_SCRUTINY_SWITCH_PORT_STATE ptrPortState = &PtrDevice->SwitchPortState;
+
+    if (ptrPortState->Valid)
+    {
+        *PtrPtrPortState = ptrPortState;
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    gPtrLoggerSwitch->logiFunctionEntry ("spcGetPortState (PtrDevice=%x)", PtrDevice != NULL);
+
+    /* Offset of the Configuration Register */
+    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &ptrPortState->ChipIdRegister);
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        /* The clock enable registers are consecutive, fetch them in one read */
+        status = bsdiMemoryRead32 (PtrDevice,
+                                   ATLAS_REGISTER_BASE_ADDRESS_PSB_PORT_CONFIG_SPACE + ATLAS_REGISTER_PMG_REG_PORT_CLOCK_EN_0,
+                                   ptrPortState->ClockEnable,
+                                   sizeof (ptrPortState->ClockEnable));
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerSwitch->logiDebug ("read PSB PORT SPACE fail, status=0x%x", status);
+        gPtrLoggerSwitch->logiFunctionExit ("spcGetPortState (status=0x%x)", status);
+        return (status);
+    }
+
+    ptrPortState->Valid = TRUE;
+
+    gPtrLoggerSwitch->logiDebug ("ChipIdRegister=0x%x, ClockEnable=%x %x %x %x", ptrPortState->ChipIdRegister,
+                                 ptrPortState->ClockEnable[0], ptrPortState->ClockEnable[1],
+                                 ptrPortState->ClockEnable[2], ptrPortState->ClockEnable[3]);
+
+    *PtrPtrPortState = ptrPortState;
+
+    gPtrLoggerSwitch->logiFunctionExit ("spcGetPortState (status=0x%x)", status);
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  spcInvalidatePortState()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @return  none
+ *
+ * @brief   drop the cached port state, the next lookup reads the registers again
+ *
+ *
+ */
+VOID spcInvalidatePortState (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice
+)
+{
+    PtrDevice->SwitchPortState.Valid = FALSE;
+}
+
+/**
+ *
+ * @method  spcGetChipIdRegister()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @param   PtrValue       value of the chip ID register (port 0, 0xB7C)
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   cached read of the chip ID register
+ *
+ *
+ */
+SCRUTINY_STATUS spcGetChipIdRegister (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __OUT__ PU32 PtrValue
+)
+{
+
+    SCRUTINY_STATUS   status;
+    PTR_SCRUTINY_SWITCH_PORT_STATE ptrPortState = NULL;
+
+    status = spcGetPortState (PtrDevice, &ptrPortState);
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        *PtrValue = ptrPortState->ChipIdRegister;
+    }
+
+    return (status);
+
+}
+
 /**
  *
  * @method  spcGetPexChipId()
@@ -58,13 +179,11 @@ SCRUTINY_STATUS spcGetPexChipId (
 )
 {
 
-    /* Offset of the Configuration Register */
-    U32 offset = 0xB7C;
     U32 value = 0;
 
     gPtrLoggerSwitch->logiFunctionEntry ("spcGetPexChipId (PtrDevice=%x, PtrChipId=%x)", PtrDevice != NULL, PtrChipId != NULL);
 
-    if (atlasPCIeConfigurationSpaceRead (PtrDevice, 0, offset, &value))
+    if (spcGetChipIdRegister (PtrDevice, &value))
     {
 	gPtrLoggerSwitch->logiFunctionExit ("spcGetPexChipId (status=%x)", SCRUTINY_STATUS_FAILED);
         return (SCRUTINY_STATUS_FAILED);
@@ -105,13 +224,16 @@ SCRUTINY_STATUS spcGetErrorCounters (
     U32 dword;
     SCRUTINY_STATUS   status = SCRUTINY_STATUS_SUCCESS;
     U32	port0OfStation;
+    U32 badCounterOffsets[] = { 0xFAC, 0xFB0 };
+    U32 badCounters[2] = { 0 };
 
     gPtrLoggerSwitch->logiFunctionEntry ("spcGetErrorCounters (PtrDevice=%x, PortNum=0x%x, PtrErrorCounters=%x)", 
 	    PtrDevice != NULL, PortNum, PtrErrorCounters != NULL);
 
     port0OfStation = (PortNum / ATLAS_PMG_MAX_STNPORT) * ATLAS_PMG_MAX_STNPORT;
 
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, 0xFAC, &dword);
+    /* Bad TLP and bad DLLP counters are adjacent, fetch both with one access */
+    status = atlasPCIeConfigurationSpaceReadScatter (PtrDevice, PortNum, badCounterOffsets, badCounters, sizeof (badCounterOffsets) / sizeof (U32));
 
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
@@ -120,18 +242,8 @@ SCRUTINY_STATUS spcGetErrorCounters (
         return (status);
     }
 	
-    PtrErrorCounters->BadTLPErrors = dword;
-
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, 0xFB0, &dword);
-	
-    if (status != SCRUTINY_STATUS_SUCCESS)
-    {
-        gPtrLoggerSwitch->logiFunctionExit("spcGetErrorCounters (status=0x%x)", status);
-
-        return (status);
-    }
-    
-    PtrErrorCounters->BadDLLPErrors = dword;
+    PtrErrorCounters->BadTLPErrors = badCounters[0];
+    PtrErrorCounters->BadDLLPErrors = badCounters[1];
 
 	// PMG_OFF_ERR_PORT_RECEIVER, station level register
     dword = ((U32)(PortNum % 16) << 24);
@@ -217,7 +329,8 @@ SCRUTINY_STATUS spcGetErrorCounters (
  *
  * @return  BOOLEAN             enabled or disable          
  *
- * @brief   check whether specific port is enabled or not
+ * @brief   check whether specific port is enabled or not, using the cached
+ *          PORT_CLOCK_EN registers
  *
  *
  */
@@ -226,71 +339,68 @@ BOOLEAN spcIsPortEnabled (
 	__IN__ U32						PortNum
 	)
 {
-    U32 offset = 0;
-    U32 regValue = 0;
     SCRUTINY_STATUS   status;
+    PTR_SCRUTINY_SWITCH_PORT_STATE ptrPortState = NULL;
+
+    status = spcGetPortState (PtrDevice, &ptrPortState);
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (FALSE);
+    }
 
-    gPtrLoggerSwitch->logiFunctionEntry ("spcIsPortEnabled (PtrDevice=%x, Port=0x%x)", PtrDevice != NULL, PortNum);
- 
     // Verify port is enabled (ports 116 & 117 are special case)
     if (PortNum < ATLAS_PMG_MAX_PORT_NO_2X1)
     {
-        // Check if port is disabled
-        offset = ATLAS_REGISTER_PMG_REG_PORT_CLOCK_EN_0 + ((PortNum / 32) * sizeof(U32));
-        status = bsdiMemoryRead32 (PtrDevice, ATLAS_REGISTER_BASE_ADDRESS_PSB_PORT_CONFIG_SPACE + offset, 
-        	&regValue, sizeof (U32));
-        if (status != SCRUTINY_STATUS_SUCCESS)
-        {
-            gPtrLoggerSwitch->logiDebug ("read PSB PORT SPACE fail, status=0x%x", status);
-            gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-            return (FALSE);
-        }
-
-        if ( (regValue & ((U32)1 << (PortNum % 32))) == 0 )
-        {
-            // Port is not enabled
-            gPtrLoggerSwitch->logiDebug ("Port disabled");
-            gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-            return (FALSE);
-        }
+        return ((ptrPortState->ClockEnable[PortNum / 32] & ((U32)1 << (PortNum % 32))) != 0);
     }
-    else if ( (PortNum == ATLAS_PMG_PORT_NUM_X1_1) || (PortNum == ATLAS_PMG_PORT_NUM_X1_2) )
+    else if (PortNum == ATLAS_PMG_PORT_NUM_X1_1)
     {
         // Clock enable for ports 116 & 117 (Port 0 318h[1:0])
-        offset = ATLAS_REGISTER_BASE_ADDRESS_PSB_PORT_CONFIG_SPACE + ATLAS_REGISTER_PMG_REG_PORT_CLOCK_EN_3;
-        status = bsdiMemoryRead32 (PtrDevice, offset, &regValue, sizeof (U32));
-        if (status != SCRUTINY_STATUS_SUCCESS)
-        {
-            gPtrLoggerSwitch->logiDebug ("read PSB PORT SPACE fail, status=0x%x", status);
-            gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-        	return (FALSE);
-        }
-
-        if ( (PortNum == ATLAS_PMG_PORT_NUM_X1_1) && ((regValue & (1 << 0)) == 0) )
-        {
-            gPtrLoggerSwitch->logiDebug ("Port disabled");
-            gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-            // Port 116 not enabled
-            return (FALSE);
-        }
-        else if ( (PortNum == ATLAS_PMG_PORT_NUM_X1_2) && ((regValue & (1 << 1)) == 0) )
-        {
-            gPtrLoggerSwitch->logiDebug ("Port disabled");
-            gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-            // Port 117 not enabled
-            return (FALSE);;
-        }
+        return ((ptrPortState->ClockEnable[3] & (1 << 0)) != 0);
     }
-    else
+    else if (PortNum == ATLAS_PMG_PORT_NUM_X1_2)
+    {
+        return ((ptrPortState->ClockEnable[3] & (1 << 1)) != 0);
+    }
+
+    // Port not enabled
+    return (FALSE);
+}
+
+/**
+ *
+ * @method  spcIsPortValid()
+ *
+ *
+ * @param   PtrDevice           pointer to the device
+ *
+ * @param   PortNum             specific port
+ *
+ *
+ * @return  BOOLEAN             TRUE when the chip has the port and it is enabled
+ *
+ * @brief   cached check whether a port number can be used on this switch
+ *
+ *
+ */
+BOOLEAN spcIsPortValid (
+	__IN__ PTR_SCRUTINY_DEVICE  	PtrDevice,
+	__IN__ U32						PortNum
+	)
+{
+    PTR_SCRUTINY_SWITCH_PORT_STATE ptrPortState = NULL;
+
+    if (spcGetPortState (PtrDevice, &ptrPortState) != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (FALSE);
+    }
+
+    if (PortNum > ((ptrPortState->ChipIdRegister >> 16) & 0xFF))
     {
-        gPtrLoggerSwitch->logiDebug ("Port disabled");
-        gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (FALSE)");
-        // Port not enabled
         return (FALSE);
     }
 
-    gPtrLoggerSwitch->logiFunctionExit ("spcIsPortEnabled (TRUE)");
-    return (TRUE);
+    return (spcIsPortEnabled (PtrDevice, PortNum));
 }
 
 /**
@@ -386,13 +496,15 @@ SCRUTINY_STATUS spcGetAdvancedErrorStatus  (
     __OUT__ PTR_SCRUTINY_SWITCH_ADVANCED_ERROR_STATUS PtrErrorStatus 
     )
 {
-    U32 dword;
+    U32 offsetList[] = { 0x70, 0xFB8, 0xFC4 };
+    U32 dwords[3] = { 0 };
     SCRUTINY_STATUS  status = SCRUTINY_STATUS_SUCCESS;
 
     gPtrLoggerSwitch->logiFunctionEntry ("spcGetAdvancedErrorStatus (PtrDevice=%x, PortNum=0x%x, PtrErrorStatus=%x)", 
             PtrDevice != NULL, PortNum, PtrErrorStatus != NULL);
 
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, 0x70, &dword);
+    /* Device status (0x70), uncorrectable (0xFB8) and correctable (0xFC4) status */
+    status = atlasPCIeConfigurationSpaceReadScatter (PtrDevice, PortNum, offsetList, dwords, sizeof (offsetList) / sizeof (U32));
 
 	if (status != SCRUTINY_STATUS_SUCCESS)
 	{
@@ -401,32 +513,13 @@ SCRUTINY_STATUS spcGetAdvancedErrorStatus  (
 	    return (status);
 	}
 
-    PtrErrorStatus->ErrorStatus.CorrectableErrorDetected    = (U8)((dword >> 16) & 1);
-    PtrErrorStatus->ErrorStatus.NonFatalErrorDetected       = (U8)(dword >> 17) & 1;
-    PtrErrorStatus->ErrorStatus.FatalErrorDetected          = (U8)(dword >> 18) & 1;
-    PtrErrorStatus->ErrorStatus.UnsupportedRequestDetected  = (U8)(dword >> 19) & 1;
+    PtrErrorStatus->ErrorStatus.CorrectableErrorDetected    = (U8)((dwords[0] >> 16) & 1);
+    PtrErrorStatus->ErrorStatus.NonFatalErrorDetected       = (U8)(dwords[0] >> 17) & 1;
+    PtrErrorStatus->ErrorStatus.FatalErrorDetected          = (U8)(dwords[0] >> 18) & 1;
+    PtrErrorStatus->ErrorStatus.UnsupportedRequestDetected  = (U8)(dwords[0] >> 19) & 1;
 
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, 0xFB8, &dword);
-	
-	if (status != SCRUTINY_STATUS_SUCCESS)
-	{
-		gPtrLoggerSwitch->logiFunctionExit ("spcGetAdvancedErrorStatus (status=0x%x)", status);
-		
-	    return (status);
-	}
-	
-    PtrErrorStatus->Uncorrectable.word = dword;
-
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortNum, 0xFC4, &dword);
-    
-	if (status != SCRUTINY_STATUS_SUCCESS)
-	{
-		gPtrLoggerSwitch->logiFunctionExit ("spcGetAdvancedErrorStatus (status=0x%x)", status);
-		
-	    return (status);
-	}
-    
-    PtrErrorStatus->Correctable.word = dword;
+    PtrErrorStatus->Uncorrectable.word = dwords[1];
+    PtrErrorStatus->Correctable.word = dwords[2];
 
     gPtrLoggerSwitch->logiFunctionExit ("spcGetAdvancedErrorStatus (status=0x%x)", status);
 	
@@ -456,7 +549,7 @@ SCRUTINY_STATUS spciGetPciPortErrorStatistic(
     __IN__ U32 						Port, 
     __OUT__ PTR_SCRUTINY_SWITCH_ERROR_STATISTICS PtrPciePortErrStatistic)
 {
-	U32 				chipId = 0;
+	PTR_SCRUTINY_SWITCH_PORT_STATE	ptrPortState = NULL;
 	SCRUTINY_STATUS   	status;
 
     gPtrLoggerSwitch->logiFunctionEntry ("spciGetPciPortErrorStatistic (PtrDevice=%x, Port=0x%x, PtrPciePortErrStatistic=%x)", 
@@ -468,7 +561,7 @@ SCRUTINY_STATUS spciGetPciPortErrorStatistic(
         return (SCRUTINY_STATUS_INVALID_PARAMETER);
     }
 
-    status = spcGetPexChipId (PtrDevice, &chipId);
+    status = spcGetPortState (PtrDevice, &ptrPortState);
 	
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
@@ -476,7 +569,7 @@ SCRUTINY_STATUS spciGetPciPortErrorStatistic(
     	return (status);
     }
 
-    if (Port > (chipId & 0xFF) || !spcIsPortEnabled (PtrDevice, Port))
+    if (!spcIsPortValid (PtrDevice, Port))
     {
         gPtrLoggerSwitch->logiFunctionExit ("spciGetPciPortErrorStatistic (status=0x%x)", SCRUTINY_STATUS_INVALID_PORT);
     	return (SCRUTINY_STATUS_INVALID_PORT);
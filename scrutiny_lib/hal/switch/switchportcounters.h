@@ -48,6 +48,25 @@ BOOLEAN spcIsPortEnabled (
 	__IN__ U32						PortNum
 	);
 
+BOOLEAN spcIsPortValid (
+	__IN__ PTR_SCRUTINY_DEVICE  	PtrDevice,
+	__IN__ U32						PortNum
+	);
+
+SCRUTINY_STATUS spcGetPortState (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __OUT__ PTR_SCRUTINY_SWITCH_PORT_STATE *PtrPtrPortState
+    );
+
+VOID spcInvalidatePortState (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice
+    );
+
+SCRUTINY_STATUS spcGetChipIdRegister (
+    __IN__  PTR_SCRUTINY_DEVICE PtrDevice,
+    __OUT__ PU32 PtrValue
+    );
+
 SCRUTINY_STATUS spcGetPciPortMaxLinkWidth (
 	__IN__ PTR_SCRUTINY_DEVICE		PtrDevice,
 	__IN__ U32						PortNum,
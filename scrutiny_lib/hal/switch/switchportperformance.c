@@ -20,6 +20,7 @@
 
 
 #include "libincludes.h"
+#include "atlas.h"
 
 
 SCRUTINY_STATUS sppGetPciePortPerformance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance )
@@ -29,6 +30,17 @@ SCRUTINY_STATUS sppGetPciePortPerformance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice,
     
     gPtrLoggerSwitch->logiFunctionEntry ("sppGetPciePortPerformance (PtrDevice=%x,  PtrPciePortPerformance=%x)", PtrDevice != NULL,  PtrPciePortPerformance != NULL);
 
+    // The sampler owns the monitor while it runs, only its own operations are allowed
+    if ((PtrDevice->PtrPerfSampler != NULL) &&
+        ((PtrPciePortPerformance->Operation == SWITCH_PCIE_PERF_OP_CMD_START) ||
+         (PtrPciePortPerformance->Operation == SWITCH_PCIE_PERF_OP_CMD_READ) ||
+         (PtrPciePortPerformance->Operation == SWITCH_PCIE_PERF_OP_CMD_STOP)))
+    {
+        status = SCRUTINY_STATUS_OPERATION_RESTRICTED;
+        gPtrLoggerSwitch->logiFunctionExit ("sppGetPciePortPerformance  (Status = %x) ",status);
+        return (status);              
+    }
+
     switch (PtrPciePortPerformance->Operation )
     {
         case SWITCH_PCIE_PERF_OP_CMD_START : 
@@ -115,6 +127,27 @@ SCRUTINY_STATUS sppGetPciePortPerformance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice,
 
             break;
         }
+        case SWITCH_PCIE_PERF_OP_CMD_SAMPLER_START :
+        {
+            status = sppPerfSamplerStart( PtrDevice, PtrPciePortPerformance );
+            break;
+        }
+        case SWITCH_PCIE_PERF_OP_CMD_SAMPLER_READ :
+        {
+            status = sppPerfSamplerRead( PtrDevice, PtrPciePortPerformance );
+            break;
+        }
+        case SWITCH_PCIE_PERF_OP_CMD_SAMPLER_STOP :
+        {
+            if (PtrDevice->PtrPerfSampler == NULL)
+            {
+                status = SCRUTINY_STATUS_ILLEGAL_REQUEST;
+                break;
+            }
+
+            status = sppPerfSamplerStop( PtrDevice );
+            break;
+        }
         default :
         {
             status = SCRUTINY_STATUS_UNSUPPORTED;
@@ -141,7 +174,7 @@ SCRUTINY_STATUS sppGetPciePortPerformanceInit (__IN__ PTR_SCRUTINY_DEVICE PtrDev
     //get regular port properties
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
     regVal = 0;
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("sppGetPciePortPerformanceInit  (Status = %x) ",status);
@@ -436,7 +469,7 @@ SCRUTINY_STATUS sppPerfGetCounters( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT_
     gPtrLoggerSwitch->logiFunctionEntry ("sppPerfGetCounters (PtrDevice=%x,  PtrPciePortPerformance=%x)", PtrDevice != NULL,  PtrPciePortPerformance != NULL);
 
 
-    tempBufSize = PCIE_PERF_COUNTERS_PER_PORT * ATLAS_PMG_MAX_PHYS * sizeof( U32 );
+    tempBufSize = sizeof( PCIE_PERF_MONITOR_READ_FIFO );
     ptrTempBuf = (PU32) sosiMemAlloc ( tempBufSize );
     if (ptrTempBuf == NULL)
     {
@@ -458,18 +491,8 @@ SCRUTINY_STATUS sppPerfGetCounters( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT_
 SCRUTINY_STATUS sppPerfGetCountersBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance, __IN__ PU32  PtrBuf, __IN__ U32 BufSize)
 {
     SCRUTINY_STATUS 			          status = SCRUTINY_STATUS_FAILED;
-    U32          dWord;
     U32          portIndex;
-    U32          regVal;
-    
-    U32          currStation;
-    U32          station;
-    U32          stnPort;
-    U32          idx;
-    PU32         ptrCounter = NULL;
     PTR_PCIE_PERF_MONITOR_READ_FIFO          ptrCounterFifo = NULL;
-    PTR_PCIE_PERF_PORT_INGRESS_TLP_COUNTERS  ptrIngCounters = NULL;
-    PTR_PCIE_PERF_PORT_EGRESS_TLP_COUNTERS   ptrEgCounters = NULL;
 
     gPtrLoggerSwitch->logiFunctionEntry ("sppPerfGetCountersBuf (PtrDevice=%x,  PtrPciePortPerformance=%x, PtrBuf=%x, BufSize=%x)", PtrDevice != NULL,  PtrPciePortPerformance != NULL, PtrBuf != NULL, BufSize);
 
@@ -569,8 +592,8 @@ SCRUTINY_STATUS sppPerfGetCountersBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __O
  *           -----------------
  */
 
-    /* Get memory to store Performance counters. Need 5,376 bytes if storing
-     * counters for all ports. This is the same as sizeof(PMG_MONITOR_READ_FIFO).
+    /* Get memory to store Performance counters. Need 7,168 bytes if storing
+     * counters for all ports. This is the same as sizeof(PCIE_PERF_MONITOR_READ_FIFO).
      */
     if( PtrBuf == NULL )
     {
@@ -578,10 +601,122 @@ SCRUTINY_STATUS sppPerfGetCountersBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __O
         gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
         return (status);              
     }
-    ptrCounter = PtrBuf;
-    ptrCounterFifo = ( PTR_PCIE_PERF_MONITOR_READ_FIFO )ptrCounter;
 
+    if( BufSize < sizeof (PCIE_PERF_MONITOR_READ_FIFO) )
+    {
+        status = SCRUTINY_STATUS_INVALID_PARAMETER;
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
+        return (status);              
+    }
+
+    ptrCounterFifo = ( PTR_PCIE_PERF_MONITOR_READ_FIFO )PtrBuf;
+
+    status = sppPerfReadCounterSnapshot( PtrDevice, sppPerfGetActiveStations( PtrPciePortPerformance ), ptrCounterFifo );
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
+        return (status);    
+    }
+
+    /* Populate PERF_PROP structs with counters. Each struct is associated with a port.
+     * Counters were read for all ports above in a predetermined format (see comment at
+     * beginning of this routine). Extract counters for port associated with PERF_PROP
+     * struct and populate struct. Then repeat until all structs have been populated.
+     */
+    for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
+    {
+        if( !(PtrPciePortPerformance->PortPerfData[portIndex].Valid) )
+        {
+            continue;
+        }
+
+        sppPerfExtractPortCounters( ptrCounterFifo, portIndex, &(PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter) );
+    }
+
+    status = SCRUTINY_STATUS_SUCCESS;
+    gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
+    return (status);              
+}
+
+
+
+
+VOID sppPerfExtractPortCounters( __IN__ PTR_PCIE_PERF_MONITOR_READ_FIFO PtrSnapshot, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PCIE_PERF_ONE_PORT_COUNTERS PtrCounters )
+{
+    U32          station;
+    U32          stnPort;
+    PTR_PCIE_PERF_PORT_INGRESS_TLP_COUNTERS  ptrIngCounters = NULL;
+    PTR_PCIE_PERF_PORT_EGRESS_TLP_COUNTERS   ptrEgCounters = NULL;
+
+    // Calculate starting index for counters based on station
+    station = PortIndex / ATLAS_MAX_PORT_PER_STN;
+    stnPort = PortIndex % ATLAS_MAX_PORT_PER_STN;
+
+    // Get pointer to start of Ingress counters. Adjust for port here.
+    ptrIngCounters = &PtrSnapshot->PciePerfCounters[station].IngTLPCounters[stnPort];
+
+    // Get Ingress counters (6 DW/port)
+    PtrCounters->IngressPHCounter = ptrIngCounters->IngPH;
+    PtrCounters->IngressPDWCounter = ptrIngCounters->IngPDW;
+    PtrCounters->IngressNPHCounter = ptrIngCounters->IngNPH;
+    PtrCounters->IngressNPDWCounter = ptrIngCounters->IngNPDW;
+    PtrCounters->IngressCplHCounter = ptrIngCounters->IngCplH;
+    PtrCounters->IngressCplDWCounter = ptrIngCounters->IngCplDW;
+    
+    // Egress counters start after ingress. Also adjust for port.
+    ptrEgCounters = &PtrSnapshot->PciePerfCounters[station].EgTLPCounters[stnPort];
+
+    /**********************************************************************/
+    /*  FIRMWARE WORKAROUND here is implemented due to HWBug CQ 1051251   */
+    /**********************************************************************/
+    /*  Ingress DW counters count 2 dword overhead per TLP but Egress     */
+    /*  DW counters do not. So firmware workaround is following. Since    */
+    /*  there is a header counter and one header/TLP then code will add   */
+    /*  (2 * Egress header counter) to actual Egress DW counter. There    */
+    /*  are 3 Egress counters which are modified: Posted DW, Nonposted DW,*/
+    /*  and Completion DW.                                                */
+    /**********************************************************************/
+    // Get Egress counters (6 DW/port)
+    PtrCounters->EgressPHCounter = ptrEgCounters->EgPH;
+    /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */            
+    PtrCounters->EgressPDWCounter = ptrEgCounters->EgPDW + ( ptrEgCounters->EgPH * PCIE_PERF_TLP_OH_DW );
+    PtrCounters->EgressNPHCounter = ptrEgCounters->EgNPH;
+    /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */            
+    PtrCounters->EgressNPDWCounter = ptrEgCounters->EgNPDW + ( ptrEgCounters->EgNPH * PCIE_PERF_TLP_OH_DW );
+    PtrCounters->EgressCplHCounter = ptrEgCounters->EgCplH;        
+    /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */
+    PtrCounters->EgressCplDWCounter = ptrEgCounters->EgCplDW +  ( ptrEgCounters->EgCplH * PCIE_PERF_TLP_OH_DW );
+
+    // Get DLLP Ingress counters (1 DW/port)
+    PtrCounters->IngressDLLPCounter = PtrSnapshot->PciePerfCounters[station].IngDLLPCounter[stnPort];
+
+    // Get DLLP Egress counters (1 DW/port)
+    PtrCounters->EgressDLLPCounter = PtrSnapshot->PciePerfCounters[station].EgDLLPCounter[stnPort];
+}
+
+U32 sppPerfGetActiveStations( __IN__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance )
+{
+    U32          portIndex;
+    U32          stationMask = 0;
+
+    for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
+    {
+        if( PtrPciePortPerformance->PortPerfData[portIndex].Valid )
+        {
+            stationMask |= (1 << (portIndex / ATLAS_MAX_PORT_PER_STN));
+        }
+    }
+
+    return (stationMask);
+}
+
+SCRUTINY_STATUS sppPerfReadCounterSnapshot( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 StationMask, __OUT__ PTR_PCIE_PERF_MONITOR_READ_FIFO PtrSnapshot )
+{
+    SCRUTINY_STATUS 			          status = SCRUTINY_STATUS_SUCCESS;
+    U32          dWord;
+    U32          station;
 
+    gPtrLoggerSwitch->logiFunctionEntry ("sppPerfReadCounterSnapshot (PtrDevice=%x, StationMask=%x, PtrSnapshot=%x)", PtrDevice != NULL, StationMask, PtrSnapshot != NULL);
 
     //0x3F0 InOut Probe RAM Control Register
     //[0]		RAM Enable
@@ -596,124 +731,337 @@ SCRUTINY_STATUS sppPerfGetCountersBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __O
     //[30:21]	Last RAM Write Addr
     //[31]	    RAM Full Status
 
-    // RAM control
+    // RAM control, reset the read pointer so the FIFO starts at Port 0 IN PH
     dWord = (2 << 4) |   // Capture type ([5:4])
-               (1 << 2) |   // Reset read pointer
-               (1 << 0);    // Enable RAM
+               PCIE_PERF_PROBE_RAM_CTL_READ_PTR_RESET |
+               PCIE_PERF_PROBE_RAM_CTL_RAM_BUF_ENABLE;
 
+    for( station = 0; station < ATLAS_MAX_STN; station++ )
+    {
+        // Stations without a valid port are not read at all
+        if( !(StationMask & (1 << station)) )
+        {
+            sosiMemSet (&PtrSnapshot->PciePerfCounters[station], 0, sizeof (PCIE_PERF_MONITOR_READ_FIFO_ONE_STN));
+            continue;
+        }
 
-    // Reset RAM read pointers
-    for( portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++ )
+        // To get counters use port 0 of station
+        status = atlasPCIeConfigurationSpaceWrite (PtrDevice, station * ATLAS_MAX_PORT_PER_STN, PCIE_PERF_REG_PROBE_RAM_CONTROL, dWord);
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        // The whole station is drained in one burst straight into the snapshot
+        status = atlasPCIeConfigurationSpaceReadFifo (PtrDevice,
+                                                      station * ATLAS_MAX_PORT_PER_STN,
+                                                      PCIE_PERF_REG_MONITOR_READ_FIFO,
+                                                      (PU32) &PtrSnapshot->PciePerfCounters[station],
+                                                      PCIE_PERF_COUNTERS_PER_STN);
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    gPtrLoggerSwitch->logiFunctionExit ("sppPerfReadCounterSnapshot  (Status = %x) ",status);
+    return (status);              
+}
+
+#if defined (OS_LINUX)
+
+static void* sppPerfSamplerThread( void* PtrArgument )
+{
+    PTR_SPP_PERF_SAMPLER                  ptrSampler = (PTR_SPP_PERF_SAMPLER) PtrArgument;
+    PTR_SPP_PERF_SAMPLE                   ptrSample;
+    SCRUTINY_STATUS                       status;
+    U32                                   portIndex;
+    U32                                   timeStamp;
+    struct timespec                       deadline;
+
+    while (TRUE)
     {
-        // station level
-        if( (portIndex % ATLAS_MAX_PORT_PER_STN) == 0 )
+        // The register reads run without the sampler lock, readers only wait for the copy below.
+        // The device lock keeps the FIFO burst apart from the register accesses of the API calls.
+        ldmiLockDevice (ptrSampler->PtrDevice);
+        status = sppPerfReadCounterSnapshot( ptrSampler->PtrDevice, ptrSampler->StationMask, &ptrSampler->Snapshot );
+        ldmiUnlockDevice (ptrSampler->PtrDevice);
+        timeStamp = sosiGetMicroSeconds ();
+
+        pthread_mutex_lock (&ptrSampler->Lock);
+
+        ptrSampler->LastStatus = status;
+
+        if (status == SCRUTINY_STATUS_SUCCESS)
         {
-            status = atlasPCIeConfigurationSpaceWrite (PtrDevice, portIndex, 0x3F0, dWord);
-            if (status != SCRUTINY_STATUS_SUCCESS)
+            ptrSample = &ptrSampler->Samples[ptrSampler->SampleCount % SPP_PERF_SAMPLER_MAX_SAMPLES];
+            ptrSample->TimeStamp = timeStamp;
+
+            for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
             {
-                gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
-                return (status);    
+                if (ptrSampler->PortConfig.PortPerfData[portIndex].Valid)
+                {
+                    sppPerfExtractPortCounters( &ptrSampler->Snapshot, portIndex, &ptrSample->PortCounters[portIndex] );
+                }
             }
-        
+
+            ptrSampler->SampleCount++;
         }
-    }
 
+        // Sleep for the interval, a stop request wakes us up right away
+        clock_gettime (CLOCK_MONOTONIC, &deadline);
 
-    // Read in all counters
-    
-    currStation = 0;
-    for ( idx = 0; idx < (ATLAS_PMG_MAX_PHYS * PCIE_PERF_COUNTERS_PER_PORT); idx++)
-    {
-        // Check if reached station boundary
-        if( (idx % (PCIE_PERF_COUNTERS_PER_PORT * ATLAS_MAX_PORT_PER_STN)) == 0 )
+        deadline.tv_sec += ptrSampler->IntervalMs / 1000;
+        deadline.tv_nsec += (long) (ptrSampler->IntervalMs % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000)
         {
-            // Increment to next station
-            currStation = idx / (PCIE_PERF_COUNTERS_PER_PORT * ATLAS_MAX_PORT_PER_STN);
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
 
+        while (!ptrSampler->Stop)
+        {
+            if (pthread_cond_timedwait (&ptrSampler->StopCondition, &ptrSampler->Lock, &deadline) == ETIMEDOUT)
+            {
+                break;
+            }
         }
 
-        // Get next counter. To get counters use port 0 of station
-        //0x3E4h	 	 	 	 	 	 	 	Monitor Read  FIFO Register
-        //[31:0]		Monitor Read  FIFO Register
-        status = atlasPCIeConfigurationSpaceRead (PtrDevice, currStation * ATLAS_MAX_PORT_PER_STN, 0x3E4, &regVal);
-        if (status != SCRUTINY_STATUS_SUCCESS)
+        if (ptrSampler->Stop)
         {
-            gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
-            return (status);    
+            pthread_mutex_unlock (&ptrSampler->Lock);
+            break;
         }
-        *ptrCounter = regVal;
-        gPtrLoggerSwitch->logiDebug("currStation = %d ptrCounter idx = %d, value = %x", currStation, idx, *ptrCounter);
-        // Jump to next counter
-        ptrCounter++;
+
+        pthread_mutex_unlock (&ptrSampler->Lock);
     }
 
-    /* Populate PERF_PROP structs with counters. Each struct is associated with a port.
-     * Counters were read for all ports above in a predetermined format (see comment at
-     * beginning of this routine). Extract counters for port associated with PERF_PROP
-     * struct and populate struct. Then repeat until all structs have been populated.
-     */
-    for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
+    return (NULL);
+}
+
+#endif
+
+SCRUTINY_STATUS sppPerfSamplerStart( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance )
+{
+#if defined (OS_LINUX)
+    SCRUTINY_STATUS 			          status = SCRUTINY_STATUS_FAILED;
+    PTR_SPP_PERF_SAMPLER                  ptrSampler = NULL;
+    pthread_condattr_t                    conditionAttributes;
+
+    gPtrLoggerSwitch->logiFunctionEntry ("sppPerfSamplerStart (PtrDevice=%x,  PtrPciePortPerformance=%x, IntervalMs=%d)", PtrDevice != NULL,  PtrPciePortPerformance != NULL, PtrPciePortPerformance->StatisticElapsedTimeMs);
+
+    if (PtrDevice->PtrPerfSampler != NULL)
     {
-        if( !(PtrPciePortPerformance->PortPerfData[portIndex].Valid) )
+        status = SCRUTINY_STATUS_OPERATION_RESTRICTED;
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+        return (status);              
+    }
+
+    if (PtrPciePortPerformance->StatisticElapsedTimeMs < SPP_PERF_SAMPLER_MIN_INTERVAL_MS)
+    {
+        status = SCRUTINY_STATUS_INVALID_PARAMETER;
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+        return (status);              
+    }
+
+    ptrSampler = (PTR_SPP_PERF_SAMPLER) sosiMemAlloc (sizeof (SPP_PERF_SAMPLER));
+    if (ptrSampler == NULL)
+    {
+        status = SCRUTINY_STATUS_NO_MEMORY; 
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+        return (status);              
+    }
+    sosiMemSet (ptrSampler, 0, sizeof (SPP_PERF_SAMPLER));
+
+    ptrSampler->PtrDevice = PtrDevice;
+    ptrSampler->IntervalMs = PtrPciePortPerformance->StatisticElapsedTimeMs;
+
+    status = sppGetPciePortPerformanceInit ( PtrDevice, &ptrSampler->PortConfig );
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        status = sppPerfMonControl( PtrDevice, &ptrSampler->PortConfig, PCIE_PORT_PERF_MON_CMD_START );
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        sosiMemFree (ptrSampler);
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+        return (status);              
+    }
+
+    ptrSampler->StationMask = sppPerfGetActiveStations( &ptrSampler->PortConfig );
+
+    pthread_mutex_init (&ptrSampler->Lock, NULL);
+    // The interval deadline must not move with the wall clock
+    pthread_condattr_init (&conditionAttributes);
+    pthread_condattr_setclock (&conditionAttributes, CLOCK_MONOTONIC);
+    pthread_cond_init (&ptrSampler->StopCondition, &conditionAttributes);
+    pthread_condattr_destroy (&conditionAttributes);
+
+    if (pthread_create (&ptrSampler->Thread, NULL, sppPerfSamplerThread, (void*) ptrSampler))
+    {
+        sppPerfMonControl( PtrDevice, &ptrSampler->PortConfig, PCIE_PORT_PERF_MON_CMD_STOP );
+
+        pthread_cond_destroy (&ptrSampler->StopCondition);
+        pthread_mutex_destroy (&ptrSampler->Lock);
+        sosiMemFree (ptrSampler);
+
+        status = SCRUTINY_STATUS_FAILED;
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+        return (status);              
+    }
+
+    PtrDevice->PtrPerfSampler = ptrSampler;
+
+    // Give the caller the port properties the sampler works with
+    sosiMemCopy (PtrPciePortPerformance->PortPerfData, ptrSampler->PortConfig.PortPerfData, sizeof (ptrSampler->PortConfig.PortPerfData));
+    PtrPciePortPerformance->ToTalUserPhyNum = ptrSampler->PortConfig.ToTalUserPhyNum;
+
+    gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStart  (Status = %x) ",status);
+    return (status);              
+#else
+    return (SCRUTINY_STATUS_UNSUPPORTED);
+#endif
+}
+
+SCRUTINY_STATUS sppPerfSamplerRead( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance )
+{
+#if defined (OS_LINUX)
+    SCRUTINY_STATUS 			          status = SCRUTINY_STATUS_FAILED;
+    PTR_SPP_PERF_SAMPLER                  ptrSampler = (PTR_SPP_PERF_SAMPLER) PtrDevice->PtrPerfSampler;
+    PTR_SPP_PERF_SAMPLE                   ptrNewest;
+    PTR_SPP_PERF_SAMPLE                   ptrOldest;
+    U32                                   available;
+    U32                                   back;
+    U32                                   windowUs;
+    U32                                   elapsedMs;
+    U32                                   portIndex;
+
+    gPtrLoggerSwitch->logiFunctionEntry ("sppPerfSamplerRead (PtrDevice=%x,  PtrPciePortPerformance=%x, WindowMs=%d)", PtrDevice != NULL,  PtrPciePortPerformance != NULL, PtrPciePortPerformance->StatisticElapsedTimeMs);
+
+    if (ptrSampler == NULL)
+    {
+        status = SCRUTINY_STATUS_ILLEGAL_REQUEST;
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerRead  (Status = %x) ",status);
+        return (status);              
+    }
+
+    windowUs = PtrPciePortPerformance->StatisticElapsedTimeMs * 1000;
+
+    sosiMemCopy (PtrPciePortPerformance->PortPerfData, ptrSampler->PortConfig.PortPerfData, sizeof (ptrSampler->PortConfig.PortPerfData));
+    PtrPciePortPerformance->ToTalUserPhyNum = ptrSampler->PortConfig.ToTalUserPhyNum;
+
+    pthread_mutex_lock (&ptrSampler->Lock);
+
+    available = ptrSampler->SampleCount;
+
+    if (available > SPP_PERF_SAMPLER_MAX_SAMPLES)
+    {
+        available = SPP_PERF_SAMPLER_MAX_SAMPLES;
+    }
+
+    if (available < 2)
+    {
+        // Not enough samples for a window yet, report a failing sampler as such
+        status = (ptrSampler->LastStatus != SCRUTINY_STATUS_SUCCESS) ? ptrSampler->LastStatus : SCRUTINY_STATUS_RETRY;
+        pthread_mutex_unlock (&ptrSampler->Lock);
+
+        gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerRead  (Status = %x) ",status);
+        return (status);              
+    }
+
+    ptrNewest = &ptrSampler->Samples[(ptrSampler->SampleCount - 1) % SPP_PERF_SAMPLER_MAX_SAMPLES];
+
+    // Walk back to the newest sample which still covers the window, or the oldest one we have
+    for (back = 1; back < (available - 1); back++)
+    {
+        ptrOldest = &ptrSampler->Samples[(ptrSampler->SampleCount - 1 - back) % SPP_PERF_SAMPLER_MAX_SAMPLES];
+
+        if ((ptrNewest->TimeStamp - ptrOldest->TimeStamp) >= windowUs)
         {
-            continue;
+            break;
         }
+    }
 
+    ptrOldest = &ptrSampler->Samples[(ptrSampler->SampleCount - 1 - back) % SPP_PERF_SAMPLER_MAX_SAMPLES];
 
-        // Calculate starting index for counters based on station
-        station = portIndex / ATLAS_MAX_PORT_PER_STN;
-        stnPort = portIndex % ATLAS_MAX_PORT_PER_STN;
+    elapsedMs = (ptrNewest->TimeStamp - ptrOldest->TimeStamp) / 1000;
 
-       // Get pointer to start of Ingress counters. Adjust for port here.
-        ptrIngCounters = &ptrCounterFifo->PciePerfCounters[station].IngTLPCounters[stnPort];
+    for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
+    {
+        if (PtrPciePortPerformance->PortPerfData[portIndex].Valid)
+        {
+            sosiMemCopy ( &(PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter), &ptrNewest->PortCounters[portIndex], sizeof (SWITCH_PCIE_PERF_ONE_PORT_COUNTERS));
+            sosiMemCopy ( &(PtrPciePortPerformance->PortPerfData[portIndex].PrePortPerfCounter), &ptrOldest->PortCounters[portIndex], sizeof (SWITCH_PCIE_PERF_ONE_PORT_COUNTERS));
+        }
+    }
 
-        // Get Ingress counters (6 DW/port)
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressPHCounter = ptrIngCounters->IngPH;
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressPDWCounter = ptrIngCounters->IngPDW;
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressNPHCounter = ptrIngCounters->IngNPH;
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressNPDWCounter = ptrIngCounters->IngNPDW;
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressCplHCounter = ptrIngCounters->IngCplH;
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressCplDWCounter = ptrIngCounters->IngCplDW;
-        
-        // Egress counters start after ingress. Also adjust for port.
-        ptrEgCounters = &ptrCounterFifo->PciePerfCounters[station].EgTLPCounters[stnPort];
-
-        /**********************************************************************/
-        /*  FIRMWARE WORKAROUND here is implemented due to HWBug CQ 1051251   */
-        /**********************************************************************/
-        /*  Ingress DW counters count 2 dword overhead per TLP but Egress     */
-        /*  DW counters do not. So firmware workaround is following. Since    */
-        /*  there is a header counter and one header/TLP then code will add   */
-        /*  (2 * Egress header counter) to actual Egress DW counter. There    */
-        /*  are 3 Egress counters which are modified: Posted DW, Nonposted DW,*/
-        /*  and Completion DW.                                                */
-        /**********************************************************************/
-        // Get Egress counters (6 DW/port)
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressPHCounter = ptrEgCounters->EgPH;
-        /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */            
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressPDWCounter = ptrEgCounters->EgPDW + ( ptrEgCounters->EgPH * PCIE_PERF_TLP_OH_DW );
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressNPHCounter = ptrEgCounters->EgNPH;
-        /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */            
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressNPDWCounter = ptrEgCounters->EgNPDW + ( ptrEgCounters->EgNPH * PCIE_PERF_TLP_OH_DW );
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressCplHCounter = ptrEgCounters->EgCplH;        
-        /* Adjust for the 2 DW overhead/Header that Egress doesn't account for */
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressCplDWCounter = ptrEgCounters->EgCplDW +  ( ptrEgCounters->EgCplH * PCIE_PERF_TLP_OH_DW );
-
-        // Get DLLP Ingress counters (1 DW/port)
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.IngressDLLPCounter = ptrCounterFifo->PciePerfCounters[station].IngDLLPCounter[stnPort];
-
-        // Get DLLP Egress counters (1 DW/port)
-        PtrPciePortPerformance->PortPerfData[portIndex].PortPerfCounter.EgressDLLPCounter = ptrCounterFifo->PciePerfCounters[station].EgDLLPCounter[stnPort];
+    pthread_mutex_unlock (&ptrSampler->Lock);
 
+    if (elapsedMs == 0)
+    {
+        elapsedMs = 1;
     }
 
+    // Report the window the statistic really covers
+    PtrPciePortPerformance->StatisticElapsedTimeMs = elapsedMs;
+
     status = SCRUTINY_STATUS_SUCCESS;
-    gPtrLoggerSwitch->logiFunctionExit ("sppPerfGetCountersBuf  (Status = %x) ",status);
+
+    for (portIndex = 0; portIndex < ATLAS_PMG_MAX_PHYS; portIndex++)
+    {
+        if (PtrPciePortPerformance->PortPerfData[portIndex].Valid)
+        {              
+            status = sppPerfCalcStatisticsOnePort( PtrDevice, PtrPciePortPerformance, portIndex );
+            if (status != SCRUTINY_STATUS_SUCCESS)
+            {
+                break;
+            }
+        }
+    }
+
+    gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerRead  (Status = %x) ",status);
     return (status);              
+#else
+    return (SCRUTINY_STATUS_UNSUPPORTED);
+#endif
 }
 
+SCRUTINY_STATUS sppPerfSamplerStop( __IN__ PTR_SCRUTINY_DEVICE PtrDevice )
+{
+#if defined (OS_LINUX)
+    SCRUTINY_STATUS 			          status = SCRUTINY_STATUS_SUCCESS;
+    PTR_SPP_PERF_SAMPLER                  ptrSampler = (PTR_SPP_PERF_SAMPLER) PtrDevice->PtrPerfSampler;
+
+    if (ptrSampler == NULL)
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    gPtrLoggerSwitch->logiFunctionEntry ("sppPerfSamplerStop (PtrDevice=%x)", PtrDevice != NULL);
+
+    pthread_mutex_lock (&ptrSampler->Lock);
+    ptrSampler->Stop = TRUE;
+    pthread_cond_signal (&ptrSampler->StopCondition);
+    pthread_mutex_unlock (&ptrSampler->Lock);
+
+    pthread_join (ptrSampler->Thread, NULL);
+
+    PtrDevice->PtrPerfSampler = NULL;
 
+    status = sppPerfMonControl( PtrDevice, &ptrSampler->PortConfig, PCIE_PORT_PERF_MON_CMD_STOP );
 
+    pthread_cond_destroy (&ptrSampler->StopCondition);
+    pthread_mutex_destroy (&ptrSampler->Lock);
+    sosiMemFree (ptrSampler);
+
+    gPtrLoggerSwitch->logiFunctionExit ("sppPerfSamplerStop  (Status = %x) ",status);
+    return (status);              
+#else
+    return (SCRUTINY_STATUS_SUCCESS);
+#endif
+}
 
 SCRUTINY_STATUS sppPerfCalcStatisticsOnePort(    __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance,  __IN__ U32 PortIndex)
 {
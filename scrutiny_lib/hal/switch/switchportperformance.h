@@ -54,6 +54,12 @@ typedef enum _PCIE_PORT_PERF_MON_CMD
 
 #define PCIE_PERF_COUNTERS_PER_PORT               (14)
 
+// Counters in the Monitor Read FIFO of one station (3E4h)
+#define PCIE_PERF_COUNTERS_PER_STN                (PCIE_PERF_COUNTERS_PER_PORT * ATLAS_MAX_PORT_PER_STN)
+
+#define PCIE_PERF_REG_MONITOR_READ_FIFO           0x3E4
+#define PCIE_PERF_REG_PROBE_RAM_CONTROL           0x3F0
+
 // 250 MBps (2.5 Gbps * 80%)
 #define PCIE_PERF_MAX_BPS_GEN_1_0             ((unsigned long long)250000000)
 
@@ -137,11 +143,51 @@ typedef struct _PCIE_PERF_MONITOR_READ_FIFO
 
 
 
+/*
+ * Background sampler. Every interval a counter snapshot is taken into a ring of
+ * SPP_PERF_SAMPLER_MAX_SAMPLES, so the longest window that can be read back is
+ * (SPP_PERF_SAMPLER_MAX_SAMPLES - 1) intervals.
+ */
+#define SPP_PERF_SAMPLER_MAX_SAMPLES              (64)
+#define SPP_PERF_SAMPLER_MIN_INTERVAL_MS          (10)
+
+typedef struct _SPP_PERF_SAMPLE
+{
+    U32                                 TimeStamp;                          // sosiGetMicroSeconds() when the snapshot was taken
+    SWITCH_PCIE_PERF_ONE_PORT_COUNTERS  PortCounters[ATLAS_PMG_MAX_PHYS];
+} SPP_PERF_SAMPLE, *PTR_SPP_PERF_SAMPLE;
+
+#if defined (OS_LINUX)
+
+typedef struct _SPP_PERF_SAMPLER
+{
+    PTR_SCRUTINY_DEVICE                     PtrDevice;
+    U32                                     IntervalMs;
+    U32                                     StationMask;
+    SCRUTINY_STATUS                         LastStatus;                     // status of the last snapshot
+    SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PortConfig;                     // valid ports and link properties at start
+    PCIE_PERF_MONITOR_READ_FIFO             Snapshot;                       // only used by the sampling thread
+    SPP_PERF_SAMPLE                         Samples[SPP_PERF_SAMPLER_MAX_SAMPLES];
+    U32                                     SampleCount;                    // total samples, newest is at (SampleCount - 1) % SPP_PERF_SAMPLER_MAX_SAMPLES
+    BOOLEAN                                 Stop;
+    pthread_t                               Thread;
+    pthread_mutex_t                         Lock;                           // protects Samples, SampleCount, LastStatus and Stop
+    pthread_cond_t                          StopCondition;
+} SPP_PERF_SAMPLER, *PTR_SPP_PERF_SAMPLER;
+
+#endif
+
 SCRUTINY_STATUS sppGetPciePortPerformance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance);
 SCRUTINY_STATUS sppGetPciePortPerformanceInit (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance );
 SCRUTINY_STATUS sppPerfMonControl( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance, __IN__ PCIE_PORT_PERF_MON_CMD Command );
 SCRUTINY_STATUS sppPerfGetCounters( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance );
 SCRUTINY_STATUS sppPerfGetCountersBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance, __IN__ PU32  PtrBuf, __IN__ U32 BufSize);
+U32 sppPerfGetActiveStations( __IN__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance );
+SCRUTINY_STATUS sppPerfReadCounterSnapshot( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 StationMask, __OUT__ PTR_PCIE_PERF_MONITOR_READ_FIFO PtrSnapshot );
+VOID sppPerfExtractPortCounters( __IN__ PTR_PCIE_PERF_MONITOR_READ_FIFO PtrSnapshot, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PCIE_PERF_ONE_PORT_COUNTERS PtrCounters );
+SCRUTINY_STATUS sppPerfSamplerStart( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance );
+SCRUTINY_STATUS sppPerfSamplerRead( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance );
+SCRUTINY_STATUS sppPerfSamplerStop( __IN__ PTR_SCRUTINY_DEVICE PtrDevice );
 SCRUTINY_STATUS sppPerfCalcStatisticsOnePort(    __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __OUT__ PTR_SCRUTINY_SWITCH_PCIE_PORT_PERFORMANCE   PtrPciePortPerformance,  __IN__ U32 PortIndex);
 
 #endif /* __SWITCH_PORT_PERFORMANCE__H__ */
@@ -115,7 +115,7 @@ SCRUTINY_STATUS sppGetPciePortPropertiesSsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
     
     //get regular port properties
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
 	
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
@@ -622,52 +622,45 @@ SCRUTINY_STATUS sppGetCapabilityOffset (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __
 
 
 
-SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __IN__ U32 CapabilityId, __IN__ U32 InstanceNumber, __IN__ BOOLEAN IsExtendedPcieCapability, __IN__ PU32 PtrOffset)
+/**
+ *
+ * @method  sppWalkCapabilityList()
+ *
+ *
+ * @param   PtrDevice           pointer to the device
+ *
+ * @param   PortIndex           port whose list is walked
+ *
+ * @param   IsExtendedPcieCapability    TRUE for the list at 100h, FALSE for the PCI list
+ *
+ * @param   PtrEntries          entries found, in list order
+ *
+ * @param   MaxEntries          room in PtrEntries
+ *
+ * @param   PtrCount            returns the number of capabilities found
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   walk one capability list to its end, a broken list ends the walk,
+ *          a failed register read fails it
+ *
+ *
+ */
+static SCRUTINY_STATUS sppWalkCapabilityList (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  U32                     PortIndex,
+    __IN__  BOOLEAN                 IsExtendedPcieCapability,
+    __OUT__ PTR_SPP_CAPABILITY_ENTRY PtrEntries,
+    __IN__  U32                     MaxEntries,
+    __OUT__ PU32                    PtrCount
+)
 {
-
-    U32          pcieRegisterStatus = 0x0;
-    U32          instanceCount= 0x0;
     U32          dword = 0x0;
     U32          capabilityOffset = 0x0;
-    U16          currID = 0x0;
-//    U8           bytes[1024 * 4];
-//    PU32         ptrDwords;
-//    U32          index;
-
-    SCRUTINY_STATUS 			status = SCRUTINY_STATUS_FAILED;
-    
-    
-    gPtrLoggerSwitch->logiFunctionEntry ("sppGetCapabilityOffsetInstance (PtrDevice=%x, PortIndex=%x, CapabilityId=%x, InstanceNumber=%x, IsExtendedPcieCapability=%x, PtrOffset=%x)", PtrDevice != NULL, PortIndex, CapabilityId, InstanceNumber, IsExtendedPcieCapability, PtrOffset != NULL);
-    
+    U32          count = 0;
+    SCRUTINY_STATUS status;
 
-
-    /* Check if the device, does support Capability or not */
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, PCI_REG_CMD_STAT, &pcieRegisterStatus);
-    if (status != SCRUTINY_STATUS_SUCCESS)
-    {
-        gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
-        return (status);    
-    }
-    gPtrLoggerSwitch->logiDebug ("sppGetCapabilityOffsetInstance pcieRegisterStatus = %x", pcieRegisterStatus);
-    if (pcieRegisterStatus == 0xFFFFFFFF)
-    {
-        gPtrLoggerSwitch->logiDebug ("sppGetCapabilityOffsetInstance pcieRegisterStatus = 0xFFFFFFFF");
-        status = SCRUTINY_STATUS_FAILED;
-        gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
-        return (status);
-    }
-
-    /* We have got the register, check if the capability pointer list is available */
-
-    if ((pcieRegisterStatus & 0x100000) != 0x100000)
-    {
-        gPtrLoggerSwitch->logiDebug ("sppGetCapabilityOffsetInstance pcieRegisterStatus capability pointer list is not available");
-        status = SCRUTINY_STATUS_FAILED;
-        gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
-        return (status);
-    }
-
-    instanceCount = 0;
+    *PtrCount = 0;
 
     // Set capability pointer capabilityOffset
     if (IsExtendedPcieCapability)
@@ -681,51 +674,18 @@ SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDe
         status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, PCI_REG_CAP_PTR, &dword);
         if (status != SCRUTINY_STATUS_SUCCESS)
         {
-            gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
-            return (status);    
+            return (status);
         }
 
-        //printf("I'm here %x = %x\n", PCI_REG_CAP_PTR, dword);
-
         // Set first capability capabilityOffset
         capabilityOffset = dword & 0xFF;
-
     }
 
-    // Ignore instance number for non-VSEC capabilities
-    if (CapabilityId != PCI_CAP_ID_VENDOR_SPECIFIC)
+    // Traverse the capability list, the count also stops a list that loops
+    while ((capabilityOffset != 0) && (dword != 0xFFFFFFFF) && (count < MaxEntries))
     {
-        InstanceNumber = 0;
-    }
-
-    // Start with 1st match
-    instanceCount = 0;
-
-    //printf("%x = %x\n", capabilityOffset, dword);
-
-    //ptrDwords = (PU32) &bytes[0];
-
-    //for (index = 0; index < 1024; index++)
-    //{
-    //    if (atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, index * 4, &ptrDwords[index]))
-    //    {
-    //        continue;
-    //    }
-    //}
 
-    //cmniDumpHexMemory (bytes, sizeof (bytes));
-    // Traverse capability list searching for desired ID
-    while ((capabilityOffset != 0) && (dword != 0xFFFFFFFF))
-    {
-
-        //printf("%x = %x\n", capabilityOffset, dword);
-
-
-        if ((capabilityOffset == 0xB0) //&&
-            /* (pDevice->Key.ApiMode != PLX_API_MODE_PCI) &&
-            ((pDevice->Key.PlxPort == PLX_FLAG_PORT_MPT1) ||
-            (pDevice->Key.PlxPort == PLX_FLAG_PORT_MPT2) ||
-            (pDevice->Key.PlxPort == PLX_FLAG_PORT_MPT3)) */)
+        if (capabilityOffset == 0xB0)
         {
             // MPT1-3 break the capability list at B0h (VPD), so override
             dword = 0x0004803;
@@ -733,53 +693,220 @@ SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDe
         else
         {
             // Get next capability
-            atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, capabilityOffset, &dword);
+            status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, capabilityOffset, &dword);
+            if (status != SCRUTINY_STATUS_SUCCESS)
+            {
+                return (status);
+            }
         }
 
         // Verify capability is valid
         if ((dword == 0) || (dword == 0xFFFFFFFF))
         {
-            return (SCRUTINY_STATUS_FAILED);
+            break;
         }
 
-        // Extract the capability ID
+        PtrEntries[count].Offset = (U16) capabilityOffset;
+
+        // Extract the capability ID and jump to next capability
         if (IsExtendedPcieCapability)
         {
-            // PCIe ID in [15:0]
-            currID = (U16)((dword >> 0) & 0xFFFF);
+            // PCIe ID in [15:0], next cap capabilityOffset in [31:20]
+            PtrEntries[count].Id = (U16)((dword >> 0) & 0xFFFF);
+            capabilityOffset = (U16)((dword >> 20) & 0xFFF);
         }
         else
         {
-            // PCI ID in [7:0]
-            currID = (U16)((dword >> 0) & 0xFF);
+            // PCI ID in [7:0], next cap capabilityOffset in [15:8]
+            PtrEntries[count].Id = (U16)((dword >> 0) & 0xFF);
+            capabilityOffset = (U8)((dword >> 8) & 0xFF);
         }
 
-        // Compare with desired capability
-        if (currID == CapabilityId)
+        count++;
+    }
+
+    *PtrCount = count;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+}
+
+/**
+ *
+ * @method  sppGetPortCapabilityIndex()
+ *
+ *
+ * @param   PtrDevice           pointer to the device
+ *
+ * @param   PortIndex           port of the switch
+ *
+ * @param   PtrPtrPortIndex     returns the capability index of the port
+ *
+ * @return  SCRUTINY_STATUS     Indication Success or Fail
+ *
+ * @brief   walk the standard and extended capability lists of a port once,
+ *          later calls are served from the device until
+ *          sppInvalidateCapabilityIndex()
+ *
+ *
+ */
+static SCRUTINY_STATUS sppGetPortCapabilityIndex (
+    __IN__  PTR_SCRUTINY_DEVICE             PtrDevice,
+    __IN__  U32                             PortIndex,
+    __OUT__ PTR_SPP_PORT_CAPABILITY_INDEX   *PtrPtrPortIndex
+)
+{
+
+    U32                             pcieRegisterStatus = 0x0;
+    PTR_SPP_CAPABILITY_INDEX        ptrIndex;
+    PTR_SPP_PORT_CAPABILITY_INDEX   ptrPortIndex;
+    SCRUTINY_STATUS                 status = SCRUTINY_STATUS_FAILED;
+
+    if (PortIndex >= ATLAS_PMG_MAX_PHYS)
+    {
+        return (SCRUTINY_STATUS_INVALID_PORT);
+    }
+
+    if (PtrDevice->PtrCapabilityIndex == NULL)
+    {
+        ptrIndex = (PTR_SPP_CAPABILITY_INDEX) sosiMemAlloc (sizeof (SPP_CAPABILITY_INDEX));
+
+        if (ptrIndex == NULL)
         {
-            // Verify correct instance
-            if (InstanceNumber == instanceCount)
-            {
-                // Capability found, return base capabilityOffset
-                *PtrOffset = capabilityOffset;
-                return (SCRUTINY_STATUS_SUCCESS);
-            }
+            return (SCRUTINY_STATUS_NO_MEMORY);
+        }
+
+        sosiMemSet (ptrIndex, 0, sizeof (SPP_CAPABILITY_INDEX));
+        PtrDevice->PtrCapabilityIndex = ptrIndex;
+    }
+
+    ptrPortIndex = &((PTR_SPP_CAPABILITY_INDEX) PtrDevice->PtrCapabilityIndex)->Port[PortIndex];
+
+    if (ptrPortIndex->Valid)
+    {
+        *PtrPtrPortIndex = ptrPortIndex;
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    gPtrLoggerSwitch->logiFunctionEntry ("sppGetPortCapabilityIndex (PtrDevice=%x, PortIndex=%x)", PtrDevice != NULL, PortIndex);
+
+    /* Check if the device, does support Capability or not */
+    status = atlasPCIeConfigurationSpaceRead (PtrDevice, PortIndex, PCI_REG_CMD_STAT, &pcieRegisterStatus);
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerSwitch->logiFunctionExit ("sppGetPortCapabilityIndex  (Status = %x) ",status);
+        return (status);
+    }
+    gPtrLoggerSwitch->logiDebug ("sppGetPortCapabilityIndex pcieRegisterStatus = %x", pcieRegisterStatus);
+
+    /* A port that does not answer is not indexed, it may come up later */
+    if (pcieRegisterStatus == 0xFFFFFFFF)
+    {
+        gPtrLoggerSwitch->logiDebug ("sppGetPortCapabilityIndex pcieRegisterStatus = 0xFFFFFFFF");
+        status = SCRUTINY_STATUS_FAILED;
+        gPtrLoggerSwitch->logiFunctionExit ("sppGetPortCapabilityIndex  (Status = %x) ",status);
+        return (status);
+    }
+
+    ptrPortIndex->StandardCount = 0;
+    ptrPortIndex->ExtendedCount = 0;
 
-            // Increment count of matches
-            instanceCount++;
+    /* Without the capability pointer list the port is indexed as empty */
+    if ((pcieRegisterStatus & 0x100000) == 0x100000)
+    {
+        status = sppWalkCapabilityList (PtrDevice, PortIndex, FALSE, ptrPortIndex->Standard,
+                                        SPP_CAPABILITY_INDEX_MAX_STANDARD, &ptrPortIndex->StandardCount);
+
+        if (status == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sppWalkCapabilityList (PtrDevice, PortIndex, TRUE, ptrPortIndex->Extended,
+                                            SPP_CAPABILITY_INDEX_MAX_EXTENDED, &ptrPortIndex->ExtendedCount);
         }
 
-        // Jump to next capability
-        if (IsExtendedPcieCapability)
+        /* A half read list is not indexed, the next lookup walks it again */
+        if (status != SCRUTINY_STATUS_SUCCESS)
         {
-            // PCIe next cap capabilityOffset in [31:20]
-            capabilityOffset = (U16)((dword >> 20) & 0xFFF);
+            ptrPortIndex->StandardCount = 0;
+            ptrPortIndex->ExtendedCount = 0;
+
+            gPtrLoggerSwitch->logiFunctionExit ("sppGetPortCapabilityIndex  (Status = %x) ",status);
+            return (status);
         }
-        else
+    }
+    else
+    {
+        gPtrLoggerSwitch->logiDebug ("sppGetPortCapabilityIndex pcieRegisterStatus capability pointer list is not available");
+    }
+
+    ptrPortIndex->Valid = TRUE;
+
+    gPtrLoggerSwitch->logiDebug ("sppGetPortCapabilityIndex StandardCount = %x, ExtendedCount = %x",
+                                 ptrPortIndex->StandardCount, ptrPortIndex->ExtendedCount);
+
+    *PtrPtrPortIndex = ptrPortIndex;
+
+    gPtrLoggerSwitch->logiFunctionExit ("sppGetPortCapabilityIndex  (Status = %x) ", SCRUTINY_STATUS_SUCCESS);
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __IN__ U32 CapabilityId, __IN__ U32 InstanceNumber, __IN__ BOOLEAN IsExtendedPcieCapability, __IN__ PU32 PtrOffset)
+{
+
+    U32                             instanceCount = 0x0;
+    U32                             index;
+    U32                             entryCount;
+    PTR_SPP_CAPABILITY_ENTRY        ptrEntries;
+    PTR_SPP_PORT_CAPABILITY_INDEX   ptrPortIndex = NULL;
+
+    SCRUTINY_STATUS 			status = SCRUTINY_STATUS_FAILED;
+
+
+    gPtrLoggerSwitch->logiFunctionEntry ("sppGetCapabilityOffsetInstance (PtrDevice=%x, PortIndex=%x, CapabilityId=%x, InstanceNumber=%x, IsExtendedPcieCapability=%x, PtrOffset=%x)", PtrDevice != NULL, PortIndex, CapabilityId, InstanceNumber, IsExtendedPcieCapability, PtrOffset != NULL);
+
+    status = sppGetPortCapabilityIndex (PtrDevice, PortIndex, &ptrPortIndex);
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
+        return (status);
+    }
+
+    if (IsExtendedPcieCapability)
+    {
+        ptrEntries = ptrPortIndex->Extended;
+        entryCount = ptrPortIndex->ExtendedCount;
+    }
+    else
+    {
+        ptrEntries = ptrPortIndex->Standard;
+        entryCount = ptrPortIndex->StandardCount;
+    }
+
+    // Ignore instance number for non-VSEC capabilities
+    if (CapabilityId != PCI_CAP_ID_VENDOR_SPECIFIC)
+    {
+        InstanceNumber = 0;
+    }
+
+    status = SCRUTINY_STATUS_FAILED;
+
+    for (index = 0; index < entryCount; index++)
+    {
+        if (ptrEntries[index].Id != CapabilityId)
         {
-            // PCI next cap capabilityOffset in [15:8]
-            capabilityOffset = (U8)((dword >> 8) & 0xFF);
+            continue;
+        }
+
+        // Verify correct instance
+        if (InstanceNumber == instanceCount)
+        {
+            // Capability found, return base capabilityOffset
+            *PtrOffset = ptrEntries[index].Offset;
+            status = SCRUTINY_STATUS_SUCCESS;
+            break;
         }
+
+        // Increment count of matches
+        instanceCount++;
     }
 
     gPtrLoggerSwitch->logiFunctionExit ("sppGetCapabilityOffsetInstance  (Status = %x) ",status);
@@ -788,6 +915,66 @@ SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDe
 
 }
 
+/**
+ *
+ * @method  sppInvalidateCapabilityIndex()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @param   PortIndex      port to drop, SPP_CAPABILITY_INDEX_ALL_PORTS for all of them
+ *
+ * @return  none
+ *
+ * @brief   drop the capability index, the next lookup walks the lists again
+ *
+ *
+ */
+VOID sppInvalidateCapabilityIndex (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex)
+{
+    PTR_SPP_CAPABILITY_INDEX    ptrIndex = (PTR_SPP_CAPABILITY_INDEX) PtrDevice->PtrCapabilityIndex;
+    U32                         index;
+
+    if (ptrIndex == NULL)
+    {
+        return;
+    }
+
+    if (PortIndex == SPP_CAPABILITY_INDEX_ALL_PORTS)
+    {
+        for (index = 0; index < ATLAS_PMG_MAX_PHYS; index++)
+        {
+            ptrIndex->Port[index].Valid = FALSE;
+        }
+    }
+    else if (PortIndex < ATLAS_PMG_MAX_PHYS)
+    {
+        ptrIndex->Port[PortIndex].Valid = FALSE;
+    }
+}
+
+/**
+ *
+ * @method  sppFreeCapabilityIndex()
+ *
+ *
+ * @param   PtrDevice      pointer to the device
+ *
+ * @return  none
+ *
+ * @brief   release the capability index when the device goes away
+ *
+ *
+ */
+VOID sppFreeCapabilityIndex (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+    if (PtrDevice->PtrCapabilityIndex != NULL)
+    {
+        sosiMemFree (PtrDevice->PtrCapabilityIndex);
+        PtrDevice->PtrCapabilityIndex = NULL;
+    }
+}
+
 
 SCRUTINY_STATUS sppFillPortConfigurationFromCcrSpace (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PORT_CONFIGURATION PtrConfiguration)
 {
@@ -876,6 +1063,52 @@ SCRUTINY_STATUS sppGetDownStreamPortAdditionalProperties (__IN__ PTR_SCRUTINY_DE
 
 }
 
+/**
+ *
+ * @method  sppReadAttachedDeviceConfig()
+ *
+ *
+ * @param   PtrDevice           pointer to the switch
+ *
+ * @param   Location            host PCI address of the attached device
+ *
+ * @param   Offset              configuration space offset
+ *
+ * @param   PtrDword            read value
+ *
+ * @return  status
+ *
+ * @brief   read the host config space of a device below a downstream port, the read
+ *          is traced with the switch so a replay does not look at the replay host
+ *
+ *
+ */
+static SCRUTINY_STATUS sppReadAttachedDeviceConfig (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  SCRUTINY_PCI_ADDRESS    Location,
+    __IN__  U32                     Offset,
+    __OUT__ PU32                    PtrDword
+)
+{
+    SCRUTINY_STATUS     status;
+    LRC_EXCHANGE        exchange;
+
+    lrciInitializeExchange (&exchange, LRC_RECORD_TYPE_CONFIG_READ,
+                            LRC_CONFIG_ADDRESS (Location.BusNumber, Location.DeviceNumber, Location.FunctionNumber, Offset),
+                            PtrDword, sizeof (U32), TRUE);
+
+    if (lrciBeginExchange (PtrDevice, &exchange, &status))
+    {
+        return (status);
+    }
+
+    status = pcsiReadDword (Location, Offset, PtrDword);
+
+    lrciEndExchange (PtrDevice, &exchange, status);
+
+    return (status);
+}
+
 
 
 SCRUTINY_STATUS sppGetPciePortPropertiesBsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevice,  __OUT__ PTR_SCRUTINY_SWITCH_PORT_PROPERTIES PtrPciePortProperties)
@@ -907,7 +1140,7 @@ SCRUTINY_STATUS sppGetPciePortPropertiesBsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
     
     //get regular port properties
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("sppGetPciePortPropertiesBsw  (Status = %x) ",status);
@@ -1051,12 +1284,14 @@ SCRUTINY_STATUS sppGetPciePortPropertiesBsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
                 busIndex.BusNumber = PtrPciePortProperties->PortConfigurations[index].u.Ds.GblBusSec;
                 busIndex.DeviceNumber = 0x0;
                 busIndex.FunctionNumber = 0x0;
+                busIndex.Reserved = 0x0;
+                busIndex.SegmentNumber = (PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_PCI) ? PtrDevice->Handle.PciHandle.PciLocation.SegmentNumber : 0;
 
                 /*
                  * Read 4 bytes from config space and get the device id information
                  */
                 dword = 0xFFFFFFFF;
-                if (pcsiReadDword (busIndex, PCI_REG_DEV_VEN_ID, &dword) != SCRUTINY_STATUS_SUCCESS)
+                if (sppReadAttachedDeviceConfig (PtrDevice, busIndex, PCI_REG_DEV_VEN_ID, &dword) != SCRUTINY_STATUS_SUCCESS)
                 {
                     gPtrLoggerSwitch->logiDebug ("Unable to read the attached device id.");
                     continue;
@@ -1069,7 +1304,7 @@ SCRUTINY_STATUS sppGetPciePortPropertiesBsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
                 }
                 
                 dword = 0xFFFFFFFF;
-                if (pcsiReadDword (busIndex, PCI_REG_CLASS_REV, &dword) != SCRUTINY_STATUS_SUCCESS)
+                if (sppReadAttachedDeviceConfig (PtrDevice, busIndex, PCI_REG_CLASS_REV, &dword) != SCRUTINY_STATUS_SUCCESS)
                 {
                     gPtrLoggerSwitch->logiDebug ("Unable to read the attached device class code.");
                     continue;
@@ -1084,7 +1319,7 @@ SCRUTINY_STATUS sppGetPciePortPropertiesBsw (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
                 }
 
                 dword = 0xFFFFFFFF;
-                if (pcsiReadDword (busIndex, PCI_REG_DEV_SUB_VEN_ID, &dword) != SCRUTINY_STATUS_SUCCESS)
+                if (sppReadAttachedDeviceConfig (PtrDevice, busIndex, PCI_REG_DEV_SUB_VEN_ID, &dword) != SCRUTINY_STATUS_SUCCESS)
                 {
                     gPtrLoggerSwitch->logiDebug ("Unable to read the attached subdevice id.");
                     continue;
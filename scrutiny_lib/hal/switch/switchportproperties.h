@@ -160,6 +160,9 @@ struct __PCI_STATUS_BITS
 #define ATLAS_REGISTER_PMG_REG_SWITCH_ID        0x609F0000
 #define ATLAS_REGISTER_PMG_REG_SWITCH_MODE      0xFFF000B0
 
+/* Pass to sppInvalidateCapabilityIndex() to drop the index of every port */
+#define SPP_CAPABILITY_INDEX_ALL_PORTS          0xFFFFFFFF
+
 
 typedef struct _SWITCH_CFG_PAGE_E00F
 {
@@ -206,6 +209,34 @@ typedef struct _SWITCH_ID
 } SWITCH_ID, *PTR_SWITCH_ID;
 
 
+/* Capabilities kept per port, the switch ports have far less on either list */
+#define SPP_CAPABILITY_INDEX_MAX_STANDARD       (16)
+#define SPP_CAPABILITY_INDEX_MAX_EXTENDED       (32)
+
+/** One capability in the order it was found on the list */
+typedef struct _SPP_CAPABILITY_ENTRY
+{
+    U16 Id;                         /**< Capability ID */
+    U16 Offset;                     /**< Config space offset of the capability header */
+} SPP_CAPABILITY_ENTRY, *PTR_SPP_CAPABILITY_ENTRY;
+
+/** Standard and extended capability lists of one port, walked once */
+typedef struct _SPP_PORT_CAPABILITY_INDEX
+{
+    BOOLEAN              Valid;
+    U32                  StandardCount;
+    U32                  ExtendedCount;
+    SPP_CAPABILITY_ENTRY Standard[SPP_CAPABILITY_INDEX_MAX_STANDARD];
+    SPP_CAPABILITY_ENTRY Extended[SPP_CAPABILITY_INDEX_MAX_EXTENDED];
+} SPP_PORT_CAPABILITY_INDEX, *PTR_SPP_PORT_CAPABILITY_INDEX;
+
+/** Capability index of a switch, hangs off PtrDevice->PtrCapabilityIndex */
+typedef struct _SPP_CAPABILITY_INDEX
+{
+    SPP_PORT_CAPABILITY_INDEX Port[ATLAS_PMG_MAX_PHYS];
+} SPP_CAPABILITY_INDEX, *PTR_SPP_CAPABILITY_INDEX;
+
+
 
 
 
@@ -215,6 +246,8 @@ SCRUTINY_STATUS sppGetPcieOnePortProperties (__IN__ PTR_SCRUTINY_DEVICE PtrDevic
 SCRUTINY_STATUS sppFillPortConfigurationFromConfigSpace (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PORT_CONFIGURATION PtrPortConfiguration);
 SCRUTINY_STATUS sppGetCapabilityOffset (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __IN__ U32 CapabilityId, __IN__ BOOLEAN IsExtendedPcieCapability, __IN__ PU32 PtrOffset);
 SCRUTINY_STATUS sppGetCapabilityOffsetInstance (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __IN__ U32 CapabilityId, __IN__ U32 InstanceNumber, __IN__ BOOLEAN IsExtendedPcieCapability, __IN__ PU32 PtrOffset);
+VOID sppInvalidateCapabilityIndex (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex);
+VOID sppFreeCapabilityIndex (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
 SCRUTINY_STATUS sppFillPortConfigurationFromCcrSpace (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PORT_CONFIGURATION PtrConfiguration);
 SCRUTINY_STATUS sppGetDownStreamPortAdditionalProperties (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 PortIndex, __OUT__ PTR_SWITCH_PORT_CONFIGURATION PtrPortConfiguration);
 
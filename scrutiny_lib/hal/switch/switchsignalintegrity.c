@@ -69,7 +69,7 @@ SCRUTINY_STATUS ssiRxEqStatus (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32
     gPtrLoggerSwitch->logiFunctionEntry ("ssiRxEqStatus (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortRxEqStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortRxEqStatus != NULL);
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
 	
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
@@ -525,7 +525,7 @@ SCRUTINY_STATUS ssiTxCoeff( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Sta
     gPtrLoggerSwitch->logiFunctionEntry ("ssiTxCoeff (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortTxCoeffStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortTxCoeffStatus != NULL);
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiTxCoeff  (Status = %x) ",status);
@@ -728,7 +728,7 @@ SCRUTINY_STATUS ssiHardwareEyeStart( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN_
     gPtrLoggerSwitch->logiFunctionEntry ("ssiHardwareEyeStart (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortHwEyeStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortHwEyeStatus != NULL );
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiHardwareEyeStart  (Status = %x) ",status);
@@ -1059,7 +1059,7 @@ SCRUTINY_STATUS ssiHardwareEyePoll( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
     gPtrLoggerSwitch->logiFunctionEntry ("ssiHardwareEyePoll (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortHwEyeStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortHwEyeStatus != NULL );
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiHardwareEyePoll  (Status = %x) ",status);
@@ -1249,7 +1249,7 @@ SCRUTINY_STATUS ssiHardwareEyeGet( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__
     gPtrLoggerSwitch->logiFunctionEntry ("ssiHardwareEyeGet (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortHwEyeStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortHwEyeStatus != NULL );
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiHardwareEyeGet  (Status = %x) ",status);
@@ -1420,7 +1420,7 @@ SCRUTINY_STATUS ssiHardwareEyeClean( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN_
     gPtrLoggerSwitch->logiFunctionEntry ("ssiHardwareEyeClean (PtrDevice=%x, StartPort=%x, NumberOfPort=%x, PtrPortHwEyeStatus=%x)", PtrDevice != NULL, StartPort, NumberOfPort, PtrPortHwEyeStatus != NULL );
 
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiHardwareEyeClean  (Status = %x) ",status);
@@ -1661,7 +1661,7 @@ SCRUTINY_STATUS ssiSoftwareEyeWithBuf( __IN__ PTR_SCRUTINY_DEVICE PtrDevice, __I
     bitCount = 100000000;		//default 1e8
     
     //read the chip ID ,extract the max port number, the offset is 0xB7C, just read it from port 0 cfg space
-    status = atlasPCIeConfigurationSpaceRead (PtrDevice, 0, 0xB7C, &regVal);
+    status = spcGetChipIdRegister (PtrDevice, &regVal);
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         gPtrLoggerSwitch->logiFunctionExit ("ssiSoftwareEyeWithBuf  (Status = %x) ",status);
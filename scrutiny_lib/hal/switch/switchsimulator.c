@@ -0,0 +1,246 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+#include "libincludes.h"
+#include "atlas.h"
+#include "switchsimulator.h"
+
+/**
+ *
+ *  @method  ssimiDiscoverDevices()
+ *
+ *  @param   PtrDiscoveryParams     Discovery parameters holding the snapshot file
+ *
+ *  @return  SCRUTINY_STATUS        SCRUTINY_STATUS_SUCCESS when the simulated switch
+ *                                  was added, SCRUTINY_STATUS_IGNORE when no snapshot
+ *                                  is configured, otherwise the failure status
+ *
+ *  @brief   Loads the register snapshot and adds a simulated Atlas switch to the
+ *           device list. The device is qualified through the same register reads
+ *           as a real switch, so the snapshot has to hold the chip ID registers.
+ *
+ */
+
+SCRUTINY_STATUS ssimiDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams)
+{
+
+    PTR_SCRUTINY_DEVICE ptrDevice = NULL;
+    PTR_LRM_REGISTER_MODEL ptrModel = NULL;
+    U32 latency = 0;
+    SCRUTINY_STATUS status;
+
+    gPtrLoggerSwitch->logiFunctionEntry ("ssimiDiscoverDevices (PtrDiscoveryParams=%x)", PtrDiscoveryParams != NULL);
+
+    if (PtrDiscoveryParams == NULL)
+    {
+        gPtrLoggerSwitch->logiFunctionExit ("ssimiDiscoverDevices (Status=%x)", SCRUTINY_STATUS_INVALID_PARAMETER);
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    if ((PtrDiscoveryParams->u.SimulatorConfig.SimulatorType != SCRUTINY_SIMULATOR_TYPE_SWITCH_SNAPSHOT) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile[0] == '\0'))
+    {
+        /* No switch is simulated in this configuration */
+        gPtrLoggerSwitch->logiFunctionExit ("ssimiDiscoverDevices (Status=%x)", SCRUTINY_STATUS_IGNORE);
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
+    status = lrmiLoadSnapshot (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile, &ptrModel, &latency);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerSwitch->logiFunctionExit ("ssimiDiscoverDevices (Snapshot Status=%x)", status);
+        return (status);
+    }
+
+    gPtrLoggerSwitch->logiDebug ("Simulated switch has %d us latency", latency);
+
+    ptrDevice = (PTR_SCRUTINY_DEVICE) sosiMemAlloc (sizeof (SCRUTINY_DEVICE));
+
+    if (ptrDevice == NULL)
+    {
+        lrmiFreeModel (ptrModel);
+
+        gPtrLoggerSwitch->logiFunctionExit ("ssimiDiscoverDevices (Memory Allocation)");
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    sosiMemSet (ptrDevice, 0, sizeof (SCRUTINY_DEVICE));
+
+    ptrDevice->HandleType = SCRUTINY_HANDLE_TYPE_SIMULATED;
+    ptrDevice->DeviceInfo.HandleType = ptrDevice->HandleType;
+
+    ptrDevice->Handle.SimulatedHandle.PtrRegisterModel = ptrModel;
+    ptrDevice->Handle.SimulatedHandle.AccessLatencyMicroSeconds = latency;
+
+    status = atlasiRegisterBasedQualifSwitch (ptrDevice);
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        status = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice);
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        lrmiFreeModel (ptrModel);
+        sosiMemFree (ptrDevice);
+    }
+
+    gPtrLoggerSwitch->logiFunctionExit ("ssimiDiscoverDevices (Status=%x)", status);
+
+    return (status);
+
+}
+
+/**
+ *
+ *  @method  ssimiMemoryRead32()
+ *
+ *  @param   PtrDevice          Simulated switch
+ *
+ *  @param   Address            DWORD aligned start address
+ *
+ *  @param   PtrData            Receives the register contents
+ *
+ *  @param   SizeInBytes        Number of bytes to read, a multiple of a DWORD
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS or
+ *                              SCRUTINY_STATUS_INVALID_PARAMETER
+ *
+ *  @brief   Reads consecutive registers from the model. The access latency
+ *           is paid once per call, as a burst costs one transaction.
+ *
+ */
+
+SCRUTINY_STATUS ssimiMemoryRead32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __OUT__ PU32 PtrData, __IN__ U32 SizeInBytes)
+{
+
+    U32 index;
+    PTR_LRM_REGISTER_MODEL ptrModel = (PTR_LRM_REGISTER_MODEL) PtrDevice->Handle.SimulatedHandle.PtrRegisterModel;
+
+    if ((ptrModel == NULL) || (PtrData == NULL) || (Address & 0x3))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    if (PtrDevice->Handle.SimulatedHandle.AccessLatencyMicroSeconds)
+    {
+        sosiMicroSleep (PtrDevice->Handle.SimulatedHandle.AccessLatencyMicroSeconds);
+    }
+
+    for (index = 0; index < (SizeInBytes / sizeof (U32)); index++)
+    {
+        PtrData[index] = lrmiReadRegister (ptrModel, Address + (index * sizeof (U32)));
+    }
+
+    ptrModel->ReadCount++;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  ssimiMemoryWrite32()
+ *
+ *  @param   PtrDevice          Simulated switch
+ *
+ *  @param   Address            DWORD aligned register address
+ *
+ *  @param   Value              Value to write
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS or failure status
+ *
+ *  @brief   Writes one register of the model. A pending script of the
+ *           register is not affected.
+ *
+ */
+
+SCRUTINY_STATUS ssimiMemoryWrite32 (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Address, __IN__ U32 Value)
+{
+
+    PTR_LRM_REGISTER_MODEL ptrModel = (PTR_LRM_REGISTER_MODEL) PtrDevice->Handle.SimulatedHandle.PtrRegisterModel;
+
+    if ((ptrModel == NULL) || (Address & 0x3))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    if (PtrDevice->Handle.SimulatedHandle.AccessLatencyMicroSeconds)
+    {
+        sosiMicroSleep (PtrDevice->Handle.SimulatedHandle.AccessLatencyMicroSeconds);
+    }
+
+    if (lrmiWriteRegister (ptrModel, Address, Value) != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    ptrModel->WriteCount++;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  ssimiCloseDevice()
+ *
+ *  @param   PtrDevice          Simulated switch
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS
+ *
+ *  @brief   Releases the register model of the simulated switch
+ *
+ */
+
+SCRUTINY_STATUS ssimiCloseDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    PTR_LRM_REGISTER_MODEL ptrModel = (PTR_LRM_REGISTER_MODEL) PtrDevice->Handle.SimulatedHandle.PtrRegisterModel;
+
+    if (ptrModel != NULL)
+    {
+        gPtrLoggerSwitch->logiDebug ("Simulated switch closed after %d reads and %d writes",
+                                     ptrModel->ReadCount, ptrModel->WriteCount);
+    }
+
+    lrmiFreeModel (ptrModel);
+
+    PtrDevice->Handle.SimulatedHandle.PtrRegisterModel = NULL;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
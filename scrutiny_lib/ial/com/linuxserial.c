@@ -36,12 +36,14 @@
 #include <termios.h>
 #include <linux/serial.h>
 #include <sys/file.h>
+#include <poll.h>
 
 
 SCRUTINY_STATUS spGetComPortConfiguration (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrSerialConfig, __OUT__ struct termios *PtrTermConfig);
 BOOLEAN spiIsHandleValid (__IN__ U32 FileDescriptor);
-SCRUTINY_STATUS spReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial);
+U32 spReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial);
 VOID *spReadThread (__IN__ VOID* PtrParam);
+VOID spRollReceiveStatistics (__INOUT__ PTR_IAL_SERIAL_RECEIVE_STATISTICS PtrStatistics, __IN__ U32 Now);
 
 /**
  *
@@ -83,10 +85,17 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 
     ptrSerial = (PTR_SCRUTINY_IAL_SERIAL_HANDLE) malloc (sizeof (SCRUTINY_IAL_SERIAL_HANDLE));
 
+    if (ptrSerial == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
     memset (ptrSerial, 0, sizeof (SCRUTINY_IAL_SERIAL_HANDLE));
 
     ptrSerial->ReadHandle = -1;
     ptrSerial->WriteHandle = -1;
+    ptrSerial->WakeupHandle[0] = -1;
+    ptrSerial->WakeupHandle[1] = -1;
 
     fdRead = open (PtrConfig->DeviceName, O_RDONLY | O_NOCTTY | O_NDELAY);
     fdWrite = open (PtrConfig->DeviceName, O_WRONLY | O_NOCTTY | O_NDELAY);
@@ -102,16 +111,18 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
     if (fdRead < 0 || fdWrite < 0)
     {
 
-        if (fdRead > 0)
+        if (fdRead >= 0)
         {
             close (fdRead);
         }
 
-        if (fdWrite > 0)
+        if (fdWrite >= 0)
         {
             close (fdWrite);
         }
 
+        free (ptrSerial);
+
         return (SCRUTINY_STATUS_FAILED);
 
     }
@@ -124,6 +135,8 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
         close (fdRead);
         close (fdWrite);
 
+        free (ptrSerial);
+
         return (SCRUTINY_STATUS_FAILED);
 
     }
@@ -138,15 +151,10 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 
     if (spGetComPortConfiguration (PtrConfig, &options) != SCRUTINY_STATUS_SUCCESS) {
 
-        if (fdRead > 0)
-        {
-            close (fdRead);
-        }
+        close (fdRead);
+        close (fdWrite);
 
-        if (fdWrite > 0)
-        {
-            close (fdWrite);
-        }
+        free (ptrSerial);
 
         return (SCRUTINY_STATUS_FAILED);
 
@@ -167,7 +175,49 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 
     ptrSerial->PtrSerialBuffer = (PTR_IAL_SERIAL_BUFFER) malloc (sizeof (IAL_SERIAL_BUFFER));
 
-    wsbiInitializeBuffers (ptrSerial->PtrSerialBuffer);
+    if (ptrSerial->PtrSerialBuffer == NULL)
+    {
+        close (fdRead);
+        close (fdWrite);
+
+        free (ptrSerial);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    memset (ptrSerial->PtrSerialBuffer, 0, sizeof (IAL_SERIAL_BUFFER));
+
+    if (wsbiInitializeBuffers (ptrSerial->PtrSerialBuffer) != SCRUTINY_STATUS_SUCCESS)
+    {
+        close (fdRead);
+        close (fdWrite);
+
+        free (ptrSerial->PtrSerialBuffer);
+        free (ptrSerial);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    /*
+     * The read thread sleeps in poll() on the port and on this pipe. Closing
+     * the port writes into the pipe so the thread leaves without a timeout.
+     */
+
+    if (pipe (ptrSerial->WakeupHandle) != 0)
+    {
+        wsbiFreeBuffers (ptrSerial->PtrSerialBuffer);
+        sem_destroy (&ptrSerial->PtrSerialBuffer->CriticalSectionHandle);
+
+        close (fdRead);
+        close (fdWrite);
+
+        free (ptrSerial->PtrSerialBuffer);
+        free (ptrSerial);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    fcntl (ptrSerial->WakeupHandle[1], F_SETFL, O_NONBLOCK);
 
     /*
      * We need to start the reading thread
@@ -175,6 +225,22 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 
     if (pthread_create (&ptrSerial->ReadThread, NULL, spReadThread, (void*) ptrSerial))
     {
+        close (ptrSerial->WakeupHandle[0]);
+        close (ptrSerial->WakeupHandle[1]);
+
+        wsbiFreeBuffers (ptrSerial->PtrSerialBuffer);
+        sem_destroy (&ptrSerial->PtrSerialBuffer->CriticalSectionHandle);
+
+        #ifndef OS_SOLARIS
+        flock (fdRead, LOCK_UN);
+        #endif
+
+        close (fdRead);
+        close (fdWrite);
+
+        free (ptrSerial->PtrSerialBuffer);
+        free (ptrSerial);
+
         return (SCRUTINY_STATUS_FAILED);
     }
 
@@ -202,9 +268,41 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 SCRUTINY_STATUS spiClosePort (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial)
 {
 
+    U8 wakeup = 0;
+    IAL_SERIAL_RECEIVE_STATISTICS statistics;
+
     if (PtrSerial->ReadHandle != -1)
     {
 
+        /*
+         * Stop the read thread before the descriptors it polls are closed. Should the
+         * wakeup byte not go through, closing the write end still hangs up the pipe
+         * under the poll of the thread, so the join always returns.
+         */
+        if (write (PtrSerial->WakeupHandle[1], &wakeup, sizeof (wakeup)) != sizeof (wakeup))
+        {
+            gPtrLoggerGeneric->logiDebug ("Serial read thread wakeup failed (errno=%d), hanging up its pipe", errno);
+        }
+
+        close (PtrSerial->WakeupHandle[1]);
+
+        pthread_join (PtrSerial->ReadThread, NULL);
+
+        close (PtrSerial->WakeupHandle[0]);
+
+        PtrSerial->WakeupHandle[0] = -1;
+        PtrSerial->WakeupHandle[1] = -1;
+
+        spiGetReceiveStatistics (PtrSerial, &statistics);
+
+        gPtrLoggerGeneric->logiDebug ("Serial port %s closed after %u bytes in %u wakeups, %u bytes and %u wakeups in the last second, %u bytes dropped in %u overflows",
+                                      PtrSerial->SerialConfig.DeviceName, statistics.BytesReceived, statistics.Wakeups,
+                                      statistics.BytesPerSecond, statistics.WakeupsPerSecond,
+                                      PtrSerial->PtrSerialBuffer->OverflowBytes, PtrSerial->PtrSerialBuffer->OverflowCount);
+
+        /* No producer anymore, the ring can go */
+        wsbiFreeBuffers (PtrSerial->PtrSerialBuffer);
+
         #ifndef OS_SOLARIS
         flock (PtrSerial->ReadHandle, LOCK_UN);
         #endif
@@ -268,7 +366,9 @@ SCRUTINY_STATUS spiFlushPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial)
  * @return  VOID*           However we are not returning anything.
  *
  * @brief   Starts the thread for reading and wirting the serial port. This will
- *          keep reading theport until the COM port is closed.
+ *          keep reading theport until the COM port is closed. The thread sleeps
+ *          in poll() until the port has data or spiClosePort() writes into the
+ *          wakeup pipe, so an idle port costs no CPU.
  *
  */
 
@@ -277,41 +377,77 @@ VOID *spReadThread (__IN__ VOID* PtrParam)
 {
 
     PTR_SCRUTINY_IAL_SERIAL_HANDLE ptrSerial = (PTR_SCRUTINY_IAL_SERIAL_HANDLE) PtrParam;
-    int available = 0;
+    PTR_IAL_SERIAL_RECEIVE_STATISTICS ptrStatistics = &ptrSerial->PtrSerialBuffer->ReceiveStatistics;
 
-    fd_set input;
+    struct pollfd descriptors[2];
+    U32 received = 0;
+    int ready = 0;
 
     if (!spiIsHandleValid (ptrSerial->ReadHandle))
     {
         return (NULL);
     }
 
-    FD_ZERO (&input);
-    FD_SET (ptrSerial->ReadHandle, &input);
+    descriptors[0].fd = ptrSerial->ReadHandle;
+    descriptors[0].events = POLLIN;
+
+    descriptors[1].fd = ptrSerial->WakeupHandle[0];
+    descriptors[1].events = POLLIN;
 
+    wsbiLockBuffer (ptrSerial->PtrSerialBuffer);
+
+    ptrStatistics->WindowStart = sosiGetMicroSeconds();
+
+    wsbiUnlockBuffer (ptrSerial->PtrSerialBuffer);
 
     while (TRUE)
     {
 
-        if (!spiIsHandleValid (ptrSerial->ReadHandle))
+        descriptors[0].revents = 0;
+        descriptors[1].revents = 0;
+
+        ready = poll (descriptors, 2, -1);
+
+        if (ready < 0)
         {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
             break;
         }
 
-        available = 0;
-
-        /* Do the select */
+        if (descriptors[1].revents)
+        {
+            /* Port is being closed */
+            break;
+        }
 
-        if (ioctl (ptrSerial->ReadHandle, FIONREAD, &available) < 0)
+        if (descriptors[0].revents & (POLLERR | POLLHUP | POLLNVAL))
         {
-            available = 0;
+            break;
         }
 
-        if (available)
+        received = 0;
+
+        if (descriptors[0].revents & POLLIN)
         {
-            spReadData (ptrSerial);
+            received = spReadData (ptrSerial);
         }
 
+        wsbiLockBuffer (ptrSerial->PtrSerialBuffer);
+
+        /* Roll first, the bytes of this wakeup belong to the window which is open now */
+        spRollReceiveStatistics (ptrStatistics, sosiGetMicroSeconds());
+
+        ptrStatistics->Wakeups++;
+        ptrStatistics->BytesReceived += received;
+        ptrStatistics->WindowWakeups++;
+        ptrStatistics->WindowBytes += received;
+
+        wsbiUnlockBuffer (ptrSerial->PtrSerialBuffer);
+
     }
 
     return (NULL);
@@ -324,29 +460,132 @@ VOID *spReadThread (__IN__ VOID* PtrParam)
  *
  * @param   PtrSerial           Serial port handle for the native system call.
  *
- * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS when success and
- *                              SCRUTINY_STATUS_FAILED on failure.
+ * @return  U32                 Number of bytes read from the port.
  *
  * @brief   Reads the available data on the serial port and stores them into the
- *          serial buffer. The method does not throw any error message.
+ *          serial buffer. The port is drained chunk by chunk until the
+ *          non-blocking read has nothing left. The method does not throw any
+ *          error message.
  *
  */
 
-SCRUTINY_STATUS spReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial)
+U32 spReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial)
 {
 
     int numRead = 0;
-    U8 data[1024 * 1024] = { 0 };
+    U32 total = 0;
+    U8 data[SERIAL_RECEIVE_CHUNK_SIZE];
+
+    while (TRUE)
+    {
+
+        numRead = read (PtrSerial->ReadHandle, data, sizeof (data));
 
-    numRead = read (PtrSerial->ReadHandle, data, 1024 * 1024);
+        if (numRead < 1)
+        {
+            break;
+        }
+
+        /* The receive thread is the only producer of the ring, no lock needed */
+        wsbiAddData (PtrSerial->PtrSerialBuffer, data, numRead);
+
+        total += numRead;
+
+        if ((U32) numRead < sizeof (data))
+        {
+            break;
+        }
+
+    }
 
-    if (numRead < 1)
+    /* One wakeup per drain, whoever waits for a response rechecks the ring */
+    if (total)
     {
-        return (SCRUTINY_STATUS_SUCCESS);
+        wsbiSignalArrival (PtrSerial->PtrSerialBuffer);
+    }
+
+    return (total);
+
+}
+
+/**
+ *
+ * @name    spRollReceiveStatistics()
+ *
+ * @param   PtrStatistics       Receive statistics of the port, the buffer lock
+ *                              is held by the caller.
+ *
+ * @param   Now                 Current time in micro seconds.
+ *
+ * @return  VOID
+ *
+ * @brief   Closes the current window once it is over and publishes its counts
+ *          as the per second rates. A window which ended more than one window
+ *          ago saw no traffic since, so the rates drop to zero.
+ *
+ */
+
+VOID spRollReceiveStatistics (__INOUT__ PTR_IAL_SERIAL_RECEIVE_STATISTICS PtrStatistics, __IN__ U32 Now)
+{
+
+    U32 elapsed;
+
+    elapsed = Now - PtrStatistics->WindowStart;
+
+    if (elapsed < SERIAL_RECEIVE_STATISTICS_WINDOW_US)
+    {
+        return;
+    }
+
+    if (elapsed < (2 * SERIAL_RECEIVE_STATISTICS_WINDOW_US))
+    {
+        PtrStatistics->BytesPerSecond = PtrStatistics->WindowBytes;
+        PtrStatistics->WakeupsPerSecond = PtrStatistics->WindowWakeups;
+    }
+
+    else
+    {
+        PtrStatistics->BytesPerSecond = 0;
+        PtrStatistics->WakeupsPerSecond = 0;
+    }
+
+    PtrStatistics->WindowBytes = 0;
+    PtrStatistics->WindowWakeups = 0;
+    PtrStatistics->WindowStart = Now;
+
+}
+
+/**
+ *
+ * @name    spiGetReceiveStatistics()
+ *
+ * @param   PtrSerial           Serial port handle for the native system call.
+ *
+ * @param   PtrStatistics       Receives a snapshot of the receive statistics.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS when success and
+ *                              SCRUTINY_STATUS_FAILED on failure.
+ *
+ * @brief   Returns the bytes received and the receive thread wakeups, in
+ *          total and for the last one second window. The window is rolled
+ *          here as well, so an idle port reads as idle.
+ *
+ */
+
+SCRUTINY_STATUS spiGetReceiveStatistics (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __OUT__ PTR_IAL_SERIAL_RECEIVE_STATISTICS PtrStatistics)
+{
+
+    if ((PtrSerial == NULL) || (PtrSerial->PtrSerialBuffer == NULL) || (PtrStatistics == NULL))
+    {
+        return (SCRUTINY_STATUS_FAILED);
     }
 
     wsbiLockBuffer (PtrSerial->PtrSerialBuffer);
-    wsbiAddData (PtrSerial->PtrSerialBuffer, data, numRead);
+
+    spRollReceiveStatistics (&PtrSerial->PtrSerialBuffer->ReceiveStatistics, sosiGetMicroSeconds());
+
+    memcpy (PtrStatistics, &PtrSerial->PtrSerialBuffer->ReceiveStatistics, sizeof (IAL_SERIAL_RECEIVE_STATISTICS));
+
     wsbiUnlockBuffer (PtrSerial->PtrSerialBuffer);
 
     return (SCRUTINY_STATUS_SUCCESS);
@@ -377,6 +616,133 @@ SCRUTINY_STATUS spiReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __
     return (wsbiGetData (PtrSerial->PtrSerialBuffer, PtrData, PtrReadSize, MaxSize));
 }
 
+/**
+ *
+ * @name    spiPeekData()
+ *
+ * @param   PtrSerial           Serial port handle for the native system call.
+ *
+ * @param   PtrPtrData          Returns the pointer to the unread data inside the receive ring.
+ *
+ * @param   PtrSize             Returns the number of contiguous bytes at PtrPtrData.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS when success and
+ *                              SCRUTINY_STATUS_FAILED on failure.
+ *
+ * @brief   Gives the parser direct access to the received data without copying.
+ *          Does not wait for data. Release the bytes with spiConsumeData().
+ *
+ */
+
+SCRUTINY_STATUS spiPeekData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __OUT__ U8** PtrPtrData, __OUT__ U32* PtrSize)
+{
+    return (wsbiPeekData (PtrSerial->PtrSerialBuffer, PtrPtrData, PtrSize));
+}
+
+/**
+ *
+ * @name    spiConsumeData()
+ *
+ * @param   PtrSerial           Serial port handle for the native system call.
+ *
+ * @param   Size                Number of bytes the parser is done with.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS when success and
+ *                              SCRUTINY_STATUS_FAILED on failure.
+ *
+ * @brief   Releases bytes returned by spiPeekData() back to the receive ring.
+ *
+ */
+
+SCRUTINY_STATUS spiConsumeData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __IN__ U32 Size)
+{
+    return (wsbiConsumeData (PtrSerial->PtrSerialBuffer, Size));
+}
+
+/**
+ *
+ * @name    spiWaitData()
+ *
+ * @param   PtrSerial               Serial port handle for the native system call.
+ *
+ * @param   MinimumSize             Number of unread bytes to wait for.
+ *
+ * @param   TimeoutMicroSeconds     Longest time to wait for them.
+ *
+ * @param   PtrAvailable            Unread bytes in the receive ring on return.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS when MinimumSize bytes
+ *                              arrived and SCRUTINY_STATUS_FAILED otherwise.
+ *
+ * @brief   Sleeps until the receive thread has stored at least MinimumSize
+ *          bytes or the timeout expires. Nothing is consumed, the data is
+ *          read with spiReadData() or spiPeekData() afterwards.
+ *
+ */
+
+SCRUTINY_STATUS spiWaitData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __IN__ U32 MinimumSize, __IN__ U32 TimeoutMicroSeconds, __OUT__ U32* PtrAvailable)
+{
+
+    U32 available;
+
+    available = wsbiWaitData (PtrSerial->PtrSerialBuffer, MinimumSize, TimeoutMicroSeconds);
+
+    if (PtrAvailable)
+    {
+        *PtrAvailable = available;
+    }
+
+    if (available < MinimumSize)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @name    spiGetBitsPerSecond()
+ *
+ * @param   PtrSerial           Serial port handle for the native system call.
+ *
+ * @return  U32                 Line speed of the opened port, 0 when unknown.
+ *
+ * @brief   Used to size response deadlines from the time the bytes need on the
+ *          wire.
+ *
+ */
+
+U32 spiGetBitsPerSecond (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial)
+{
+
+    switch (PtrSerial->SerialConfig.BaudRate)
+    {
+
+        case SCRUTINY_BAUD_RATE_230400: return (230400);
+        case SCRUTINY_BAUD_RATE_115200: return (115200);
+        case SCRUTINY_BAUD_RATE_57600:  return (57600);
+        case SCRUTINY_BAUD_RATE_38400:  return (38400);
+        case SCRUTINY_BAUD_RATE_19200:  return (19200);
+        case SCRUTINY_BAUD_RATE_14400:  return (14400);
+        case SCRUTINY_BAUD_RATE_9600:   return (9600);
+        case SCRUTINY_BAUD_RATE_4800:   return (4800);
+        case SCRUTINY_BAUD_RATE_2400:   return (2400);
+        case SCRUTINY_BAUD_RATE_1200:   return (1200);
+        case SCRUTINY_BAUD_RATE_600:    return (600);
+        case SCRUTINY_BAUD_RATE_300:    return (300);
+        case SCRUTINY_BAUD_RATE_110:    return (110);
+
+        default:
+        {
+            return (0);
+        }
+
+    }
+
+}
+
 /**
  *
  * @name    spiWriteData()
@@ -60,18 +60,69 @@
  *
  */
 
+/**
+ *
+ * @brief
+ *
+ * Receive thread accounting. Totals are running counters, the per second
+ * values are those of the last completed one second window.
+ *
+ */
+
+typedef struct __IAL_SERIAL_RECEIVE_STATISTICS
+{
+
+    U32                 BytesReceived;          /** Bytes read from the port since it was opened */
+    U32                 Wakeups;                /** Number of times the receive thread woke up */
+
+    U32                 BytesPerSecond;         /** Bytes received in the last window */
+    U32                 WakeupsPerSecond;       /** Wakeups in the last window */
+
+    U32                 WindowStart;            /** Start of the current window in micro seconds */
+    U32                 WindowBytes;            /** Bytes received in the current window */
+    U32                 WindowWakeups;          /** Wakeups in the current window */
+
+} IAL_SERIAL_RECEIVE_STATISTICS, *PTR_IAL_SERIAL_RECEIVE_STATISTICS;
+
 typedef struct __IAL_SERIAL_BUFFER
 {
 
-    U8*                 PtrBuffer;              /** Buffer data where the Serial read will be stored into. */
+    U8*                 PtrBuffer;              /** Ring storage of SERIAL_RING_BUFFER_SIZE bytes where the Serial read will be stored into. */
 
     sem_t               CriticalSectionHandle;  /** Critial section to lock the buffer when there is a change. */
 
-    volatile U32        CurrentPosition;        /** Current position of the buffer. */
-    volatile U32        BytesUnRead;            /** How many number of bytes which are not read */
+    /*
+     * Single producer (receive thread) / single consumer ring. Both indexes are free running,
+     * the producer only moves Head and the consumer only moves Tail, so no lock is needed.
+     */
+
+    volatile U32        Head;                   /** Total bytes written into the ring */
+    volatile U32        Tail;                   /** Total bytes consumed from the ring */
+
+    volatile U32        OverflowBytes;          /** Bytes dropped because the ring was full */
+    volatile U32        OverflowCount;          /** Number of appends which dropped data */
+
+    IAL_SERIAL_RECEIVE_STATISTICS   ReceiveStatistics;  /** Guarded by CriticalSectionHandle */
+
+    /*
+     * The receive thread broadcasts Arrival after every drain of the port so a
+     * consumer waiting for a response wakes up as soon as its bytes are in.
+     */
+
+    pthread_mutex_t     ArrivalLock;            /** Protects the Arrival condition */
+    pthread_cond_t      Arrival;                /** Signaled whenever Head has moved */
 
 } IAL_SERIAL_BUFFER, *PTR_IAL_SERIAL_BUFFER;
 
+/* Capacity of the receive ring, must be a power of two */
+#define SERIAL_RING_BUFFER_SIZE             (1024 * 1024)
+
+/* Chunk size the receive thread drains the port with */
+#define SERIAL_RECEIVE_CHUNK_SIZE           (4 * 1024)
+
+/* Window for the per second receive statistics */
+#define SERIAL_RECEIVE_STATISTICS_WINDOW_US (1000 * 1000)
+
 
 typedef struct __IAL_SERIAL_HANDLE
 {
@@ -81,10 +132,16 @@ typedef struct __IAL_SERIAL_HANDLE
 
     pthread_t ReadThread;       /** Thread handle for the Reading serial port. */
 
+    int WakeupHandle[2];        /** Pipe used to wake the read thread up for shutdown, [0] read end, [1] write end */
+
     SCRUTINY_IAL_SERIAL_CONFIG SerialConfig; /** Common Scrutiny OSAL specific Serial configuration */
 
     PTR_IAL_SERIAL_BUFFER PtrSerialBuffer;  /** Buffer handle */
 
+    U32 SdbLastBinaryAddress;   /** Last dword the SDB layer read on this port, 'n' continues from it */
+    U8 SdbReadTrailer;          /** Byte which ended the last complete SDB read response */
+    BOOLEAN SdbReadTrailerValid;/** SdbReadTrailer has been learnt on this port */
+
 }SCRUTINY_IAL_SERIAL_HANDLE, *PTR_SCRUTINY_IAL_SERIAL_HANDLE;
 
 
@@ -92,8 +149,16 @@ SCRUTINY_STATUS spiOpenPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_CONFIG PtrConfig, __
 SCRUTINY_STATUS spiClosePort (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialParams);
 SCRUTINY_STATUS spiReadData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialParams, __OUT__ U8 *PtrData, __OUT__ U32* PtrReadSize, __IN__ U32 MaxSize);
 SCRUTINY_STATUS spiWriteData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialParams, __IN__ U8 *PtrData, __IN__ U32 Size, __OUT__ U32 *PtrWritten);
+SCRUTINY_STATUS spiPeekData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __OUT__ U8** PtrPtrData, __OUT__ U32* PtrSize);
+
+SCRUTINY_STATUS spiConsumeData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __IN__ U32 Size);
+
+SCRUTINY_STATUS spiWaitData (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __IN__ U32 MinimumSize, __IN__ U32 TimeoutMicroSeconds, __OUT__ U32* PtrAvailable);
+U32 spiGetBitsPerSecond (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial);
+
 SCRUTINY_STATUS spiFlushPort (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialParams);
 SCRUTINY_STATUS spiCreateJsonSerial (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrHandle);
+SCRUTINY_STATUS spiGetReceiveStatistics (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial, __OUT__ PTR_IAL_SERIAL_RECEIVE_STATISTICS PtrStatistics);
 
 #endif /* __LINUX_SERIAL__H__ */
 
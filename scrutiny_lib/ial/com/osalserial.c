@@ -42,7 +42,8 @@
  *
  * @return  SCRUTINY_STATUS_SUCCESS - On success
  *
- * @brief   Critical section and the serial buffer will be initialized.
+ * @brief   Critical section and the serial buffer will be initialized. The ring
+ *          storage is allocated once here and reused for the life of the port.
  *
  */
 
@@ -52,12 +53,64 @@ SCRUTINY_STATUS wsbiInitializeBuffers (__OUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
     #if defined (OS_WINDOWS)
         InitializeCriticalSection (&PtrBuffer->CriticalSectionHandle);
     #elif defined (OS_LINUX)
+
+        pthread_condattr_t attributes;
+
         sem_init (&PtrBuffer->CriticalSectionHandle, 0, 1);
+
+        /* Response deadlines must not move with the wall clock */
+        pthread_condattr_init (&attributes);
+        pthread_condattr_setclock (&attributes, CLOCK_MONOTONIC);
+
+        pthread_mutex_init (&PtrBuffer->ArrivalLock, NULL);
+        pthread_cond_init (&PtrBuffer->Arrival, &attributes);
+
+        pthread_condattr_destroy (&attributes);
+
     #endif
 
-    PtrBuffer->CurrentPosition   = 0;
-    PtrBuffer->BytesUnRead       = 0;
-    PtrBuffer->PtrBuffer         = NULL;
+    PtrBuffer->Head              = 0;
+    PtrBuffer->Tail              = 0;
+    PtrBuffer->OverflowBytes     = 0;
+    PtrBuffer->OverflowCount     = 0;
+
+    PtrBuffer->PtrBuffer         = (PU8) sosiMemAlloc (SERIAL_RING_BUFFER_SIZE);
+
+    if (PtrBuffer->PtrBuffer == NULL)
+    {
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @name    wsbiFreeBuffers()
+ *
+ * @param   PtrBuffer       The serial buffer handle which needs to be
+ *                          released.
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS - On success
+ *
+ * @brief   Releases the ring storage. The receive thread must have stopped.
+ *
+ */
+
+SCRUTINY_STATUS wsbiFreeBuffers (__INOUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+{
+
+    sosiMemFree (PtrBuffer->PtrBuffer);
+
+    PtrBuffer->PtrBuffer = NULL;
+    PtrBuffer->Head      = 0;
+    PtrBuffer->Tail      = 0;
+
+    #if defined (OS_LINUX)
+        pthread_cond_destroy (&PtrBuffer->Arrival);
+        pthread_mutex_destroy (&PtrBuffer->ArrivalLock);
+    #endif
 
     return (SCRUTINY_STATUS_SUCCESS);
 
@@ -95,7 +148,9 @@ SCRUTINY_STATUS wsbiAddDataByte (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__
  *
  * @return  SCRUTINY_STATUS_SUCCESS - On success
  *
- * @brief   The read serial data will be stored into the Serial Buffer.
+ * @brief   The read serial data will be stored into the Serial Buffer. Must be
+ *          called from the single producer only. Data which does not fit into
+ *          the ring is dropped and counted in OverflowBytes.
  *
  *
  */
@@ -103,100 +158,322 @@ SCRUTINY_STATUS wsbiAddDataByte (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__
 SCRUTINY_STATUS wsbiAddData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U8 *PtrData, __IN__ U32 Size)
 {
 
-    U32 size = 0;
+    U32 head;
+    U32 space;
+    U32 offset;
+    U32 first;
+
+    if (PtrBuffer->PtrBuffer == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
 
-    PU8 ptrResult = NULL;
+    head = PtrBuffer->Head;
 
-    size = PtrBuffer->BytesUnRead + Size;
+    WSB_MEMORY_BARRIER();
 
-    ptrResult = (PU8) sosiMemAlloc (size);
+    space = SERIAL_RING_BUFFER_SIZE - (head - PtrBuffer->Tail);
 
-    if (PtrBuffer->PtrBuffer)
+    if (Size > space)
     {
-        sosiMemCopy (&ptrResult[0], PtrBuffer->PtrBuffer, PtrBuffer->BytesUnRead);
-        sosiMemCopy (&ptrResult[PtrBuffer->BytesUnRead], PtrData, Size);
-    }
+        PtrBuffer->OverflowBytes += (Size - space);
+        PtrBuffer->OverflowCount++;
 
-    else
-    {
-        sosiMemCopy (&ptrResult[0], PtrData, Size);
+        Size = space;
     }
 
-    if (PtrBuffer->PtrBuffer)
+    offset = head & (SERIAL_RING_BUFFER_SIZE - 1);
+    first = SERIAL_RING_BUFFER_SIZE - offset;
+
+    if (first > Size)
     {
-        sosiMemFree (PtrBuffer->PtrBuffer);
+        first = Size;
     }
 
-    PtrBuffer->PtrBuffer = ptrResult;
-    PtrBuffer->BytesUnRead += Size;
+    sosiMemCopy (&PtrBuffer->PtrBuffer[offset], PtrData, first);
+    sosiMemCopy (&PtrBuffer->PtrBuffer[0], &PtrData[first], Size - first);
+
+    /* Data has to be visible before the consumer sees the new head */
+    WSB_MEMORY_BARRIER();
+
+    PtrBuffer->Head = head + Size;
 
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
 
+/**
+ *
+ * @name    wsbiGetAvailable()
+ *
+ * @param   PtrBuffer       The buffer handle.
+ *
+ * @return  Number of bytes which are not consumed yet.
+ *
+ */
+
+U32 wsbiGetAvailable (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+{
+
+    U32 available;
+
+    available = PtrBuffer->Head - PtrBuffer->Tail;
+
+    WSB_MEMORY_BARRIER();
+
+    return (available);
+
+}
+
+/**
+ *
+ * @name    wsbiSignalArrival()
+ *
+ * @param   PtrBuffer       The buffer to which new data has been added.
+ *
+ * @brief   Wakes up the consumer if it is waiting in wsbiWaitData(). Called by
+ *          the producer once the new Head has been published.
+ *
+ */
+
+VOID wsbiSignalArrival (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+{
+
+    #if defined (OS_LINUX)
+
+        /*
+         * Taking the lock closes the window between the waiter checking the
+         * ring and going to sleep, otherwise the wakeup could be lost.
+         */
+
+        pthread_mutex_lock (&PtrBuffer->ArrivalLock);
+        pthread_cond_broadcast (&PtrBuffer->Arrival);
+        pthread_mutex_unlock (&PtrBuffer->ArrivalLock);
+
+    #endif
+
+}
 
 /**
  *
- * @name    wsbiFlush()
+ * @name    wsbiWaitData()
  *
- * @param   PtrBuffer       The buffer handle which needs the reset.
+ * @param   PtrBuffer               The buffer handle.
  *
- * @return  SCRUTINY_STATUS_SUCCESS - On success
+ * @param   MinimumSize             Number of unread bytes to wait for.
+ *
+ * @param   TimeoutMicroSeconds     Longest time to wait for them.
  *
- * @brief   The specified buffer will be freed and gets a reset.
+ * @return  Number of bytes which are not consumed yet. This is less than
+ *          MinimumSize when the timeout expired.
  *
+ * @brief   Blocks until at least MinimumSize bytes are in the ring or the
+ *          timeout expires. The receive thread wakes us up on every arrival,
+ *          so the call returns as soon as the data is in instead of after a
+ *          fixed sleep. Nothing is consumed.
  *
  */
 
-SCRUTINY_STATUS wsbiFlush (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+U32 wsbiWaitData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U32 MinimumSize, __IN__ U32 TimeoutMicroSeconds)
 {
-    /*
-     * Enter into critical section
-     */
 
-    wsbiLockBuffer (PtrBuffer);
+    U32 available;
 
-    wsbiClearAndReset (PtrBuffer);
+    #if defined (OS_LINUX)
 
-    /*
-     * Leave aside critical section
-     */
+        struct timespec deadline;
 
-    wsbiUnlockBuffer (PtrBuffer);
+        available = wsbiGetAvailable (PtrBuffer);
 
-    return (SCRUTINY_STATUS_SUCCESS);
+        if (available >= MinimumSize || TimeoutMicroSeconds == 0)
+        {
+            return (available);
+        }
+
+        clock_gettime (CLOCK_MONOTONIC, &deadline);
+
+        deadline.tv_sec += TimeoutMicroSeconds / 1000000;
+        deadline.tv_nsec += (long) (TimeoutMicroSeconds % 1000000) * 1000;
+
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        pthread_mutex_lock (&PtrBuffer->ArrivalLock);
+
+        while (TRUE)
+        {
+
+            available = wsbiGetAvailable (PtrBuffer);
+
+            if (available >= MinimumSize)
+            {
+                break;
+            }
+
+            if (pthread_cond_timedwait (&PtrBuffer->Arrival, &PtrBuffer->ArrivalLock, &deadline) == ETIMEDOUT)
+            {
+                available = wsbiGetAvailable (PtrBuffer);
+                break;
+            }
+
+        }
+
+        pthread_mutex_unlock (&PtrBuffer->ArrivalLock);
+
+    #else
+
+        U32 start = sosiGetMicroSeconds();
+        U32 slept = 0;
+
+        /* The time slept bounds the wait where there is no micro-second clock */
+        while (TRUE)
+        {
+
+            available = wsbiGetAvailable (PtrBuffer);
+
+            if (available >= MinimumSize || (sosiGetMicroSeconds() - start) >= TimeoutMicroSeconds || slept >= TimeoutMicroSeconds)
+            {
+                break;
+            }
+
+            sosiSleep (1);
+
+            slept += 1000;
+
+        }
+
+    #endif
+
+    return (available);
 
 }
 
 /**
  *
- * @name    wsbiClearAndReset()
+ * @name    wsbiPeekData()
  *
- * @param   PtrBuffer       The buffer handle which needs the reset.
+ * @param   PtrBuffer       The buffer handle.
+ *
+ * @param   PtrPtrData      Pointer into the ring where the unread data starts.
+ *
+ * @param   PtrSize         Number of contiguous unread bytes at PtrPtrData.
  *
  * @return  SCRUTINY_STATUS_SUCCESS - On success
  *
- * @brief   The specified buffer will be freed and gets a reset.
+ * @brief   Zero copy access for the consumer. The returned region stays valid
+ *          until it is released with wsbiConsumeData(). When the unread data
+ *          wraps around the end of the ring only the first part is returned,
+ *          peek again after consuming it to get the rest.
  *
+ */
+
+SCRUTINY_STATUS wsbiPeekData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8 **PtrPtrData, __OUT__ U32 *PtrSize)
+{
+
+    U32 available;
+    U32 offset;
+
+    *PtrPtrData = NULL;
+    *PtrSize = 0;
+
+    if (PtrBuffer->PtrBuffer == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    available = wsbiGetAvailable (PtrBuffer);
+
+    offset = PtrBuffer->Tail & (SERIAL_RING_BUFFER_SIZE - 1);
+
+    if (available > (SERIAL_RING_BUFFER_SIZE - offset))
+    {
+        available = SERIAL_RING_BUFFER_SIZE - offset;
+    }
+
+    *PtrPtrData = &PtrBuffer->PtrBuffer[offset];
+    *PtrSize = available;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @name    wsbiConsumeData()
+ *
+ * @param   PtrBuffer       The buffer handle.
+ *
+ * @param   Size            Number of bytes to release.
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS - On success
+ *
+ * @brief   Releases bytes of the ring to the producer. Must be called from
+ *          the single consumer only.
  *
  */
 
-SCRUTINY_STATUS wsbiClearAndReset (__INOUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+SCRUTINY_STATUS wsbiConsumeData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U32 Size)
 {
 
-    if (PtrBuffer->PtrBuffer)
+    U32 available;
+
+    available = wsbiGetAvailable (PtrBuffer);
+
+    if (Size > available)
     {
-        sosiMemFree (PtrBuffer->PtrBuffer);
-        PtrBuffer->PtrBuffer = NULL;
+        Size = available;
     }
 
-    PtrBuffer->BytesUnRead      = 0;
-    PtrBuffer->CurrentPosition  = 0;
+    /* We are done reading the data before the producer may overwrite it */
+    WSB_MEMORY_BARRIER();
+
+    PtrBuffer->Tail += Size;
 
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
 
+
+/**
+ *
+ * @name    wsbiFlush()
+ *
+ * @param   PtrBuffer       The buffer handle which needs the reset.
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS - On success
+ *
+ * @brief   Everything received so far is discarded.
+ *
+ *
+ */
+
+SCRUTINY_STATUS wsbiFlush (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+{
+    return (wsbiClearAndReset (PtrBuffer));
+}
+
+/**
+ *
+ * @name    wsbiClearAndReset()
+ *
+ * @param   PtrBuffer       The buffer handle which needs the reset.
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS - On success
+ *
+ * @brief   Consumes all the unread data. Only the consumer side index is
+ *          moved, so this is safe against a running receive thread.
+ *
+ *
+ */
+
+SCRUTINY_STATUS wsbiClearAndReset (__INOUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer)
+{
+    return (wsbiConsumeData (PtrBuffer, wsbiGetAvailable (PtrBuffer)));
+}
+
 /**
  *
  * @name    wsbiGetData()
@@ -231,20 +508,24 @@ SCRUTINY_STATUS wsbiGetData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8
 {
 
     U32 size = 0;
-    PU8 ptrResult;
+    U32 chunk = 0;
+    PU8 ptrChunk;
     volatile U32 retryCount = 0;
     volatile U32 lastDataCount = 0;
+    U32 available = 0;
 
     /* Hold and wait here */
     do
     {
 
-        if (PtrBuffer->BytesUnRead >= MaxSize)
+        available = wsbiGetAvailable (PtrBuffer);
+
+        if (available >= MaxSize)
         {
             break;
         }
 
-        if (lastDataCount == PtrBuffer->BytesUnRead)
+        if (lastDataCount == available)
         {
             retryCount++;
         }
@@ -252,7 +533,7 @@ SCRUTINY_STATUS wsbiGetData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8
         else
         {
             retryCount = 0;
-            lastDataCount = PtrBuffer->BytesUnRead;
+            lastDataCount = available;
         }
 
         #if defined (OS_WINDOWS)
@@ -264,41 +545,31 @@ SCRUTINY_STATUS wsbiGetData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8
 
     } while (retryCount < MAX_READ_CYCLES_FOR_GET_DATA);
 
-    wsbiLockBuffer (PtrBuffer);
-
-    size = PtrBuffer->BytesUnRead > MaxSize ? MaxSize : PtrBuffer->BytesUnRead;
-
-    sosiMemCopy (PtrData, PtrBuffer->PtrBuffer, size);
+    /* Copy out at most two contiguous regions, the second one after a wrap of the ring */
+    while (size < MaxSize)
+    {
 
-    *PtrSize = size;
+        wsbiPeekData (PtrBuffer, &ptrChunk, &chunk);
 
-    if (size < PtrBuffer->BytesUnRead)
-    {
-        ptrResult = (PU8) sosiMemAlloc (PtrBuffer->BytesUnRead - size);
-        sosiMemCopy (ptrResult, &PtrBuffer->PtrBuffer[size], PtrBuffer->BytesUnRead - size);
+        if (chunk == 0)
+        {
+            break;
+        }
 
-        sosiMemFree (PtrBuffer->PtrBuffer);
+        if (chunk > (MaxSize - size))
+        {
+            chunk = MaxSize - size;
+        }
 
-        PtrBuffer->PtrBuffer = ptrResult;
-        PtrBuffer->BytesUnRead = PtrBuffer->BytesUnRead - size;
+        sosiMemCopy (&PtrData[size], ptrChunk, chunk);
 
-    }
+        wsbiConsumeData (PtrBuffer, chunk);
 
-    else if (size > PtrBuffer->BytesUnRead)
-    {
-        /* Something wrong, we got request more than the size */
-    }
+        size += chunk;
 
-    else
-    {
-        wsbiClearAndReset (PtrBuffer);
     }
 
-    /*
-     * Set the size and buffer
-     */
-
-    wsbiUnlockBuffer (PtrBuffer);
+    *PtrSize = size;
 
     return (SCRUTINY_STATUS_SUCCESS);
 
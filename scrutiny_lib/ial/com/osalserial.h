@@ -59,6 +59,20 @@
 
 #define MAX_SERIAL_PORTS   (255)
 
+/**
+ *
+ * @brief
+ *
+ * Barrier between the ring data and the ring index updates.
+ *
+ */
+
+#if defined (OS_WINDOWS)
+#define WSB_MEMORY_BARRIER()    MemoryBarrier()
+#else
+#define WSB_MEMORY_BARRIER()    __sync_synchronize()
+#endif
+
 
 SCRUTINY_STATUS wsbiAddDataByte (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U8 Data);
 SCRUTINY_STATUS wsbiInitializeBuffers (__OUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
@@ -68,6 +82,12 @@ SCRUTINY_STATUS wsbiGetData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8
 SCRUTINY_STATUS wsbiClearAndReset (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
 SCRUTINY_STATUS wsbiFlush (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
 SCRUTINY_STATUS wsbiAddData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U8 *PtrData, __IN__ U32 Size);
+SCRUTINY_STATUS wsbiFreeBuffers (__INOUT__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
+U32 wsbiGetAvailable (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
+SCRUTINY_STATUS wsbiPeekData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __OUT__ U8 **PtrPtrData, __OUT__ U32 *PtrSize);
+SCRUTINY_STATUS wsbiConsumeData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U32 Size);
+VOID wsbiSignalArrival (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer);
+U32 wsbiWaitData (__IN__ PTR_IAL_SERIAL_BUFFER PtrBuffer, __IN__ U32 MinimumSize, __IN__ U32 TimeoutMicroSeconds);
 
 
 #endif /* __OSAL_SERIAL__H__ */
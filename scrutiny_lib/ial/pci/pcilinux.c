@@ -34,6 +34,7 @@
 #include "pcilinux.h"
 
 static int mSliffDriverHandle;
+static BOOLEAN mSliffBatchUnsupported = FALSE;
 
 
 SCRUTINY_STATUS dciLoadSliffDriver()
@@ -116,7 +117,8 @@ SCRUTINY_STATUS pcsiWriteDword (__IN__ SCRUTINY_PCI_ADDRESS PciLocation,  U32 Of
 
     scrutinyLocation.Bus = PciLocation.BusNumber;
     scrutinyLocation.Device = PciLocation.DeviceNumber;
-    scrutinyLocation.Domain = 0; //PciLocation.SegmentNumber; //as of now we support only domain Zero
+    scrutinyLocation.Slot = PciLocation.DeviceNumber;
+    scrutinyLocation.Domain = (U8) PciLocation.SegmentNumber;
     scrutinyLocation.Function = PciLocation.FunctionNumber;
 
     scrutinyLocation.Offset = Offset;
@@ -145,17 +147,13 @@ SCRUTINY_STATUS pcsiReadDword (SCRUTINY_PCI_ADDRESS PciLocation,  U32 Offset, U3
 
     scrutinyLocation.Bus = PciLocation.BusNumber;
     scrutinyLocation.Device = PciLocation.DeviceNumber;
-    scrutinyLocation.Domain = 0; //PciLocation.SegmentNumber; //as of now we support only domain Zero
+    scrutinyLocation.Slot = PciLocation.DeviceNumber;
+    scrutinyLocation.Domain = (U8) PciLocation.SegmentNumber;
     scrutinyLocation.Function = PciLocation.FunctionNumber;
 
     scrutinyLocation.Offset = Offset;
 
-    ioctlStatus = ioctl (mSliffDriverHandle, SCRUTINY_DRIVER_IOCTL_DISCOVER_PCI, &scrutinyLocation);
-
-    if (ioctlStatus < 0)
-    {
-
-    }
+    /* The driver resolves the device as part of the read, no separate discover is needed */
 
     ioctlStatus = ioctl (mSliffDriverHandle, SCRUTINY_DRIVER_IOCTL_READ_PCI, &scrutinyLocation);
 
@@ -173,4 +171,376 @@ SCRUTINY_STATUS pcsiReadDword (SCRUTINY_PCI_ADDRESS PciLocation,  U32 Offset, U3
 
 }
 
+/**
+ *
+ *  @method  pcsiBatchConfigAccess()
+ *
+ *  @param   PciLocation        PCI location of the device
+ *
+ *  @param   PtrOperations      Read/write operations, read data and per operation
+ *                              status are returned in place
+ *
+ *  @param   Count              Number of operations
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Perform a list of configuration space accesses with a single ioctl.
+ *           Falls back to one ioctl per DWORD when the batch request fails for
+ *           another reason than a missing device, and stops trying the batch
+ *           request once the loaded driver reports it does not know it.
+ *
+ */
+
+SCRUTINY_STATUS pcsiBatchConfigAccess (__IN__ SCRUTINY_PCI_ADDRESS PciLocation, __INOUT__ PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION PtrOperations, __IN__ U32 Count)
+{
+
+    int ioctlStatus = 0;
+    U32 index;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+    SCRUTINY_STATUS dwordStatus;
+
+    SCRUTINY_DRIVER_PCI_CFG_BATCH   batch;
+
+    if ((PtrOperations == NULL) || (Count == 0) || (Count > SCRUTINY_DRIVER_PCI_BATCH_MAX_OPERATIONS))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    if (!mSliffBatchUnsupported)
+    {
+        sosiMemSet (&batch, 0, sizeof (SCRUTINY_DRIVER_PCI_CFG_BATCH));
+
+        batch.Bus = PciLocation.BusNumber;
+        batch.Device = PciLocation.DeviceNumber;
+        batch.Slot = PciLocation.DeviceNumber;
+        batch.Domain = (U8) PciLocation.SegmentNumber;
+        batch.Function = PciLocation.FunctionNumber;
+
+        batch.Count = Count;
+        batch.PtrOperations = (unsigned long long) (unsigned long) PtrOperations;
+
+        ioctlStatus = ioctl (mSliffDriverHandle, SCRUTINY_DRIVER_IOCTL_BATCH_PCI, &batch);
+
+        if (ioctlStatus == 0)
+        {
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        if (errno == ENODEV)
+        {
+            /* The device is gone, single DWORD accesses would not find it either */
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        if ((errno != EFAULT) && (errno != ENOMEM))
+        {
+            /*
+             * Older driver without the batch request, don't try again. Released
+             * drivers fail unknown requests with -1 which arrives as EPERM, so
+             * anything but a transient failure means the request is missing.
+             */
+            gPtrLoggerGeneric->logiDebug ("SliffDriver batch request not available (errno=%d), using single DWORD access.", errno);
+
+            mSliffBatchUnsupported = TRUE;
+        }
+    }
+
+    for (index = 0; index < Count; index++)
+    {
+        if (PtrOperations[index].Operation == SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE)
+        {
+            dwordStatus = pcsiWriteDword (PciLocation, PtrOperations[index].Offset, PtrOperations[index].Data);
+
+            PtrOperations[index].Status = (dwordStatus == SCRUTINY_STATUS_SUCCESS) ? 0 : -1;
+        }
+
+        else
+        {
+            dwordStatus = pcsiReadDword (PciLocation, PtrOperations[index].Offset, &PtrOperations[index].Data);
+
+            PtrOperations[index].Status = ((dwordStatus == SCRUTINY_STATUS_SUCCESS) && (PtrOperations[index].Data != 0xFFFFFFFF)) ? 0 : -1;
+        }
+
+        if ((dwordStatus != SCRUTINY_STATUS_SUCCESS) && (status == SCRUTINY_STATUS_SUCCESS))
+        {
+            status = dwordStatus;
+        }
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ *  @method  pcsiReadConfigSpace()
+ *
+ *  @param   PciLocation        PCI location of the device
+ *
+ *  @param   Offset             DWORD aligned offset of the first register
+ *
+ *  @param   PtrDwords          Buffer for Count DWORDs
+ *
+ *  @param   Count              Number of consecutive DWORDs to read
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Snapshot a range of the configuration space with one ioctl.
+ *           Registers which can't be read are returned as 0xFFFFFFFF.
+ *
+ */
+
+SCRUTINY_STATUS pcsiReadConfigSpace (__IN__ SCRUTINY_PCI_ADDRESS PciLocation, __IN__ U32 Offset, __OUT__ PU32 PtrDwords, __IN__ U32 Count)
+{
+
+    U32 index;
+    SCRUTINY_STATUS status;
+    PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION ptrOperations;
+
+    if ((PtrDwords == NULL) || (Offset & 0x3))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    ptrOperations = (PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION) sosiMemAlloc (Count * sizeof (SCRUTINY_DRIVER_PCI_CFG_OPERATION));
+
+    if (ptrOperations == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    for (index = 0; index < Count; index++)
+    {
+        ptrOperations[index].Offset = (U16) (Offset + (index * sizeof (U32)));
+        ptrOperations[index].Operation = SCRUTINY_DRIVER_PCI_BATCH_OPERATION_READ;
+    }
+
+    status = pcsiBatchConfigAccess (PciLocation, ptrOperations, Count);
+
+    for (index = 0; (index < Count) && (status == SCRUTINY_STATUS_SUCCESS); index++)
+    {
+        PtrDwords[index] = (ptrOperations[index].Status == 0) ? ptrOperations[index].Data : 0xFFFFFFFF;
+    }
+
+    sosiMemFree (ptrOperations);
+
+    return (status);
+
+}
+
+/**
+ *
+ *  @method  pcsReadSysfsAttribute()
+ *
+ *  @param   PtrDeviceName      sysfs name of the device (dddd:bb:dd.f)
+ *
+ *  @param   PtrAttribute       Attribute file to read
+ *
+ *  @param   PtrValue           Hex value of the attribute
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Read a hex attribute (vendor, device, ...) of a PCI function from
+ *           sysfs without touching its configuration space.
+ *
+ */
+
+static SCRUTINY_STATUS pcsReadSysfsAttribute (__IN__ const char *PtrDeviceName, __IN__ const char *PtrAttribute, __OUT__ PU32 PtrValue)
+{
 
+    char    path[256];
+    FILE    *ptrFile;
+    U32     value = 0;
+    int     fields;
+
+    snprintf (path, sizeof (path), "%s/%s/%s", SCRUTINY_PCI_SYSFS_DEVICES_PATH, PtrDeviceName, PtrAttribute);
+
+    ptrFile = fopen (path, "r");
+
+    if (ptrFile == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    fields = fscanf (ptrFile, "%x", &value);
+
+    fclose (ptrFile);
+
+    if (fields != 1)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    *PtrValue = value;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  pcsComparePciAddress()
+ *
+ *  @param   PtrFirst           First PCI location
+ *
+ *  @param   PtrSecond          Second PCI location
+ *
+ *  @return  int                < 0, 0 or > 0 as for qsort
+ *
+ *  @brief   Order PCI locations by segment, bus, device and function so the
+ *           discovery order does not depend on the directory order.
+ *
+ */
+
+static int pcsComparePciAddress (__IN__ const void *PtrFirst, __IN__ const void *PtrSecond)
+{
+
+    const SCRUTINY_PCI_ADDRESS *ptrFirst = (const SCRUTINY_PCI_ADDRESS *) PtrFirst;
+    const SCRUTINY_PCI_ADDRESS *ptrSecond = (const SCRUTINY_PCI_ADDRESS *) PtrSecond;
+
+    if (ptrFirst->SegmentNumber != ptrSecond->SegmentNumber)
+    {
+        return (ptrFirst->SegmentNumber < ptrSecond->SegmentNumber ? -1 : 1);
+    }
+
+    if (ptrFirst->BusNumber != ptrSecond->BusNumber)
+    {
+        return ((int) ptrFirst->BusNumber - (int) ptrSecond->BusNumber);
+    }
+
+    if (ptrFirst->DeviceNumber != ptrSecond->DeviceNumber)
+    {
+        return ((int) ptrFirst->DeviceNumber - (int) ptrSecond->DeviceNumber);
+    }
+
+    return ((int) ptrFirst->FunctionNumber - (int) ptrSecond->FunctionNumber);
+
+}
+
+/**
+ *
+ *  @method  pcsiEnumerateVendorDevices()
+ *
+ *  @param   VendorId           PCI vendor id to look for
+ *
+ *  @param   PtrDeviceIds       PCI device ids to keep, NULL keeps every device id
+ *
+ *  @param   DeviceIdCount      Number of entries in PtrDeviceIds
+ *
+ *  @param   PtrLocations       Array receiving the matching PCI locations
+ *
+ *  @param   MaxLocations       Number of entries in PtrLocations
+ *
+ *  @param   PtrCount           Number of matching functions found
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Walk the kernel's PCI device list in sysfs and collect every
+ *           function (on every segment, device and function number) with the
+ *           given vendor id and one of the given device ids. Only the sysfs
+ *           vendor and device attributes are read, the configuration space of
+ *           non matching functions is never opened.
+ *           Fails when sysfs is not available so the caller can fall back to
+ *           probing the buses through the driver.
+ *
+ */
+
+SCRUTINY_STATUS pcsiEnumerateVendorDevices (__IN__ U16 VendorId, __IN__ const U16 *PtrDeviceIds, __IN__ U32 DeviceIdCount, __OUT__ PTR_SCRUTINY_PCI_ADDRESS PtrLocations, __IN__ U32 MaxLocations, __OUT__ PU32 PtrCount)
+{
+
+    DIR             *dirp;
+    struct dirent   *d;
+    U32             count = 0;
+    U32             vendor;
+    U32             deviceId;
+    U32             index;
+    U32             domain, bus, device, function;
+
+    gPtrLoggerGeneric->logiFunctionEntry ("pcsiEnumerateVendorDevices (VendorId=%x, MaxLocations=%x)", VendorId, MaxLocations);
+
+    *PtrCount = 0;
+
+    if ((dirp = opendir (SCRUTINY_PCI_SYSFS_DEVICES_PATH)) == NULL)
+    {
+        gPtrLoggerGeneric->logiFunctionExit ("pcsiEnumerateVendorDevices (status=%x)", SCRUTINY_STATUS_FAILED);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    while ((d = readdir (dirp)) != NULL)
+    {
+
+        /* Entries are named Domain:Bus:Device.Function, e.g. 0000:04:00.0 */
+        if (sscanf (d->d_name, "%x:%x:%x.%x", &domain, &bus, &device, &function) != 4)
+        {
+            continue;
+        }
+
+        if (pcsReadSysfsAttribute (d->d_name, "vendor", &vendor) != SCRUTINY_STATUS_SUCCESS)
+        {
+            continue;
+        }
+
+        if (vendor != VendorId)
+        {
+            continue;
+        }
+
+        if (PtrDeviceIds != NULL)
+        {
+            if (pcsReadSysfsAttribute (d->d_name, "device", &deviceId) != SCRUTINY_STATUS_SUCCESS)
+            {
+                continue;
+            }
+
+            for (index = 0; index < DeviceIdCount; index++)
+            {
+                if (PtrDeviceIds[index] == deviceId)
+                {
+                    break;
+                }
+            }
+
+            if (index == DeviceIdCount)
+            {
+                continue;
+            }
+        }
+
+        if (domain > 0xFF)
+        {
+            /* The driver interface carries an 8 bit domain */
+            gPtrLoggerGeneric->logiDebug ("Skipping %s, PCI segment is out of range for the driver.", d->d_name);
+
+            continue;
+        }
+
+        if (count >= MaxLocations)
+        {
+            gPtrLoggerGeneric->logiDebug ("Skipping %s, device list is full.", d->d_name);
+
+            continue;
+        }
+
+        sosiMemSet (&PtrLocations[count], 0, sizeof (SCRUTINY_PCI_ADDRESS));
+
+        PtrLocations[count].SegmentNumber = domain;
+        PtrLocations[count].BusNumber = (U16) bus;
+        PtrLocations[count].DeviceNumber = (U16) device;
+        PtrLocations[count].FunctionNumber = (U16) function;
+
+        count++;
+
+    }
+
+    closedir (dirp);
+
+    qsort (PtrLocations, count, sizeof (SCRUTINY_PCI_ADDRESS), pcsComparePciAddress);
+
+    *PtrCount = count;
+
+    gPtrLoggerGeneric->logiFunctionExit ("pcsiEnumerateVendorDevices (Count=%x)", count);
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
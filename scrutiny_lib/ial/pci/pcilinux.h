@@ -61,13 +61,55 @@ typedef struct __SCRUTINY_DRIVER_PCI_CFG_SPACE
 
 } SCRUTINY_DRIVER_PCI_CFG_SPACE, *PTR_SCRUTINY_DRIVER_PCI_CFG_SPACE;
 
+/*
+ * Vectored configuration space access, see SCRUTINY_DRIVER_IOCTL_BATCH_PCI
+ */
+#define SCRUTINY_DRIVER_PCI_BATCH_MAX_OPERATIONS        (1024)
+
+#define SCRUTINY_DRIVER_PCI_BATCH_OPERATION_READ        (0)
+#define SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE       (1)
+
+typedef struct __SCRUTINY_DRIVER_PCI_CFG_OPERATION
+{
+    U16      Offset;
+    U8       Operation;
+    S8       Status;
+
+    U32      Data;
+
+} SCRUTINY_DRIVER_PCI_CFG_OPERATION, *PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION;
+
+typedef struct __SCRUTINY_DRIVER_PCI_CFG_BATCH
+{
+    U8       Domain;
+    U8       Bus;
+    U8       Device;
+    U8       Function;
+    U8       Slot;
+    U8       Reserved;
+    U16      Reserved1;
+
+    U32      Count;
+    U32      Reserved2;
+
+    unsigned long long  PtrOperations;
+
+} SCRUTINY_DRIVER_PCI_CFG_BATCH, *PTR_SCRUTINY_DRIVER_PCI_CFG_BATCH;
+
 #define SCRUTINY_DRIVER_IOCTL_DISCOVER_PCI              0x1000
 #define SCRUTINY_DRIVER_IOCTL_READ_PCI                  0x1001
 #define SCRUTINY_DRIVER_IOCTL_WRITE_PCI                 0x1002
 #define SCRUTINY_DRIVER_IOCTL_ENABLE_PCI                0x1003
 #define SCRUTINY_DRIVER_IOCTL_ALLOCATE_MEMORY           0x1004
 #define SCRUTINY_DRIVER_IOCTL_FREE_MEMORY               0x1005
+#define SCRUTINY_DRIVER_IOCTL_BATCH_PCI                 0x1006
+
+#define SCRUTINY_PCI_SYSFS_DEVICES_PATH                 "/sys/bus/pci/devices"
+#define SCRUTINY_PCI_MAX_ENUMERATED_DEVICES             (256)
 
+SCRUTINY_STATUS pcsiBatchConfigAccess (__IN__ SCRUTINY_PCI_ADDRESS PciLocation, __INOUT__ PTR_SCRUTINY_DRIVER_PCI_CFG_OPERATION PtrOperations, __IN__ U32 Count);
+SCRUTINY_STATUS pcsiReadConfigSpace (__IN__ SCRUTINY_PCI_ADDRESS PciLocation, __IN__ U32 Offset, __OUT__ PU32 PtrDwords, __IN__ U32 Count);
+SCRUTINY_STATUS pcsiEnumerateVendorDevices (__IN__ U16 VendorId, __IN__ const U16 *PtrDeviceIds, __IN__ U32 DeviceIdCount, __OUT__ PTR_SCRUTINY_PCI_ADDRESS PtrLocations, __IN__ U32 MaxLocations, __OUT__ PU32 PtrCount);
 
 #endif /* __PCI_LINUX__H__ */
 
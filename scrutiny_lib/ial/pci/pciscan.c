@@ -51,6 +51,9 @@ SCRUTINY_STATUS atlasiQualifyPCIDevice (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDevic
 #define LSI_MAX_DEV     0x020
 #define LSI_MAX_FUNC    0x008
 
+/* Device ids of the functions atlasiQualifyPCIDevice accepts */
+static const U16 sLSISupportedDeviceIds[] = { 0xC010, 0xC012 };
+
 
 SCRUTINY_STATUS hlFindDevicesInBus (U16 Bus);
 
@@ -60,12 +63,20 @@ SCRUTINY_STATUS hlVerifyDeviceSignature (U16 Bus, U16 Dev, U16 Func);
 
 SCRUTINY_STATUS hlIsLSIDevice (U32 PciSignature);
 
+SCRUTINY_STATUS hlIsSupportedDevice (U32 PciSignature);
+
 SCRUTINY_STATUS hlConfigureAndAddDevice (SCRUTINY_PCI_ADDRESS *PtrBus);
 
 SCRUTINY_STATUS hliFindLSIDevices()
 {
     U16 bus = 0;
 
+#if defined(OS_LINUX)
+    U32 index;
+    U32 count = 0;
+    PTR_SCRUTINY_PCI_ADDRESS ptrLocations;
+#endif
+
     /* First we need to initialize the PCI driver */
 
     if (dciLoadSliffDriver())
@@ -73,6 +84,37 @@ SCRUTINY_STATUS hliFindLSIDevices()
         return (SCRUTINY_STATUS_FAILED);
     }
 
+#if defined(OS_LINUX)
+
+    /*
+     * Let the kernel tell us where the LSI functions are, this covers every
+     * segment, device and function with a single directory scan. Only the
+     * supported device ids are returned so no other function gets its
+     * configuration space read. Probe the buses through the driver only when
+     * sysfs is not there.
+     */
+
+    ptrLocations = (PTR_SCRUTINY_PCI_ADDRESS) sosiMemAlloc (sizeof (SCRUTINY_PCI_ADDRESS) * SCRUTINY_PCI_MAX_ENUMERATED_DEVICES);
+
+    if (ptrLocations != NULL)
+    {
+        if (pcsiEnumerateVendorDevices (0x1000, sLSISupportedDeviceIds, sizeof (sLSISupportedDeviceIds) / sizeof (U16), ptrLocations, SCRUTINY_PCI_MAX_ENUMERATED_DEVICES, &count) == SCRUTINY_STATUS_SUCCESS)
+        {
+            for (index = 0; index < count; index++)
+            {
+                hlConfigureAndAddDevice (&ptrLocations[index]);
+            }
+
+            sosiMemFree (ptrLocations);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        sosiMemFree (ptrLocations);
+    }
+
+#endif
+
     for (bus = 0; bus < LSI_MAX_BUS; bus++)
     {
         hlVerifyDeviceSignature (bus, 0, 0);
@@ -117,6 +159,8 @@ SCRUTINY_STATUS hlVerifyDeviceSignature (U16 Bus, U16 Dev, U16 Func)
     SCRUTINY_PCI_ADDRESS busIndex;
     U32 dword = 0xFFFFFFFF;
 
+    sosiMemSet (&busIndex, 0, sizeof (SCRUTINY_PCI_ADDRESS));
+
     busIndex.BusNumber = Bus;
     busIndex.DeviceNumber = Dev;
     busIndex.FunctionNumber = Func;
@@ -157,6 +201,11 @@ SCRUTINY_STATUS hlVerifyDeviceSignature (U16 Bus, U16 Dev, U16 Func)
         return (SCRUTINY_STATUS_FAILED);
     }
 
+    if (hlIsSupportedDevice (dword) != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
     /*
      * Initialize the device and add the Device Managers.
      */
@@ -181,9 +230,98 @@ SCRUTINY_STATUS hlIsLSIDevice (U32 PciSignature)
 
 }
 
+SCRUTINY_STATUS hlIsSupportedDevice (U32 PciSignature)
+{
+
+    U32 index;
+
+    /*
+     * Check the device id before any further configuration space access.
+     */
+
+    for (index = 0; index < sizeof (sLSISupportedDeviceIds) / sizeof (U16); index++)
+    {
+        if ((PciSignature >> 16) == sLSISupportedDeviceIds[index])
+        {
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+    }
+
+    return (SCRUTINY_STATUS_FAILED);
+
+}
+
+/**
+ *
+ *  @method  hlFindRetainedDevice()
+ *
+ *  @param   PtrBus             PCI location of the function
+ *
+ *  @return  Device of the previous discovery at this location, NULL if there
+ *           is none or the function there has changed
+ *
+ *  @brief   Used by incremental discovery to skip qualifying a switch again.
+ *           The vendor/device id DWORD is compared with the one the device was
+ *           qualified with, a different function in the same slot is treated
+ *           as new.
+ *
+ */
+
+static PTR_SCRUTINY_DEVICE hlFindRetainedDevice (__IN__ SCRUTINY_PCI_ADDRESS *PtrBus)
+{
+
+    U32 index;
+    U32 dword = 0xFFFFFFFF;
+    PTR_SCRUTINY_DEVICE ptrDevice;
+    PTR_SCRUTINY_PCI_ADDRESS ptrLocation;
+
+    for (index = 0; index < gPtrScrutinyDeviceManager->RetainedCount; index++)
+    {
+
+        ptrDevice = gPtrScrutinyDeviceManager->PtrRetainedList[index];
+
+        if ((ptrDevice == NULL) || (ptrDevice->HandleType != SCRUTINY_HANDLE_TYPE_PCI))
+        {
+            continue;
+        }
+
+        ptrLocation = &ptrDevice->Handle.PciHandle.PciLocation;
+
+        if ((ptrLocation->SegmentNumber != PtrBus->SegmentNumber) ||
+            (ptrLocation->BusNumber != PtrBus->BusNumber) ||
+            (ptrLocation->DeviceNumber != PtrBus->DeviceNumber) ||
+            (ptrLocation->FunctionNumber != PtrBus->FunctionNumber))
+        {
+            continue;
+        }
+
+        if ((pcsiReadDword (*PtrBus, PCI_CONFIG_SPACE_OFFSET_VENDOR_ID, &dword) != SCRUTINY_STATUS_SUCCESS) ||
+            (dword != ptrDevice->Handle.PciHandle.ConfigSpace.Dwords[0]))
+        {
+            return (NULL);
+        }
+
+        return (ptrDevice);
+
+    }
+
+    return (NULL);
+
+}
+
 SCRUTINY_STATUS hlConfigureAndAddDevice (SCRUTINY_PCI_ADDRESS *PtrBus)
 {
 
+    PTR_SCRUTINY_DEVICE ptrDevice;
+
+    ptrDevice = hlFindRetainedDevice (PtrBus);
+
+    if (ptrDevice != NULL)
+    {
+        /* Still there and unchanged, keep the device as it is */
+        return (ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice));
+    }
+
     /*
      * Add to the Device manager
      */
@@ -233,6 +371,63 @@ SCRUTINY_STATUS cdeMapBarRegions (PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocation, PT
 
 }
 
+/**
+ *
+ *  @method  pciProbeBarSize()
+ *
+ *  @param   PtrDeviceLocation  PCI location of the device
+ *
+ *  @param   Offset             Configuration space offset of the BAR
+ *
+ *  @param   Original           Value to restore into the BAR
+ *
+ *  @param   Mask               Size probe pattern, returns the read back value
+ *
+ *  @return  Status             '0' for success and  non-zero for failure
+ *
+ *  @brief   Write the size probe pattern, read it back and restore the BAR.
+ *           On Linux the three accesses go to the driver as one request so
+ *           the BAR stays decoded with the probe value for the shortest time.
+ *
+ */
+
+static SCRUTINY_STATUS pciProbeBarSize (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocation, __IN__ U32 Offset, __IN__ U32 Original, __INOUT__ PU32 PtrMask)
+{
+
+#if defined (OS_LINUX)
+
+    SCRUTINY_DRIVER_PCI_CFG_OPERATION operations[3];
+
+    sosiMemSet (operations, 0, sizeof (operations));
+
+    operations[0].Offset = (U16) Offset;
+    operations[0].Operation = SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE;
+    operations[0].Data = *PtrMask;
+
+    operations[1].Offset = (U16) Offset;
+    operations[1].Operation = SCRUTINY_DRIVER_PCI_BATCH_OPERATION_READ;
+
+    operations[2].Offset = (U16) Offset;
+    operations[2].Operation = SCRUTINY_DRIVER_PCI_BATCH_OPERATION_WRITE;
+    operations[2].Data = Original;
+
+    if (pcsiBatchConfigAccess (*PtrDeviceLocation, operations, 3) == SCRUTINY_STATUS_SUCCESS)
+    {
+        *PtrMask = operations[1].Data;
+
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+#endif
+
+    pcsiWriteDword (*PtrDeviceLocation, Offset, *PtrMask);
+    pcsiReadDword (*PtrDeviceLocation, Offset, PtrMask);
+    pcsiWriteDword (*PtrDeviceLocation, Offset, Original);
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
 SCRUTINY_STATUS peiInitializeBARRegions (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDeviceLocation, __OUT__ PTR_SCRUTINY_PCI_HANDLE PtrHandle)
 {
     U32 offset = 0;
@@ -287,16 +482,13 @@ SCRUTINY_STATUS peiInitializeBARRegions (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDevi
 
             mask = PCI_CONFIG_SPACE_OFFSET_MEM_BAR_MASK;
 
-            pcsiWriteDword (*PtrDeviceLocation, offset, mask);
-            pcsiReadDword (*PtrDeviceLocation, offset, &mask);
+            pciProbeBarSize (PtrDeviceLocation, offset, lower, &mask);
 
             mask &= PCI_CONFIG_SPACE_OFFSET_MEM_BAR_MASK;
 
             PtrHandle->BarRegions[barIndex].BarSize  = ~mask + 1;
             PtrHandle->BarRegions[barIndex].PhysicalAddress.u.Low = lower & PCI_CONFIG_SPACE_OFFSET_MEM_BAR_MASK;
 
-            pcsiWriteDword (*PtrDeviceLocation, offset, lower);
-
             offset += 4;
 
             if (lower & 4)
@@ -315,16 +507,13 @@ SCRUTINY_STATUS peiInitializeBARRegions (__IN__ PTR_SCRUTINY_PCI_ADDRESS PtrDevi
             // IO space
             mask = PCI_CONFIG_SPACE_OFFSET_IO_BAR_MASK;
 
-            pcsiWriteDword (*PtrDeviceLocation, offset, mask);
-            pcsiReadDword (*PtrDeviceLocation, offset, &mask);
+            pciProbeBarSize (PtrDeviceLocation, offset, lower, &mask);
 
             mask &= PCI_CONFIG_SPACE_OFFSET_IO_BAR_MASK;
 
             PtrHandle->BarRegions[barIndex].BarSize  = ~mask + 1;
             PtrHandle->BarRegions[barIndex].PhysicalAddress.u.Low = lower & PCI_CONFIG_SPACE_OFFSET_IO_BAR_MASK;
 
-            pcsiWriteDword (*PtrDeviceLocation, offset, lower);
-
             offset += 4;
 
         }
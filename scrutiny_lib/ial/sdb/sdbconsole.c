@@ -34,48 +34,378 @@
 #include "sdbconsole.h"
 
 
-
 /**
  *
+ * @method  sdbProbePort()
+ *
+ * @param   PtrFilters          Discovery parameters naming exactly one port.
  *
- * @brief   When the serial port is reading any address via SDB, we can store
- *          the last read address. Thus, we don't have to repeat the entire
- *          command for reading the next data. This will save time. Hence this
- *          should be static and initialized once.
+ * @param   PtrPtrDevice        Qualified device when an SDB answered on the
+ *                              port, it is not yet known to the device manager.
  *
- *          The Binary address has a condition that, only read works.
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if a device was
+ *                              qualified on the port.
+ *
+ * @brief   Runs the connection states of one port up to the post connect
+ *          and qualifies the device there. The console check bounds the
+ *          time a silent port takes, so a port never holds up the others.
  *
  */
 
-static U32 sSdbLastBinaryAddress = 0;
-
-
-SCRUTINY_STATUS sdbiConnectSdb (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters)
+SCRUTINY_STATUS sdbProbePort (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters, __OUT__ PTR_SCRUTINY_DEVICE *PtrPtrDevice)
 {
 
     SDB_SERIAL_STATE state;
     SCRUTINY_STATUS status;
     PTR_SCRUTINY_IAL_SERIAL_HANDLE ptrSerialHandle = NULL;
 
+    *PtrPtrDevice = NULL;
+
     state = SDB_DISCOVERY_SERIAL_STATE_CONNECTION_ESTABLISH;
     status = SCRUTINY_STATUS_RETRY;
 
-    while (TRUE)
+    while (state != SDB_DISCOVERY_SERIAL_STATE_SDB_POST_CONNECT)
     {
 
-        gPtrLoggerGeneric->logiDebug ("SDB enumerating state is %x", state);
+        gPtrLoggerGeneric->logiDebug ("SDB enumerating state of %s is %x", PtrFilters->u.SerialConfig.DeviceName, state);
 
         status = sdbEnumerateConnectionStates (PtrFilters, &state, &ptrSerialHandle);
 
         if (status != SCRUTINY_STATUS_RETRY)
+        {
+            return (status);
+        }
+
+    }
+
+    return (sdbQualifySerialDevice (PtrFilters, ptrSerialHandle, PtrPtrDevice));
+
+}
+
+#if defined (OS_LINUX)
+
+/**
+ *
+ * @method  sdbDiscoveryWorker()
+ *
+ * @param   PtrContext          Pointer to the shared SDB_DISCOVERY_CONTEXT
+ *
+ * @return  NULL
+ *
+ * @brief   Worker of the discovery pool. Picks the next port, probes and
+ *          qualifies it and leaves the qualified device in the slot of that
+ *          port. Nothing is added to the device manager from here.
+ *
+ */
+
+static void* sdbDiscoveryWorker (__IN__ void *PtrContext)
+{
+
+    PTR_SDB_DISCOVERY_CONTEXT ptrContext = (PTR_SDB_DISCOVERY_CONTEXT) PtrContext;
+    PTR_SCRUTINY_DISCOVERY_PARAMS ptrFilters;
+    U32 entry;
+
+    ptrFilters = (PTR_SCRUTINY_DISCOVERY_PARAMS) sosiMemAlloc (sizeof (SCRUTINY_DISCOVERY_PARAMS));
+
+    if (ptrFilters == NULL)
+    {
+        return (NULL);
+    }
+
+    while (TRUE)
+    {
+
+        pthread_mutex_lock (&ptrContext->Lock);
+
+        entry = ptrContext->NextEntry++;
+
+        pthread_mutex_unlock (&ptrContext->Lock);
+
+        if (entry >= ptrContext->Count)
+        {
+            break;
+        }
+
+        sosiMemCopy (ptrFilters, ptrContext->PtrFilters, sizeof (SCRUTINY_DISCOVERY_PARAMS));
+
+        sosiMemSet (ptrFilters->u.SerialConfig.DeviceName, 0, sizeof (ptrFilters->u.SerialConfig.DeviceName));
+
+        strncpy (ptrFilters->u.SerialConfig.DeviceName, ptrContext->PortList.gl_pathv[entry], sizeof (ptrFilters->u.SerialConfig.DeviceName) - 1);
+
+        ptrContext->PtrStatusList[entry] = sdbProbePort (ptrFilters, &ptrContext->PtrDeviceList[entry]);
+
+    }
+
+    sosiMemFree (ptrFilters);
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sdbHasDuplicateDevice()
+ *
+ * @param   PtrDeviceManager    Pointer to the device manager
+ *
+ * @param   PtrDevice           Qualified SDB device
+ *
+ * @return  TRUE if an SDB device with the same SAS address is already added
+ *
+ * @brief   The same expander may answer on two of the listed ports. The
+ *          SCSI duplicate check of the device manager does not cover SDB
+ *          handles, so the SAS address read during the qualification is
+ *          compared here. A device without a SAS address is never dropped.
+ *
+ */
+
+static BOOLEAN sdbHasDuplicateDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager, __IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    U32 index;
+    U64 sasAddress;
+    U64 knownSasAddress;
+    PTR_SCRUTINY_DEVICE ptrKnown;
+
+    sasAddress = (PtrDevice->ProductFamily == SCRUTINY_PRODUCT_FAMILY_SWITCH) ?
+                 PtrDevice->DeviceInfo.u.SwitchInfo.SASAddress : PtrDevice->DeviceInfo.u.ExpanderInfo.SASAddress;
+
+    if ((sasAddress.High == 0) && (sasAddress.Low == 0))
+    {
+        return (FALSE);
+    }
+
+    for (index = 0; index < PtrDeviceManager->DeviceCount; index++)
+    {
+
+        ptrKnown = PtrDeviceManager->PtrDeviceList[index];
+
+        if ((ptrKnown == NULL) || (ptrKnown->HandleType != SCRUTINY_HANDLE_TYPE_SDB) ||
+            (ptrKnown->ProductFamily != PtrDevice->ProductFamily))
+        {
+            continue;
+        }
+
+        knownSasAddress = (ptrKnown->ProductFamily == SCRUTINY_PRODUCT_FAMILY_SWITCH) ?
+                          ptrKnown->DeviceInfo.u.SwitchInfo.SASAddress : ptrKnown->DeviceInfo.u.ExpanderInfo.SASAddress;
+
+        if ((knownSasAddress.High == sasAddress.High) && (knownSasAddress.Low == sasAddress.Low))
+        {
+            return (TRUE);
+        }
+
+    }
+
+    return (FALSE);
+
+}
+
+/**
+ *
+ * @method  sdbListPorts()
+ *
+ * @param   PtrPortNames        Device names and wildcard patterns separated by
+ *                              SDB_PORT_LIST_SEPARATOR
+ *
+ * @param   PtrPortList         Expanded ports, release with globfree ().
+ *
+ * @return  Number of candidate ports, zero when no port is named
+ *
+ * @brief   Expands the configured device name into the list of ports the
+ *          discovery has to probe. Only the ports the caller names are
+ *          probed. A name which does not match anything is kept as it is,
+ *          so opening it reports the error as before.
+ *
+ */
+
+static U32 sdbListPorts (__IN__ const char *PtrPortNames, __OUT__ glob_t *PtrPortList)
+{
+
+    char portNames[sizeof (((PTR_SCRUTINY_IAL_SERIAL_CONFIG) 0)->DeviceName)];
+    char *ptrName;
+    char *ptrSave = NULL;
+    int flags = 0;
+
+    sosiMemSet (PtrPortList, 0, sizeof (glob_t));
+    sosiMemSet (portNames, 0, sizeof (portNames));
+
+    if (sosiStringLength (PtrPortNames) < 1)
+    {
+        return (0);
+    }
+
+    strncpy (portNames, PtrPortNames, sizeof (portNames) - 1);
+
+    for (ptrName = strtok_r (portNames, SDB_PORT_LIST_SEPARATOR, &ptrSave); ptrName != NULL; ptrName = strtok_r (NULL, SDB_PORT_LIST_SEPARATOR, &ptrSave))
+    {
+
+        /* Wildcards which match nothing are dropped, plain names are probed regardless */
+        if (glob (ptrName, flags | (strpbrk (ptrName, "*?[") ? 0 : GLOB_NOCHECK), NULL, PtrPortList) == 0)
+        {
+            flags = GLOB_APPEND;
+        }
+
+    }
+
+    return ((U32) PtrPortList->gl_pathc);
+
+}
+
+#endif
+
+/**
+ *
+ * @method  sdbiConnectSdb()
+ *
+ * @param   PtrFilters          Discovery parameters. The serial device name
+ *                              may list several ports and wildcard patterns.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if at least one SDB
+ *                              device was added to the device manager,
+ *                              otherwise the status of the first listed port.
+ *
+ * @brief   Discovers the SDB devices behind the candidate serial ports. The
+ *          ports are probed and qualified by a bounded pool of workers, so a
+ *          silent port costs its deadline once instead of once per port.
+ *          Qualified devices are added to the device manager afterwards in
+ *          the order the ports were listed. An expander reachable on two of
+ *          the listed ports is added once.
+ *
+ */
+
+SCRUTINY_STATUS sdbiConnectSdb (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters)
+{
+
+    #if defined (OS_LINUX)
+
+    U32 index;
+    U32 workers;
+    U32 started;
+    U32 added;
+    SCRUTINY_STATUS status;
+
+    SDB_DISCOVERY_CONTEXT context;
+    pthread_t threads[SDB_DISCOVERY_MAX_WORKERS];
+
+    sosiMemSet (&context, 0, sizeof (SDB_DISCOVERY_CONTEXT));
+
+    context.PtrFilters = PtrFilters;
+    context.Count = sdbListPorts (PtrFilters->u.SerialConfig.DeviceName, &context.PortList);
+
+    if (context.Count == 0)
+    {
+        globfree (&context.PortList);
+
+        return (SCRUTINY_STATUS_INVALID_PORT);
+    }
+
+    context.PtrDeviceList = (PTR_SCRUTINY_DEVICE *) sosiMemAlloc (sizeof (PTR_SCRUTINY_DEVICE) * context.Count);
+    context.PtrStatusList = (SCRUTINY_STATUS *) sosiMemAlloc (sizeof (SCRUTINY_STATUS) * context.Count);
+
+    if ((context.PtrDeviceList == NULL) || (context.PtrStatusList == NULL))
+    {
+        sosiMemFree (context.PtrDeviceList);
+        sosiMemFree (context.PtrStatusList);
+        globfree (&context.PortList);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    sosiMemSet (context.PtrDeviceList, 0, sizeof (PTR_SCRUTINY_DEVICE) * context.Count);
+
+    for (index = 0; index < context.Count; index++)
+    {
+        /* Stays when a worker can't take the port */
+        context.PtrStatusList[index] = SCRUTINY_STATUS_FAILED;
+    }
+
+    context.NextEntry = 0;
+
+    pthread_mutex_init (&context.Lock, NULL);
+
+    /* The calling thread is a worker as well */
+    workers = (context.Count <= SDB_DISCOVERY_MAX_WORKERS) ? (context.Count - 1) : SDB_DISCOVERY_MAX_WORKERS;
+
+    for (started = 0; started < workers; started++)
+    {
+        if (pthread_create (&threads[started], NULL, sdbDiscoveryWorker, (void*) &context))
         {
             break;
         }
+    }
+
+    gPtrLoggerGeneric->logiDebug ("SDB probing %x ports with %x additional workers", context.Count, started);
+
+    sdbDiscoveryWorker (&context);
+
+    for (index = 0; index < started; index++)
+    {
+        pthread_join (threads[index], NULL);
+    }
+
+    pthread_mutex_destroy (&context.Lock);
+
+    added = 0;
+
+    for (index = 0; index < context.Count; index++)
+    {
+
+        if (context.PtrDeviceList[index] == NULL)
+        {
+            continue;
+        }
+
+        gPtrLoggerGeneric->logiDebug ("SDB device qualified on %s", context.PortList.gl_pathv[index]);
+
+        if (sdbHasDuplicateDevice (gPtrScrutinyDeviceManager, context.PtrDeviceList[index]))
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB device on %s is already known, dropped", context.PortList.gl_pathv[index]);
+
+            sdbiSerialConnectionClose (context.PtrDeviceList[index]);
+            sosiMemFree (context.PtrDeviceList[index]);
+
+            continue;
+        }
+
+        context.PtrStatusList[index] = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, context.PtrDeviceList[index]);
+
+        if (context.PtrStatusList[index] != SCRUTINY_STATUS_SUCCESS)
+        {
+            sdbiSerialConnectionClose (context.PtrDeviceList[index]);
+            sosiMemFree (context.PtrDeviceList[index]);
+
+            continue;
+        }
+
+        added++;
 
     }
 
+    /* Nothing added, report why the first port failed, like a single named port always did */
+    status = (added > 0) ? SCRUTINY_STATUS_SUCCESS : context.PtrStatusList[0];
+
+    sosiMemFree (context.PtrDeviceList);
+    sosiMemFree (context.PtrStatusList);
+    globfree (&context.PortList);
+
     return (status);
 
+    #else
+
+    SCRUTINY_STATUS status;
+    PTR_SCRUTINY_DEVICE ptrDevice = NULL;
+
+    status = sdbProbePort (PtrFilters, &ptrDevice);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (status);
+    }
+
+    return (ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice));
+
+    #endif
+
 }
 
 SCRUTINY_STATUS sdbEnumerateConnectionStates (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters, __INOUT__ SDB_SERIAL_STATE* PtrCurrentState, __INOUT__ PTR_SCRUTINY_IAL_SERIAL_HANDLE *PtrSerialHandle)
@@ -143,7 +473,8 @@ SCRUTINY_STATUS sdbEnumerateConnectionStates (__IN__ PTR_SCRUTINY_DISCOVERY_PARA
             else
             {
 
-                if (SCRUTINY_DISCOVERY_TYPE_SERIAL_DEBUG == gPtrScrutinyDeviceManager->DiscoveryFlag)
+                if ((SCRUTINY_DISCOVERY_TYPE_SERIAL_DEBUG == gPtrScrutinyDeviceManager->DiscoveryFlag) ||
+                    (SCRUTINY_DISCOVERY_TYPE_SIMULATED == gPtrScrutinyDeviceManager->DiscoveryFlag))
                 {
                     /* We just have to post connect */
                     *PtrCurrentState = SDB_DISCOVERY_SERIAL_STATE_SDB_POST_CONNECT;
@@ -199,8 +530,61 @@ SCRUTINY_STATUS sdbExpanderSerialInterfacePostConnect (__IN__ PTR_SCRUTINY_DISCO
     PTR_SCRUTINY_DEVICE ptrDevice = NULL;
     SCRUTINY_STATUS status;
 
+    status = sdbQualifySerialDevice (PtrFilter, PtrSerialHandle, &ptrDevice);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (status);
+    }
+
+    /* We will now have to add it to the global device list */
+
+    return (ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice));
+
+}
+
+/**
+ *
+ * @method  sdbQualifySerialDevice()
+ *
+ * @param   PtrFilter           Filter parameters used for the connection.
+ *
+ * @param   PtrSerialHandle     Serial handle of the port where the console
+ *                              check has passed.
+ *
+ * @param   PtrPtrDevice        Qualified device, it is not yet known to the
+ *                              device manager.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if the device behind
+ *                              the port is ours, otherwise the failure of
+ *                              the qualification. The port is closed then.
+ *
+ * @brief   Builds the SDB device for the port and qualifies it. Nothing
+ *          global is touched, so ports can be qualified in parallel.
+ *
+ */
+
+SCRUTINY_STATUS sdbQualifySerialDevice (
+    __IN__  PTR_SCRUTINY_DISCOVERY_PARAMS   PtrFilter,
+    __IN__  PTR_SCRUTINY_IAL_SERIAL_HANDLE  PtrSerialHandle,
+    __OUT__ PTR_SCRUTINY_DEVICE             *PtrPtrDevice
+    )
+{
+
+    PTR_SCRUTINY_DEVICE ptrDevice = NULL;
+    SCRUTINY_STATUS status;
+
+    *PtrPtrDevice = NULL;
+
     ptrDevice = (PTR_SCRUTINY_DEVICE) sosiMemAlloc (sizeof (SCRUTINY_DEVICE));
 
+    if (ptrDevice == NULL)
+    {
+        spiClosePort (PtrSerialHandle);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
     sosiMemSet (ptrDevice, 0, sizeof (SCRUTINY_DEVICE));
 
     ptrDevice->HandleType = SCRUTINY_HANDLE_TYPE_SDB;
@@ -232,51 +616,126 @@ SCRUTINY_STATUS sdbExpanderSerialInterfacePostConnect (__IN__ PTR_SCRUTINY_DISCO
         return (status);
     }
 
-    /* We will now have to add it to the global device list */
+    *PtrPtrDevice = ptrDevice;
 
-    return (ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice));
+    return (SCRUTINY_STATUS_SUCCESS);
 
 }
 
 /**
  *
- * @method  sdbYield()
+ * @method  sdbGetResponseTimeout()
  *
- * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if the operation is
- *                              successful or SCRUTINY_STATUS_FAILED.
+ * @param   PtrSerialHandle     Serial handle where the connection details are
+ *                              stored.
+ *
+ * @param   WireBytes           Bytes of the command and of its response.
+ *
+ * @return  U32                 Deadline for the response in micro seconds.
  *
- * @brief   For SDB we need to yield the read parallel thread.
+ * @brief   The firmware turnaround plus the time the command and the response
+ *          need on the wire at the configured baud rate.
  *
  */
 
-SCRUTINY_STATUS sdbYield()
+U32 sdbGetResponseTimeout (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 WireBytes)
 {
 
-    #if defined(OS_WINDOWS)
+    U32 bitsPerSecond;
 
-        U32 index = 0;
+    bitsPerSecond = spiGetBitsPerSecond (PtrSerialHandle);
 
-        SwitchToThread();
+    if (bitsPerSecond == 0)
+    {
+        return (SDB_RESPONSE_TIMEOUT_US);
+    }
 
-        /*
-         * I want to sleep less than 1 milliseconds. There is no direct option in windows.
-         * thus making this ugly hack.
-         */
+    return (SDB_RESPONSE_TIMEOUT_US + (U32) (((unsigned long long) WireBytes * SDB_BITS_PER_CHARACTER * 1000000) / bitsPerSecond));
 
-        for (index = 0; index < 2000; index++)
-        {
-            sosiSleep (0);
-        }
+}
 
-    #elif defined (OS_UEFI)
+/**
+ *
+ * @method  sdbExchange()
+ *
+ * @param   PtrSerialHandle     Serial handle where the connection details are
+ *                              stored.
+ *
+ * @param   PtrCommand          SDB command to send.
+ *
+ * @param   CommandSize         Size of the command.
+ *
+ * @param   PtrResponse         Receives the response data, may be NULL when
+ *                              ResponseSize is zero.
+ *
+ * @param   ResponseSize        Data bytes expected before the trailing byte.
+ *
+ * @param   PtrReceived         Data bytes actually stored into PtrResponse.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if the command could be
+ *                              sent or SCRUTINY_STATUS_FAILED.
+ *
+ * @brief   Sends one SDB command and waits for its response. Every response
+ *          ends with one trailing byte, for writes it is the only byte. The
+ *          receive thread wakes us up as the bytes come in, so the command
+ *          completes as soon as the response is complete. When the deadline
+ *          passes with only the data in, the data is used and the late
+ *          trailer is flushed by the next command.
+ *
+ */
 
+SCRUTINY_STATUS sdbExchange (
+    __IN__  PTR_SCRUTINY_IAL_SERIAL_HANDLE  PtrSerialHandle,
+    __IN__  PU8                             PtrCommand,
+    __IN__  U32                             CommandSize,
+    __OUT__ PU8                             PtrResponse,
+    __IN__  U32                             ResponseSize,
+    __OUT__ U32*                            PtrReceived
+    )
+{
 
-    #else
+    U32 sizeOp = 0;
+    U32 available = 0;
+    U32 timeout;
+    PU8 ptrTrailer = NULL;
 
+    *PtrReceived = 0;
 
-    sosiSleep (1);
+    timeout = sdbGetResponseTimeout (PtrSerialHandle, CommandSize + ResponseSize + SDB_RESPONSE_TRAILER_SIZE);
 
-    #endif
+    spiFlushPort (PtrSerialHandle);
+
+    /* Write the data into the serial port */
+    if (spiWriteData (PtrSerialHandle, PtrCommand, CommandSize, &sizeOp))
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    spiWaitData (PtrSerialHandle, ResponseSize + SDB_RESPONSE_TRAILER_SIZE, timeout, &available);
+
+    if (available < ResponseSize)
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    if (ResponseSize)
+    {
+        /* The bytes are already in, this does not wait */
+        spiReadData (PtrSerialHandle, PtrResponse, PtrReceived, ResponseSize);
+    }
+
+    if (available > ResponseSize)
+    {
+        spiPeekData (PtrSerialHandle, &ptrTrailer, &sizeOp);
+
+        if (ResponseSize && sizeOp)
+        {
+            PtrSerialHandle->SdbReadTrailer = *ptrTrailer;
+            PtrSerialHandle->SdbReadTrailerValid = TRUE;
+        }
+
+        spiConsumeData (PtrSerialHandle, SDB_RESPONSE_TRAILER_SIZE);
+    }
 
     return (SCRUTINY_STATUS_SUCCESS);
 
@@ -405,7 +864,10 @@ SCRUTINY_STATUS sdbiSerialConnectionEstablish (__IN__ PTR_SCRUTINY_DISCOVERY_PAR
  *          successful, we know that we have a device which is responding for
  *          Serial port commands. At this point of a time, we don't know if the
  *          device attached is Expander or Switch. As the Expanders and Switch
- *          shares the same SDB hardware responses are same.
+ *          shares the same SDB hardware responses are same. The read is
+ *          repeated until SDB_PORT_PROBE_TIMEOUT_US has passed or it was tried
+ *          SDB_PORT_PROBE_MAX_ATTEMPTS times, a port which stays silent fails
+ *          then.
  *
  */
 
@@ -413,9 +875,12 @@ SCRUTINY_STATUS sdbiCheckConsole (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilter
 {
 
     U8 data[1024] = { "\r" };
+    U8 cmd[SDB_READ_COMMAND_SIZE];
     U32 dword = 0, readSize;
+    U32 start;
+    U32 attempts = 0;
 
-    sSdbLastBinaryAddress = 0;
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     /* Flush the existing values. */
     spiFlushPort (PtrSerialHandle);
@@ -431,13 +896,35 @@ SCRUTINY_STATUS sdbiCheckConsole (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilter
 
     sosiSleep (10);
 
+    cmd[0] = 'G';
+    cmd[1] = 4;
+    cmd[2] = (U8) ((SDB_CONSOLE_CHECK_ADDRESS >> 24) & 0xFF);
+    cmd[3] = (U8) ((SDB_CONSOLE_CHECK_ADDRESS >> 16) & 0xFF);
+    cmd[4] = (U8) ((SDB_CONSOLE_CHECK_ADDRESS >> 8) & 0xFF);
+    cmd[5] = (U8) (SDB_CONSOLE_CHECK_ADDRESS & 0xFF);
+    cmd[6] = '\r';
+
+    start = sosiGetMicroSeconds ();
+
     /* Do a valid memory read. */
-    if (sdbiMemoryRead32 (PtrSerialHandle, 0x10000000, &dword))
+    do
     {
-        return (SCRUTINY_STATUS_FAILED);
-    }
 
-    return (SCRUTINY_STATUS_SUCCESS);
+        if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), (PU8) &dword, sizeof (dword), &readSize))
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        if (readSize == sizeof (dword))
+        {
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+    } while (((sosiGetMicroSeconds () - start) < SDB_PORT_PROBE_TIMEOUT_US) && (++attempts < SDB_PORT_PROBE_MAX_ATTEMPTS));
+
+    gPtrLoggerGeneric->logiDebug ("SDB console on %s did not answer", PtrSerialHandle->SerialConfig.DeviceName);
+
+    return (SCRUTINY_STATUS_FAILED);
 
 }
 
@@ -462,19 +949,12 @@ SCRUTINY_STATUS sdbiCheckConsole (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilter
 SCRUTINY_STATUS sdbiMemoryRead8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU8 PtrData)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[7];
-    U32 cmdSize = 7;
     U32 sizeOp = 0;
     U8 data;
-    U32 retryCount = 6;
+    U32 retryCount;
 
-    while (retryCount--)
-    {
-
-    sSdbLastBinaryAddress = 0;
-
-    spiFlushPort (PtrSerialHandle);
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     cmd[0] = 'G';
     cmd[1] = 1;
@@ -484,42 +964,26 @@ SCRUTINY_STATUS sdbiMemoryRead8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial
     cmd[5] = (U8) (Address & 0xFF);
     cmd[6] = '\r';
 
-    /* Write the data into the serial port */
-
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
-
-    if (status)
+    for (retryCount = 0; retryCount < SDB_COMMAND_RETRY_COUNT; retryCount++)
     {
-        return (SCRUTINY_STATUS_FAILED);
-    }
 
-    sdbYield();
+        data = 0;
 
-    data = 0;
-    sizeOp = 1;
-
-    status = spiReadData (PtrSerialHandle, (U8 *) &data, &sizeOp, 1);
-
-    if (status || sizeOp != 1)
-    {
-
-        if (retryCount == 0)
+        if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), (PU8) &data, sizeof (data), &sizeOp))
         {
             return (SCRUTINY_STATUS_FAILED);
         }
 
-        continue;
-    }
-
-    *PtrData = data;
-
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
+        if (sizeOp == sizeof (data))
+        {
+            *PtrData = data;
 
-    break;
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
 
     }
 
-    return (SCRUTINY_STATUS_SUCCESS);
+    return (SCRUTINY_STATUS_FAILED);
 
 }
 
@@ -544,19 +1008,12 @@ SCRUTINY_STATUS sdbiMemoryRead8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerial
 SCRUTINY_STATUS sdbiMemoryRead16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU16 PtrData)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[7];
-    U32 cmdSize = 7;
     U32 sizeOp = 0;
     U16 data;
-    U32 retryCount = 6;
+    U32 retryCount;
 
-    sSdbLastBinaryAddress = 0;
-
-    while (retryCount--)
-    {
-
-    spiFlushPort (PtrSerialHandle);
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     cmd[0] = 'G';
     cmd[1] = 2;
@@ -566,42 +1023,27 @@ SCRUTINY_STATUS sdbiMemoryRead16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
     cmd[5] = (U8) (Address & 0xFF);
     cmd[6] = '\r';
 
-    /* Write the data into the serial port */
-
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
-
-    if (status)
+    for (retryCount = 0; retryCount < SDB_COMMAND_RETRY_COUNT; retryCount++)
     {
-        return (SCRUTINY_STATUS_FAILED);
-    }
-
-    sdbYield();
 
-    data = 0;
-    sizeOp = 2;
+        data = 0;
 
-    status = spiReadData (PtrSerialHandle, (U8 *) &data, &sizeOp, 2);
-
-    if (status || sizeOp != 1)
-    {
-        if (retryCount == 0)
+        if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), (PU8) &data, sizeof (data), &sizeOp))
         {
             return (SCRUTINY_STATUS_FAILED);
         }
 
-        continue;
-    }
-
-    data = ((data >> 8) & 0xFF) | (data & 0xFF) << 8;
-    *PtrData = data;
-
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
+        if (sizeOp == sizeof (data))
+        {
+            data = ((data >> 8) & 0xFF) | (data & 0xFF) << 8;
+            *PtrData = data;
 
-    break;
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
 
     }
 
-    return (SCRUTINY_STATUS_SUCCESS);
+    return (SCRUTINY_STATUS_FAILED);
 
 }
 
@@ -626,78 +1068,284 @@ SCRUTINY_STATUS sdbiMemoryRead16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
 SCRUTINY_STATUS sdbiMemoryRead32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU32 PtrData)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[7];
-    U32 cmdSize = 7;
+    U32 cmdSize;
     U32 sizeOp = 0;
     U32 data;
-    U32 retryCount = 6;
+    U32 retryCount;
 
-    while (retryCount--)
+    for (retryCount = 0; retryCount < SDB_COMMAND_RETRY_COUNT; retryCount++)
     {
 
-    spiFlushPort (PtrSerialHandle);
+        if (PtrSerialHandle->SdbLastBinaryAddress == (Address - 4))
+        {
 
-    if (sSdbLastBinaryAddress == (Address - 4))
-    {
+            cmdSize = 2;
+
+            cmd[0] = 'n';
+            cmd[1] = '\r';
+
+        }
+
+        else
+        {
 
-        sizeOp = 2;
-        cmdSize = 2;
+            cmdSize = 7;
 
-        cmd[0] = 'n';
-        cmd[1] = '\r';
+            cmd[0] = 'G';
+            cmd[1] = 4;
+            cmd[2] = (U8) ((Address >> 24) & 0xFF);
+            cmd[3] = (U8) ((Address >> 16) & 0xFF);
+            cmd[4] = (U8) ((Address >> 8) & 0xFF);
+            cmd[5] = (U8) (Address & 0xFF);
+            cmd[6] = '\r';
+
+        }
+
+        data = 0;
+
+        if (sdbExchange (PtrSerialHandle, cmd, cmdSize, (PU8) &data, sizeof (data), &sizeOp))
+        {
+            PtrSerialHandle->SdbLastBinaryAddress = 0;
+
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        if (sizeOp != sizeof (data))
+        {
+            /* The device may have lost the position, retry with the full address */
+            PtrSerialHandle->SdbLastBinaryAddress = 0;
+
+            continue;
+        }
+
+        data = (((data & 0x000000FF) << 24)  +
+                ((data & 0x0000FF00) << 8)  +
+                ((data & 0x00FF0000) >> 8)  +
+                ((data & 0xFF000000) >> 24));
+
+        *PtrData = data;
+
+        PtrSerialHandle->SdbLastBinaryAddress = Address;
+
+        return (SCRUTINY_STATUS_SUCCESS);
 
     }
 
-    else
+    return (SCRUTINY_STATUS_FAILED);
+
+}
+
+/**
+ *
+ * @method  sdbBlockReadSend()
+ *
+ * @param   PtrSerialHandle     Serial handle where the connection details are
+ *                              stored.
+ *
+ * @param   Address             Address of the first dword to request.
+ *
+ * @param   Count               Number of dwords to request.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if the commands could be
+ *                              sent or SCRUTINY_STATUS_FAILED.
+ *
+ * @brief   Puts one full address read command per dword on the wire with a
+ *          single write. The 'n' shortcut is not used, a lost command would
+ *          shift every following response by one dword.
+ *
+ */
+
+SCRUTINY_STATUS sdbBlockReadSend (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U32 Count)
+{
+
+    U8 cmd[SDB_BLOCK_READ_WINDOW * SDB_READ_COMMAND_SIZE];
+    U32 index;
+    U32 sizeOp = 0;
+    PU8 ptrCmd;
+
+    for (index = 0; index < Count; index++, Address += 4)
     {
-        cmd[0] = 'G';
-        cmd[1] = 4;
-        cmd[2] = (U8) ((Address >> 24) & 0xFF);
-        cmd[3] = (U8) ((Address >> 16) & 0xFF);
-        cmd[4] = (U8) ((Address >> 8) & 0xFF);
-        cmd[5] = (U8) (Address & 0xFF);
-        cmd[6] = '\r';
+
+        ptrCmd = &cmd[index * SDB_READ_COMMAND_SIZE];
+
+        ptrCmd[0] = 'G';
+        ptrCmd[1] = 4;
+        ptrCmd[2] = (U8) ((Address >> 24) & 0xFF);
+        ptrCmd[3] = (U8) ((Address >> 16) & 0xFF);
+        ptrCmd[4] = (U8) ((Address >> 8) & 0xFF);
+        ptrCmd[5] = (U8) (Address & 0xFF);
+        ptrCmd[6] = '\r';
+
     }
 
-    /* Write the data into the serial port */
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
+    return (spiWriteData (PtrSerialHandle, cmd, Count * SDB_READ_COMMAND_SIZE, &sizeOp));
+
+}
 
-    if (status)
+/**
+ *
+ * @method  sdbiMemoryReadBlock32()
+ *
+ * @param   PtrSerialHandle     Serial handle where the connection details are
+ *                              stored.
+ *
+ * @param   Address             Address of the first dword.
+ *
+ * @param   PtrData             Receives DwordCount dwords.
+ *
+ * @param   DwordCount          Number of consecutive dwords to read.
+ *
+ * @return  SCRUTINY_STATUS     SCRUTINY_STATUS_SUCCESS if the operation is
+ *                              successful or SCRUTINY_STATUS_FAILED.
+ *
+ * @brief   Reads consecutive dwords with windows of up to SDB_BLOCK_READ_WINDOW
+ *          read commands on the wire, so the link does not sit idle for a
+ *          command turnaround per dword.
+ *
+ *          SDB responses carry no address, a lost or an extra response would
+ *          silently move every following dword to the wrong address. Hence a
+ *          window is only taken when exactly one response per address of the
+ *          window came in, each ending with the trailing byte a plain read
+ *          returned, and nothing behind them. Otherwise the addresses of the
+ *          window are read again one at a time with sdbiMemoryRead32().
+ *
+ */
+
+SCRUTINY_STATUS sdbiMemoryReadBlock32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU32 PtrData, __IN__ U32 DwordCount)
+{
+
+    U8 response[SDB_BLOCK_READ_WINDOW * SDB_READ_RESPONSE_SIZE];
+    U32 index;
+    U32 count;
+    U32 slot;
+    U32 sizeOp;
+    U32 extra;
+    U32 pending;
+    PU8 ptrWindow;
+    PU8 ptrResponse;
+
+    if (DwordCount == 0)
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    /* A plain read first, it also tells us how a response ends */
+    if (sdbiMemoryRead32 (PtrSerialHandle, Address, &PtrData[0]))
     {
         return (SCRUTINY_STATUS_FAILED);
     }
 
-    sdbYield();
+    index = 1;
 
-    data = 0;
-    sizeOp = 4;
+    while (index < DwordCount)
+    {
 
-    status = spiReadData (PtrSerialHandle, (U8 *) &data, &sizeOp, 4);
+        count = DwordCount - index;
 
-    if (status || sizeOp != 4)
-    {
+        if (count > SDB_BLOCK_READ_WINDOW)
+        {
+            count = SDB_BLOCK_READ_WINDOW;
+        }
+
+        if (count < 2 || !PtrSerialHandle->SdbReadTrailerValid)
+        {
+
+            if (sdbiMemoryRead32 (PtrSerialHandle, Address + (index * 4), &PtrData[index]))
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            index++;
+
+            continue;
+
+        }
+
+        spiFlushPort (PtrSerialHandle);
 
-        if (retryCount == 0)
+        PtrSerialHandle->SdbLastBinaryAddress = 0;
+
+        if (sdbBlockReadSend (PtrSerialHandle, Address + (index * 4), count))
         {
             return (SCRUTINY_STATUS_FAILED);
         }
 
-        continue;
-    }
+        sizeOp = 0;
+        extra = 0;
+        pending = 0;
+        ptrWindow = response;
+
+        if (spiWaitData (PtrSerialHandle,
+                         count * SDB_READ_RESPONSE_SIZE,
+                         sdbGetResponseTimeout (PtrSerialHandle, count * (SDB_READ_COMMAND_SIZE + SDB_READ_RESPONSE_SIZE)),
+                         NULL) == SCRUTINY_STATUS_SUCCESS)
+        {
+
+            /* Parse the window inside the receive ring, copy only when it wraps around the end */
+            spiPeekData (PtrSerialHandle, &ptrWindow, &sizeOp);
+
+            if (sizeOp >= (count * SDB_READ_RESPONSE_SIZE))
+            {
+                sizeOp = count * SDB_READ_RESPONSE_SIZE;
+                pending = sizeOp;
+            }
+
+            else
+            {
+                ptrWindow = response;
+                spiReadData (PtrSerialHandle, response, &sizeOp, count * SDB_READ_RESPONSE_SIZE);
+            }
+
+            /* Anything already behind the last response means we are out of step */
+            spiWaitData (PtrSerialHandle, 1, 0, &extra);
+
+            extra -= pending;
+
+        }
+
+        for (slot = 0; (sizeOp == (count * SDB_READ_RESPONSE_SIZE)) && (slot < count); slot++)
+        {
+            if (ptrWindow[(slot * SDB_READ_RESPONSE_SIZE) + sizeof (U32)] != PtrSerialHandle->SdbReadTrailer)
+            {
+                break;
+            }
+        }
+
+        if (sizeOp != (count * SDB_READ_RESPONSE_SIZE) || slot != count || extra)
+        {
 
-    data = (((data & 0x000000FF) << 24)  +
-            ((data & 0x0000FF00) << 8)  +
-            ((data & 0x00FF0000) >> 8)  +
-            ((data & 0xFF000000) >> 24));
+            spiConsumeData (PtrSerialHandle, pending);
 
-    *PtrData = data;
+            /* Take the window one dword at a time, each of those flushes whatever is left */
+            for (slot = 0; slot < count; slot++, index++)
+            {
+                if (sdbiMemoryRead32 (PtrSerialHandle, Address + (index * 4), &PtrData[index]))
+                {
+                    return (SCRUTINY_STATUS_FAILED);
+                }
+            }
 
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
+            continue;
+
+        }
+
+        for (slot = 0; slot < count; slot++, index++)
+        {
 
-    sSdbLastBinaryAddress = Address;
+            ptrResponse = &ptrWindow[slot * SDB_READ_RESPONSE_SIZE];
 
-    break;
+            PtrData[index] = ((U32) ptrResponse[0] << 24) |
+                             ((U32) ptrResponse[1] << 16) |
+                             ((U32) ptrResponse[2] << 8)  |
+                             ((U32) ptrResponse[3]);
+
+        }
+
+        spiConsumeData (PtrSerialHandle, pending);
+
+        /* The last command was a full address read, so 'n' can carry on from here */
+        PtrSerialHandle->SdbLastBinaryAddress = Address + ((index - 1) * 4);
 
     }
 
@@ -726,17 +1374,10 @@ SCRUTINY_STATUS sdbiMemoryRead32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
 SCRUTINY_STATUS sdbiMemoryWrite8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U8 Data)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[8];
-    U32 cmdSize = 8;
     U32 sizeOp = 0;
 
-    while (TRUE)
-    {
-
-    sSdbLastBinaryAddress = 0;
-
-    spiFlushPort (PtrSerialHandle);
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     cmd[0] = 'P';
     cmd[1] = 1;
@@ -747,23 +1388,12 @@ SCRUTINY_STATUS sdbiMemoryWrite8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
     cmd[6] = (U8) (Data & 0xFF);
     cmd[7] = '\r';
 
-    /* Write the data into the serial port */
-
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
-
-    sdbYield();
-
-    if (status)
+    /* Only the acknowledge byte comes back, it is not checked */
+    if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), NULL, 0, &sizeOp))
     {
         return (SCRUTINY_STATUS_FAILED);
     }
 
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
-
-    break;
-
-    }
-
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
@@ -789,17 +1419,10 @@ SCRUTINY_STATUS sdbiMemoryWrite8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
 SCRUTINY_STATUS sdbiMemoryWrite16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U16 Data)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[9];
-    U32 cmdSize = 9;
     U32 sizeOp = 0;
 
-    sSdbLastBinaryAddress = 0;
-
-    while (TRUE)
-    {
-
-    spiFlushPort (PtrSerialHandle);
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     cmd[0] = 'P';
     cmd[1] = 2;
@@ -811,23 +1434,12 @@ SCRUTINY_STATUS sdbiMemoryWrite16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeri
     cmd[7] = (U8) (Data & 0xFF);
     cmd[8] = '\r';
 
-    /* Write the data into the serial port */
-
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
-
-    sdbYield();
-
-    if (status)
+    /* Only the acknowledge byte comes back, it is not checked */
+    if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), NULL, 0, &sizeOp))
     {
         return (SCRUTINY_STATUS_FAILED);
     }
 
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
-
-    break;
-
-    }
-
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
@@ -853,17 +1465,10 @@ SCRUTINY_STATUS sdbiMemoryWrite16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeri
 SCRUTINY_STATUS sdbiMemoryWrite32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U32 Data)
 {
 
-    SCRUTINY_STATUS status;
     U8 cmd[11];
-    U32 cmdSize = 11;
     U32 sizeOp = 0;
 
-    while (TRUE)
-    {
-
-    sSdbLastBinaryAddress = 0;
-
-    spiFlushPort (PtrSerialHandle);
+    PtrSerialHandle->SdbLastBinaryAddress = 0;
 
     cmd[0] = 'P';
     cmd[1] = 4;
@@ -877,22 +1482,12 @@ SCRUTINY_STATUS sdbiMemoryWrite32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeri
     cmd[9] = (U8) (Data & 0xFF);
     cmd[10] = '\r';
 
-    /* Write the data into the serial port */
-    status = spiWriteData (PtrSerialHandle, cmd, cmdSize, &sizeOp);
-
-    sdbYield();
-
-    if (status)
+    /* Only the acknowledge byte comes back, it is not checked */
+    if (sdbExchange (PtrSerialHandle, cmd, sizeof (cmd), NULL, 0, &sizeOp))
     {
         return (SCRUTINY_STATUS_FAILED);
     }
 
-    spiReadData (PtrSerialHandle, cmd, &sizeOp, 1);
-
-    break;
-
-    }
-
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
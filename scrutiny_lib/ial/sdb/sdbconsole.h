@@ -35,6 +35,42 @@
 
 #define SDB_ACCESS_SLEEP_TIME   (0)
 
+/* Firmware turnaround allowed for one command, the wire time is added on top */
+#define SDB_RESPONSE_TIMEOUT_US         (250 * 1000)
+
+/* Start, eight data and stop bits plus one spare for a parity bit */
+#define SDB_BITS_PER_CHARACTER          (11)
+
+/* Every response ends with one byte after the data, for writes it is the acknowledge */
+#define SDB_RESPONSE_TRAILER_SIZE       (1)
+
+/* Attempts for a read which got no complete response within its deadline */
+#define SDB_COMMAND_RETRY_COUNT         (6)
+
+/* Full address dword read command, 'G', size, four address bytes and '\r' */
+#define SDB_READ_COMMAND_SIZE           (7)
+
+/* Dword read response, four data bytes and the trailer */
+#define SDB_READ_RESPONSE_SIZE          (4 + SDB_RESPONSE_TRAILER_SIZE)
+
+/* Read commands a block read puts on the wire at once, one disables the pipelining */
+#define SDB_BLOCK_READ_WINDOW           (8)
+
+/* Time a port gets to answer the console check before it is given up */
+#define SDB_PORT_PROBE_TIMEOUT_US       (1000 * 1000)
+
+/* Console check reads within SDB_PORT_PROBE_TIMEOUT_US, also ends the check on hosts without a micro-second clock */
+#define SDB_PORT_PROBE_MAX_ATTEMPTS     ((SDB_PORT_PROBE_TIMEOUT_US / SDB_RESPONSE_TIMEOUT_US) + 1)
+
+/* Address the console check reads to tell an SDB from any other serial device */
+#define SDB_CONSOLE_CHECK_ADDRESS       (0x10000000)
+
+/* Separates the device names and wildcard patterns of a port list */
+#define SDB_PORT_LIST_SEPARATOR         ","
+
+/* Number of threads probing and qualifying serial ports in parallel during discovery */
+#define SDB_DISCOVERY_MAX_WORKERS       (32)
+
 typedef enum __EXPANDER_SERIAL_STATE
 {
 
@@ -47,12 +83,33 @@ typedef enum __EXPANDER_SERIAL_STATE
 
 } SDB_SERIAL_STATE;
 
+#if defined (OS_LINUX)
+
+typedef struct _SDB_DISCOVERY_CONTEXT
+{
+
+    PTR_SCRUTINY_DISCOVERY_PARAMS   PtrFilters;         /* discovery parameters, each port gets a copy with its own name */
+    glob_t                          PortList;           /* candidate ports, in the order they were listed */
+    PTR_SCRUTINY_DEVICE             *PtrDeviceList;     /* qualified device per port, NULL if no SDB answered */
+    SCRUTINY_STATUS                 *PtrStatusList;     /* probe status per port */
+    U32                             Count;
+    U32                             NextEntry;          /* next port to be picked by a worker */
+    pthread_mutex_t                 Lock;
+
+} SDB_DISCOVERY_CONTEXT, *PTR_SDB_DISCOVERY_CONTEXT;
+
+#endif
+
 SCRUTINY_STATUS sdbiSerialConnectionClose (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
 
 SCRUTINY_STATUS sdbiReestablishConnection (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
 
 SCRUTINY_STATUS sdbExpanderSerialInterfacePostConnect (PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilter, PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle);
 
+SCRUTINY_STATUS sdbQualifySerialDevice (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilter, __IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __OUT__ PTR_SCRUTINY_DEVICE *PtrPtrDevice);
+
+SCRUTINY_STATUS sdbProbePort (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters, __OUT__ PTR_SCRUTINY_DEVICE *PtrPtrDevice);
+
 SCRUTINY_STATUS sdbEnumerateConnectionStates (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters, __INOUT__ SDB_SERIAL_STATE* PtrCurrentState, __INOUT__ PTR_SCRUTINY_IAL_SERIAL_HANDLE *PtrSerialHandle);
 
 SCRUTINY_STATUS sdbiSerialConnectionEstablish (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters, __INOUT__ PTR_SCRUTINY_IAL_SERIAL_HANDLE *PtrSerialHandle);
@@ -65,6 +122,8 @@ SCRUTINY_STATUS sdbiMemoryRead16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeria
 
 SCRUTINY_STATUS sdbiMemoryRead32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU32 PtrData);
 
+SCRUTINY_STATUS sdbiMemoryReadBlock32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __OUT__ PU32 PtrData, __IN__ U32 DwordCount);
+
 SCRUTINY_STATUS sdbiMemoryWrite8 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U8 Data);
 
 SCRUTINY_STATUS sdbiMemoryWrite16 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U16 Data);
@@ -73,6 +132,12 @@ SCRUTINY_STATUS sdbiMemoryWrite32 (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSeri
 
 SCRUTINY_STATUS sdbiConnectSdb (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrFilters);
 
+U32 sdbGetResponseTimeout (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 WireBytes);
+
+SCRUTINY_STATUS sdbBlockReadSend (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ U32 Address, __IN__ U32 Count);
+
+SCRUTINY_STATUS sdbExchange (__IN__ PTR_SCRUTINY_IAL_SERIAL_HANDLE PtrSerialHandle, __IN__ PU8 PtrCommand, __IN__ U32 CommandSize, __OUT__ PU8 PtrResponse, __IN__ U32 ResponseSize, __OUT__ U32* PtrReceived);
+
 
 
 #endif /* __SDB__CONSOLE__H__ */
@@ -0,0 +1,1097 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+
+
+/* posix_openpt() and ptsname_r() */
+#define _GNU_SOURCE
+
+#include "libincludes.h"
+#include "sdbsimulator.h"
+
+#include <termios.h>
+
+/**
+ *
+ * @brief   the one running simulator, its port stays valid until the next
+ *          simulated discovery or the library exit
+ *
+ */
+
+static PTR_SDB_SIMULATOR sPtrSdbSimulator = NULL;
+
+/**
+ *
+ * @method  sdbsimNow ()
+ *
+ * @return  monotonic time in micro seconds
+ *
+ * @brief   64 bit clock for the line timing, sosiGetMicroSeconds() wraps
+ *
+ *
+ */
+
+static unsigned long long sdbsimNow ()
+{
+
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (((unsigned long long) now.tv_sec * 1000000ULL) + ((unsigned long long) now.tv_nsec / 1000ULL));
+
+}
+
+/**
+ *
+ * @method  sdbsimNextRandom ()
+ *
+ * @param   PtrSimulator    simulator holding the generator state
+ *
+ * @return  next value in 0 .. 999999
+ *
+ * @brief   small LCG, the same seed gives the same noise on every run
+ *
+ *
+ */
+
+static U32 sdbsimNextRandom (__INOUT__ PTR_SDB_SIMULATOR PtrSimulator)
+{
+
+    PtrSimulator->Random = (PtrSimulator->Random * 1103515245) + 12345;
+
+    return ((PtrSimulator->Random >> 8) % 1000000);
+
+}
+
+/**
+ *
+ * @method  sdbsimFindWindow ()
+ *
+ * @param   PtrSimulator    simulator to search
+ *
+ * @param   Address         first byte accessed
+ *
+ * @param   Size            bytes accessed
+ *
+ * @return  the window holding all the bytes, NULL when there is none
+ *
+ * @brief   memory windows are served ahead of the registers
+ *
+ *
+ */
+
+static PTR_SDBSIM_WINDOW sdbsimFindWindow (__IN__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ U32 Address, __IN__ U32 Size)
+{
+
+    U32 index;
+    PTR_SDBSIM_WINDOW ptrWindow;
+
+    for (index = 0; index < PtrSimulator->WindowCount; index++)
+    {
+        ptrWindow = &PtrSimulator->PtrWindows[index];
+
+        if ((Address >= ptrWindow->Address) && ((Address - ptrWindow->Address) + Size <= ptrWindow->Size))
+        {
+            return (ptrWindow);
+        }
+    }
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sdbsimMemoryRead ()
+ *
+ * @param   PtrSimulator    simulator serving the read
+ *
+ * @param   Address         address to read
+ *
+ * @param   Size            1, 2 or 4
+ *
+ * @return  value read
+ *
+ * @brief   read from a memory window or from the register snapshot, byte and
+ *          word reads take their part of the aligned register
+ *
+ *
+ */
+
+static U32 sdbsimMemoryRead (__IN__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ U32 Address, __IN__ U32 Size)
+{
+
+    U32 index;
+    U32 value = 0;
+    PTR_SDBSIM_WINDOW ptrWindow;
+
+    ptrWindow = sdbsimFindWindow (PtrSimulator, Address, Size);
+
+    if (ptrWindow != NULL)
+    {
+        /* Little endian memory like on the chip */
+        for (index = 0; index < Size; index++)
+        {
+            value |= (U32) ptrWindow->PtrData[(Address - ptrWindow->Address) + index] << (index * 8);
+        }
+
+        return (value);
+    }
+
+    if (PtrSimulator->PtrRegisterModel == NULL)
+    {
+        return (0);
+    }
+
+    PtrSimulator->PtrRegisterModel->ReadCount++;
+
+    value = lrmiReadRegister (PtrSimulator->PtrRegisterModel, Address & ~3);
+
+    if (Size == 4)
+    {
+        return (value);
+    }
+
+    value >>= ((Address & 3) * 8);
+
+    return ((Size == 1) ? (value & 0xFF) : (value & 0xFFFF));
+
+}
+
+/**
+ *
+ * @method  sdbsimMemoryWrite ()
+ *
+ * @param   PtrSimulator    simulator serving the write
+ *
+ * @param   Address         address to write
+ *
+ * @param   Size            1, 2 or 4
+ *
+ * @param   Value           value to write
+ *
+ * @return  none
+ *
+ * @brief   write into a memory window or into the register snapshot, byte and
+ *          word writes merge into the aligned register
+ *
+ *
+ */
+
+static VOID sdbsimMemoryWrite (__IN__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ U32 Address, __IN__ U32 Size, __IN__ U32 Value)
+{
+
+    U32 index;
+    U32 shift;
+    U32 mask;
+    U32 current;
+    PTR_SDBSIM_WINDOW ptrWindow;
+
+    ptrWindow = sdbsimFindWindow (PtrSimulator, Address, Size);
+
+    if (ptrWindow != NULL)
+    {
+        for (index = 0; index < Size; index++)
+        {
+            ptrWindow->PtrData[(Address - ptrWindow->Address) + index] = (U8) (Value >> (index * 8));
+        }
+
+        return;
+    }
+
+    if (PtrSimulator->PtrRegisterModel == NULL)
+    {
+        return;
+    }
+
+    PtrSimulator->PtrRegisterModel->WriteCount++;
+
+    if (Size != 4)
+    {
+        shift = (Address & 3) * 8;
+        mask = ((Size == 1) ? 0xFF : 0xFFFF) << shift;
+
+        current = lrmiReadRegister (PtrSimulator->PtrRegisterModel, Address & ~3);
+
+        Value = (current & ~mask) | ((Value << shift) & mask);
+    }
+
+    lrmiWriteRegister (PtrSimulator->PtrRegisterModel, Address & ~3, Value);
+
+}
+
+/**
+ *
+ * @method  sdbsimRespond ()
+ *
+ * @param   PtrSimulator    simulator sending the response
+ *
+ * @param   Value           data of the response, most significant byte first
+ *
+ * @param   Size            data bytes, 0 for the trailer only
+ *
+ * @param   Arrival         time the command was handed to the line
+ *
+ * @return  none
+ *
+ * @brief   send one response at the time the paced line would deliver it.
+ *          The command takes its wire time on the receive line, the firmware
+ *          its turnaround and the response waits for the transmit line, so
+ *          commands sent back to back overlap like on the real port. Noise
+ *          and drops are applied here.
+ *
+ *
+ */
+
+static VOID sdbsimRespond (__INOUT__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ U32 Value, __IN__ U32 Size, __IN__ unsigned long long Arrival)
+{
+
+    U8 response[sizeof (U32) + 1];
+    U32 index;
+    unsigned long long byteTime = 0;
+    unsigned long long ready;
+    unsigned long long now;
+
+    if (PtrSimulator->BitsPerSecond != 0)
+    {
+        byteTime = (SDBSIM_BITS_PER_BYTE * 1000000ULL) / PtrSimulator->BitsPerSecond;
+    }
+
+    if (PtrSimulator->ReceiveClock < Arrival)
+    {
+        PtrSimulator->ReceiveClock = Arrival;
+    }
+
+    PtrSimulator->ReceiveClock += byteTime * PtrSimulator->CommandSize;
+
+    ready = PtrSimulator->ReceiveClock + PtrSimulator->TurnaroundMicroSeconds;
+
+    if (PtrSimulator->TransmitClock < ready)
+    {
+        PtrSimulator->TransmitClock = ready;
+    }
+
+    PtrSimulator->TransmitClock += byteTime * (Size + 1);
+
+    for (index = 0; index < Size; index++)
+    {
+        response[index] = (U8) (Value >> ((Size - 1 - index) * 8));
+    }
+
+    response[Size] = SDBSIM_RESPONSE_TRAILER;
+
+    if ((PtrSimulator->DropPpm != 0) && (sdbsimNextRandom (PtrSimulator) < PtrSimulator->DropPpm))
+    {
+        PtrSimulator->DropCount++;
+        return;
+    }
+
+    if (PtrSimulator->NoisePpm != 0)
+    {
+        for (index = 0; index <= Size; index++)
+        {
+            if (sdbsimNextRandom (PtrSimulator) < PtrSimulator->NoisePpm)
+            {
+                response[index] ^= (U8) (1 << (sdbsimNextRandom (PtrSimulator) % 8));
+                PtrSimulator->NoiseCount++;
+            }
+        }
+    }
+
+    now = sdbsimNow ();
+
+    if (PtrSimulator->TransmitClock > now)
+    {
+        sosiMicroSleep ((U32) (PtrSimulator->TransmitClock - now));
+    }
+
+    if (write (PtrSimulator->MasterHandle, response, Size + 1) > 0)
+    {
+        PtrSimulator->ByteCount += Size + 1;
+    }
+
+}
+
+/**
+ *
+ * @method  sdbsimExecuteCommand ()
+ *
+ * @param   PtrSimulator    simulator with a complete command
+ *
+ * @param   Arrival         time the command was handed to the line
+ *
+ * @return  none
+ *
+ * @brief   serve the read or write and answer it
+ *
+ *
+ */
+
+static VOID sdbsimExecuteCommand (__INOUT__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ unsigned long long Arrival)
+{
+
+    PU8 ptrCommand = PtrSimulator->Command;
+    U32 address;
+    U32 size;
+    U32 value = 0;
+    U32 index;
+
+    PtrSimulator->CommandCount++;
+
+    if (ptrCommand[0] == 'n')
+    {
+        PtrSimulator->LastReadAddress += 4;
+
+        sdbsimRespond (PtrSimulator, sdbsimMemoryRead (PtrSimulator, PtrSimulator->LastReadAddress, 4), 4, Arrival);
+
+        return;
+    }
+
+    size = ptrCommand[1];
+
+    address = ((U32) ptrCommand[2] << 24) | ((U32) ptrCommand[3] << 16) | ((U32) ptrCommand[4] << 8) | (U32) ptrCommand[5];
+
+    if (ptrCommand[0] == 'G')
+    {
+        PtrSimulator->LastReadAddress = address;
+
+        sdbsimRespond (PtrSimulator, sdbsimMemoryRead (PtrSimulator, address, size), size, Arrival);
+
+        return;
+    }
+
+    for (index = 0; index < size; index++)
+    {
+        value = (value << 8) | ptrCommand[6 + index];
+    }
+
+    sdbsimMemoryWrite (PtrSimulator, address, size, value);
+
+    sdbsimRespond (PtrSimulator, 0, 0, Arrival);
+
+}
+
+/**
+ *
+ * @method  sdbsimReceiveByte ()
+ *
+ * @param   PtrSimulator    simulator receiving
+ *
+ * @param   Data            next byte from the host
+ *
+ * @param   Arrival         time the byte was handed to the line
+ *
+ * @return  none
+ *
+ * @brief   collect the bytes of a command and execute it once complete. A
+ *          byte which can not continue a command drops what was collected,
+ *          the parser then looks for the next command byte like the firmware
+ *          does after line noise.
+ *
+ *
+ */
+
+static VOID sdbsimReceiveByte (__INOUT__ PTR_SDB_SIMULATOR PtrSimulator, __IN__ U8 Data, __IN__ unsigned long long Arrival)
+{
+
+    PU8 ptrCommand = PtrSimulator->Command;
+    U32 expected = 0;
+
+    if (PtrSimulator->CommandSize == 0)
+    {
+        /* Only a command byte can start a command, a lone '\r' is the console poke */
+        if ((Data == 'G') || (Data == 'n') || (Data == 'P'))
+        {
+            ptrCommand[PtrSimulator->CommandSize++] = Data;
+        }
+
+        else if (Data != '\r')
+        {
+            PtrSimulator->FramingErrorCount++;
+        }
+
+        return;
+    }
+
+    ptrCommand[PtrSimulator->CommandSize++] = Data;
+
+    if (ptrCommand[0] == 'n')
+    {
+        expected = 2;
+    }
+
+    else
+    {
+        if ((ptrCommand[1] != 1) && (ptrCommand[1] != 2) && (ptrCommand[1] != 4))
+        {
+            PtrSimulator->FramingErrorCount++;
+            PtrSimulator->CommandSize = 0;
+            return;
+        }
+
+        expected = (ptrCommand[0] == 'G') ? 7 : (7 + ptrCommand[1]);
+    }
+
+    if (PtrSimulator->CommandSize < expected)
+    {
+        return;
+    }
+
+    if (Data == '\r')
+    {
+        sdbsimExecuteCommand (PtrSimulator, Arrival);
+    }
+
+    else
+    {
+        PtrSimulator->FramingErrorCount++;
+    }
+
+    PtrSimulator->CommandSize = 0;
+
+}
+
+/**
+ *
+ * @method  sdbsimThread ()
+ *
+ * @param   PtrParam        the simulator
+ *
+ * @return  NULL
+ *
+ * @brief   serve the master side of the pseudo terminal until the simulator
+ *          is stopped through the wakeup pipe
+ *
+ *
+ */
+
+static VOID *sdbsimThread (__IN__ VOID *PtrParam)
+{
+
+    PTR_SDB_SIMULATOR ptrSimulator = (PTR_SDB_SIMULATOR) PtrParam;
+    struct pollfd descriptors[2];
+    U8 data[SDBSIM_RECEIVE_CHUNK_SIZE];
+    unsigned long long arrival;
+    int numRead;
+    int index;
+
+    descriptors[0].fd = ptrSimulator->MasterHandle;
+    descriptors[0].events = POLLIN;
+
+    descriptors[1].fd = ptrSimulator->WakeupHandle[0];
+    descriptors[1].events = POLLIN;
+
+    while (TRUE)
+    {
+
+        descriptors[0].revents = 0;
+        descriptors[1].revents = 0;
+
+        if (poll (descriptors, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        if (descriptors[1].revents)
+        {
+            break;
+        }
+
+        if ((descriptors[0].revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        numRead = read (ptrSimulator->MasterHandle, data, sizeof (data));
+
+        if (numRead < 1)
+        {
+            continue;
+        }
+
+        arrival = sdbsimNow ();
+
+        for (index = 0; index < numRead; index++)
+        {
+            sdbsimReceiveByte (ptrSimulator, data[index], arrival);
+        }
+
+    }
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sdbsimFreeSimulator ()
+ *
+ * @param   PtrSimulator    simulator to release, may be NULL
+ *
+ * @return  none
+ *
+ * @brief   stop the thread, close the pseudo terminal and release everything
+ *          loaded from the profile
+ *
+ *
+ */
+
+static VOID sdbsimFreeSimulator (__IN__ PTR_SDB_SIMULATOR PtrSimulator)
+{
+
+    U8 wakeup = 0;
+    U32 index;
+
+    if (PtrSimulator == NULL)
+    {
+        return;
+    }
+
+    if (PtrSimulator->ThreadStarted)
+    {
+        if (write (PtrSimulator->WakeupHandle[1], &wakeup, sizeof (wakeup)) == sizeof (wakeup))
+        {
+            pthread_join (PtrSimulator->Thread, NULL);
+        }
+    }
+
+    if (PtrSimulator->WakeupHandle[0] != -1)
+    {
+        close (PtrSimulator->WakeupHandle[0]);
+        close (PtrSimulator->WakeupHandle[1]);
+    }
+
+    if (PtrSimulator->SlaveHandle != -1)
+    {
+        close (PtrSimulator->SlaveHandle);
+    }
+
+    if (PtrSimulator->MasterHandle != -1)
+    {
+        close (PtrSimulator->MasterHandle);
+    }
+
+    if (PtrSimulator->PtrRegisterModel != NULL)
+    {
+        lrmiFreeModel (PtrSimulator->PtrRegisterModel);
+    }
+
+    for (index = 0; index < PtrSimulator->WindowCount; index++)
+    {
+        sosiMemFree (PtrSimulator->PtrWindows[index].PtrData);
+    }
+
+    sosiMemFree (PtrSimulator->PtrWindows);
+
+    sosiMemFree (PtrSimulator);
+
+}
+
+/**
+ *
+ * @method  sdbsimResolveFileName ()
+ *
+ * @param   PtrDirectory    directory of the profile, ends with '/' or is empty
+ *
+ * @param   PtrValue        file name as written in the profile
+ *
+ * @param   PtrFileName     receives the name to open
+ *
+ * @param   FileNameSize    size of PtrFileName
+ *
+ * @return  none
+ *
+ * @brief   relative names in the profile are taken from the profile directory
+ *
+ *
+ */
+
+static VOID sdbsimResolveFileName (
+    __IN__  const char  *PtrDirectory,
+    __IN__  const char  *PtrValue,
+    __OUT__ char        *PtrFileName,
+    __IN__  U32         FileNameSize
+)
+{
+
+    if (PtrValue[0] == '/')
+    {
+        sosiSprintf (PtrFileName, FileNameSize, "%s", PtrValue);
+    }
+
+    else
+    {
+        sosiSprintf (PtrFileName, FileNameSize, "%s%s", PtrDirectory, PtrValue);
+    }
+
+}
+
+/**
+ *
+ * @method  sdbsimLoadMemorySegment ()
+ *
+ * @param   PtrSegment      the [MEMORY] segment, one <hex address> = <file> per entry
+ *
+ * @param   PtrDirectory    directory of the profile
+ *
+ * @param   PtrSimulator    simulator being set up
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   load the memory windows
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sdbsimLoadMemorySegment (
+    __IN__    PTR_CONFIG_INI_DICTIONARY   PtrSegment,
+    __IN__    const char                  *PtrDirectory,
+    __INOUT__ PTR_SDB_SIMULATOR           PtrSimulator
+)
+{
+
+    U32 index;
+    U32 address = 0;
+    U32 size = 0;
+    PU8 ptrData = NULL;
+    char fileName[1024];
+    PTR_SDBSIM_WINDOW ptrWindows;
+    PTR_CONFIG_INI_ENTRIES ptrEntry;
+
+    for (index = 0; index < PtrSegment->TotalEntries; index++)
+    {
+        ptrEntry = &PtrSegment->PtrIniEntries[index];
+
+        if (sosiHexToInt (ptrEntry->Key, &address) != SCRUTINY_STATUS_SUCCESS)
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB simulator profile [%s]: invalid address '%s'", PtrSegment->SegmentName, ptrEntry->Key);
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        sdbsimResolveFileName (PtrDirectory, ptrEntry->Value, fileName, sizeof (fileName));
+
+        if (sosiFileBufferRead (fileName, &ptrData, &size))
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB simulator profile [%s]: unable to read '%s'", PtrSegment->SegmentName, fileName);
+            return (SCRUTINY_STATUS_FILE_OPEN_FAILED);
+        }
+
+        ptrWindows = (PTR_SDBSIM_WINDOW) sosiMemRealloc (PtrSimulator->PtrWindows,
+                                                         (PtrSimulator->WindowCount + 1) * sizeof (SDBSIM_WINDOW),
+                                                         PtrSimulator->WindowCount * sizeof (SDBSIM_WINDOW));
+
+        if (ptrWindows == NULL)
+        {
+            sosiMemFree (ptrData);
+            return (SCRUTINY_STATUS_NO_MEMORY);
+        }
+
+        PtrSimulator->PtrWindows = ptrWindows;
+
+        ptrWindows[PtrSimulator->WindowCount].Address = address;
+        ptrWindows[PtrSimulator->WindowCount].PtrData = ptrData;
+        ptrWindows[PtrSimulator->WindowCount].Size = size;
+
+        PtrSimulator->WindowCount++;
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sdbsimLoadSdbSegment ()
+ *
+ * @param   PtrSegment      the [SDB] segment of the profile
+ *
+ * @param   PtrDirectory    directory of the profile
+ *
+ * @param   PtrSimulator    simulator being set up
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   pick up the line timing, the noise and the register snapshot
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sdbsimLoadSdbSegment (
+    __IN__    PTR_CONFIG_INI_DICTIONARY   PtrSegment,
+    __IN__    const char                  *PtrDirectory,
+    __INOUT__ PTR_SDB_SIMULATOR           PtrSimulator
+)
+{
+
+    U32 index;
+    U32 latency = 0;
+    char fileName[1024];
+    PTR_CONFIG_INI_ENTRIES ptrEntry;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    for (index = 0; (status == SCRUTINY_STATUS_SUCCESS) && (index < PtrSegment->TotalEntries); index++)
+    {
+        ptrEntry = &PtrSegment->PtrIniEntries[index];
+
+        if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_BAUD_RATE) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrSimulator->BitsPerSecond = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_TURNAROUND) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrSimulator->TurnaroundMicroSeconds = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_NOISE) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrSimulator->NoisePpm = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_DROP) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrSimulator->DropPpm = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_SEED) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrSimulator->Random = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SDBSIM_KEY_REGISTERS) == SCRUTINY_STATUS_SUCCESS)
+        {
+            if (PtrSimulator->PtrRegisterModel != NULL)
+            {
+                lrmiFreeModel (PtrSimulator->PtrRegisterModel);
+                PtrSimulator->PtrRegisterModel = NULL;
+            }
+
+            sdbsimResolveFileName (PtrDirectory, ptrEntry->Value, fileName, sizeof (fileName));
+
+            /* Registers are reached through commands, the turnaround applies instead */
+            status = lrmiLoadSnapshot (fileName, &PtrSimulator->PtrRegisterModel, &latency);
+        }
+
+        else
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB simulator profile: unknown key '%s' ignored", ptrEntry->Key);
+        }
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB simulator profile: '%s = %s' failed (Status=%x)", ptrEntry->Key, ptrEntry->Value, status);
+        }
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sdbsimLoadProfile ()
+ *
+ * @param   PtrProfile      profile of the simulated port
+ *
+ * @param   PtrSimulator    simulator being set up
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   read the INI profile, all files are read up front so no file IO
+ *          is done while commands are served
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sdbsimLoadProfile (__IN__ const char *PtrProfile, __INOUT__ PTR_SDB_SIMULATOR PtrSimulator)
+{
+
+    char directory[1024];
+    U32 index;
+    U32 separator = 0;
+    PTR_CONFIG_INI_DICTIONARY ptrDictionary = NULL;
+    PTR_CONFIG_INI_DICTIONARY ptrSegment = NULL;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    /* Everything up to and including the last '/' */
+    sosiSprintf (directory, sizeof (directory), "%s", PtrProfile);
+
+    for (index = 0; directory[index] != '\0'; index++)
+    {
+        if (directory[index] == '/')
+        {
+            separator = index + 1;
+        }
+    }
+
+    directory[separator] = '\0';
+
+    if (lcpiParserProcessINIFile (PtrProfile, &ptrDictionary))
+    {
+        gPtrLoggerGeneric->logiDebug ("Unable to process the SDB simulator profile '%s'", PtrProfile);
+        return (SCRUTINY_STATUS_FILE_OPEN_FAILED);
+    }
+
+    for (ptrSegment = ptrDictionary; (ptrSegment != NULL) && (status == SCRUTINY_STATUS_SUCCESS); ptrSegment = ptrSegment->PtrNext)
+    {
+        if (ptrSegment->PtrIniEntries == NULL)
+        {
+            continue;
+        }
+
+        if (sosiStringCompare (ptrSegment->SegmentName, SDBSIM_SEGMENT_SDB) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sdbsimLoadSdbSegment (ptrSegment, directory, PtrSimulator);
+        }
+
+        else if (sosiStringCompare (ptrSegment->SegmentName, SDBSIM_SEGMENT_MEMORY) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sdbsimLoadMemorySegment (ptrSegment, directory, PtrSimulator);
+        }
+
+        else
+        {
+            gPtrLoggerGeneric->logiDebug ("SDB simulator profile: unknown segment [%s] ignored", ptrSegment->SegmentName);
+        }
+    }
+
+    lcpiParserDestroyDictionary (ptrDictionary);
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sdbsimOpenPort ()
+ *
+ * @param   PtrSimulator    simulator being set up
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   create the pseudo terminal in raw mode and start serving it
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sdbsimOpenPort (__INOUT__ PTR_SDB_SIMULATOR PtrSimulator)
+{
+
+    struct termios options;
+
+    PtrSimulator->MasterHandle = posix_openpt (O_RDWR | O_NOCTTY);
+
+    if (PtrSimulator->MasterHandle == -1)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    if ((grantpt (PtrSimulator->MasterHandle) != 0) ||
+        (unlockpt (PtrSimulator->MasterHandle) != 0) ||
+        (ptsname_r (PtrSimulator->MasterHandle, PtrSimulator->PortName, sizeof (PtrSimulator->PortName)) != 0))
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    PtrSimulator->SlaveHandle = open (PtrSimulator->PortName, O_RDWR | O_NOCTTY);
+
+    if (PtrSimulator->SlaveHandle == -1)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    /* No echo and no line discipline, the SDB protocol is binary */
+    if (tcgetattr (PtrSimulator->SlaveHandle, &options) == 0)
+    {
+        cfmakeraw (&options);
+        tcsetattr (PtrSimulator->SlaveHandle, TCSANOW, &options);
+    }
+
+    if (pipe (PtrSimulator->WakeupHandle) != 0)
+    {
+        PtrSimulator->WakeupHandle[0] = -1;
+        PtrSimulator->WakeupHandle[1] = -1;
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    if (pthread_create (&PtrSimulator->Thread, NULL, sdbsimThread, (VOID *) PtrSimulator))
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    PtrSimulator->ThreadStarted = TRUE;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sdbsimiStopSimulator ()
+ *
+ * @return  none
+ *
+ * @brief   stop the running simulator, its devices have to be freed before
+ *
+ *
+ */
+
+VOID sdbsimiStopSimulator ()
+{
+
+    PTR_SDB_SIMULATOR ptrSimulator = sPtrSdbSimulator;
+
+    if (ptrSimulator == NULL)
+    {
+        return;
+    }
+
+    sPtrSdbSimulator = NULL;
+
+    gPtrLoggerGeneric->logiDebug ("SDB simulator %s stopped after %d commands and %llu bytes, %d framing errors, %d bytes of noise, %d responses dropped, %d register reads, %d register writes",
+                                  ptrSimulator->PortName, ptrSimulator->CommandCount, ptrSimulator->ByteCount,
+                                  ptrSimulator->FramingErrorCount, ptrSimulator->NoiseCount, ptrSimulator->DropCount,
+                                  (ptrSimulator->PtrRegisterModel != NULL) ? ptrSimulator->PtrRegisterModel->ReadCount : 0,
+                                  (ptrSimulator->PtrRegisterModel != NULL) ? ptrSimulator->PtrRegisterModel->WriteCount : 0);
+
+    sdbsimFreeSimulator (ptrSimulator);
+
+}
+
+/**
+ *
+ * @method  sdbsimiDiscoverDevices ()
+ *
+ * @param   PtrDiscoveryParams  discovery parameters holding the profile
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS when the simulated port answered and its
+ *          device was added, SCRUTINY_STATUS_IGNORE when no profile is
+ *          configured, otherwise the failure status
+ *
+ * @brief   start a simulated SDB port and run the regular serial debug
+ *          discovery on it. The device found is a plain SDB device on the
+ *          pseudo terminal, reconnecting reopens the same port. The profile
+ *          has to provide what the qualification reads, e.g. the flash
+ *          signature and chip ID registers of an expander.
+ *
+ *
+ */
+
+SCRUTINY_STATUS sdbsimiDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams)
+{
+
+    PTR_SDB_SIMULATOR ptrSimulator = NULL;
+    PTR_SCRUTINY_DISCOVERY_PARAMS ptrSerialParams = NULL;
+    SCRUTINY_STATUS status;
+
+    if ((PtrDiscoveryParams == NULL) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulatorType != SCRUTINY_SIMULATOR_TYPE_SDB_PROFILE) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile[0] == '\0'))
+    {
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
+    gPtrLoggerGeneric->logiFunctionEntry ("sdbsimiDiscoverDevices (Profile=%s)", PtrDiscoveryParams->u.SimulatorConfig.SimulationFile);
+
+    /* The devices of the previous discovery are gone, so is the use of its port */
+    sdbsimiStopSimulator ();
+
+    ptrSimulator = (PTR_SDB_SIMULATOR) sosiMemAlloc (sizeof (SDB_SIMULATOR));
+    ptrSerialParams = (PTR_SCRUTINY_DISCOVERY_PARAMS) sosiMemAlloc (sizeof (SCRUTINY_DISCOVERY_PARAMS));
+
+    if ((ptrSimulator == NULL) || (ptrSerialParams == NULL))
+    {
+        sosiMemFree (ptrSimulator);
+        sosiMemFree (ptrSerialParams);
+
+        gPtrLoggerGeneric->logiFunctionExit ("sdbsimiDiscoverDevices (Memory Allocation)");
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
+
+    sosiMemSet (ptrSimulator, 0, sizeof (SDB_SIMULATOR));
+    sosiMemSet (ptrSerialParams, 0, sizeof (SCRUTINY_DISCOVERY_PARAMS));
+
+    ptrSimulator->MasterHandle = -1;
+    ptrSimulator->SlaveHandle = -1;
+    ptrSimulator->WakeupHandle[0] = -1;
+    ptrSimulator->WakeupHandle[1] = -1;
+    ptrSimulator->Random = 1;
+
+    status = sdbsimLoadProfile (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile, ptrSimulator);
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        status = sdbsimOpenPort (ptrSimulator);
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        sdbsimFreeSimulator (ptrSimulator);
+        sosiMemFree (ptrSerialParams);
+
+        gPtrLoggerGeneric->logiFunctionExit ("sdbsimiDiscoverDevices (Status=%x)", status);
+        return (status);
+    }
+
+    gPtrLoggerGeneric->logiDebug ("SDB simulator on %s, %d bps, %d us turnaround, noise %d ppm, drop %d ppm, %d memory windows",
+                                  ptrSimulator->PortName, ptrSimulator->BitsPerSecond, ptrSimulator->TurnaroundMicroSeconds,
+                                  ptrSimulator->NoisePpm, ptrSimulator->DropPpm, ptrSimulator->WindowCount);
+
+    sPtrSdbSimulator = ptrSimulator;
+
+    sosiStringCopy (ptrSerialParams->u.SerialConfig.DeviceName, ptrSimulator->PortName);
+
+    status = sdbiConnectSdb (ptrSerialParams);
+
+    sosiMemFree (ptrSerialParams);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        sdbsimiStopSimulator ();
+    }
+
+    gPtrLoggerGeneric->logiFunctionExit ("sdbsimiDiscoverDevices (Status=%x)", status);
+
+    return (status);
+
+}
+
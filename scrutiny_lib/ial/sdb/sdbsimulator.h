@@ -0,0 +1,145 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+
+#ifndef __SDB_SIMULATOR__H__
+#define __SDB_SIMULATOR__H__
+
+/*
+ * SDB debug port simulated behind a pseudo terminal. The library opens the slave side
+ * like a real debug cable, so the serial layer, the SDB commands and the SDB discovery
+ * states all run unchanged. The simulator serves the binary SDB commands
+ *
+ *     'G' <size> <address[4]> '\r'                 read 1, 2 or 4 bytes
+ *     'n' '\r'                                     read the dword behind the last read
+ *     'P' <size> <address[4]> <data[size]> '\r'    write 1, 2 or 4 bytes
+ *
+ * Addresses and data are sent most significant byte first. Every response ends with
+ * SDBSIM_RESPONSE_TRAILER, a write answers with the trailer only.
+ *
+ * The profile is an INI file, file names not starting with '/' are taken relative to
+ * the directory of the profile.
+ *
+ *   [SDB]
+ *   BAUD_RATE     = <decimal>      line speed both directions are paced at, 10 bits per
+ *                                  byte, 0 or missing for no pacing
+ *   TURNAROUND_US = <decimal>      firmware time from the end of a command to the
+ *                                  start of its response
+ *   NOISE_PPM     = <decimal>      response bytes with one bit flipped, per million
+ *   DROP_PPM      = <decimal>      responses lost on the line, per million
+ *   SEED          = <decimal>      start value of the noise generator, runs with the
+ *                                  same seed see the same noise
+ *   REGISTERS     = <file>         register snapshot, see libregmodel.h
+ *
+ *   [MEMORY]      <address> = <file>   memory windows served ahead of the registers,
+ *                                      e.g. the flash image behind the flash window
+ *
+ * Addresses are in hex. Writes into a memory window are kept in memory only, the files
+ * are never modified.
+ */
+
+#define SDBSIM_SEGMENT_SDB                  "SDB"
+#define SDBSIM_SEGMENT_MEMORY               "MEMORY"
+
+#define SDBSIM_KEY_BAUD_RATE                "BAUD_RATE"
+#define SDBSIM_KEY_TURNAROUND               "TURNAROUND_US"
+#define SDBSIM_KEY_NOISE                    "NOISE_PPM"
+#define SDBSIM_KEY_DROP                     "DROP_PPM"
+#define SDBSIM_KEY_SEED                     "SEED"
+#define SDBSIM_KEY_REGISTERS                "REGISTERS"
+
+#define SDBSIM_RESPONSE_TRAILER             ('>')
+
+/* Longest command, a dword write */
+#define SDBSIM_MAX_COMMAND_SIZE             (11)
+
+#define SDBSIM_BITS_PER_BYTE                (10)
+
+#define SDBSIM_RECEIVE_CHUNK_SIZE           (4 * 1024)
+
+typedef struct _SDBSIM_WINDOW
+{
+    U32                 Address;
+    PU8                 PtrData;
+    U32                 Size;
+
+} SDBSIM_WINDOW, *PTR_SDBSIM_WINDOW;
+
+typedef struct _SDB_SIMULATOR
+{
+    int                     MasterHandle;
+    int                     SlaveHandle;        /* kept open, so the port survives the host closing it */
+    int                     WakeupHandle[2];    /* [0] read end, [1] write end */
+
+    pthread_t               Thread;
+    BOOLEAN                 ThreadStarted;
+
+    char                    PortName[256];
+
+    U32                     BitsPerSecond;
+    U32                     TurnaroundMicroSeconds;
+    U32                     NoisePpm;
+    U32                     DropPpm;
+    U32                     Random;
+
+    PTR_LRM_REGISTER_MODEL  PtrRegisterModel;
+
+    PTR_SDBSIM_WINDOW       PtrWindows;
+    U32                     WindowCount;
+
+    /* Command being received and the address the 'n' command continues from */
+    U8                      Command[SDBSIM_MAX_COMMAND_SIZE];
+    U32                     CommandSize;
+    U32                     LastReadAddress;
+
+    /* Time in micro seconds at which each direction of the line is free again */
+    unsigned long long      ReceiveClock;
+    unsigned long long      TransmitClock;
+
+    /* Traffic counters, reported when the simulator is stopped */
+    U32                     CommandCount;
+    U32                     FramingErrorCount;
+    U32                     NoiseCount;
+    U32                     DropCount;
+    unsigned long long      ByteCount;
+
+} SDB_SIMULATOR, *PTR_SDB_SIMULATOR;
+
+SCRUTINY_STATUS sdbsimiDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams);
+
+VOID sdbsimiStopSimulator ();
+
+#endif /* __SDB_SIMULATOR__H__ */
+
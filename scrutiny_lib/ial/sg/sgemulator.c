@@ -0,0 +1,1359 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+#include "libincludes.h"
+#include "sglinux.h"
+#include "sgemulator.h"
+
+/**
+ *
+ * @method  sgemFindBuffer ()
+ *
+ * @param   PtrList         buffers to search
+ *
+ * @param   Key             buffer ID, address or page code
+ *
+ * @return  the buffer, NULL when the emulator has none for the key
+ *
+ * @brief   look up a region, memory window or page by its key
+ *
+ *
+ */
+
+static PTR_SGEM_BUFFER sgemFindBuffer (__IN__ PTR_SGEM_BUFFER_LIST PtrList, __IN__ U32 Key)
+{
+
+    U32 index;
+
+    for (index = 0; index < PtrList->Count; index++)
+    {
+        if (PtrList->PtrBuffers[index].Key == Key)
+        {
+            return (&PtrList->PtrBuffers[index]);
+        }
+    }
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sgemFindWindow ()
+ *
+ * @param   PtrList         memory windows of the emulator
+ *
+ * @param   Address         start address of the access
+ *
+ * @param   Size            bytes accessed
+ *
+ * @return  the window holding the whole access, NULL if there is none
+ *
+ * @brief   memory windows are looked up by range, their key is the start address
+ *
+ *
+ */
+
+static PTR_SGEM_BUFFER sgemFindWindow (__IN__ PTR_SGEM_BUFFER_LIST PtrList, __IN__ U32 Address, __IN__ U32 Size)
+{
+
+    U32 index;
+    PTR_SGEM_BUFFER ptrWindow;
+
+    for (index = 0; index < PtrList->Count; index++)
+    {
+        ptrWindow = &PtrList->PtrBuffers[index];
+
+        if ((Address >= ptrWindow->Key) &&
+            ((unsigned long long) Address + Size <= (unsigned long long) ptrWindow->Key + ptrWindow->Size))
+        {
+            return (ptrWindow);
+        }
+    }
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sgemAddBuffer ()
+ *
+ * @param   PtrList         list the buffer goes to
+ *
+ * @param   Key             buffer ID, address or page code
+ *
+ * @param   PtrData         contents, owned by the list from now on
+ *
+ * @param   Size            bytes in PtrData
+ *
+ * @return  the buffer, NULL when out of memory
+ *
+ * @brief   add a buffer to a list, an existing buffer with the same key is
+ *          replaced
+ *
+ *
+ */
+
+static PTR_SGEM_BUFFER sgemAddBuffer (__INOUT__ PTR_SGEM_BUFFER_LIST PtrList, __IN__ U32 Key, __IN__ PU8 PtrData, __IN__ U32 Size)
+{
+
+    PTR_SGEM_BUFFER ptrBuffer;
+
+    ptrBuffer = sgemFindBuffer (PtrList, Key);
+
+    if (ptrBuffer == NULL)
+    {
+        ptrBuffer = (PTR_SGEM_BUFFER) sosiMemRealloc (PtrList->PtrBuffers,
+                                                      (PtrList->Count + 1) * sizeof (SGEM_BUFFER),
+                                                      PtrList->Count * sizeof (SGEM_BUFFER));
+
+        if (ptrBuffer == NULL)
+        {
+            return (NULL);
+        }
+
+        PtrList->PtrBuffers = ptrBuffer;
+
+        ptrBuffer = &PtrList->PtrBuffers[PtrList->Count];
+        PtrList->Count++;
+    }
+
+    else
+    {
+        sosiMemFree (ptrBuffer->PtrData);
+    }
+
+    ptrBuffer->Key = Key;
+    ptrBuffer->PtrData = PtrData;
+    ptrBuffer->Size = Size;
+
+    return (ptrBuffer);
+
+}
+
+/**
+ *
+ * @method  sgemFreeBufferList ()
+ *
+ * @param   PtrList         list to release
+ *
+ * @return  none
+ *
+ * @brief   release every buffer of the list and the list itself
+ *
+ *
+ */
+
+static VOID sgemFreeBufferList (__INOUT__ PTR_SGEM_BUFFER_LIST PtrList)
+{
+
+    U32 index;
+
+    for (index = 0; index < PtrList->Count; index++)
+    {
+        sosiMemFree (PtrList->PtrBuffers[index].PtrData);
+    }
+
+    sosiMemFree (PtrList->PtrBuffers);
+
+    PtrList->PtrBuffers = NULL;
+    PtrList->Count = 0;
+
+}
+
+/**
+ *
+ * @method  sgemFreeEmulator ()
+ *
+ * @param   PtrEmulator     emulator to release, may be NULL
+ *
+ * @return  none
+ *
+ * @brief   release the emulator with everything loaded from its profile
+ *
+ *
+ */
+
+static VOID sgemFreeEmulator (__IN__ PTR_SG_EMULATOR PtrEmulator)
+{
+
+    if (PtrEmulator == NULL)
+    {
+        return;
+    }
+
+    if (PtrEmulator->PtrRegisterModel != NULL)
+    {
+        lrmiFreeModel (PtrEmulator->PtrRegisterModel);
+    }
+
+    sgemFreeBufferList (&PtrEmulator->Regions);
+    sgemFreeBufferList (&PtrEmulator->MemoryWindows);
+    sgemFreeBufferList (&PtrEmulator->DiagnosticPages);
+    sgemFreeBufferList (&PtrEmulator->ConfigPages);
+
+    sosiMemFree (PtrEmulator->PtrCliOutput);
+    sosiMemFree (PtrEmulator);
+
+}
+
+/**
+ *
+ * @method  sgemResolveFileName ()
+ *
+ * @param   PtrDirectory    directory of the profile, with the trailing '/'
+ *
+ * @param   PtrValue        file name given in the profile
+ *
+ * @param   PtrFileName     receives the name to open
+ *
+ * @param   FileNameSize    size of PtrFileName
+ *
+ * @return  none
+ *
+ * @brief   relative names in the profile are taken from the profile directory
+ *
+ *
+ */
+
+static VOID sgemResolveFileName (
+    __IN__  const char  *PtrDirectory,
+    __IN__  const char  *PtrValue,
+    __OUT__ char        *PtrFileName,
+    __IN__  U32         FileNameSize
+)
+{
+
+    if (PtrValue[0] == '/')
+    {
+        sosiSprintf (PtrFileName, FileNameSize, "%s", PtrValue);
+    }
+
+    else
+    {
+        sosiSprintf (PtrFileName, FileNameSize, "%s%s", PtrDirectory, PtrValue);
+    }
+
+}
+
+/**
+ *
+ * @method  sgemLoadBufferSegment ()
+ *
+ * @param   PtrSegment      profile segment, one <hex key> = <file> per entry
+ *
+ * @param   PtrDirectory    directory of the profile
+ *
+ * @param   PtrList         list the files are loaded into
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   load the files of a [REGIONS], [MEMORY], [DIAGNOSTIC] or
+ *          [CONFIG_PAGES] segment
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemLoadBufferSegment (
+    __IN__    PTR_CONFIG_INI_DICTIONARY   PtrSegment,
+    __IN__    const char                  *PtrDirectory,
+    __INOUT__ PTR_SGEM_BUFFER_LIST        PtrList
+)
+{
+
+    U32 index;
+    U32 key = 0;
+    U32 size = 0;
+    PU8 ptrData = NULL;
+    char fileName[1024];
+    PTR_CONFIG_INI_ENTRIES ptrEntry;
+
+    for (index = 0; index < PtrSegment->TotalEntries; index++)
+    {
+        ptrEntry = &PtrSegment->PtrIniEntries[index];
+
+        if (sosiHexToInt (ptrEntry->Key, &key) != SCRUTINY_STATUS_SUCCESS)
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator profile [%s]: invalid key '%s'", PtrSegment->SegmentName, ptrEntry->Key);
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        sgemResolveFileName (PtrDirectory, ptrEntry->Value, fileName, sizeof (fileName));
+
+        if (sosiFileBufferRead (fileName, &ptrData, &size))
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator profile [%s]: unable to read '%s'", PtrSegment->SegmentName, fileName);
+            return (SCRUTINY_STATUS_FILE_OPEN_FAILED);
+        }
+
+        if (sgemAddBuffer (PtrList, key, ptrData, size) == NULL)
+        {
+            sosiMemFree (ptrData);
+            return (SCRUTINY_STATUS_NO_MEMORY);
+        }
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgemLoadExpanderSegment ()
+ *
+ * @param   PtrSegment      the [EXPANDER] segment of the profile
+ *
+ * @param   PtrDirectory    directory of the profile
+ *
+ * @param   PtrEmulator     emulator being set up
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   pick up the timing, the register snapshot and the CLI output
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemLoadExpanderSegment (
+    __IN__    PTR_CONFIG_INI_DICTIONARY   PtrSegment,
+    __IN__    const char                  *PtrDirectory,
+    __INOUT__ PTR_SG_EMULATOR             PtrEmulator
+)
+{
+
+    U32 index;
+    U32 latency = 0;
+    char fileName[1024];
+    PTR_CONFIG_INI_ENTRIES ptrEntry;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    for (index = 0; (status == SCRUTINY_STATUS_SUCCESS) && (index < PtrSegment->TotalEntries); index++)
+    {
+        ptrEntry = &PtrSegment->PtrIniEntries[index];
+
+        if (sosiStringCompare (ptrEntry->Key, SGEM_KEY_LATENCY) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrEmulator->LatencyMicroSeconds = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SGEM_KEY_THROUGHPUT) == SCRUTINY_STATUS_SUCCESS)
+        {
+            PtrEmulator->KBytesPerSecond = sosiAtoi (ptrEntry->Value);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SGEM_KEY_MAX_TRANSFER) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sosiHexToInt (ptrEntry->Value, &PtrEmulator->MaxTransferSize);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SGEM_KEY_REGISTERS) == SCRUTINY_STATUS_SUCCESS)
+        {
+            if (PtrEmulator->PtrRegisterModel != NULL)
+            {
+                lrmiFreeModel (PtrEmulator->PtrRegisterModel);
+                PtrEmulator->PtrRegisterModel = NULL;
+            }
+
+            sgemResolveFileName (PtrDirectory, ptrEntry->Value, fileName, sizeof (fileName));
+
+            /* Registers are reached through commands, the command latency applies instead */
+            status = lrmiLoadSnapshot (fileName, &PtrEmulator->PtrRegisterModel, &latency);
+        }
+
+        else if (sosiStringCompare (ptrEntry->Key, SGEM_KEY_CLI) == SCRUTINY_STATUS_SUCCESS)
+        {
+            sosiMemFree (PtrEmulator->PtrCliOutput);
+            PtrEmulator->PtrCliOutput = NULL;
+
+            sgemResolveFileName (PtrDirectory, ptrEntry->Value, fileName, sizeof (fileName));
+
+            if (sosiFileBufferRead (fileName, &PtrEmulator->PtrCliOutput, &PtrEmulator->CliOutputSize))
+            {
+                PtrEmulator->PtrCliOutput = NULL;
+                status = SCRUTINY_STATUS_FILE_OPEN_FAILED;
+            }
+        }
+
+        else
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator profile: unknown key '%s' ignored", ptrEntry->Key);
+        }
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator profile: '%s = %s' failed (Status=%x)", ptrEntry->Key, ptrEntry->Value, status);
+        }
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sgemLoadProfile ()
+ *
+ * @param   PtrProfile      profile of the emulated enclosure
+ *
+ * @param   PtrPtrEmulator  receives the emulator, released by sgemFreeEmulator()
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   build an emulator from the INI profile, all files are read up front
+ *          so no file IO is done while commands are served
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemLoadProfile (__IN__ const char *PtrProfile, __OUT__ PTR_SG_EMULATOR *PtrPtrEmulator)
+{
+
+    char directory[1024];
+    U32 index;
+    U32 separator = 0;
+    PTR_SG_EMULATOR ptrEmulator = NULL;
+    PTR_CONFIG_INI_DICTIONARY ptrDictionary = NULL;
+    PTR_CONFIG_INI_DICTIONARY ptrSegment = NULL;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_SUCCESS;
+
+    *PtrPtrEmulator = NULL;
+
+    /* Everything up to and including the last '/' */
+    sosiSprintf (directory, sizeof (directory), "%s", PtrProfile);
+
+    for (index = 0; directory[index] != '\0'; index++)
+    {
+        if (directory[index] == '/')
+        {
+            separator = index + 1;
+        }
+    }
+
+    directory[separator] = '\0';
+
+    if (lcpiParserProcessINIFile (PtrProfile, &ptrDictionary))
+    {
+        gPtrLoggerScsi->logiDebug ("Unable to process the emulator profile '%s'", PtrProfile);
+        return (SCRUTINY_STATUS_FILE_OPEN_FAILED);
+    }
+
+    ptrEmulator = (PTR_SG_EMULATOR) sosiMemAlloc (sizeof (SG_EMULATOR));
+
+    if (ptrEmulator == NULL)
+    {
+        lcpiParserDestroyDictionary (ptrDictionary);
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
+
+    sosiMemSet (ptrEmulator, 0, sizeof (SG_EMULATOR));
+
+    for (ptrSegment = ptrDictionary; (ptrSegment != NULL) && (status == SCRUTINY_STATUS_SUCCESS); ptrSegment = ptrSegment->PtrNext)
+    {
+        if (ptrSegment->PtrIniEntries == NULL)
+        {
+            continue;
+        }
+
+        if (sosiStringCompare (ptrSegment->SegmentName, SGEM_SEGMENT_EXPANDER) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sgemLoadExpanderSegment (ptrSegment, directory, ptrEmulator);
+        }
+
+        else if (sosiStringCompare (ptrSegment->SegmentName, SGEM_SEGMENT_REGIONS) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sgemLoadBufferSegment (ptrSegment, directory, &ptrEmulator->Regions);
+        }
+
+        else if (sosiStringCompare (ptrSegment->SegmentName, SGEM_SEGMENT_MEMORY) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sgemLoadBufferSegment (ptrSegment, directory, &ptrEmulator->MemoryWindows);
+        }
+
+        else if (sosiStringCompare (ptrSegment->SegmentName, SGEM_SEGMENT_DIAGNOSTIC) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sgemLoadBufferSegment (ptrSegment, directory, &ptrEmulator->DiagnosticPages);
+        }
+
+        else if (sosiStringCompare (ptrSegment->SegmentName, SGEM_SEGMENT_CONFIG_PAGES) == SCRUTINY_STATUS_SUCCESS)
+        {
+            status = sgemLoadBufferSegment (ptrSegment, directory, &ptrEmulator->ConfigPages);
+        }
+
+        else
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator profile: unknown segment [%s] ignored", ptrSegment->SegmentName);
+        }
+    }
+
+    lcpiParserDestroyDictionary (ptrDictionary);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        sgemFreeEmulator (ptrEmulator);
+        return (status);
+    }
+
+    gPtrLoggerScsi->logiDebug ("Emulator profile '%s': %d regions, %d memory windows, %d diagnostic pages, %d config pages",
+                               PtrProfile, ptrEmulator->Regions.Count, ptrEmulator->MemoryWindows.Count,
+                               ptrEmulator->DiagnosticPages.Count, ptrEmulator->ConfigPages.Count);
+
+    *PtrPtrEmulator = ptrEmulator;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgemCopyOut ()
+ *
+ * @param   PtrDestination  data phase of the command
+ *
+ * @param   Length          bytes asked for
+ *
+ * @param   PtrBuffer       buffer served
+ *
+ * @param   Offset          offset in the buffer to start at
+ *
+ * @return  none
+ *
+ * @brief   copy from a buffer, what lies beyond its end reads as zero
+ *
+ *
+ */
+
+static VOID sgemCopyOut (__OUT__ PU8 PtrDestination, __IN__ U32 Length, __IN__ PTR_SGEM_BUFFER PtrBuffer, __IN__ U32 Offset)
+{
+
+    U32 available = 0;
+
+    if (Offset < PtrBuffer->Size)
+    {
+        available = PtrBuffer->Size - Offset;
+    }
+
+    if (available > Length)
+    {
+        available = Length;
+    }
+
+    if (available)
+    {
+        sosiMemCopy (PtrDestination, PtrBuffer->PtrData + Offset, available);
+    }
+
+    if (available < Length)
+    {
+        sosiMemSet (PtrDestination + available, 0, Length - available);
+    }
+
+}
+
+/**
+ *
+ * @method  sgemMemoryRead ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   Address         start address
+ *
+ * @param   PtrData         data phase of the command
+ *
+ * @param   Length          bytes to read
+ *
+ * @return  none
+ *
+ * @brief   serve a memory read from a memory window holding the whole range,
+ *          else from the register model, registers not modelled read as zero
+ *
+ *
+ */
+
+static VOID sgemMemoryRead (__IN__ PTR_SG_EMULATOR PtrEmulator, __IN__ U32 Address, __OUT__ PU8 PtrData, __IN__ U32 Length)
+{
+
+    U32 offset;
+    U32 value;
+    PTR_SGEM_BUFFER ptrWindow;
+
+    ptrWindow = sgemFindWindow (&PtrEmulator->MemoryWindows, Address, Length);
+
+    if (ptrWindow != NULL)
+    {
+        sgemCopyOut (PtrData, Length, ptrWindow, Address - ptrWindow->Key);
+        return;
+    }
+
+    for (offset = 0; offset < Length; offset += sizeof (U32))
+    {
+        value = 0;
+
+        if (PtrEmulator->PtrRegisterModel != NULL)
+        {
+            value = lrmiReadRegister (PtrEmulator->PtrRegisterModel, Address + offset);
+        }
+
+        sosiMemCopy (PtrData + offset, &value, ((Length - offset) < sizeof (U32)) ? (Length - offset) : sizeof (U32));
+    }
+
+}
+
+/**
+ *
+ * @method  sgemMemoryWrite ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   Address         start address
+ *
+ * @param   PtrData         data phase of the command
+ *
+ * @param   Length          bytes to write
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   counterpart of sgemMemoryRead(), whole DWORDs go to the register model
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemMemoryWrite (__IN__ PTR_SG_EMULATOR PtrEmulator, __IN__ U32 Address, __IN__ PU8 PtrData, __IN__ U32 Length)
+{
+
+    U32 offset;
+    U32 value;
+    PTR_SGEM_BUFFER ptrWindow;
+
+    ptrWindow = sgemFindWindow (&PtrEmulator->MemoryWindows, Address, Length);
+
+    if (ptrWindow != NULL)
+    {
+        sosiMemCopy (ptrWindow->PtrData + (Address - ptrWindow->Key), PtrData, Length);
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    if (PtrEmulator->PtrRegisterModel == NULL)
+    {
+        /* Nothing to keep the value in, it is dropped like on unmapped space */
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    for (offset = 0; offset + sizeof (U32) <= Length; offset += sizeof (U32))
+    {
+        sosiMemCopy (&value, PtrData + offset, sizeof (U32));
+
+        if (lrmiWriteRegister (PtrEmulator->PtrRegisterModel, Address + offset, value) != SCRUTINY_STATUS_SUCCESS)
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgemReadCliOutput ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   Offset          offset in the packet stream
+ *
+ * @param   Size            bytes asked for, one packet
+ *
+ * @param   PtrData         data phase of the command
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   hand out the CLI output in packets the way the firmware does,
+ *          every packet but the last is full, so the offset the host
+ *          advances by header plus payload maps straight to a packet
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemReadCliOutput (__IN__ PTR_SG_EMULATOR PtrEmulator, __IN__ U32 Offset, __IN__ U32 Size, __OUT__ PU8 PtrData)
+{
+
+    U32 payload;
+    U32 sequence;
+    U32 dataOffset;
+    U32 count = 0;
+
+    if (Size <= SGEM_CLI_PACKET_HEADER_SIZE)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    payload = Size - SGEM_CLI_PACKET_HEADER_SIZE;
+    sequence = Offset / Size;
+    dataOffset = sequence * payload;
+
+    if (dataOffset < PtrEmulator->CliOutputSize)
+    {
+        count = PtrEmulator->CliOutputSize - dataOffset;
+        count = (count < payload) ? count : payload;
+    }
+
+    sosiMemSet (PtrData, 0, Size);
+
+    if (dataOffset + count >= PtrEmulator->CliOutputSize)
+    {
+        PtrData[0] = SGEM_CLI_PACKET_FLAG_LAST;
+    }
+
+    PtrData[2] = (U8) (sequence & 0xFF);
+    PtrData[3] = (U8) ((sequence >> 8) & 0xFF);
+    PtrData[4] = (U8) (count & 0xFF);
+    PtrData[5] = (U8) ((count >> 8) & 0xFF);
+
+    if (count)
+    {
+        sosiMemCopy (&PtrData[SGEM_CLI_PACKET_HEADER_SIZE], PtrEmulator->PtrCliOutput + dataOffset, count);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgemReadBuffer ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   PtrScsiRequest  READ BUFFER request
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   descriptor mode gives the region size, data mode a range of the
+ *          region, vendor mode the memory, config page, CLI or the head of
+ *          a region depending on the buffer ID
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemReadBuffer (__IN__ PTR_SG_EMULATOR PtrEmulator, __INOUT__ PTR_SCRUTINY_SCSI_PASSTHROUGH PtrScsiRequest)
+{
+
+    PU8 ptrCdb = PtrScsiRequest->Cdb;
+    PU8 ptrData = (PU8) PtrScsiRequest->PtrDataBuffer;
+    U32 offset;
+    U32 length;
+    PTR_SGEM_BUFFER ptrBuffer;
+
+    switch (ptrCdb[1] & 0x1F)
+    {
+        case SCSI_READ_MODE_DESCRIPTOR:
+        {
+            ptrBuffer = sgemFindBuffer (&PtrEmulator->Regions, ptrCdb[2]);
+
+            if ((ptrBuffer == NULL) || (PtrScsiRequest->DataBufferLength < sizeof (U32)))
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            /* Offset boundary, then the 24 bit buffer capacity */
+            ptrData[0] = 0;
+            ptrData[1] = (U8) ((ptrBuffer->Size >> 16) & 0xFF);
+            ptrData[2] = (U8) ((ptrBuffer->Size >> 8) & 0xFF);
+            ptrData[3] = (U8) (ptrBuffer->Size & 0xFF);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        case SCSI_READ_MODE_DATA:
+        {
+            offset = ((U32) ptrCdb[3] << 16) | ((U32) ptrCdb[4] << 8) | ptrCdb[5];
+            length = ((U32) ptrCdb[6] << 16) | ((U32) ptrCdb[7] << 8) | ptrCdb[8];
+
+            if ((PtrEmulator->MaxTransferSize != 0) && (length > PtrEmulator->MaxTransferSize))
+            {
+                gPtrLoggerScsi->logiDebug ("Emulator refused READ BUFFER of %x bytes", length);
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            ptrBuffer = sgemFindBuffer (&PtrEmulator->Regions, ptrCdb[2]);
+
+            if ((ptrBuffer == NULL) || (length > PtrScsiRequest->DataBufferLength))
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            sgemCopyOut (ptrData, length, ptrBuffer, offset);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        case SCSI_READ_MODE_VENDOR_SPECIFIC:
+        {
+            break;
+        }
+
+        default:
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+    }
+
+    length = PtrScsiRequest->DataBufferLength;
+
+    switch (ptrCdb[2])
+    {
+        case BRCM_SCSI_BUFFER_ID_MEMORY_RW_DWORD:
+        {
+            offset = ((U32) ptrCdb[3] << 24) | ((U32) ptrCdb[4] << 16) | ((U32) ptrCdb[5] << 8) | ptrCdb[6];
+            length = ((((U32) ptrCdb[7] << 8) | ptrCdb[8]) < length) ? (((U32) ptrCdb[7] << 8) | ptrCdb[8]) : length;
+
+            sgemMemoryRead (PtrEmulator, offset, ptrData, length);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        case BRCM_SCSI_BUFFER_ID_ETHERNET_CONFIG:
+        {
+            /* Config pages, the region in Cdb[7] is not told apart */
+            ptrBuffer = sgemFindBuffer (&PtrEmulator->ConfigPages, ((U32) ptrCdb[3] << 8) | ptrCdb[4]);
+
+            if (ptrBuffer == NULL)
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            sgemCopyOut (ptrData, length, ptrBuffer, 0);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        case BRCM_SCSI_BUFFER_ID_SCSI_TOOLBOX:
+        {
+            offset = ((U32) ptrCdb[3] << 16) | ((U32) ptrCdb[4] << 8) | ptrCdb[5];
+
+            return (sgemReadCliOutput (PtrEmulator, offset, length, ptrData));
+        }
+
+        default:
+        {
+            /* Firmware headers, read from the start of the region */
+            ptrBuffer = sgemFindBuffer (&PtrEmulator->Regions, ptrCdb[2]);
+
+            if (ptrBuffer == NULL)
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            sgemCopyOut (ptrData, length, ptrBuffer, 0);
+
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+    }
+
+}
+
+/**
+ *
+ * @method  sgemWriteBuffer ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   PtrScsiRequest  WRITE BUFFER request
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   data mode writes the in memory copy of a region, growing or
+ *          creating it, vendor mode writes the memory and takes CLI
+ *          commands, config pages and resets without acting on them
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgemWriteBuffer (__IN__ PTR_SG_EMULATOR PtrEmulator, __IN__ PTR_SCRUTINY_SCSI_PASSTHROUGH PtrScsiRequest)
+{
+
+    PU8 ptrCdb = PtrScsiRequest->Cdb;
+    PU8 ptrData = (PU8) PtrScsiRequest->PtrDataBuffer;
+    PU8 ptrRegion;
+    U32 offset;
+    U32 length;
+    PTR_SGEM_BUFFER ptrBuffer;
+
+    if ((ptrCdb[1] & 0x1F) == SCSI_WRITE_MODE_WRITE_DATA)
+    {
+        offset = ((U32) ptrCdb[3] << 16) | ((U32) ptrCdb[4] << 8) | ptrCdb[5];
+        length = ((U32) ptrCdb[6] << 16) | ((U32) ptrCdb[7] << 8) | ptrCdb[8];
+
+        if (((PtrEmulator->MaxTransferSize != 0) && (length > PtrEmulator->MaxTransferSize)) ||
+            (length > PtrScsiRequest->DataBufferLength))
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        ptrBuffer = sgemFindBuffer (&PtrEmulator->Regions, ptrCdb[2]);
+
+        if (ptrBuffer == NULL)
+        {
+            ptrBuffer = sgemAddBuffer (&PtrEmulator->Regions, ptrCdb[2], NULL, 0);
+
+            if (ptrBuffer == NULL)
+            {
+                return (SCRUTINY_STATUS_NO_MEMORY);
+            }
+        }
+
+        if (offset + length > ptrBuffer->Size)
+        {
+            ptrRegion = (PU8) sosiMemRealloc (ptrBuffer->PtrData, offset + length, ptrBuffer->Size);
+
+            if (ptrRegion == NULL)
+            {
+                return (SCRUTINY_STATUS_NO_MEMORY);
+            }
+
+            sosiMemSet (ptrRegion + ptrBuffer->Size, 0, offset + length - ptrBuffer->Size);
+
+            ptrBuffer->PtrData = ptrRegion;
+            ptrBuffer->Size = offset + length;
+        }
+
+        sosiMemCopy (ptrBuffer->PtrData + offset, ptrData, length);
+
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    if ((ptrCdb[1] & 0x1F) != SCSI_WRITE_MODE_VENDOR_SPECIFIC)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    switch (ptrCdb[2])
+    {
+        case BRCM_SCSI_BUFFER_ID_MEMORY_RW_DWORD:
+        {
+            offset = ((U32) ptrCdb[3] << 24) | ((U32) ptrCdb[4] << 16) | ((U32) ptrCdb[5] << 8) | ptrCdb[6];
+            length = ((U32) ptrCdb[7] << 8) | ptrCdb[8];
+            length = (length < PtrScsiRequest->DataBufferLength) ? length : PtrScsiRequest->DataBufferLength;
+
+            return (sgemMemoryWrite (PtrEmulator, offset, ptrData, length));
+        }
+
+        case BRCM_SCSI_BUFFER_ID_SCSI_TOOLBOX:
+        case BRCM_SCSI_BUFFER_ID_ETHERNET_CONFIG:
+        case BRCM_SCSI_BUFFER_ID_CHIP_RESET:
+        {
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+        default:
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+    }
+
+}
+
+/**
+ *
+ * @method  sgemPace ()
+ *
+ * @param   PtrEmulator     emulator
+ *
+ * @param   Length          bytes in the data phase
+ *
+ * @return  none
+ *
+ * @brief   hold the command for the configured latency plus the time the
+ *          data phase takes at the configured throughput
+ *
+ *
+ */
+
+static VOID sgemPace (__IN__ PTR_SG_EMULATOR PtrEmulator, __IN__ U32 Length)
+{
+
+    unsigned long long delay = PtrEmulator->LatencyMicroSeconds;
+
+    if (PtrEmulator->KBytesPerSecond != 0)
+    {
+        delay += ((unsigned long long) Length * 1000000ULL) / ((unsigned long long) PtrEmulator->KBytesPerSecond * 1024ULL);
+    }
+
+    if (delay != 0)
+    {
+        sosiMicroSleep ((U32) delay);
+    }
+
+}
+
+/**
+ *
+ * @method  sgemiPerformScsiPassthrough ()
+ *
+ * @param   PtrDevice       emulated device
+ *
+ * @param   PtrScsiRequest  request as it would go to the sg node
+ *
+ * @return  status indicating success or fail, a failure stands for a CHECK
+ *          CONDITION of the real device
+ *
+ * @brief   serve READ BUFFER, WRITE BUFFER, RECEIVE DIAGNOSTIC and TEST UNIT
+ *          READY from the emulator, paced like the enclosure in the profile
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgemiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SCSI_PASSTHROUGH PtrScsiRequest)
+{
+
+    PTR_SG_EMULATOR ptrEmulator = (PTR_SG_EMULATOR) PtrDevice->Handle.ScsiHandle.PtrEmulator;
+    PTR_SGEM_BUFFER ptrBuffer;
+    SCRUTINY_STATUS status = SCRUTINY_STATUS_FAILED;
+
+    if (ptrEmulator == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    if ((PtrScsiRequest->DataBufferLength != 0) && (PtrScsiRequest->PtrDataBuffer == NULL))
+    {
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    switch (PtrScsiRequest->Cdb[0])
+    {
+        case SCSI_COMMAND_READ_BUFFER:
+        {
+            status = sgemReadBuffer (ptrEmulator, PtrScsiRequest);
+            break;
+        }
+
+        case SCSI_COMMAND_WRITE_BUFFER:
+        {
+            status = sgemWriteBuffer (ptrEmulator, PtrScsiRequest);
+            break;
+        }
+
+        case SCSI_COMMAND_RECEIVE_DIAGNOSTIC:
+        {
+            ptrBuffer = sgemFindBuffer (&ptrEmulator->DiagnosticPages, PtrScsiRequest->Cdb[2]);
+
+            if (ptrBuffer != NULL)
+            {
+                sgemCopyOut ((PU8) PtrScsiRequest->PtrDataBuffer, PtrScsiRequest->DataBufferLength, ptrBuffer, 0);
+                status = SCRUTINY_STATUS_SUCCESS;
+            }
+
+            break;
+        }
+
+        case SCSI_COMMAND_TEST_UNIT_READY:
+        {
+            status = SCRUTINY_STATUS_SUCCESS;
+            break;
+        }
+
+        default:
+        {
+            gPtrLoggerScsi->logiDebug ("Emulator has no support for opcode %x", PtrScsiRequest->Cdb[0]);
+            break;
+        }
+    }
+
+    ptrEmulator->CommandCount++;
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        ptrEmulator->ByteCount += PtrScsiRequest->DataBufferLength;
+        sgemPace (ptrEmulator, PtrScsiRequest->DataBufferLength);
+    }
+
+    else
+    {
+        sgemPace (ptrEmulator, 0);
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sgemiReadBuffer ()
+ *
+ * @param   PtrDevice       emulated device
+ *
+ * @param   BufferId        buffer ID of the region
+ *
+ * @param   Offset          offset in the region to start at
+ *
+ * @param   Length          bytes to read
+ *
+ * @param   ChunkSize       bytes per READ BUFFER
+ *
+ * @param   PtrDestination  buffer of Length bytes the chunks land in, NULL to
+ *                          read through a chunk sized staging buffer
+ *
+ * @param   Handler         optional, called for every chunk once it arrived
+ *
+ * @param   PtrContext      passed through to the handler
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   sgiPipelinedReadBuffer() for an emulated node. The emulator
+ *          answers in line, so the chunks are read one after the other.
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgemiReadBuffer (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  U8                      BufferId,
+    __IN__  U32                     Offset,
+    __IN__  U32                     Length,
+    __IN__  U32                     ChunkSize,
+    __OUT__ PU8                     PtrDestination,
+    __IN__  SG_LINUX_CHUNK_HANDLER  Handler,
+    __IN__  PVOID                   PtrContext
+)
+{
+
+    SCRUTINY_SCSI_PASSTHROUGH   scsiRequest;
+    PU8                         ptrStaging = NULL;
+    PU8                         ptrChunk;
+    U32                         done;
+    U32                         chunkSize;
+    U32                         chunkOffset;
+    SCRUTINY_STATUS             status = SCRUTINY_STATUS_SUCCESS;
+
+    if ((Length == 0) || (ChunkSize == 0))
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    if (PtrDestination == NULL)
+    {
+        ptrStaging = sgiGetTransferBuffer (PtrDevice, ChunkSize);
+
+        if (ptrStaging == NULL)
+        {
+            return (SCRUTINY_STATUS_NO_MEMORY);
+        }
+    }
+
+    for (done = 0; done < Length; done += chunkSize)
+    {
+        chunkSize = ((Length - done) < ChunkSize) ? (Length - done) : ChunkSize;
+        chunkOffset = Offset + done;
+        ptrChunk = (PtrDestination != NULL) ? (PtrDestination + done) : ptrStaging;
+
+        sosiMemSet (&scsiRequest, 0, sizeof (SCRUTINY_SCSI_PASSTHROUGH));
+
+        scsiRequest.CdbLength = 10;
+        scsiRequest.DataDirection = DIRECTION_READ;
+        scsiRequest.PtrDataBuffer = (PVOID) ptrChunk;
+        scsiRequest.DataBufferLength = chunkSize;
+
+        scsiRequest.Cdb[0] = SCSI_COMMAND_READ_BUFFER;
+        scsiRequest.Cdb[1] = SCSI_READ_MODE_DATA;
+        scsiRequest.Cdb[2] = BufferId;
+        scsiRequest.Cdb[3] = (U8) (chunkOffset >> 16);
+        scsiRequest.Cdb[4] = (U8) (chunkOffset >> 8);
+        scsiRequest.Cdb[5] = (U8) (chunkOffset & 0xFF);
+        scsiRequest.Cdb[6] = (U8) (chunkSize >> 16);
+        scsiRequest.Cdb[7] = (U8) (chunkSize >> 8);
+        scsiRequest.Cdb[8] = (U8) (chunkSize & 0xFF);
+
+        status = sgemiPerformScsiPassthrough (PtrDevice, &scsiRequest);
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        if (Handler != NULL)
+        {
+            status = Handler (PtrContext, chunkOffset, ptrChunk, chunkSize);
+
+            if (status != SCRUTINY_STATUS_SUCCESS)
+            {
+                break;
+            }
+        }
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sgemiGetMaxTransferSize ()
+ *
+ * @param   PtrDevice       emulated device
+ *
+ * @return  MAX_TRANSFER of the profile, 0 when it has no limit
+ *
+ * @brief   stands in for the queue limits of a real sg node
+ *
+ *
+ */
+
+U32 sgemiGetMaxTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    PTR_SG_EMULATOR ptrEmulator = (PTR_SG_EMULATOR) PtrDevice->Handle.ScsiHandle.PtrEmulator;
+
+    if (ptrEmulator == NULL)
+    {
+        return (0);
+    }
+
+    return (ptrEmulator->MaxTransferSize);
+
+}
+
+/**
+ *
+ * @method  sgemiFreeEmulator ()
+ *
+ * @param   PtrDevice       device, emulated or not
+ *
+ * @return  none
+ *
+ * @brief   release the emulator behind the device, nothing to do for a real
+ *          sg node
+ *
+ *
+ */
+
+VOID sgemiFreeEmulator (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    PTR_SG_EMULATOR ptrEmulator = (PTR_SG_EMULATOR) PtrDevice->Handle.ScsiHandle.PtrEmulator;
+
+    if (ptrEmulator == NULL)
+    {
+        return;
+    }
+
+    gPtrLoggerScsi->logiDebug ("Emulated enclosure closed after %d commands and %llu bytes",
+                               ptrEmulator->CommandCount, ptrEmulator->ByteCount);
+
+    sgemFreeEmulator (ptrEmulator);
+
+    PtrDevice->Handle.ScsiHandle.PtrEmulator = NULL;
+
+}
+
+/**
+ *
+ * @method  sgemiDiscoverDevices ()
+ *
+ * @param   PtrDiscoveryParams  discovery parameters holding the profile
+ *
+ * @return  SCRUTINY_STATUS_SUCCESS when the emulated enclosure was added,
+ *          SCRUTINY_STATUS_IGNORE when no profile is configured, otherwise
+ *          the failure status
+ *
+ * @brief   add an emulated enclosure on the SCSI generic path. It is
+ *          qualified like a real sg node, so the profile has to provide
+ *          what the qualification reads, e.g. the flash signature and chip
+ *          ID registers of an expander and the running firmware region.
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgemiDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams)
+{
+
+    PTR_SCRUTINY_DEVICE ptrDevice = NULL;
+    PTR_SG_EMULATOR ptrEmulator = NULL;
+    SCRUTINY_STATUS status;
+
+    if ((PtrDiscoveryParams == NULL) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulatorType != SCRUTINY_SIMULATOR_TYPE_EXPANDER_PROFILE) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile[0] == '\0'))
+    {
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
+    gPtrLoggerScsi->logiFunctionEntry ("sgemiDiscoverDevices (Profile=%s)", PtrDiscoveryParams->u.SimulatorConfig.SimulationFile);
+
+    status = sgemLoadProfile (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile, &ptrEmulator);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerScsi->logiFunctionExit ("sgemiDiscoverDevices (Profile Status=%x)", status);
+        return (status);
+    }
+
+    ptrDevice = (PTR_SCRUTINY_DEVICE) sosiMemAlloc (sizeof (SCRUTINY_DEVICE));
+
+    if (ptrDevice == NULL)
+    {
+        sgemFreeEmulator (ptrEmulator);
+
+        gPtrLoggerScsi->logiFunctionExit ("sgemiDiscoverDevices (Memory Allocation)");
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
+
+    sosiMemSet (ptrDevice, 0, sizeof (SCRUTINY_DEVICE));
+
+    ptrDevice->HandleType = SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC;
+    ptrDevice->Handle.ScsiHandle.SgDeviceHandle = INVALID_HANDLE_VALUE;
+    ptrDevice->Handle.ScsiHandle.PtrEmulator = ptrEmulator;
+
+    status = bsdiQualifyBroadcomScsiDevice (ptrDevice);
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        ptrDevice->DeviceInfo.HandleType = ptrDevice->HandleType;
+
+        status = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice);
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        sgemiFreeEmulator (ptrDevice);
+        sgiFreeTransferBuffer (ptrDevice);
+        sosiMemFree (ptrDevice);
+    }
+
+    gPtrLoggerScsi->logiFunctionExit ("sgemiDiscoverDevices (Status=%x)", status);
+
+    return (status);
+
+}
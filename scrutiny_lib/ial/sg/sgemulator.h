@@ -0,0 +1,132 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+#ifndef __SG_EMULATOR__H__
+#define __SG_EMULATOR__H__
+
+/*
+ * Profile of an emulated enclosure, an INI file. File names not starting with '/'
+ * are taken relative to the directory of the profile.
+ *
+ *   [EXPANDER]
+ *   LATENCY_US      = <decimal>    added to every command
+ *   THROUGHPUT_KBPS = <decimal>    paces the data phase, 0 or missing for no limit
+ *   MAX_TRANSFER    = <hex>        larger data phases are refused like on a real node,
+ *                                  0 or missing for no limit
+ *   REGISTERS       = <file>       register snapshot, see libregmodel.h
+ *   CLI             = <file>       output returned for any firmware CLI command
+ *
+ *   [REGIONS]       <buffer id> = <file>   READ/WRITE BUFFER regions, e.g. firmware
+ *                                          images, traces, health logs, core dump
+ *   [MEMORY]        <address>   = <file>   memory windows served through the DWORD
+ *                                          memory buffer ID ahead of the registers
+ *   [DIAGNOSTIC]    <page>      = <file>   RECEIVE DIAGNOSTIC pages
+ *   [CONFIG_PAGES]  <page>      = <file>   firmware config pages, header included
+ *
+ * Buffer IDs, addresses and pages are in hex. Regions written by the host are kept
+ * in memory only, the files are never modified.
+ */
+
+#define SGEM_SEGMENT_EXPANDER               "EXPANDER"
+#define SGEM_SEGMENT_REGIONS                "REGIONS"
+#define SGEM_SEGMENT_MEMORY                 "MEMORY"
+#define SGEM_SEGMENT_DIAGNOSTIC             "DIAGNOSTIC"
+#define SGEM_SEGMENT_CONFIG_PAGES           "CONFIG_PAGES"
+
+#define SGEM_KEY_LATENCY                    "LATENCY_US"
+#define SGEM_KEY_THROUGHPUT                 "THROUGHPUT_KBPS"
+#define SGEM_KEY_MAX_TRANSFER               "MAX_TRANSFER"
+#define SGEM_KEY_REGISTERS                  "REGISTERS"
+#define SGEM_KEY_CLI                        "CLI"
+
+/* Header of a firmware CLI output packet: flags, reserved, sequence and size */
+#define SGEM_CLI_PACKET_HEADER_SIZE         (6)
+#define SGEM_CLI_PACKET_FLAG_LAST           (0x08)
+
+typedef struct _SGEM_BUFFER
+{
+    U32                 Key;            /* buffer ID, start address or page code */
+    PU8                 PtrData;
+    U32                 Size;
+
+} SGEM_BUFFER, *PTR_SGEM_BUFFER;
+
+typedef struct _SGEM_BUFFER_LIST
+{
+    PTR_SGEM_BUFFER     PtrBuffers;
+    U32                 Count;
+
+} SGEM_BUFFER_LIST, *PTR_SGEM_BUFFER_LIST;
+
+typedef struct _SG_EMULATOR
+{
+    U32                     LatencyMicroSeconds;
+    U32                     KBytesPerSecond;
+    U32                     MaxTransferSize;
+
+    PTR_LRM_REGISTER_MODEL  PtrRegisterModel;
+
+    SGEM_BUFFER_LIST        Regions;
+    SGEM_BUFFER_LIST        MemoryWindows;
+    SGEM_BUFFER_LIST        DiagnosticPages;
+    SGEM_BUFFER_LIST        ConfigPages;
+
+    PU8                     PtrCliOutput;
+    U32                     CliOutputSize;
+
+    /* Traffic counters, reported when the emulator is released */
+    U32                     CommandCount;
+    unsigned long long      ByteCount;
+
+} SG_EMULATOR, *PTR_SG_EMULATOR;
+
+SCRUTINY_STATUS sgemiDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams);
+
+SCRUTINY_STATUS sgemiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_SCRUTINY_SCSI_PASSTHROUGH PtrScsiRequest);
+
+SCRUTINY_STATUS sgemiReadBuffer (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  U8                      BufferId,
+    __IN__  U32                     Offset,
+    __IN__  U32                     Length,
+    __IN__  U32                     ChunkSize,
+    __OUT__ PU8                     PtrDestination,
+    __IN__  SG_LINUX_CHUNK_HANDLER  Handler,
+    __IN__  PVOID                   PtrContext);
+
+U32 sgemiGetMaxTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+VOID sgemiFreeEmulator (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+#endif /* __SG_EMULATOR__H__ */
@@ -71,14 +71,17 @@ SCRUTINY_STATUS sgiLocateScsiDevices()
  *
  * @param   PtrEntry        Pointer to the scsi device
  *
+ * @param   PtrIndex        Index of the sg node
+ *
  * @return  status indicating success or fail
  *
- * @brief   This function will scan the directory to locate expander
+ * @brief   This function will check if the directory entry is a sg node
+ *          and return its index
  *
  *
  */
 
-SCRUTINY_STATUS sgLinuxScanSelect (__IN__ const struct dirent * PtrEntry)
+SCRUTINY_STATUS sgLinuxScanSelect (__IN__ const struct dirent * PtrEntry, __OUT__ PU32 PtrIndex)
 {
     int idx;
 
@@ -87,18 +90,83 @@ SCRUTINY_STATUS sgLinuxScanSelect (__IN__ const struct dirent * PtrEntry)
 
         if (( idx >= 0 ) && (idx < MAX_SCSI_DEVS))
         {
+            *PtrIndex = (U32) idx;
 
-            /*
-             * We found one entry go and play around with it now.
-             */
+            return (SCRUTINY_STATUS_SUCCESS);
+        }
+
+    }
+
+    return (SCRUTINY_STATUS_FAILED);
 
-            return (sgLinuxCheckDevice (idx));
+}
 
+/**
+ *
+ * @method  sgLinuxCompareIndex ()
+ *
+ * @param   PtrFirst        Pointer to the first sg index
+ *
+ * @param   PtrSecond       Pointer to the second sg index
+ *
+ * @return  < 0, 0 or > 0 as for qsort
+ *
+ * @brief   Order the sg nodes by index so the devices are added in the same
+ *          order on every discovery
+ *
+ *
+ */
+
+static int sgLinuxCompareIndex (__IN__ const void *PtrFirst, __IN__ const void *PtrSecond)
+{
+
+    U32 first = *((const U32 *) PtrFirst);
+    U32 second = *((const U32 *) PtrSecond);
+
+    return ((first > second) - (first < second));
+
+}
+
+/**
+ *
+ * @method  sgLinuxDiscoveryWorker ()
+ *
+ * @param   PtrContext      Pointer to the shared SG_LINUX_DISCOVERY_CONTEXT
+ *
+ * @return  NULL
+ *
+ * @brief   Worker of the discovery pool. Picks the next sg node, probes and
+ *          qualifies it and leaves the qualified device in the slot of that
+ *          node. Nothing is added to the device manager from here.
+ *
+ *
+ */
+
+static void* sgLinuxDiscoveryWorker (__IN__ void *PtrContext)
+{
+
+    PTR_SG_LINUX_DISCOVERY_CONTEXT ptrContext = (PTR_SG_LINUX_DISCOVERY_CONTEXT) PtrContext;
+    U32 entry;
+
+    while (TRUE)
+    {
+
+        pthread_mutex_lock (&ptrContext->Lock);
+
+        entry = ptrContext->NextEntry++;
+
+        pthread_mutex_unlock (&ptrContext->Lock);
+
+        if (entry >= ptrContext->Count)
+        {
+            break;
         }
 
+        sgLinuxProbeDevice (ptrContext->PtrIndexList[entry], &ptrContext->PtrDeviceList[entry]);
+
     }
 
-    return (SCRUTINY_STATUS_FAILED);
+    return (NULL);
 
 }
 
@@ -109,9 +177,13 @@ SCRUTINY_STATUS sgLinuxScanSelect (__IN__ const struct dirent * PtrEntry)
  *
  * @param   PtrDirectory        Pointer to the directory
  *
- * @return  status indicating success or fail
+ * @return  Number of devices added
  *
- * @brief   This function will Scan the sys file system for SCSI devices
+ * @brief   This function will Scan the sys file system for SCSI devices.
+ *          The sg nodes are probed and qualified by a bounded pool of
+ *          workers, the qualification CDBs of slow enclosures then overlap
+ *          instead of adding up. Qualified devices are added to the device
+ *          manager afterwards in sg index order.
  *
  *
  */
@@ -119,21 +191,105 @@ SCRUTINY_STATUS sgLinuxScanSelect (__IN__ const struct dirent * PtrEntry)
 U32 sgLinuxScanDirectory (__IN__ const char * PtrDirectory)
 {
     U32 num;
+    U32 index;
+    U32 count;
+    U32 workers;
+    U32 started;
     register struct dirent *d;
 
     DIR *dirp;
 
+    SG_LINUX_DISCOVERY_CONTEXT context;
+    pthread_t threads[SG_LINUX_DISCOVERY_MAX_WORKERS];
+
     if ((dirp = opendir (PtrDirectory)) == NULL)
     {
         return (0);
     }
 
+    sosiMemSet (&context, 0, sizeof (SG_LINUX_DISCOVERY_CONTEXT));
+
+    context.PtrIndexList = (PU32) sosiMemAlloc (sizeof (U32) * MAX_SCSI_DEVS);
+
+    if (context.PtrIndexList == NULL)
+    {
+        closedir (dirp);
+
+        return (0);
+    }
+
+    count = 0;
+
+    while (((d = readdir (dirp)) != NULL) && (count < MAX_SCSI_DEVS))
+    {
+
+        if (sgLinuxScanSelect (d, &context.PtrIndexList[count]) != SCRUTINY_STATUS_SUCCESS)
+        {
+            continue;
+        }
+
+        count++;
+
+    }
+
+    closedir (dirp);
+
+    if (count == 0)
+    {
+        sosiMemFree (context.PtrIndexList);
+
+        return (0);
+    }
+
+    qsort (context.PtrIndexList, count, sizeof (U32), sgLinuxCompareIndex);
+
+    context.PtrDeviceList = (PTR_SCRUTINY_DEVICE *) sosiMemAlloc (sizeof (PTR_SCRUTINY_DEVICE) * count);
+
+    if (context.PtrDeviceList == NULL)
+    {
+        sosiMemFree (context.PtrIndexList);
+
+        return (0);
+    }
+
+    sosiMemSet (context.PtrDeviceList, 0, sizeof (PTR_SCRUTINY_DEVICE) * count);
+
+    context.Count = count;
+    context.NextEntry = 0;
+
+    pthread_mutex_init (&context.Lock, NULL);
+
+    workers = (count < SG_LINUX_DISCOVERY_MAX_WORKERS) ? count : SG_LINUX_DISCOVERY_MAX_WORKERS;
+
+    for (started = 0; started < workers; started++)
+    {
+        if (pthread_create (&threads[started], NULL, sgLinuxDiscoveryWorker, (void*) &context))
+        {
+            break;
+        }
+    }
+
+    /* The calling thread works through the list as well, this also covers the case where no worker could be started */
+    sgLinuxDiscoveryWorker (&context);
+
+    for (index = 0; index < started; index++)
+    {
+        pthread_join (threads[index], NULL);
+    }
+
+    pthread_mutex_destroy (&context.Lock);
+
     num = 0;
 
-    while ((d = readdir (dirp)) != NULL)
+    for (index = 0; index < count; index++)
     {
 
-        if (sgLinuxScanSelect (d) != SCRUTINY_STATUS_SUCCESS)
+        if (context.PtrDeviceList[index] == NULL)
+        {
+            continue;
+        }
+
+        if (sgLinuxAddDevice (context.PtrDeviceList[index]) != SCRUTINY_STATUS_SUCCESS)
         {
             continue;
         }
@@ -142,7 +298,8 @@ U32 sgLinuxScanDirectory (__IN__ const char * PtrDirectory)
 
     }
 
-    closedir (dirp);
+    sosiMemFree (context.PtrDeviceList);
+    sosiMemFree (context.PtrIndexList);
 
     return (num);
 
@@ -150,18 +307,69 @@ U32 sgLinuxScanDirectory (__IN__ const char * PtrDirectory)
 
 /**
  *
- * @method  lsgCheckDevice ()
+ * @method  sgLinuxFindRetainedDevice ()
  *
- * @param   Index       Index of the device
+ * @param   Index           Index of the sg node
+ *
+ * @param   PtrSgData       SCSI address reported by the sg node
+ *
+ * @return  Device of the previous discovery on this node, NULL if there is
+ *          none or a different device sits on the node now
+ *
+ * @brief   The retained list is not modified while the discovery runs, so
+ *          this can be called from the discovery workers
+ *
+ *
+ */
+
+PTR_SCRUTINY_DEVICE sgLinuxFindRetainedDevice (__IN__ U32 Index, __IN__ Sg_scsi_id *PtrSgData)
+{
+
+    U32 index;
+    PTR_SCRUTINY_DEVICE ptrDevice;
+
+    for (index = 0; index < gPtrScrutinyDeviceManager->RetainedCount; index++)
+    {
+
+        ptrDevice = gPtrScrutinyDeviceManager->PtrRetainedList[index];
+
+        if ((ptrDevice == NULL) || (ptrDevice->HandleType != SCRUTINY_HANDLE_TYPE_SCSI_ON_SCSI_GENERIC))
+        {
+            continue;
+        }
+
+        if ((ptrDevice->Handle.ScsiHandle.Index == Index) &&
+            (ptrDevice->Handle.ScsiHandle.HostNumber == (U32) PtrSgData->host_no) &&
+            (ptrDevice->Handle.ScsiHandle.Channel == (U32) PtrSgData->channel) &&
+            (ptrDevice->Handle.ScsiHandle.TargetId == (U32) PtrSgData->scsi_id) &&
+            (ptrDevice->Handle.ScsiHandle.Lun == (U32) PtrSgData->lun))
+        {
+            return (ptrDevice);
+        }
+
+    }
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  sgLinuxProbeDevice ()
+ *
+ * @param   Index           Index of the device
+ *
+ * @param   PtrPtrDevice    Qualified device, NULL when the node is not ours
  *
  * @return  status indicating success or fail
  *
- * @brief   This function will check the expander device and add to the other expander device list
+ * @brief   This function will open the sg node and qualify the enclosure
+ *          behind it, without adding it to the device manager
  *
  *
  */
 
-SCRUTINY_STATUS sgLinuxCheckDevice (__IN__ U32 Index)
+SCRUTINY_STATUS sgLinuxProbeDevice (__IN__ U32 Index, __OUT__ PTR_SCRUTINY_DEVICE *PtrPtrDevice)
 {
 
     char    file[64];
@@ -170,6 +378,8 @@ SCRUTINY_STATUS sgLinuxCheckDevice (__IN__ U32 Index)
     Sg_scsi_id  sgData;
     SCRUTINY_STATUS  status = SCRUTINY_STATUS_FAILED;
 
+    *PtrPtrDevice = NULL;
+
     sprintf (file, "%s%d", "/dev/sg", Index);
 
     handle = open (file, O_RDWR | O_NONBLOCK);
@@ -189,22 +399,102 @@ SCRUTINY_STATUS sgLinuxCheckDevice (__IN__ U32 Index)
         return (SCRUTINY_STATUS_FAILED);
     }
 
+    /* On incremental discovery an unchanged enclosure is taken over as it is */
+    *PtrPtrDevice = sgLinuxFindRetainedDevice (Index, &sgData);
+
+    if (*PtrPtrDevice != NULL)
+    {
+        close (handle);
+
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
     /*
      * We found some device. Lets investiagate more and get
      * back with results
      */
 
-    status = sgAddExpanderDevice (handle, file, Index);
+    status = sgQualifyExpanderDevice (handle, file, Index, PtrPtrDevice);
 
     if (status != SCRUTINY_STATUS_SUCCESS)
     {
         close (handle);
+
+        return (status);
     }
 
+    (*PtrPtrDevice)->Handle.ScsiHandle.HostNumber = sgData.host_no;
+    (*PtrPtrDevice)->Handle.ScsiHandle.Channel = sgData.channel;
+    (*PtrPtrDevice)->Handle.ScsiHandle.TargetId = sgData.scsi_id;
+    (*PtrPtrDevice)->Handle.ScsiHandle.Lun = sgData.lun;
+
     return (status);
 
 }
 
+/**
+ *
+ * @method  sgLinuxAddDevice ()
+ *
+ * @param   PtrDevice       Qualified device
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   This function will add a qualified device to the device manager,
+ *          the device is released when it can't be added
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgLinuxAddDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    SCRUTINY_STATUS  status;
+
+    /* We have everything now. Add this device into the global structure */
+    status = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, PtrDevice);
+
+    /* Retained devices are released when the incremental discovery completes */
+    if ((status != SCRUTINY_STATUS_SUCCESS) && (!ldmiIsRetainedDevice (gPtrScrutinyDeviceManager, PtrDevice)))
+    {
+        close ((int) PtrDevice->Handle.ScsiHandle.SgDeviceHandle);
+        sosiMemFree (PtrDevice);
+    }
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  lsgCheckDevice ()
+ *
+ * @param   Index       Index of the device
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   This function will check the expander device and add to the other expander device list
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgLinuxCheckDevice (__IN__ U32 Index)
+{
+
+    PTR_SCRUTINY_DEVICE ptrDevice = NULL;
+    SCRUTINY_STATUS  status;
+
+    status = sgLinuxProbeDevice (Index, &ptrDevice);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (status);
+    }
+
+    return (sgLinuxAddDevice (ptrDevice));
+
+}
+
 SCRUTINY_STATUS sgAssignPCILocations (char *PtrBuffer, PTR_SCRUTINY_PCI_ADDRESS PtrPciLocation)
 {
 
@@ -223,15 +513,22 @@ SCRUTINY_STATUS sgAssignPCILocations (char *PtrBuffer, PTR_SCRUTINY_PCI_ADDRESS
 
 }
 
-SCRUTINY_STATUS sgAddExpanderDevice (__IN__ U32 CurrentHandle, __IN__ const char* PtrFile, __IN__ U32 Index)
+SCRUTINY_STATUS sgQualifyExpanderDevice (__IN__ U32 CurrentHandle, __IN__ const char* PtrFile, __IN__ U32 Index, __OUT__ PTR_SCRUTINY_DEVICE *PtrPtrDevice)
 {
     SCRUTINY_STATUS         status = SCRUTINY_STATUS_SUCCESS;
     PTR_SCRUTINY_DEVICE     ptrDevice = NULL;
     char buf[1024] = "";
     int rc;
 
+    *PtrPtrDevice = NULL;
+
     ptrDevice = (PTR_SCRUTINY_DEVICE) sosiMemAlloc (sizeof (SCRUTINY_DEVICE));
 
+    if (ptrDevice == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
     sosiMemSet (ptrDevice, 0, sizeof (SCRUTINY_DEVICE));
 
     ptrDevice->Handle.ScsiHandle.Index = Index;
@@ -256,6 +553,24 @@ SCRUTINY_STATUS sgAddExpanderDevice (__IN__ U32 CurrentHandle, __IN__ const char
 
     ptrDevice->DeviceInfo.HandleType = ptrDevice->HandleType;
 
+    *PtrPtrDevice = ptrDevice;
+
+    return (status);
+
+}
+
+SCRUTINY_STATUS sgAddExpanderDevice (__IN__ U32 CurrentHandle, __IN__ const char* PtrFile, __IN__ U32 Index)
+{
+    SCRUTINY_STATUS         status;
+    PTR_SCRUTINY_DEVICE     ptrDevice = NULL;
+
+    status = sgQualifyExpanderDevice (CurrentHandle, PtrFile, Index, &ptrDevice);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (status);
+    }
+
     /* We have everything now. Add this device into the global structure */
     status = ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevice);
 
@@ -289,6 +604,10 @@ SCRUTINY_STATUS sgiFreeDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
 
     sgiCloseDevice (PtrDevice);
 
+    sgiFreeTransferBuffer (PtrDevice);
+
+    sgemiFreeEmulator (PtrDevice);
+
     return (SCRUTINY_STATUS_SUCCESS);
 }
 
@@ -377,6 +696,33 @@ SCRUTINY_STATUS sgiCloseDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
 
 }
 
+/**
+ *
+ * @method  sgDirectIoFlag()
+ *
+ * @param   PtrBuffer      data buffer of the command
+ *
+ * @return  SG_FLAG_DIRECT_IO for a page aligned buffer, 0 otherwise
+ *
+ * @brief   the driver maps an aligned buffer instead of copying through its
+ *          own, it falls back to the copy by itself when direct IO is not
+ *          allowed (/proc/scsi/sg/allow_dio)
+ *
+ *
+ */
+
+static unsigned int sgDirectIoFlag (__IN__ const U8 *PtrBuffer)
+{
+
+    if (((unsigned long) PtrBuffer & (SG_LINUX_BUFFER_ALIGNMENT - 1)) == 0)
+    {
+        return (SG_FLAG_DIRECT_IO);
+    }
+
+    return (0);
+
+}
+
 /**
  *
  * @method  sgReadCdb()
@@ -420,6 +766,7 @@ SCRUTINY_STATUS sgReadCdb (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 *PtrC
     ioHdr.cmdp            = (U8 *) PtrCdb;
     ioHdr.sbp             = senseBuff;
     ioHdr.timeout         = 600000;
+    ioHdr.flags           = sgDirectIoFlag (PtrBuffer);
 
     if ((ioctlRetVal = ioctl ((int) PtrDevice->Handle.ScsiHandle.SgDeviceHandle, SG_IO, &ioHdr)) < 0)
     {
@@ -528,6 +875,7 @@ SCRUTINY_STATUS sgWriteCdb (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U8 *Ptr
     ioHdr.cmdp            = (U8 *)PtrCdb;
     ioHdr.sbp             = senseBuff;
     ioHdr.timeout         = 600000;
+    ioHdr.flags           = sgDirectIoFlag (PtrBuffer);
 
     if ((ioctlRetVal = ioctl ((int) PtrDevice->Handle.ScsiHandle.SgDeviceHandle, SG_IO, &ioHdr)) < 0)
     {
@@ -572,6 +920,11 @@ SCRUTINY_STATUS sgiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice,
     U8 retryCount = 3;
     U32 sizeDone = 0;
 
+    if (PtrDevice->Handle.ScsiHandle.PtrEmulator != NULL)
+    {
+        return (sgemiPerformScsiPassthrough (PtrDevice, PtrScsiRequest));
+    }
+
     if (sgOpenDevice (PtrDevice) != SCRUTINY_STATUS_SUCCESS)
     {
         return (SCRUTINY_STATUS_FAILED);
@@ -611,3 +964,481 @@ SCRUTINY_STATUS sgiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice,
 
 }
 
+
+/**
+ *
+ * @method  sgPipelineSubmit ()
+ *
+ * @param   Handle          open sg file descriptor
+ *
+ * @param   PtrSlot         slot holding the chunk to be read
+ *
+ * @param   BufferId        buffer ID of the region
+ *
+ * @param   PackId          tag the completion is picked up with
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   queue a READ BUFFER (data mode) through the sg v3 write() interface
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgPipelineSubmit (
+    __IN__ int                          Handle,
+    __IN__ PTR_SG_LINUX_PIPELINE_SLOT   PtrSlot,
+    __IN__ U8                           BufferId,
+    __IN__ U32                          PackId
+)
+{
+
+    sosiMemSet (&PtrSlot->IoHdr, 0, sizeof (Sg_io_hdr));
+    sosiMemSet (PtrSlot->SenseBuffer, 0, sizeof (PtrSlot->SenseBuffer));
+
+    PtrSlot->Cdb[0] = SCSI_COMMAND_READ_BUFFER;
+    PtrSlot->Cdb[1] = SCSI_READ_MODE_DATA;
+    PtrSlot->Cdb[2] = BufferId;
+    PtrSlot->Cdb[3] = (U8) (PtrSlot->Offset >> 16);
+    PtrSlot->Cdb[4] = (U8) (PtrSlot->Offset >> 8);
+    PtrSlot->Cdb[5] = (U8) (PtrSlot->Offset & 0xFF);
+    PtrSlot->Cdb[6] = (U8) (PtrSlot->Size >> 16);
+    PtrSlot->Cdb[7] = (U8) (PtrSlot->Size >> 8);
+    PtrSlot->Cdb[8] = (U8) (PtrSlot->Size & 0xFF);
+    PtrSlot->Cdb[9] = 0;
+
+    PtrSlot->IoHdr.interface_id    = 'S';
+    PtrSlot->IoHdr.cmd_len         = sizeof (PtrSlot->Cdb);
+    PtrSlot->IoHdr.mx_sb_len       = sizeof (PtrSlot->SenseBuffer);
+    PtrSlot->IoHdr.dxfer_direction = SG_DXFER_FROM_DEV;
+    PtrSlot->IoHdr.dxfer_len       = PtrSlot->Size;
+    PtrSlot->IoHdr.dxferp          = PtrSlot->PtrData;
+    PtrSlot->IoHdr.cmdp            = PtrSlot->Cdb;
+    PtrSlot->IoHdr.sbp             = PtrSlot->SenseBuffer;
+    PtrSlot->IoHdr.timeout         = 600000;
+    PtrSlot->IoHdr.pack_id         = (int) PackId;
+    PtrSlot->IoHdr.flags           = sgDirectIoFlag (PtrSlot->PtrData);
+
+    if (write (Handle, &PtrSlot->IoHdr, sizeof (Sg_io_hdr)) != sizeof (Sg_io_hdr))
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgPipelineQueue ()
+ *
+ * @param   Handle          open sg file descriptor
+ *
+ * @param   PtrSlots        SG_LINUX_PIPELINE_SLOTS slots of the read
+ *
+ * @param   BufferId        buffer ID of the region
+ *
+ * @param   Offset          offset in the region the read started at
+ *
+ * @param   Length          bytes of the whole read
+ *
+ * @param   ChunkSize       bytes per READ BUFFER
+ *
+ * @param   PtrDestination  buffer of the whole read, NULL for staging chunks
+ *
+ * @param   PtrStaging      staging chunks used without a destination
+ *
+ * @param   Limit           chunks to have submitted when done
+ *
+ * @param   PtrSubmitted    chunks submitted so far, advanced in place
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   submit the following chunks of a pipelined read up to Limit, the
+ *          caller makes sure the slots being reused are no longer needed
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgPipelineQueue (
+    __IN__    int                           Handle,
+    __INOUT__ PTR_SG_LINUX_PIPELINE_SLOT    PtrSlots,
+    __IN__    U8                            BufferId,
+    __IN__    U32                           Offset,
+    __IN__    U32                           Length,
+    __IN__    U32                           ChunkSize,
+    __IN__    PU8                           PtrDestination,
+    __IN__    PU8                           PtrStaging,
+    __IN__    U32                           Limit,
+    __INOUT__ PU32                          PtrSubmitted
+)
+{
+
+    PTR_SG_LINUX_PIPELINE_SLOT  ptrSlot;
+    U32                         chunkCount = (Length + ChunkSize - 1) / ChunkSize;
+    U32                         submitted = *PtrSubmitted;
+    SCRUTINY_STATUS             status = SCRUTINY_STATUS_SUCCESS;
+
+    while ((submitted < chunkCount) && (submitted < Limit))
+    {
+        ptrSlot = &PtrSlots[submitted % SG_LINUX_PIPELINE_SLOTS];
+
+        ptrSlot->Offset  = Offset + (submitted * ChunkSize);
+        ptrSlot->Size    = ((Length - (submitted * ChunkSize)) < ChunkSize) ? (Length - (submitted * ChunkSize)) : ChunkSize;
+        ptrSlot->PtrData = (PtrDestination != NULL) ? (PtrDestination + (submitted * ChunkSize)) :
+                                                      (PtrStaging + ((submitted % SG_LINUX_PIPELINE_SLOTS) * ChunkSize));
+
+        status = sgPipelineSubmit (Handle, ptrSlot, BufferId, submitted);
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        submitted++;
+    }
+
+    *PtrSubmitted = submitted;
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sgPipelineReceive ()
+ *
+ * @param   Handle          open sg file descriptor, in blocking mode
+ *
+ * @param   PtrSlot         slot whose command is to be completed
+ *
+ * @return  status indicating success, retry or fail
+ *
+ * @brief   wait for the completion carrying the pack id of the slot
+ *
+ *
+ */
+
+static SCRUTINY_STATUS sgPipelineReceive (
+    __IN__ int                          Handle,
+    __IN__ PTR_SG_LINUX_PIPELINE_SLOT   PtrSlot
+)
+{
+
+    /* pack_id still holds the tag given at submit, SG_SET_FORCE_PACK_ID makes read() wait for it */
+    if (read (Handle, &PtrSlot->IoHdr, sizeof (Sg_io_hdr)) != sizeof (Sg_io_hdr))
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    if (PtrSlot->IoHdr.status == 2) /* Magic number #2 is CHECK_CONDITION */
+    {
+        /* Same UNIT ATTENTION / POWER ON, RESET handling as sgReadCdb() */
+        if ((PtrSlot->IoHdr.sb_len_wr > 0) &&
+            (0x06 == (PtrSlot->SenseBuffer[2] & 0xF)) && (PtrSlot->SenseBuffer[12] == 0x29))
+        {
+            return (SCRUTINY_STATUS_RETRY);
+        }
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  sgiPipelinedReadBuffer ()
+ *
+ * @param   PtrDevice       Pointer to the device
+ *
+ * @param   BufferId        buffer ID of the region
+ *
+ * @param   Offset          offset in the region to start at
+ *
+ * @param   Length          bytes to read
+ *
+ * @param   ChunkSize       bytes per READ BUFFER
+ *
+ * @param   PtrDestination  buffer of Length bytes the chunks land in, NULL to
+ *                          read through SG_LINUX_PIPELINE_SLOTS staging chunks
+ *
+ * @param   Handler         optional, called for every chunk once it arrived
+ *
+ * @param   PtrContext      passed through to the handler
+ *
+ * @return  status indicating success or fail
+ *
+ * @brief   read a region keeping SG_LINUX_PIPELINE_DEPTH READ BUFFER commands
+ *          queued on the device, so the handler of one chunk overlaps with
+ *          the transfer of the next ones
+ *
+ *
+ */
+
+SCRUTINY_STATUS sgiPipelinedReadBuffer (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  U8                      BufferId,
+    __IN__  U32                     Offset,
+    __IN__  U32                     Length,
+    __IN__  U32                     ChunkSize,
+    __OUT__ PU8                     PtrDestination,
+    __IN__  SG_LINUX_CHUNK_HANDLER  Handler,
+    __IN__  PVOID                   PtrContext
+)
+{
+
+    SG_LINUX_PIPELINE_SLOT      slots[SG_LINUX_PIPELINE_SLOTS];
+    PTR_SG_LINUX_PIPELINE_SLOT  ptrSlot;
+    PU8                         ptrStaging = NULL;
+    U32                         chunkCount;
+    U32                         chunk;
+    U32                         submitted = 0;
+    U32                         received = 0;
+    U32                         sizeDone = 0;
+    U32                         retryCount;
+    int                         handle;
+    int                         fileFlags;
+    int                         forcePackId = 1;
+    SCRUTINY_STATUS             status = SCRUTINY_STATUS_SUCCESS;
+
+    if ((Length == 0) || (ChunkSize == 0))
+    {
+        return (SCRUTINY_STATUS_SUCCESS);
+    }
+
+    if (PtrDevice->Handle.ScsiHandle.PtrEmulator != NULL)
+    {
+        return (sgemiReadBuffer (PtrDevice, BufferId, Offset, Length, ChunkSize, PtrDestination, Handler, PtrContext));
+    }
+
+    if (PtrDestination == NULL)
+    {
+        /* Chunk sized slots of the device buffer, page aligned so they qualify for direct IO */
+        ptrStaging = sgiGetTransferBuffer (PtrDevice, SG_LINUX_PIPELINE_SLOTS * ChunkSize);
+
+        if (ptrStaging == NULL)
+        {
+            return (SCRUTINY_STATUS_NO_MEMORY);
+        }
+    }
+
+    if (sgOpenDevice (PtrDevice) != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    handle = (int) PtrDevice->Handle.ScsiHandle.SgDeviceHandle;
+
+    /* Completions are collected in order, read() has to block on a given pack id */
+    fileFlags = fcntl (handle, F_GETFL);
+    fcntl (handle, F_SETFL, fileFlags & ~O_NONBLOCK);
+
+    if (ioctl (handle, SG_SET_FORCE_PACK_ID, &forcePackId) < 0)
+    {
+        status = SCRUTINY_STATUS_FAILED;
+    }
+
+    chunkCount = (Length + ChunkSize - 1) / ChunkSize;
+
+    if (status == SCRUTINY_STATUS_SUCCESS)
+    {
+        status = sgPipelineQueue (handle, slots, BufferId, Offset, Length, ChunkSize, PtrDestination, ptrStaging,
+                                  SG_LINUX_PIPELINE_DEPTH, &submitted);
+    }
+
+    for (chunk = 0; (status == SCRUTINY_STATUS_SUCCESS) && (chunk < chunkCount); chunk++)
+    {
+
+        ptrSlot = &slots[chunk % SG_LINUX_PIPELINE_SLOTS];
+
+        status = sgPipelineReceive (handle, ptrSlot);
+        received++;
+
+        /* A unit attention is retried in line, like sgiPerformScsiPassthrough() does */
+        for (retryCount = 0; (status == SCRUTINY_STATUS_RETRY) && (retryCount < 2); retryCount++)
+        {
+            status = sgReadCdb (PtrDevice, ptrSlot->Cdb, sizeof (ptrSlot->Cdb), ptrSlot->PtrData, ptrSlot->Size, &sizeDone);
+        }
+
+        if (status != SCRUTINY_STATUS_SUCCESS)
+        {
+            break;
+        }
+
+        /*
+         * Refill before the handler runs, so DEPTH commands stay queued while it works. The
+         * slot being reused belongs to the chunk handled last, the one of this chunk is kept.
+         */
+        status = sgPipelineQueue (handle, slots, BufferId, Offset, Length, ChunkSize, PtrDestination, ptrStaging,
+                                  chunk + 1 + SG_LINUX_PIPELINE_DEPTH, &submitted);
+
+        if ((status == SCRUTINY_STATUS_SUCCESS) && (Handler != NULL))
+        {
+            status = Handler (PtrContext, ptrSlot->Offset, ptrSlot->PtrData, ptrSlot->Size);
+        }
+
+    }
+
+    /* Reap whatever is still queued before the buffers go away */
+    for (; received < submitted; received++)
+    {
+        sgPipelineReceive (handle, &slots[received % SG_LINUX_PIPELINE_SLOTS]);
+    }
+
+    fcntl (handle, F_SETFL, fileFlags);
+
+    sgiCloseDevice (PtrDevice);
+
+    return (status);
+
+}
+
+/**
+ *
+ * @method  sgiGetMaxTransferSize ()
+ *
+ * @param   PtrDevice       Pointer to the device
+ *
+ * @return  largest data phase the sg node and its queue take, 0 if unknown
+ *
+ * @brief   BLKSECTGET on an sg node reports max_sectors_kb of the device
+ *          queue in bytes, the reserved buffer size is the fallback for
+ *          drivers not answering it
+ *
+ *
+ */
+
+U32 sgiGetMaxTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    int     handle;
+    int     maxSectorBytes = 0;
+    int     reservedSize = 0;
+    U32     maxTransferSize = 0;
+
+    if (PtrDevice->Handle.ScsiHandle.PtrEmulator != NULL)
+    {
+        return (sgemiGetMaxTransferSize (PtrDevice));
+    }
+
+    if (sgOpenDevice (PtrDevice) != SCRUTINY_STATUS_SUCCESS)
+    {
+        return (0);
+    }
+
+    handle = (int) PtrDevice->Handle.ScsiHandle.SgDeviceHandle;
+
+    if ((ioctl (handle, BLKSECTGET, &maxSectorBytes) == 0) && (maxSectorBytes > 0))
+    {
+        maxTransferSize = (U32) maxSectorBytes;
+    }
+
+    else if ((ioctl (handle, SG_GET_RESERVED_SIZE, &reservedSize) == 0) && (reservedSize > 0))
+    {
+        maxTransferSize = (U32) reservedSize;
+    }
+
+    sgiCloseDevice (PtrDevice);
+
+    return (maxTransferSize);
+
+}
+
+/**
+ *
+ * @method  sgiGetTransferBuffer ()
+ *
+ * @param   PtrDevice       Pointer to the device
+ *
+ * @param   Size            bytes needed
+ *
+ * @return  page aligned buffer of at least Size bytes, NULL when out of memory
+ *
+ * @brief   the buffer stays with the device and is reused by the next
+ *          transfer, it only grows. Released by sgiFreeTransferBuffer().
+ *
+ *
+ */
+
+PU8 sgiGetTransferBuffer (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Size)
+{
+
+    PTR_SCRUTINY_SCSI_HANDLE    ptrScsiHandle = &PtrDevice->Handle.ScsiHandle;
+    PVOID                       ptrBuffer = NULL;
+
+    if ((ptrScsiHandle->PtrTransferBuffer != NULL) && (ptrScsiHandle->TransferBufferSize >= Size))
+    {
+        return (ptrScsiHandle->PtrTransferBuffer);
+    }
+
+    sgiFreeTransferBuffer (PtrDevice);
+
+    if (posix_memalign (&ptrBuffer, SG_LINUX_BUFFER_ALIGNMENT, Size) != 0)
+    {
+        return (NULL);
+    }
+
+    ptrScsiHandle->PtrTransferBuffer = (PU8) ptrBuffer;
+    ptrScsiHandle->TransferBufferSize = Size;
+
+    return (ptrScsiHandle->PtrTransferBuffer);
+
+}
+
+/**
+ *
+ * @method  sgiFreeTransferBuffer ()
+ *
+ * @param   PtrDevice       Pointer to the device
+ *
+ * @return  none
+ *
+ * @brief   release the transfer buffer of the device
+ *
+ *
+ */
+
+VOID sgiFreeTransferBuffer (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    if (PtrDevice->Handle.ScsiHandle.PtrTransferBuffer != NULL)
+    {
+        free (PtrDevice->Handle.ScsiHandle.PtrTransferBuffer);
+    }
+
+    PtrDevice->Handle.ScsiHandle.PtrTransferBuffer = NULL;
+    PtrDevice->Handle.ScsiHandle.TransferBufferSize = 0;
+
+}
+
+/**
+ *
+ * @method  sgiAllocAlignedBuffer ()
+ *
+ * @param   Size            bytes needed
+ *
+ * @return  zeroed page aligned buffer, NULL when out of memory
+ *
+ * @brief   for data buffers which outlive a single transfer, e.g. a region
+ *          handed back to the caller. Page aligned so the transfers into it
+ *          qualify for direct IO, released with sosiMemFree().
+ *
+ *
+ */
+
+PU8 sgiAllocAlignedBuffer (__IN__ U32 Size)
+{
+
+    PVOID   ptrBuffer = NULL;
+
+    if (posix_memalign (&ptrBuffer, SG_LINUX_BUFFER_ALIGNMENT, Size) != 0)
+    {
+        return (NULL);
+    }
+
+    sosiMemSet (ptrBuffer, 0, Size);
+
+    return ((PU8) ptrBuffer);
+
+}
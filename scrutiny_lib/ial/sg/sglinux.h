@@ -46,6 +46,53 @@
 
 #define MAX_SCSI_DEVS           (4096)
 
+/* From linux/fs.h, which does not mix with the other system headers we pull in */
+#ifndef BLKSECTGET
+#define BLKSECTGET              _IO (0x12, 103)
+#endif
+
+/* Number of threads probing and qualifying sg nodes in parallel during discovery */
+#define SG_LINUX_DISCOVERY_MAX_WORKERS      (8)
+
+typedef struct _SG_LINUX_DISCOVERY_CONTEXT
+{
+
+    PU32                    PtrIndexList;       /* sg node indexes, sorted */
+    PTR_SCRUTINY_DEVICE     *PtrDeviceList;     /* qualified device per index, NULL if not ours */
+    U32                     Count;
+    U32                     NextEntry;          /* next index to be picked by a worker */
+    pthread_mutex_t         Lock;
+
+} SG_LINUX_DISCOVERY_CONTEXT, *PTR_SG_LINUX_DISCOVERY_CONTEXT;
+
+/* Alignment of the transfer buffers, the sg driver can map them for direct IO */
+#define SG_LINUX_BUFFER_ALIGNMENT           (4096)
+
+/* READ BUFFER commands kept in flight by a pipelined region read */
+#define SG_LINUX_PIPELINE_DEPTH             (2)
+
+/* One more slot than the depth, the handler of a chunk runs while DEPTH commands are queued */
+#define SG_LINUX_PIPELINE_SLOTS             (SG_LINUX_PIPELINE_DEPTH + 1)
+
+/* Called for every chunk of a pipelined read, in offset order */
+typedef SCRUTINY_STATUS (*SG_LINUX_CHUNK_HANDLER) (
+    __IN__ PVOID    PtrContext,
+    __IN__ U32      Offset,
+    __IN__ PU8      PtrChunk,
+    __IN__ U32      ChunkSize);
+
+typedef struct _SG_LINUX_PIPELINE_SLOT
+{
+
+    Sg_io_hdr               IoHdr;
+    U8                      Cdb[10];
+    U8                      SenseBuffer[32];
+    PU8                     PtrData;
+    U32                     Offset;             /* offset of the chunk in the region */
+    U32                     Size;
+
+} SG_LINUX_PIPELINE_SLOT, *PTR_SG_LINUX_PIPELINE_SLOT;
+
 SCRUTINY_STATUS sgiLocateScsiDevices();
 
 SCRUTINY_STATUS sgOpenDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
@@ -61,7 +108,7 @@ SCRUTINY_STATUS sgiWriteCdb (PTR_SCRUTINY_DEVICE   PtrDeviceEntry, U8 *PtrCdb, U
 
 SCRUTINY_STATUS sgiIsOpened (PTR_SCRUTINY_DEVICE   PtrDeviceEntry);
 
-SCRUTINY_STATUS sgLinuxScanSelect (const struct dirent * PtrEntry);
+SCRUTINY_STATUS sgLinuxScanSelect (const struct dirent * PtrEntry, PU32 PtrIndex);
 
 U32 sgLinuxScanDirectory (const char * PtrDirectory);
 
@@ -78,8 +125,34 @@ SCRUTINY_STATUS sgLinuxCheckDevice (U32 Index);
 
 SCRUTINY_STATUS sgAddExpanderDevice (U32 CurrentHandle, const char* PtrFile, U32 Index);
 
+SCRUTINY_STATUS sgQualifyExpanderDevice (U32 CurrentHandle, const char* PtrFile, U32 Index, PTR_SCRUTINY_DEVICE *PtrPtrDevice);
+
+SCRUTINY_STATUS sgLinuxProbeDevice (U32 Index, PTR_SCRUTINY_DEVICE *PtrPtrDevice);
+
+PTR_SCRUTINY_DEVICE sgLinuxFindRetainedDevice (U32 Index, Sg_scsi_id *PtrSgData);
+
+SCRUTINY_STATUS sgLinuxAddDevice (PTR_SCRUTINY_DEVICE PtrDevice);
+
 SCRUTINY_STATUS sgiPerformScsiPassthrough (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ PTR_SCRUTINY_SCSI_PASSTHROUGH PtrScsiRequest);
 
+U32 sgiGetMaxTransferSize (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+PU8 sgiGetTransferBuffer (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Size);
+
+VOID sgiFreeTransferBuffer (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+PU8 sgiAllocAlignedBuffer (__IN__ U32 Size);
+
+SCRUTINY_STATUS sgiPipelinedReadBuffer (
+    __IN__  PTR_SCRUTINY_DEVICE     PtrDevice,
+    __IN__  U8                      BufferId,
+    __IN__  U32                     Offset,
+    __IN__  U32                     Length,
+    __IN__  U32                     ChunkSize,
+    __OUT__ PU8                     PtrDestination,
+    __IN__  SG_LINUX_CHUNK_HANDLER  Handler,
+    __IN__  PVOID                   PtrContext);
+
 
 
 #endif
@@ -51,6 +51,10 @@
 
 #define EXPANDER_SCSI_GENERIC_CHUNK_SIZE          (64 * 1024)
 
+/* Bounds of the per device tuned READ/WRITE BUFFER size, the lower one is always safe */
+#define SCSI_TRANSFER_SIZE_MIN                    EXPANDER_SCSI_GENERIC_CHUNK_SIZE
+#define SCSI_TRANSFER_SIZE_MAX                    (512 * 1024)
+
 #ifdef OS_WINDOWS
     #define SCRUTINY_DEFAULT_IO_TIMEOUT      (30)
     #define SCRUTINY_IOCTL_MAX_SENSE_LEN     (0xFF)
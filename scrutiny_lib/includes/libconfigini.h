@@ -40,6 +40,7 @@
 #define SCRUTINY_CONFIG_FILE_KEY_LOG_LEVEL_SWITCH       "DEBUG_LOG_LEVEL_HAL_SWITCH"
 #define SCRUTINY_CONFIG_FILE_KEY_LOG_LEVEL_SCSI         "DEBUG_LOG_LEVEL_HAL_SCSI"
 #define SCRUTINY_CONFIG_FILE_KEY_LOG_FILE               "DEBUG_LOG_FILE"
+#define SCRUTINY_CONFIG_FILE_KEY_RECORD_FILE            "RECORD_FILE"
 
 typedef struct __SCRUTINY_LIBRARY_CONFIG_PARAMS
 {
@@ -53,6 +54,8 @@ typedef struct __SCRUTINY_LIBRARY_CONFIG_PARAMS
 
     char*           PtrDebugLogFile;            /* DebugLogFile = file name absolute path */
 
+    char*           PtrRecordFile;              /* RecordFile = trace of the device exchanges, see librecord.h */
+
 } SCRUTINY_LIBRARY_CONFIG_PARAMS, *PTR_SCRUTINY_LIBRARY_CONFIG_PARAMS;
 
 typedef struct __CONFIG_INI_ENTRIES
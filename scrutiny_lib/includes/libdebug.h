@@ -58,10 +58,47 @@ struct __SCRUTINY_DEBUG_LOGGER_INTERNAL
 
 };
 
+#if defined (OS_LINUX)
+
+/* Capacity of the log ring, must be a power of two */
+#define SCRUTINY_LOG_RING_SIZE              (256 * 1024)
+
+/* Pending log text which wakes the writer thread before its interval is over */
+#define SCRUTINY_LOG_FLUSH_THRESHOLD        (32 * 1024)
+
+/* Longest time a line waits in the ring before it is written to the file */
+#define SCRUTINY_LOG_FLUSH_INTERVAL_US      (200 * 1000)
+
+typedef struct __SCRUTINY_LOG_WRITER
+{
+
+    int                 FileHandle;     /** Log file, kept open while the writer runs */
+    char                *PtrRing;       /** Log text which is not yet in the file */
+
+    volatile U32        Head;           /** Bytes put into the ring, the index wraps with the ring size */
+    volatile U32        Tail;           /** Bytes written to the file */
+
+    BOOLEAN             Running;        /** Lines go through the ring, otherwise straight into the file */
+    BOOLEAN             Stop;           /** Asks the writer thread for a last flush and to exit */
+
+    pthread_t           Thread;         /** Writer thread */
+
+    pthread_mutex_t     Lock;           /** Protects Head, Tail and the flags */
+    pthread_mutex_t     FileLock;       /** Serializes the flushes, so no text is written twice */
+    pthread_cond_t      Pending;        /** Signaled when the threshold is reached, a flush is wanted or on stop */
+    pthread_cond_t      Drained;        /** Signaled whenever Tail has moved */
+
+} SCRUTINY_LOG_WRITER, *PTR_SCRUTINY_LOG_WRITER;
+
+#endif
+
 VOID ldliInitializeDefaultLogging();
 VOID ldliInitializeLogging (__IN__ PTR_SCRUTINY_DEBUG_LOGGER PtrLogger);
 VOID ldliInitializeIniFileLogging (__IN__ U32   DebugLevel);
 
+VOID ldliFlushLogging ();
+VOID ldliStopLogging ();
+
 VOID ldliEmptyHearse (const char *PtrArguments, ...);
 VOID ldliEmptyHearseDumpHexMemory (PU8 PtrBuffer, U32 SizeInBytes, PTR_SCRUTINY_DEBUG_LOGGER_INTERNAL PtrModule);
 VOID ldliDumpHexMemory (PU8 PtrBuffer, U32 SizeInBytes, PTR_SCRUTINY_DEBUG_LOGGER_INTERNAL PtrModule);
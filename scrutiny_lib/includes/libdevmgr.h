@@ -79,6 +79,19 @@ typedef struct __SCRUTINY_SCSI_HANDLE
             struct cam_device   *PtrSgCamDeviceHandle;
         #else
             int                 SgDeviceHandle;
+
+            /* SCSI address of the sg node, used to find the device again on rediscovery */
+            U32                 HostNumber;
+            U32                 Channel;
+            U32                 TargetId;
+            U32                 Lun;
+
+            /* Page aligned data buffer reused by the region transfers of this node */
+            PU8                 PtrTransferBuffer;
+            U32                 TransferBufferSize;
+
+            /* Set on an emulated enclosure, commands are served by sgemulator instead of a node */
+            PVOID               PtrEmulator;
         #endif
 
     #endif
@@ -90,8 +103,25 @@ typedef struct __SCRUTINY_SCSI_HANDLE
 
     SCRUTINY_PCI_ADDRESS         AdapterPCIAddress;     //Adapter where this SCSI device is attached into
 
+    /* Largest READ BUFFER data phase for this device, 0 until bsdiGetTransferSize() tuned it */
+    U32                          MaxTransferSize;
+
+    /* Measured on the tuning probe: latency of one command and throughput in KB/s */
+    U32                          TransferLatencyMicroSeconds;
+    U32                          TransferKBytesPerSecond;
+
 } SCRUTINY_SCSI_HANDLE, *PTR_SCRUTINY_SCSI_HANDLE;
 
+typedef struct _SCRUTINY_SIMULATED_HANDLE
+{
+    /* Register model built from the snapshot file, owned by the switch simulator */
+    PVOID                        PtrRegisterModel;
+
+    /* Delay added to every register access */
+    U32                          AccessLatencyMicroSeconds;
+
+} SCRUTINY_SIMULATED_HANDLE, *PTR_SCRUTINY_SIMULATED_HANDLE;
+
 #ifdef OS_UEFI
 
 typedef struct _SCRUTINY_EFI_FRAME_HEADER
@@ -189,6 +219,21 @@ typedef struct _SCRUTINY_CONTROLLER_HANDLE
 } SCRUTINY_CONTROLLER_HANDLE, *PTR_SCRUTINY_CONTROLLER_HANDLE;
 
 #if !defined (OS_BMC) && !defined (OS_VMWARE)
+
+/* Chime to AXI register access counters, latencies are in micro-seconds */
+typedef struct __SCRUTINY_PCI_ACCESS_STATISTICS
+{
+
+    U32                 ReadCount;
+    U32                 WriteCount;
+    U32                 FallbackCount;
+    U32                 TimeoutCount;
+    unsigned long long  TotalLatency;
+    U32                 MaxLatency;
+    U32                 LastLatency;
+
+} SCRUTINY_PCI_ACCESS_STATISTICS, *PTR_SCRUTINY_PCI_ACCESS_STATISTICS;
+
 typedef struct __SCRUTINY_PCI_HANDLE
 {
 
@@ -200,6 +245,8 @@ typedef struct __SCRUTINY_PCI_HANDLE
 
     IAL_PCI_BAR_REGIONS     BarRegions[MAX_BAR_REGIONS];
     IAL_PCI_CONFIG_SPACE    ConfigSpace;
+
+    SCRUTINY_PCI_ACCESS_STATISTICS  AccessStatistics;
 } SCRUTINY_PCI_HANDLE, *PTR_SCRUTINY_PCI_HANDLE;
 #endif
 
@@ -237,6 +284,19 @@ typedef struct __SCRUTINY_PCI_HANDLE
 
 #endif 
 
+/* Number of PORT_CLOCK_EN registers of a switch, 0-31, 32-63, 64-95 and the x1 ports */
+#define SCRUTINY_SWITCH_PORT_CLOCK_EN_REGISTERS         (4)
+
+/* Port state of a switch, read once and kept until the next reset or discovery */
+typedef struct __SCRUTINY_SWITCH_PORT_STATE
+{
+
+    BOOLEAN             Valid;
+    U32                 ChipIdRegister;
+    U32                 ClockEnable[SCRUTINY_SWITCH_PORT_CLOCK_EN_REGISTERS];
+
+} SCRUTINY_SWITCH_PORT_STATE, *PTR_SCRUTINY_SWITCH_PORT_STATE;
+
 struct  _SCRUTINY_DEVICE
 {
 
@@ -255,6 +315,8 @@ struct  _SCRUTINY_DEVICE
         SCRUTINY_IAL_SERIAL_HANDLE      SdbHandle;
 
         SCRUTINY_PCI_HANDLE             PciHandle;
+
+        SCRUTINY_SIMULATED_HANDLE       SimulatedHandle;
         #endif
 
     } Handle;
@@ -263,6 +325,23 @@ struct  _SCRUTINY_DEVICE
 
     SCRUTINY_PRODUCT_FAMILY         ProductFamily;
 
+    /* Background PCIe performance sampler of a switch, NULL when it is not running */
+    PVOID                           PtrPerfSampler;
+
+    /* Per port PCIe capability index of a switch, NULL until the first lookup */
+    PVOID                           PtrCapabilityIndex;
+
+    /* Record or replay stream of the device, see librecord.h. NULL when neither runs */
+    PVOID                           PtrRecordReplay;
+
+    SCRUTINY_SWITCH_PORT_STATE      SwitchPortState;
+
+    #if defined (OS_LINUX)
+    /* Serializes the device accesses of the API and the background sampler, see ldmiLockDevice */
+    pthread_mutex_t                 AccessLock;
+    BOOLEAN                         AccessLockValid;
+    #endif
+
 };
 
 
@@ -276,6 +355,10 @@ typedef struct _SCRUTINY_DEVICE_MANAGER
     SCRUTINY_LIB_OOB_Flags          OobFlag;
     PTR_SCRUTINY_DISCOVERY_PARAMS   PtrDiscoveryParams;
 
+    /* Devices of the previous discovery while an incremental discovery is running */
+    PTR_SCRUTINY_DEVICE             *PtrRetainedList;
+    U32                             RetainedCount;
+
 } SCRUTINY_DEVICE_MANAGER, *PTR_SCRUTINY_DEVICE_MANAGER;
 
 #define ITEM_NAME(x)        #x
@@ -289,6 +372,11 @@ typedef struct  _ITEMS_LOOKUP_TABLE
 SCRUTINY_STATUS ldmiAddScrutinyDevice (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrScrutinyLibManager, __IN__ PTR_SCRUTINY_DEVICE PtrDeviceEntryStruct);
 SCRUTINY_STATUS ldmiFreeDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager);
 SCRUTINY_STATUS ldmiInitializeLibraryDeviceManager (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER *PPtrDeviceManager);
+SCRUTINY_STATUS ldmiRetainDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager);
+BOOLEAN ldmiIsRetainedDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager, __IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+SCRUTINY_STATUS ldmiCompleteRetainedDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager);
+VOID ldmiLockDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+VOID ldmiUnlockDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
 
 
 #endif /* __LIB_DEVICE_MANGER__H__ */
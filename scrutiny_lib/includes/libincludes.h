@@ -63,6 +63,7 @@
 #include <getopt.h>
 #include <linux/ioctl.h>
 #include <dirent.h>
+#include <glob.h>
 #include <time.h>
 #include <pthread.h>
 #include <sys/types.h>
@@ -197,7 +198,9 @@
 #include "pcicommon.h"
 #include "libconfig.h"
 #include "libconfigini.h"
+#include "libregmodel.h"
 #include "libdevmgr.h"
+#include "librecord.h"
 #include "pciscan.h"
 #include "libinternal.h"
 #include "libosal.h"
@@ -240,6 +243,7 @@
 #include "switchregbla.h"
 #include "switchlanemargin.h"
 #include "switchportperformance.h"
+#include "switchsimulator.h"
 
 #ifdef OS_LINUX
 #include "pcicommon.h"
@@ -259,10 +263,15 @@
 
 #ifdef OS_LINUX
 #include "sglinux.h"
+#include "sgemulator.h"
 #endif
 
 #include "sdbconsole.h"
 
+#ifdef OS_LINUX
+#include "sdbsimulator.h"
+#endif
+
 #include "brcmscsisdk.h"
 #include "brcmscsigettemperature.h"
 #include "osalserial.h"
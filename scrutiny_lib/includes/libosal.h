@@ -85,6 +85,8 @@ SCRUTINY_STATUS sosiMemCompare (__IN__ U8 *PtrFirst, __IN__ U8 *PtrSecond, __IN_
 VOID sosiMemCopy (__OUT__ VOID *PtrDest, __IN__ const VOID *PtrSrc, __IN__ U32 Size);
 VOID sosiMemSet (__OUT__ VOID *PtrMem, __IN__ U8 FillChar, __IN__ U32 Size);
 VOID sosiSleep (U32 Milli);
+VOID sosiMicroSleep (U32 Micro);
+U32 sosiGetMicroSeconds ();
 
 S32 sosiFprintf (__IN__ SOSI_FILE_HANDLE Stream, __IN__ const char* PtrArguments, ...);
 
@@ -0,0 +1,170 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+#ifndef __LIB_RECORD__H__
+#define __LIB_RECORD__H__
+
+/*
+ * Record and replay of the device exchanges
+ *
+ * With RECORD_FILE set in scrutiny.ini every device the device manager takes gets a
+ * stream in the trace, and all of its exchanges below the bsdi layer are appended
+ * with the time they took. A trace is replayed through SCRUTINY_DISCOVERY_TYPE_SIMULATED
+ * with SCRUTINY_SIMULATOR_TYPE_REPLAY: the recorded devices come back with their original
+ * handle type and device info, and every exchange is answered from the trace, either
+ * at full speed or holding each one for the recorded time.
+ *
+ * The trace is compact binary, in host byte order
+ *
+ *     LRC_FILE_HEADER
+ *     LRC_RECORD_HEADER [CDB] [data]       repeated
+ *
+ * What gets recorded depends on the transport
+ *
+ *     SCSI            every command, the memory reads over READ BUFFER, the region
+ *                     uploads and the SES pages are all commands
+ *     SDB, PCI        bsdiMemoryRead32, bsdiMemoryWrite32 and the PCI FIFO burst
+ *
+ * Only data the device returns is stored. A write keeps its first DWORD and a SCSI
+ * command its SCSI status in Value. The replay serves the records of a device in the
+ * recorded order, a request which does not match the next record fails and does not
+ * advance the stream, so a trace only replays the sequence of calls it was taken with.
+ */
+
+#define LRC_FILE_SIGNATURE              (0x43525253)    /* 'SRRC' */
+#define LRC_FILE_VERSION                (1)
+
+/* The stream number is kept in a byte */
+#define LRC_MAXIMUM_STREAMS             (256)
+
+#define LRC_RECORD_TYPE_DEVICE          (1)     /* Address: product family, Value: handle type, data: SCRUTINY_DEVICE_INFO */
+#define LRC_RECORD_TYPE_MEMORY_READ     (2)
+#define LRC_RECORD_TYPE_MEMORY_WRITE    (3)
+#define LRC_RECORD_TYPE_FIFO_READ       (4)
+#define LRC_RECORD_TYPE_SCSI            (5)
+#define LRC_RECORD_TYPE_CONFIG_READ     (6)     /* Host PCI configuration space, Address: LRC_CONFIG_ADDRESS */
+#define LRC_RECORD_TYPE_VALUE           (7)     /* Value the host learned outside the device, Address: LRC_VALUE_TAG_* */
+
+#define LRC_VALUE_TAG_MAX_TRANSFER_SIZE (1)
+
+#define LRC_CONFIG_ADDRESS(Bus, Device, Function, Offset) \
+    ((((U32) (Bus) & 0xFF) << 20) | (((U32) (Device) & 0x1F) << 15) | (((U32) (Function) & 0x7) << 12) | ((U32) (Offset) & 0xFFF))
+
+typedef struct _LRC_FILE_HEADER
+{
+    U32                 Signature;
+    U32                 Version;
+    U32                 RecordHeaderSize;
+    U32                 Reserved;
+
+} LRC_FILE_HEADER, *PTR_LRC_FILE_HEADER;
+
+typedef struct _LRC_RECORD_HEADER
+{
+    U8                  Type;
+    U8                  Stream;
+    U8                  CdbLength;          /* CDB bytes following the header */
+    U8                  Reserved;
+
+    U32                 Address;
+    U32                 Value;
+    U32                 Status;
+    U32                 MicroSeconds;       /* Time the exchange took */
+
+    U32                 Length;             /* Bytes of the transfer */
+    U32                 StoredLength;       /* Bytes of data following the CDB */
+
+} LRC_RECORD_HEADER, *PTR_LRC_RECORD_HEADER;
+
+/* One exchange as the bsdi layer sees it, filled by the caller before it goes to the transport */
+typedef struct _LRC_EXCHANGE
+{
+    U32                 Type;
+    U32                 Address;
+    U32                 Value;
+
+    PU8                 PtrCdb;
+    U32                 CdbLength;
+
+    PVOID               PtrData;
+    U32                 Length;
+    BOOLEAN             DataIn;
+
+    U32                 StartTime;
+
+} LRC_EXCHANGE, *PTR_LRC_EXCHANGE;
+
+/* Kept in PtrRecordReplay of a device */
+typedef struct _LRC_STREAM
+{
+    BOOLEAN             Replay;
+    U32                 Index;
+
+    /* Replay only, the records of this device and the offset of the next one */
+    PU8                 PtrRecords;
+    U32                 Size;
+    U32                 Offset;
+    BOOLEAN             RecordedSpeed;
+
+#if defined (OS_LINUX)
+    pthread_mutex_t     Lock;
+#endif
+
+} LRC_STREAM, *PTR_LRC_STREAM;
+
+VOID lrciInitializeExchange (
+    __OUT__ PTR_LRC_EXCHANGE PtrExchange,
+    __IN__  U32 Type,
+    __IN__  U32 Address,
+    __IN__  PVOID PtrData,
+    __IN__  U32 Length,
+    __IN__  BOOLEAN DataIn
+    );
+
+BOOLEAN lrciBeginExchange (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_LRC_EXCHANGE PtrExchange, __OUT__ SCRUTINY_STATUS *PtrStatus);
+
+VOID lrciEndExchange (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ PTR_LRC_EXCHANGE PtrExchange, __IN__ SCRUTINY_STATUS Status);
+
+BOOLEAN lrciIsReplaying (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+VOID lrciAttachDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+VOID lrciFreeDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice);
+
+VOID lrciCloseRecording ();
+
+SCRUTINY_STATUS lrciDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams);
+
+#endif /* __LIB_RECORD__H__ */
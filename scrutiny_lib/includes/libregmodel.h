@@ -0,0 +1,105 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+#ifndef __LIB_REGISTER_MODEL__H__
+#define __LIB_REGISTER_MODEL__H__
+
+/*
+ * Register snapshot of a simulated device, one entry per line, '#' starts a comment
+ *
+ *     <address> <value>                      register contents, both in hex
+ *     script <address> <value> [<value>..]   successive reads return the values in turn,
+ *                                            the last one then stays in the register
+ *     loop <address> <value> [<value>..]     same as script but starts over when done
+ *     latency <microseconds>                 delay added to every register access
+ *
+ * Registers not listed read as zero. Scripts model the hardware which changes under
+ * the host, e.g. the perf monitor FIFO, the Aladin RAM data port or an eye FSM status.
+ */
+
+#define LRM_SNAPSHOT_KEYWORD_SCRIPT        "script"
+#define LRM_SNAPSHOT_KEYWORD_LOOP          "loop"
+#define LRM_SNAPSHOT_KEYWORD_LATENCY       "latency"
+
+#define LRM_REGISTER_ALLOCATION_STEP       (256)
+#define LRM_SCRIPT_ALLOCATION_STEP         (16)
+
+#define LRM_NO_SCRIPT                      (0xFFFFFFFF)
+
+typedef struct _LRM_REGISTER
+{
+    U32                 Address;
+    U32                 Value;
+
+    /* Index into the script table or LRM_NO_SCRIPT */
+    U32                 ScriptIndex;
+
+} LRM_REGISTER, *PTR_LRM_REGISTER;
+
+typedef struct _LRM_SCRIPT
+{
+    PU32                PtrValues;
+    U32                 Count;
+    U32                 Capacity;
+    U32                 Next;
+    BOOLEAN             Loop;
+
+} LRM_SCRIPT, *PTR_LRM_SCRIPT;
+
+typedef struct _LRM_REGISTER_MODEL
+{
+    /* Sorted by address */
+    PTR_LRM_REGISTER   PtrRegisters;
+    U32                 RegisterCount;
+    U32                 RegisterCapacity;
+
+    PTR_LRM_SCRIPT     PtrScripts;
+    U32                 ScriptCount;
+    U32                 ScriptCapacity;
+
+    /* Access counters, kept by the simulator using the model */
+    U32                 ReadCount;
+    U32                 WriteCount;
+
+} LRM_REGISTER_MODEL, *PTR_LRM_REGISTER_MODEL;
+
+SCRUTINY_STATUS lrmiLoadSnapshot (__IN__ const char *PtrFileName, __OUT__ PTR_LRM_REGISTER_MODEL *PtrPtrModel, __OUT__ PU32 PtrLatency);
+
+U32 lrmiReadRegister (__IN__ PTR_LRM_REGISTER_MODEL PtrModel, __IN__ U32 Address);
+
+SCRUTINY_STATUS lrmiWriteRegister (__IN__ PTR_LRM_REGISTER_MODEL PtrModel, __IN__ U32 Address, __IN__ U32 Value);
+
+VOID lrmiFreeModel (__IN__ PTR_LRM_REGISTER_MODEL PtrModel);
+
+#endif /* __LIB_REGISTER_MODEL__H__ */
@@ -52,6 +52,9 @@ VOID lcpiDestryLibraryConfigurations()
         sosiMemFree (gPtrLibraryConfigParams->PtrDebugLogFile);
         gPtrLibraryConfigParams->PtrDebugLogFile = NULL;
 
+        sosiMemFree (gPtrLibraryConfigParams->PtrRecordFile);
+        gPtrLibraryConfigParams->PtrRecordFile = NULL;
+
         sosiMemFree (gPtrLibraryConfigParams);
     }
 
@@ -116,6 +119,7 @@ SCRUTINY_STATUS lcpInitializeDefaultConfigurations()
     gPtrLibraryConfigParams->DebugLogLevelForOthers = SCRUTINY_DEBUG_LOG_LEVEL_NONE;
 
     gPtrLibraryConfigParams->PtrDebugLogFile = NULL;
+    gPtrLibraryConfigParams->PtrRecordFile = NULL;
 
     return (SCRUTINY_STATUS_SUCCESS);
 
@@ -197,6 +201,12 @@ SCRUTINY_STATUS lcpProcessConfigDictionaryEntry (__IN__ PTR_CONFIG_INI_ENTRIES P
         sosiStringCopy (gPtrLibraryConfigParams->PtrDebugLogFile, PtrEntry->Value);
     }
 
+    else if (sosiStringCompare (PtrEntry->Key, SCRUTINY_CONFIG_FILE_KEY_RECORD_FILE) == SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLibraryConfigParams->PtrRecordFile = (char *) sosiMemAlloc (sosiStringLength (PtrEntry->Value) + 2);
+        sosiStringCopy (gPtrLibraryConfigParams->PtrRecordFile, PtrEntry->Value);
+    }
+
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
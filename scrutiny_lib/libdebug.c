@@ -42,6 +42,17 @@ PTR_SCRUTINY_DEBUG_LOGGER           gPtrLoggerOutput = NULL;
 
 static U32 sIndent = 0;
 
+#if defined (OS_LINUX)
+
+static SCRUTINY_LOG_WRITER sLogWriter;
+
+/* Fatal signals after which the pending log text is written out */
+static const int sLogCrashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+
+static struct sigaction sLogCrashActions[sizeof (sLogCrashSignals) / sizeof (sLogCrashSignals[0])];
+
+#endif
+
 VOID ldlInitializeLoggerFromConfigParams (__IN__ PTR_SCRUTINY_DEBUG_LOGGER_INTERNAL PtrModule, __IN__ U32 LogLevel);
 VOID ldlInitializeLoggingForModule (__IN__ PTR_SCRUTINY_DEBUG_LOGGER_INTERNAL PtrModule);
 VOID ldlInitializeLoggingForConfigLevels();
@@ -51,6 +62,13 @@ VOID ldlLogBuffer (__IN__ const char* PtrArguments, __IN__ const char *PtrPrefix
 VOID ldliLogFileBufferWrite (__IN__ const char *PtrLineEntry);
 VOID ldliConsoleBufferWrite (__IN__ const char* PtrLineEntry);
 VOID ldliEmptyOutput (__IN__ const char* PtrLineEntry);
+
+#if defined (OS_LINUX)
+VOID ldlInitializeLogWriter ();
+VOID ldlStartLogWriter ();
+VOID ldlLogWriterDrain (__IN__ PTR_SCRUTINY_LOG_WRITER PtrWriter);
+#endif
+
 /**
  *
  * @method  ldliInitializeDefaultLogging()
@@ -62,6 +80,13 @@ VOID ldliEmptyOutput (__IN__ const char* PtrLineEntry);
 VOID ldliInitializeDefaultLogging()
 {
 
+    #if defined (OS_LINUX)
+    ldlInitializeLogWriter ();
+    #endif
+
+    /* The log file may change with the new configuration */
+    ldliStopLogging ();
+
     if (!gPtrLoggerOutput)
     {
     	gPtrLoggerOutput = (PTR_SCRUTINY_DEBUG_LOGGER) sosiMemAlloc (sizeof (SCRUTINY_DEBUG_LOGGER));
@@ -82,6 +107,15 @@ VOID ldliInitializeDefaultLogging()
 
     ldlInitializeLoggingForConfigLevels();
 
+    #if defined (OS_LINUX)
+
+    if (gPtrLoggerOutput->logiOutput == &ldliLogFileBufferWrite)
+    {
+        ldlStartLogWriter ();
+    }
+
+    #endif
+
 }
 
 /**
@@ -378,7 +412,9 @@ VOID ldliDumpHexMemory (PU8 PtrBuffer, U32 SizeInBytes, PTR_SCRUTINY_DEBUG_LOGGE
  *
  * @return  VOID        No return
  *
- * @brief   Message opens the file and writes the line into the file closes it.
+ * @brief   While the log writer runs the line is only copied into its ring,
+ *          the writer thread puts it into the file. Otherwise the message
+ *          opens the file and writes the line into the file closes it.
  *
  */
 
@@ -387,6 +423,59 @@ VOID ldliLogFileBufferWrite (__IN__ const char *PtrLineEntry)
 
     SOSI_FILE_HANDLE ptrFile;
 
+    #if defined (OS_LINUX)
+
+    U32 length;
+    U32 offset;
+    U32 chunk;
+
+    length = sosiStringLength (PtrLineEntry);
+
+    if (length > SCRUTINY_LOG_RING_SIZE)
+    {
+        length = SCRUTINY_LOG_RING_SIZE;
+    }
+
+    pthread_mutex_lock (&sLogWriter.Lock);
+
+    /* A full ring holds the caller until the writer thread has made room */
+    while (sLogWriter.Running && ((SCRUTINY_LOG_RING_SIZE - (sLogWriter.Head - sLogWriter.Tail)) < length))
+    {
+        pthread_cond_signal (&sLogWriter.Pending);
+        pthread_cond_wait (&sLogWriter.Drained, &sLogWriter.Lock);
+    }
+
+    if (sLogWriter.Running)
+    {
+
+        offset = sLogWriter.Head & (SCRUTINY_LOG_RING_SIZE - 1);
+        chunk = SCRUTINY_LOG_RING_SIZE - offset;
+
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+
+        sosiMemCopy (&sLogWriter.PtrRing[offset], PtrLineEntry, chunk);
+        sosiMemCopy (sLogWriter.PtrRing, PtrLineEntry + chunk, length - chunk);
+
+        sLogWriter.Head += length;
+
+        if ((sLogWriter.Head - sLogWriter.Tail) >= SCRUTINY_LOG_FLUSH_THRESHOLD)
+        {
+            pthread_cond_signal (&sLogWriter.Pending);
+        }
+
+        pthread_mutex_unlock (&sLogWriter.Lock);
+
+        return;
+
+    }
+
+    pthread_mutex_unlock (&sLogWriter.Lock);
+
+    #endif
+
     if (gPtrLibraryConfigParams->PtrDebugLogFile)
     {
         ptrFile = sosiFileOpen (gPtrLibraryConfigParams->PtrDebugLogFile, "a+");
@@ -409,6 +498,417 @@ VOID ldliLogFileBufferWrite (__IN__ const char *PtrLineEntry)
 
 }
 
+#if defined (OS_LINUX)
+
+/**
+ *
+ * @method  ldlLogWriterWrite()
+ *
+ * @param   FileHandle      Log file
+ *
+ * @param   PtrRing         Log ring
+ *
+ * @param   Tail            First byte to be written
+ *
+ * @param   Head            Byte after the last one to be written
+ *
+ * @brief   Writes a range of the ring into the file. Only write () is used,
+ *          so this can be called from a signal handler as well.
+ *
+ */
+
+static VOID ldlLogWriterWrite (__IN__ int FileHandle, __IN__ const char *PtrRing, __IN__ U32 Tail, __IN__ U32 Head)
+{
+
+    U32 offset;
+    U32 chunk;
+    ssize_t written;
+
+    while (Head != Tail)
+    {
+
+        offset = Tail & (SCRUTINY_LOG_RING_SIZE - 1);
+        chunk = SCRUTINY_LOG_RING_SIZE - offset;
+
+        if (chunk > (Head - Tail))
+        {
+            chunk = Head - Tail;
+        }
+
+        written = write (FileHandle, &PtrRing[offset], chunk);
+
+        if (written <= 0)
+        {
+            if ((written < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+
+            /* The file can not take the text, it is dropped rather than holding up the library */
+            return;
+        }
+
+        Tail += (U32) written;
+
+    }
+
+}
+
+/**
+ *
+ * @method  ldlLogWriterDrain()
+ *
+ * @param   PtrWriter       Log writer
+ *
+ * @brief   Writes everything that is in the ring at the time of the call into
+ *          the file. The lines are copied into the ring while this runs, the
+ *          ring lock is only held to take the range and to release it.
+ *
+ */
+
+VOID ldlLogWriterDrain (__IN__ PTR_SCRUTINY_LOG_WRITER PtrWriter)
+{
+
+    U32 head;
+    U32 tail;
+
+    pthread_mutex_lock (&PtrWriter->FileLock);
+
+    pthread_mutex_lock (&PtrWriter->Lock);
+
+    head = PtrWriter->Head;
+    tail = PtrWriter->Tail;
+
+    pthread_mutex_unlock (&PtrWriter->Lock);
+
+    if (head != tail)
+    {
+
+        ldlLogWriterWrite (PtrWriter->FileHandle, PtrWriter->PtrRing, tail, head);
+
+        pthread_mutex_lock (&PtrWriter->Lock);
+
+        PtrWriter->Tail = head;
+
+        pthread_cond_broadcast (&PtrWriter->Drained);
+
+        pthread_mutex_unlock (&PtrWriter->Lock);
+
+    }
+
+    pthread_mutex_unlock (&PtrWriter->FileLock);
+
+}
+
+/**
+ *
+ * @method  ldlLogWriterThread()
+ *
+ * @param   PtrContext      Log writer
+ *
+ * @return  NULL
+ *
+ * @brief   Writes the ring into the file whenever the flush threshold is
+ *          reached, a flush is asked for or the flush interval is over.
+ *          On stop it writes what is left and exits.
+ *
+ */
+
+static void* ldlLogWriterThread (__IN__ void *PtrContext)
+{
+
+    PTR_SCRUTINY_LOG_WRITER ptrWriter = (PTR_SCRUTINY_LOG_WRITER) PtrContext;
+    struct timespec deadline;
+
+    pthread_mutex_lock (&ptrWriter->Lock);
+
+    while (!ptrWriter->Stop)
+    {
+
+        if ((ptrWriter->Head - ptrWriter->Tail) < SCRUTINY_LOG_FLUSH_THRESHOLD)
+        {
+
+            clock_gettime (CLOCK_MONOTONIC, &deadline);
+
+            deadline.tv_nsec += (SCRUTINY_LOG_FLUSH_INTERVAL_US % 1000000) * 1000;
+            deadline.tv_sec += (SCRUTINY_LOG_FLUSH_INTERVAL_US / 1000000) + (deadline.tv_nsec / 1000000000);
+            deadline.tv_nsec %= 1000000000;
+
+            pthread_cond_timedwait (&ptrWriter->Pending, &ptrWriter->Lock, &deadline);
+
+        }
+
+        pthread_mutex_unlock (&ptrWriter->Lock);
+
+        ldlLogWriterDrain (ptrWriter);
+
+        pthread_mutex_lock (&ptrWriter->Lock);
+
+    }
+
+    pthread_mutex_unlock (&ptrWriter->Lock);
+
+    ldlLogWriterDrain (ptrWriter);
+
+    return (NULL);
+
+}
+
+/**
+ *
+ * @method  ldlLogWriterCrashHandler()
+ *
+ * @param   Signal          Fatal signal which has been raised
+ *
+ * @brief   Writes the pending log text, which usually tells why the process
+ *          is going down, and passes the signal on to the handler which was
+ *          installed before the log writer. No lock is taken here, the crash
+ *          may have happened while one was held.
+ *
+ */
+
+static VOID ldlLogWriterCrashHandler (__IN__ int Signal)
+{
+
+    U32 index;
+
+    if (sLogWriter.Running)
+    {
+        ldlLogWriterWrite (sLogWriter.FileHandle, sLogWriter.PtrRing, sLogWriter.Tail, sLogWriter.Head);
+    }
+
+    for (index = 0; index < (sizeof (sLogCrashSignals) / sizeof (sLogCrashSignals[0])); index++)
+    {
+        if (sLogCrashSignals[index] == Signal)
+        {
+            sigaction (Signal, &sLogCrashActions[index], NULL);
+        }
+    }
+
+    raise (Signal);
+
+}
+
+/**
+ *
+ * @method  ldlInitializeLogWriter()
+ *
+ * @brief   One time setup of the log writer locks. It has to be done before
+ *          the first line can reach ldliLogFileBufferWrite. The lines still
+ *          in the ring are written out by ScrutinyExit, a process which exits
+ *          without it loses at most the last flush interval.
+ *
+ */
+
+VOID ldlInitializeLogWriter ()
+{
+
+    static BOOLEAN sInitialized = FALSE;
+    pthread_condattr_t conditionAttributes;
+
+    if (sInitialized)
+    {
+        return;
+    }
+
+    pthread_mutex_init (&sLogWriter.Lock, NULL);
+    pthread_mutex_init (&sLogWriter.FileLock, NULL);
+
+    /* The interval must not jump with the wall clock */
+    pthread_condattr_init (&conditionAttributes);
+    pthread_condattr_setclock (&conditionAttributes, CLOCK_MONOTONIC);
+
+    pthread_cond_init (&sLogWriter.Pending, &conditionAttributes);
+    pthread_cond_init (&sLogWriter.Drained, NULL);
+
+    pthread_condattr_destroy (&conditionAttributes);
+
+    sLogWriter.FileHandle = -1;
+
+    sInitialized = TRUE;
+
+}
+
+/**
+ *
+ * @method  ldlStartLogWriter()
+ *
+ * @brief   Opens the log file once and starts the thread which writes the
+ *          log ring into it. When any of this fails, the lines are written
+ *          straight into the file as before.
+ *
+ */
+
+VOID ldlStartLogWriter ()
+{
+
+    struct sigaction action;
+    const char *ptrFileName = SCRUTINY_FILE_DEFAULT_LOG;
+    U32 index;
+
+    if (sLogWriter.Running)
+    {
+        return;
+    }
+
+    if (gPtrLibraryConfigParams->PtrDebugLogFile)
+    {
+        ptrFileName = gPtrLibraryConfigParams->PtrDebugLogFile;
+    }
+
+    sLogWriter.PtrRing = (char *) sosiMemAlloc (SCRUTINY_LOG_RING_SIZE);
+
+    if (sLogWriter.PtrRing == NULL)
+    {
+        return;
+    }
+
+    sLogWriter.FileHandle = open (ptrFileName, O_WRONLY | O_APPEND | O_CREAT, 0666);
+
+    if (sLogWriter.FileHandle < 0)
+    {
+        sosiMemFree (sLogWriter.PtrRing);
+        sLogWriter.PtrRing = NULL;
+
+        return;
+    }
+
+    sLogWriter.Head = 0;
+    sLogWriter.Tail = 0;
+    sLogWriter.Stop = FALSE;
+
+    if (pthread_create (&sLogWriter.Thread, NULL, ldlLogWriterThread, (void*) &sLogWriter))
+    {
+        close (sLogWriter.FileHandle);
+        sLogWriter.FileHandle = -1;
+
+        sosiMemFree (sLogWriter.PtrRing);
+        sLogWriter.PtrRing = NULL;
+
+        return;
+    }
+
+    pthread_mutex_lock (&sLogWriter.Lock);
+
+    sLogWriter.Running = TRUE;
+
+    pthread_mutex_unlock (&sLogWriter.Lock);
+
+    sosiMemSet (&action, 0, sizeof (action));
+
+    action.sa_handler = ldlLogWriterCrashHandler;
+    sigemptyset (&action.sa_mask);
+
+    for (index = 0; index < (sizeof (sLogCrashSignals) / sizeof (sLogCrashSignals[0])); index++)
+    {
+        sigaction (sLogCrashSignals[index], &action, &sLogCrashActions[index]);
+    }
+
+}
+
+#endif
+
+/**
+ *
+ * @method  ldliFlushLogging()
+ *
+ * @brief   Writes the log lines which are still waiting in the log ring into
+ *          the file and returns once they are there.
+ *
+ */
+
+VOID ldliFlushLogging ()
+{
+
+    #if defined (OS_LINUX)
+
+    pthread_mutex_lock (&sLogWriter.Lock);
+
+    if (!sLogWriter.Running)
+    {
+        pthread_mutex_unlock (&sLogWriter.Lock);
+
+        return;
+    }
+
+    pthread_mutex_unlock (&sLogWriter.Lock);
+
+    ldlLogWriterDrain (&sLogWriter);
+
+    #endif
+
+}
+
+/**
+ *
+ * @method  ldliStopLogging()
+ *
+ * @brief   Stops the log writer after it has written everything in the
+ *          ring and closes the log file. Lines logged afterwards go straight
+ *          into the file again.
+ *
+ */
+
+VOID ldliStopLogging ()
+{
+
+    #if defined (OS_LINUX)
+
+    U32 index;
+    struct sigaction current;
+
+    if (sLogWriter.PtrRing == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock (&sLogWriter.Lock);
+
+    sLogWriter.Stop = TRUE;
+
+    pthread_cond_signal (&sLogWriter.Pending);
+
+    pthread_mutex_unlock (&sLogWriter.Lock);
+
+    pthread_join (sLogWriter.Thread, NULL);
+
+    /* A handler the application installed after ours stays in place */
+    for (index = 0; index < (sizeof (sLogCrashSignals) / sizeof (sLogCrashSignals[0])); index++)
+    {
+        if ((sigaction (sLogCrashSignals[index], NULL, &current) == 0) &&
+            (!(current.sa_flags & SA_SIGINFO)) && (current.sa_handler == ldlLogWriterCrashHandler))
+        {
+            sigaction (sLogCrashSignals[index], &sLogCrashActions[index], NULL);
+        }
+    }
+
+    pthread_mutex_lock (&sLogWriter.Lock);
+
+    sLogWriter.Running = FALSE;
+
+    pthread_cond_broadcast (&sLogWriter.Drained);
+
+    pthread_mutex_unlock (&sLogWriter.Lock);
+
+    pthread_mutex_lock (&sLogWriter.FileLock);
+
+    /* A caller may have put a line into the ring after the last flush of the thread */
+    ldlLogWriterWrite (sLogWriter.FileHandle, sLogWriter.PtrRing, sLogWriter.Tail, sLogWriter.Head);
+
+    sLogWriter.Tail = sLogWriter.Head;
+
+    close (sLogWriter.FileHandle);
+    sLogWriter.FileHandle = -1;
+
+    sosiMemFree (sLogWriter.PtrRing);
+    sLogWriter.PtrRing = NULL;
+
+    pthread_mutex_unlock (&sLogWriter.FileLock);
+
+    #endif
+
+}
+
 /**
  *
  * @method  ldliConsoleBufferWrite()
@@ -447,23 +947,13 @@ VOID ldliConsoleBufferWrite (__IN__ const char* PtrLineEntry)
 VOID ldlLogBuffer (__IN__ const char* PtrArguments, __IN__ const char *PtrPrefix, __IN__ va_list VariableArguments, __IN__ BOOLEAN LineFeed)
 {
 
-    char buffer[2048] = { 0 };
-    char logentry[2048] = { 0 };
-    char prefix[256] = { 0 };
+    char logentry[2048];
+    U32 length = 0;
+    U32 prefixLength;
     U32 index;
 
     #ifdef OS_UEFI
-
-        CHAR8 *ptrTemp = (CHAR8*) PtrArguments;
-
-        ptrTemp = efiiFixStringTypeSpecifier (ptrTemp);
-
-        AsciiVSPrint (buffer, sizeof (buffer), (const CHAR8 *) ptrTemp, VariableArguments);
-
-    #else
-
-        vsprintf (buffer, PtrArguments, VariableArguments);
-
+    CHAR8 *ptrTemp = (CHAR8*) PtrArguments;
     #endif
 
     for (index = 0; index < sIndent * 2; index++)
@@ -473,24 +963,48 @@ VOID ldlLogBuffer (__IN__ const char* PtrArguments, __IN__ const char *PtrPrefix
             break;
         }
 
-        prefix[index] = ' ';
+        logentry[length++] = ' ';
 
     }
 
     if (PtrPrefix)
     {
-        sosiSprintf (prefix, sizeof (prefix), "%s%s", prefix, PtrPrefix);
+
+        prefixLength = sosiStringLength (PtrPrefix);
+
+        if (prefixLength > 255 - length)
+        {
+            prefixLength = 255 - length;
+        }
+
+        sosiMemCopy (&logentry[length], PtrPrefix, prefixLength);
+
+        length += prefixLength;
+
     }
 
+    /* The message is formatted straight behind the prefix, one byte stays free for the line feed */
+
+    #ifdef OS_UEFI
+
+        ptrTemp = efiiFixStringTypeSpecifier (ptrTemp);
+
+        AsciiVSPrint (&logentry[length], sizeof (logentry) - length - 1, (const CHAR8 *) ptrTemp, VariableArguments);
+
+    #else
+
+        vsnprintf (&logentry[length], sizeof (logentry) - length - 1, PtrArguments, VariableArguments);
+
+    #endif
+
+    length += sosiStringLength (&logentry[length]);
+
     if (LineFeed)
     {
-        sosiSprintf (logentry, sizeof (logentry), "%s%s\n", prefix, buffer);
+        logentry[length++] = '\n';
     }
 
-    else
-    {
-        sosiSprintf (logentry, sizeof (logentry), "%s%s", prefix, buffer);
-    }
+    logentry[length] = '\0';
 
     gPtrLoggerOutput->logiOutput (logentry);
 
@@ -65,6 +65,137 @@ SCRUTINY_STATUS ldmiInitializeLibraryDeviceManager (__INOUT__ PTR_SCRUTINY_DEVIC
 
 }
 
+/**
+ *
+ * @method  ldmCloseDevice ()
+ *
+ * @param   PtrDevice - Pointer to the device
+ *
+ * @return  lsi_status  Indicating Success or Fail
+ *
+ * @brief   Close the device through its product family
+ *
+*/
+
+static SCRUTINY_STATUS ldmCloseDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    switch (PtrDevice->ProductFamily)
+    {
+    	#if defined (LIB_SUPPORT_CONTROLLER)
+        case SCRUTINY_PRODUCT_FAMILY_CONTROLLER:
+        {
+            /* We will first close the device */
+            cdmiCloseDevice (PtrDevice);
+            break;
+        }
+		#endif
+
+		#if defined (LIB_SUPPORT_EXPANDER)
+
+        case SCRUTINY_PRODUCT_FAMILY_EXPANDER:
+        {
+			if (PtrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC) 
+			{
+				break;
+			}
+			
+            /* We will first close the device */				
+            edmiCloseDevice (PtrDevice);
+            break;
+
+        }
+		#endif
+		#if defined (LIB_SUPPORT_SWITCH)
+        case SCRUTINY_PRODUCT_FAMILY_SWITCH:
+        {
+			if (PtrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC) 
+			{
+				break;
+			}
+			
+            /* We will first close the device */
+            sdmiCloseDevice (PtrDevice);
+            break;
+        }
+		#endif
+
+        default:
+        {
+            break;
+        }
+    }
+
+    lrciFreeDevice (PtrDevice);
+
+    #if defined (OS_LINUX)
+
+    if (PtrDevice->AccessLockValid)
+    {
+        pthread_mutex_destroy (&PtrDevice->AccessLock);
+        PtrDevice->AccessLockValid = FALSE;
+    }
+
+    #endif
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  ldmiLockDevice ()
+ *
+ * @param   PtrDevice - Pointer to the device
+ *
+ * @brief   Takes the access lock of the device. Every access which is made
+ *          of several register operations (a Chime to AXI cycle, an SDB
+ *          command, a probe RAM read out) holds it from the first to the
+ *          last operation, so a background sampler and the API calls don't
+ *          interleave on the device. The lock is recursive. Devices which
+ *          are not in the device manager yet are only used by the thread
+ *          discovering them and are not locked.
+ *
+*/
+
+VOID ldmiLockDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    #if defined (OS_LINUX)
+
+    if (PtrDevice->AccessLockValid)
+    {
+        pthread_mutex_lock (&PtrDevice->AccessLock);
+    }
+
+    #endif
+
+}
+
+/**
+ *
+ * @method  ldmiUnlockDevice ()
+ *
+ * @param   PtrDevice - Pointer to the device
+ *
+ * @brief   Releases the access lock taken with ldmiLockDevice
+ *
+*/
+
+VOID ldmiUnlockDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    #if defined (OS_LINUX)
+
+    if (PtrDevice->AccessLockValid)
+    {
+        pthread_mutex_unlock (&PtrDevice->AccessLock);
+    }
+
+    #endif
+
+}
+
 /**
  *
  * @method  ldmiFreeDevices ()
@@ -92,61 +223,281 @@ SCRUTINY_STATUS ldmiFreeDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDevice
     for (index = 0; index < PtrDeviceManager->DeviceCount; index++)
     {
 
-        switch (PtrDeviceManager->PtrDeviceList[index]->ProductFamily)
+        /* Devices which went away on an incremental discovery leave an empty slot */
+        if (PtrDeviceManager->PtrDeviceList[index] == NULL)
+        {
+            continue;
+        }
+
+        ldmCloseDevice (PtrDeviceManager->PtrDeviceList[index]);
+
+    }
+
+    sosiMemFree (PtrDeviceManager->PtrDeviceList);
+    PtrDeviceManager->PtrDeviceList = NULL;
+
+    sosiMemFree (PtrDeviceManager->PtrDiscoveryParams);
+    PtrDeviceManager->PtrDiscoveryParams = NULL;
+
+    PtrDeviceManager->DeviceCount = 0;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  ldmiRetainDevices ()
+ *
+ * @param   PtrDeviceManager - Pointer to device manger structure
+ *
+ * @return  lsi_status  Indicating Success or Fail
+ *
+ * @brief   Start an incremental discovery. The current devices are moved aside
+ *          without being closed, the discovery then starts with an empty list.
+ *          Devices the discovery finds again are re-added as they are and get
+ *          their slot back in ldmiCompleteRetainedDevices.
+ *
+*/
+
+SCRUTINY_STATUS ldmiRetainDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager)
+{
+
+    #if defined (LIB_SUPPORT_SWITCH)
+    U32 index;
+    #endif
+
+    if (PtrDeviceManager->PtrRetainedList != NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    PtrDeviceManager->PtrRetainedList = PtrDeviceManager->PtrDeviceList;
+    PtrDeviceManager->RetainedCount = PtrDeviceManager->DeviceCount;
+
+    #if defined (LIB_SUPPORT_SWITCH)
+
+    /* Whatever was cached about the devices has to be read again */
+    for (index = 0; index < PtrDeviceManager->RetainedCount; index++)
+    {
+        if ((PtrDeviceManager->PtrRetainedList[index] != NULL) &&
+            (PtrDeviceManager->PtrRetainedList[index]->ProductFamily == SCRUTINY_PRODUCT_FAMILY_SWITCH))
+        {
+            sdmiInvalidateDevice (PtrDeviceManager->PtrRetainedList[index]);
+        }
+    }
+
+    #endif
+
+    PtrDeviceManager->PtrDeviceList = NULL;
+    PtrDeviceManager->DeviceCount = 0;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ * @method  ldmiIsRetainedDevice ()
+ *
+ * @param   PtrDeviceManager - Pointer to device manger structure
+ *
+ * @param   PtrDevice - Pointer to the device
+ *
+ * @return  TRUE when the device belongs to the previous discovery
+ *
+ * @brief   Retained devices must not be freed by the discovery code when they
+ *          can't be added again, ldmiCompleteRetainedDevices takes care of them.
+ *
+*/
+
+BOOLEAN ldmiIsRetainedDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager, __IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    U32 index;
+
+    for (index = 0; index < PtrDeviceManager->RetainedCount; index++)
+    {
+        if ((PtrDeviceManager->PtrRetainedList[index] != NULL) && (PtrDeviceManager->PtrRetainedList[index] == PtrDevice))
+        {
+            return (TRUE);
+        }
+    }
+
+    return (FALSE);
+
+}
+
+/**
+ *
+ * @method  ldmIsListedDevice ()
+ *
+ * @param   PtrDeviceManager - Pointer to device manger structure
+ *
+ * @param   PtrDevice - Device to look for
+ *
+ * @return  TRUE if the device is in the device list
+ *
+*/
+
+static BOOLEAN ldmIsListedDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager, __IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    U32 index;
+
+    for (index = 0; index < PtrDeviceManager->DeviceCount; index++)
+    {
+        if (PtrDeviceManager->PtrDeviceList[index] == PtrDevice)
+        {
+            return (TRUE);
+        }
+    }
+
+    return (FALSE);
+
+}
+
+/**
+ *
+ * @method  ldmiCompleteRetainedDevices ()
+ *
+ * @param   PtrDeviceManager - Pointer to device manger structure
+ *
+ * @return  lsi_status  Indicating Success or Fail
+ *
+ * @brief   Finish an incremental discovery. Devices found again go back to the
+ *          slot they had, so their product handle does not change. Retained
+ *          devices which were not found are closed and released, new devices
+ *          take the free slots first and are appended after that. Without
+ *          memory for the slots the devices keep the order of this discovery,
+ *          the retained ones which were not found are released all the same.
+ *
+*/
+
+SCRUTINY_STATUS ldmiCompleteRetainedDevices (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER PtrDeviceManager)
+{
+
+    U32 index;
+    U32 slot;
+    U32 slotCount;
+    U32 deviceCount = 0;
+    BOOLEAN placed;
+    PTR_SCRUTINY_DEVICE *ptrSlots;
+
+    slotCount = PtrDeviceManager->RetainedCount + PtrDeviceManager->DeviceCount;
+
+    ptrSlots = (PTR_SCRUTINY_DEVICE *) sosiMemAlloc (sizeof (PTR_SCRUTINY_DEVICE) * (slotCount + 1));
+
+    if (ptrSlots == NULL)
+    {
+
+        for (slot = 0; slot < PtrDeviceManager->RetainedCount; slot++)
         {
-        	#if defined (LIB_SUPPORT_CONTROLLER)
-            case SCRUTINY_PRODUCT_FAMILY_CONTROLLER:
+
+            if ((PtrDeviceManager->PtrRetainedList[slot] == NULL) ||
+                (ldmIsListedDevice (PtrDeviceManager, PtrDeviceManager->PtrRetainedList[slot])))
             {
-                /* We will first close the device */
-                cdmiCloseDevice (PtrDeviceManager->PtrDeviceList[index]);
-                break;
+                continue;
             }
-			#endif
 
-			#if defined (LIB_SUPPORT_EXPANDER)
+            ldmCloseDevice (PtrDeviceManager->PtrRetainedList[slot]);
 
-            case SCRUTINY_PRODUCT_FAMILY_EXPANDER:
-            {
-				if (PtrDeviceManager->PtrDeviceList[index]->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC) 
-				{
-					break;
-				}
-				
-                /* We will first close the device */				
-                edmiCloseDevice (PtrDeviceManager->PtrDeviceList[index]);
-                break;
+            sosiMemFree (PtrDeviceManager->PtrRetainedList[slot]);
 
-            }
-			#endif
-			#if defined (LIB_SUPPORT_SWITCH)
-            case SCRUTINY_PRODUCT_FAMILY_SWITCH:
+        }
+
+        sosiMemFree (PtrDeviceManager->PtrRetainedList);
+
+        PtrDeviceManager->PtrRetainedList = NULL;
+        PtrDeviceManager->RetainedCount = 0;
+
+        return (SCRUTINY_STATUS_NO_MEMORY);
+
+    }
+
+    sosiMemSet (ptrSlots, 0, sizeof (PTR_SCRUTINY_DEVICE) * (slotCount + 1));
+
+    /* Survivors first, each one goes back into the slot it had */
+    for (index = 0; index < PtrDeviceManager->DeviceCount; index++)
+    {
+
+        for (slot = 0; slot < PtrDeviceManager->RetainedCount; slot++)
+        {
+            if (PtrDeviceManager->PtrRetainedList[slot] == PtrDeviceManager->PtrDeviceList[index])
             {
-				if (PtrDeviceManager->PtrDeviceList[index]->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC) 
-				{
-					break;
-				}
-				
-                /* We will first close the device */
-                sdmiCloseDevice (PtrDeviceManager->PtrDeviceList[index]);
+                ptrSlots[slot] = PtrDeviceManager->PtrDeviceList[index];
+
+                PtrDeviceManager->PtrRetainedList[slot] = NULL;
+                PtrDeviceManager->PtrDeviceList[index] = NULL;
+
                 break;
             }
-			#endif
+        }
+
+    }
 
-            default:
+    /* Whatever is left of the previous discovery is gone */
+    for (slot = 0; slot < PtrDeviceManager->RetainedCount; slot++)
+    {
+
+        if (PtrDeviceManager->PtrRetainedList[slot] == NULL)
+        {
+            continue;
+        }
+
+        gPtrLoggerGeneric->logiDebug ("Device with handle %x is not present anymore", slot + 1);
+
+        ldmCloseDevice (PtrDeviceManager->PtrRetainedList[slot]);
+
+        sosiMemFree (PtrDeviceManager->PtrRetainedList[slot]);
+
+    }
+
+    /* New devices fill the free slots and then get appended */
+    for (index = 0; index < PtrDeviceManager->DeviceCount; index++)
+    {
+
+        if (PtrDeviceManager->PtrDeviceList[index] == NULL)
+        {
+            continue;
+        }
+
+        placed = FALSE;
+
+        for (slot = 0; (slot < slotCount) && (!placed); slot++)
+        {
+            if (ptrSlots[slot] == NULL)
             {
-                break;
+                ptrSlots[slot] = PtrDeviceManager->PtrDeviceList[index];
+                placed = TRUE;
             }
         }
 
     }
 
+    for (slot = 0; slot < slotCount; slot++)
+    {
+        if (ptrSlots[slot] != NULL)
+        {
+            ptrSlots[slot]->DeviceInfo.ProductHandle = slot + 1;
+            deviceCount = slot + 1;
+        }
+    }
+
+    sosiMemFree (PtrDeviceManager->PtrRetainedList);
     sosiMemFree (PtrDeviceManager->PtrDeviceList);
-    PtrDeviceManager->PtrDeviceList = NULL;
 
-    sosiMemFree (PtrDeviceManager->PtrDiscoveryParams);
-    PtrDeviceManager->PtrDiscoveryParams = NULL;
+    PtrDeviceManager->PtrRetainedList = NULL;
+    PtrDeviceManager->RetainedCount = 0;
 
-    PtrDeviceManager->DeviceCount = 0;
+    if (deviceCount == 0)
+    {
+        sosiMemFree (ptrSlots);
+        ptrSlots = NULL;
+    }
+
+    PtrDeviceManager->PtrDeviceList = ptrSlots;
+    PtrDeviceManager->DeviceCount = deviceCount;
 
     return (SCRUTINY_STATUS_SUCCESS);
 
@@ -177,7 +528,7 @@ BOOLEAN ldmHasDuplicateScsiDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrScrutin
     }
 
 	//This has to be enabled only when we add expander support to BMC
-	if (PtrScrutinyLibManager->PtrDeviceList[index]->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC) 
+	if ((PtrScrutinyLibManager->PtrDeviceList[index] != NULL) && (PtrScrutinyLibManager->PtrDeviceList[index]->HandleType & SCRUTINY_HANDLE_TYPE_MASK_BMC)) 
 	{
 		return (FALSE);
 	}
@@ -189,6 +540,11 @@ BOOLEAN ldmHasDuplicateScsiDevice (__IN__ PTR_SCRUTINY_DEVICE_MANAGER PtrScrutin
 
     for (index = 0; index < PtrScrutinyLibManager->DeviceCount; index++)
     {
+        if (PtrScrutinyLibManager->PtrDeviceList[index] == NULL)
+        {
+            continue;
+        }
+
         if (!(PtrScrutinyLibManager->PtrDeviceList[index]->HandleType & SCRUTINY_HANDLE_TYPE_MASK_SCSI))
         {
             continue;
@@ -274,10 +630,31 @@ SCRUTINY_STATUS ldmiAddScrutinyDevice (__INOUT__ PTR_SCRUTINY_DEVICE_MANAGER Ptr
 
     PtrDevice->DeviceInfo.ProductHandle = PtrScrutinyLibManager->DeviceCount + 1;
 
+    #if defined (OS_LINUX)
+
+    /* A retained device comes back with its lock */
+    if (!PtrDevice->AccessLockValid)
+    {
+        pthread_mutexattr_t attributes;
+
+        pthread_mutexattr_init (&attributes);
+        pthread_mutexattr_settype (&attributes, PTHREAD_MUTEX_RECURSIVE);
+
+        pthread_mutex_init (&PtrDevice->AccessLock, &attributes);
+
+        pthread_mutexattr_destroy (&attributes);
+
+        PtrDevice->AccessLockValid = TRUE;
+    }
+
+    #endif
+
     PtrScrutinyLibManager->PtrDeviceList[PtrScrutinyLibManager->DeviceCount] = PtrDevice;
 
     PtrScrutinyLibManager->DeviceCount++;
 
+    lrciAttachDevice (PtrDevice);
+
     return (SCRUTINY_STATUS_SUCCESS);
 
 }
@@ -110,6 +110,12 @@ SCRUTINY_STATUS slibiExitLibrary()
 
     ldmiFreeDevices (gPtrScrutinyDeviceManager);
 
+    #if defined (OS_LINUX) && !defined (OS_VMWARE)
+    sdbsimiStopSimulator ();
+    #endif
+
+    lrciCloseRecording ();
+
     #ifdef OS_UEFI
 
         /*
@@ -130,6 +136,9 @@ SCRUTINY_STATUS slibiExitLibrary()
     //sosiMemFree (gPtrLoggerController);
     sosiMemFree (gPtrScrutinyDeviceManager);
 
+    /* Everything logged so far has to be in the file before the configuration goes */
+    ldliStopLogging ();
+
     lcpiDestryLibraryConfigurations();
 
     /* Restore the global variables to NULL */
@@ -159,6 +168,9 @@ SCRUTINY_STATUS slibiDiscoverDevices (__IN__ U32 DiscoveryFlag, __IN__ PTR_SCRUT
 {
 
     SCRUTINY_STATUS status;
+    SCRUTINY_STATUS retainStatus = SCRUTINY_STATUS_SUCCESS;
+    SCRUTINY_STATUS simulatedStatus = SCRUTINY_STATUS_IGNORE;
+    BOOLEAN incremental;
 
     /* Every time when discovery is called, we will have to reinitialize the device. So, we always get the fresh entries
        added. Hence call the device manager and cleanup the device */
@@ -166,7 +178,30 @@ SCRUTINY_STATUS slibiDiscoverDevices (__IN__ U32 DiscoveryFlag, __IN__ PTR_SCRUT
     /* NOTE: ldmiFreeDevice will not or should not free the gPtrScrutinyDeviceManager */
     gPtrLoggerGeneric->logiFunctionEntry ("slibiDiscoverDevices (%X, %X)", DiscoveryFlag, (PtrDiscoveryFilter != NULL));
 
-    ldmiFreeDevices (gPtrScrutinyDeviceManager);
+    /*
+     * Incremental discovery keeps the devices of the previous inband discovery aside, the
+     * discovery then reuses the ones which are still there instead of qualifying them again.
+     */
+
+    incremental = ((DiscoveryFlag & SCRUTINY_DISCOVERY_FLAG_INCREMENTAL) &&
+                   ((DiscoveryFlag & SCRUTINY_DISCOVERY_TYPE_MASK) == SCRUTINY_DISCOVERY_TYPE_INBAND) &&
+                   (gPtrScrutinyDeviceManager->DiscoveryFlag == SCRUTINY_DISCOVERY_TYPE_INBAND) &&
+                   (gPtrScrutinyDeviceManager->DeviceCount != 0));
+
+    DiscoveryFlag &= SCRUTINY_DISCOVERY_TYPE_MASK;
+
+    if (incremental)
+    {
+        ldmiRetainDevices (gPtrScrutinyDeviceManager);
+
+        sosiMemFree (gPtrScrutinyDeviceManager->PtrDiscoveryParams);
+        gPtrScrutinyDeviceManager->PtrDiscoveryParams = NULL;
+    }
+
+    else
+    {
+        ldmiFreeDevices (gPtrScrutinyDeviceManager);
+    }
 
     gPtrScrutinyDeviceManager->DiscoveryFlag = DiscoveryFlag;
 
@@ -185,6 +220,34 @@ SCRUTINY_STATUS slibiDiscoverDevices (__IN__ U32 DiscoveryFlag, __IN__ PTR_SCRUT
             break;
         }
 
+        case SCRUTINY_DISCOVERY_TYPE_SIMULATED:
+        {
+            /*
+             * Only simulated devices, no hardware is scanned. Each backend ignores the
+             * simulator types of the others, the first one which does not owns the result.
+             */
+        #if defined (LIB_SUPPORT_SWITCH)
+            simulatedStatus = ssimiDiscoverDevices (gPtrScrutinyDeviceManager->PtrDiscoveryParams);
+        #endif
+        #if defined (OS_LINUX) && !defined (OS_VMWARE)
+            if (simulatedStatus == SCRUTINY_STATUS_IGNORE)
+            {
+                simulatedStatus = sgemiDiscoverDevices (gPtrScrutinyDeviceManager->PtrDiscoveryParams);
+            }
+
+            if (simulatedStatus == SCRUTINY_STATUS_IGNORE)
+            {
+                simulatedStatus = sdbsimiDiscoverDevices (gPtrScrutinyDeviceManager->PtrDiscoveryParams);
+            }
+        #endif
+            if (simulatedStatus == SCRUTINY_STATUS_IGNORE)
+            {
+                simulatedStatus = lrciDiscoverDevices (gPtrScrutinyDeviceManager->PtrDiscoveryParams);
+            }
+
+            break;
+        }
+
         default:
         {
          
@@ -198,14 +261,32 @@ SCRUTINY_STATUS slibiDiscoverDevices (__IN__ U32 DiscoveryFlag, __IN__ PTR_SCRUT
 
 
     if ((DiscoveryFlag != SCRUTINY_DISCOVERY_TYPE_OOB_I2C) &&
-        (DiscoveryFlag != SCRUTINY_DISCOVERY_TYPE_OOB_PCI))
+        (DiscoveryFlag != SCRUTINY_DISCOVERY_TYPE_OOB_PCI) &&
+        (DiscoveryFlag != SCRUTINY_DISCOVERY_TYPE_SIMULATED))
     {
         bsdiDiscoverDevices();
     }
 
+    if (incremental)
+    {
+        retainStatus = ldmiCompleteRetainedDevices (gPtrScrutinyDeviceManager);
+    }
+
     gPtrLoggerGeneric->logiDebug ("Number of valid device found %x", gPtrScrutinyDeviceManager->DeviceCount);
 
-    if (gPtrScrutinyDeviceManager->DeviceCount)
+    if (retainStatus != SCRUTINY_STATUS_SUCCESS)
+    {
+        /* The devices are listed, but the product handles of the previous discovery may have moved */
+        status = retainStatus;
+    }
+
+    else if ((simulatedStatus != SCRUTINY_STATUS_IGNORE) && (simulatedStatus != SCRUTINY_STATUS_SUCCESS))
+    {
+        /* Tell why the simulator, emulator or replay could not be brought up */
+        status = simulatedStatus;
+    }
+
+    else if (gPtrScrutinyDeviceManager->DeviceCount)
     {
         status = SCRUTINY_STATUS_SUCCESS;
     }
@@ -401,7 +482,7 @@ SCRUTINY_STATUS slibiGetCoreDump (
     __IN__      const char*                     PtrFolderName
     )
 {
-    SCRUTINY_STATUS         status;
+    SCRUTINY_STATUS         status = SCRUTINY_STATUS_UNSUPPORTED;
 
     switch (PtrDevice->ProductFamily)
     {
@@ -411,7 +492,6 @@ SCRUTINY_STATUS slibiGetCoreDump (
             if (PtrDevice->DeviceInfo.u.ControllerInfo.ControllerType == SCRUTINY_CONTROLLER_TYPE_GEN3_IT_IR)
             {
                 status = ccdiGetCoreDumpImage (PtrDevice, PtrBuffer, PtrBufferSize, PtrFolderName);
-                return status;
             }
 
             break;
@@ -421,14 +501,14 @@ SCRUTINY_STATUS slibiGetCoreDump (
         case SCRUTINY_PRODUCT_FAMILY_EXPANDER:
         {
             status = ecdiGetCoreDump (PtrDevice, PtrBuffer, PtrBufferSize, Type, PtrFolderName);
-            return (status);
+            break;
         }
 		#endif
 		#if defined (LIB_SUPPORT_SWITCH)
         case SCRUTINY_PRODUCT_FAMILY_SWITCH:
         {
             status = ecdiGetCoreDump (PtrDevice, PtrBuffer, PtrBufferSize, Type, PtrFolderName);
-            return (status);
+            break;
         }
 		#endif
 
@@ -444,7 +524,13 @@ SCRUTINY_STATUS slibiGetCoreDump (
 
     }
 
-    return (SCRUTINY_STATUS_UNSUPPORTED);
+    if ((status != SCRUTINY_STATUS_SUCCESS) && (status != SCRUTINY_STATUS_UNSUPPORTED))
+    {
+        /* The log of a failed upload has to be on disk before the caller acts on it */
+        ldliFlushLogging ();
+    }
+
+    return (status);
 }
 
 /**
@@ -719,6 +805,8 @@ SCRUTINY_STATUS slibiGetHealthLogs (
     __IN__ const char*                      PtrFolderName
 )
 {
+    SCRUTINY_STATUS         status = SCRUTINY_STATUS_UNSUPPORTED;
+
     switch (PtrDevice->ProductFamily)
     {
         case SCRUTINY_PRODUCT_FAMILY_CONTROLLER:
@@ -738,7 +826,7 @@ SCRUTINY_STATUS slibiGetHealthLogs (
                 PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
             {
 
-                return (ehliGetHealthLogs (PtrDevice, PtrBuffer, PtrBufferLength, Flags, PtrFolderName));
+                status = ehliGetHealthLogs (PtrDevice, PtrBuffer, PtrBufferLength, Flags, PtrFolderName);
             }
             break;
         }
@@ -755,7 +843,7 @@ SCRUTINY_STATUS slibiGetHealthLogs (
                 PtrDevice->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
             {
             
-                return (ehliGetHealthLogs (PtrDevice, PtrBuffer, PtrBufferLength, Flags, PtrFolderName));
+                status = ehliGetHealthLogs (PtrDevice, PtrBuffer, PtrBufferLength, Flags, PtrFolderName);
             }
             break;
         }
@@ -773,7 +861,13 @@ SCRUTINY_STATUS slibiGetHealthLogs (
 
     }
 
-    return (SCRUTINY_STATUS_UNSUPPORTED);
+    if ((status != SCRUTINY_STATUS_SUCCESS) && (status != SCRUTINY_STATUS_UNSUPPORTED))
+    {
+        /* The log of a failed upload has to be on disk before the caller acts on it */
+        ldliFlushLogging ();
+    }
+
+    return (status);
 }
 
 
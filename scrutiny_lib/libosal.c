@@ -2000,6 +2000,65 @@ VOID sosiSleep (U32 Milli)
 
 }
 
+/**
+ *
+ *  @method     sosiMicroSleep()
+ *
+ *  @param      Micro       Micro-seconds to sleep
+ *
+ *  @return     VOID        No return value.
+ *
+ *  @brief      Short sleep used as back-off while polling hardware
+ *
+ */
+
+VOID sosiMicroSleep (U32 Micro)
+{
+
+    #if defined(OS_LINUX) || defined(OS_FREEBSD) || defined(OS_VMWARE) || defined (OS_BMC)
+    usleep (Micro);
+    #elif OS_WINDOWS
+    Sleep ((Micro + 999) / 1000);
+    #elif defined(OS_UEFI)
+    lefiDelay (Micro);
+    #endif
+
+}
+
+/**
+ *
+ *  @method     sosiGetMicroSeconds()
+ *
+ *  @return     U32         Monotonic time stamp in micro-seconds
+ *
+ *  @brief      Time stamp for measuring short intervals. The value wraps, so
+ *              only the unsigned difference of two stamps is meaningful.
+ *
+ */
+
+U32 sosiGetMicroSeconds ()
+{
+
+    #if defined(OS_LINUX) || defined(OS_FREEBSD) || defined(OS_VMWARE) || defined (OS_BMC)
+
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return ((U32) ((now.tv_sec * 1000000) + (now.tv_nsec / 1000)));
+
+    #elif OS_WINDOWS
+
+    return ((U32) (GetTickCount () * 1000));
+
+    #else
+
+    return (0);
+
+    #endif
+
+}
+
 /**
  *
  *
@@ -0,0 +1,853 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+
+
+#include "libincludes.h"
+
+/* The trace being recorded, shared by all streams */
+static SOSI_FILE_HANDLE     gLrcRecordFile = NULL;
+static U32                  gLrcStreamCount = 0;
+static BOOLEAN              gLrcRecordFailed = FALSE;
+
+#if defined (OS_LINUX)
+static pthread_mutex_t      gLrcRecordLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ *
+ *  @method  lrcLockRecorder()
+ *
+ *  @param   Lock               TRUE to take the trace file, FALSE to release it
+ *
+ *  @return  none
+ *
+ *  @brief   The switch performance sampler reads registers from its own thread,
+ *           its records have to go into the file whole
+ *
+ */
+
+static VOID lrcLockRecorder (__IN__ BOOLEAN Lock)
+{
+
+#if defined (OS_LINUX)
+    if (Lock)
+    {
+        pthread_mutex_lock (&gLrcRecordLock);
+    }
+
+    else
+    {
+        pthread_mutex_unlock (&gLrcRecordLock);
+    }
+#endif
+
+}
+
+/**
+ *
+ *  @method  lrcIsTransportLevel()
+ *
+ *  @param   PtrDevice          Device of the exchange
+ *
+ *  @param   Type               LRC_RECORD_TYPE_* of the exchange
+ *
+ *  @return  BOOLEAN            TRUE when the exchange is traced on this device
+ *
+ *  @brief   A memory access on a SCSI device ends in a READ or WRITE BUFFER which
+ *           is traced as a command, tracing the access as well would serve it twice
+ *
+ */
+
+static BOOLEAN lrcIsTransportLevel (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ U32 Type)
+{
+
+    if ((Type != LRC_RECORD_TYPE_MEMORY_READ) &&
+        (Type != LRC_RECORD_TYPE_MEMORY_WRITE) &&
+        (Type != LRC_RECORD_TYPE_FIFO_READ))
+    {
+        return (TRUE);
+    }
+
+    return ((PtrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_SCSI) ? FALSE : TRUE);
+
+}
+
+/**
+ *
+ *  @method  lrcWriteRecord()
+ *
+ *  @param   PtrRecord          Record header, Stream already set
+ *
+ *  @param   PtrCdb             CDB of a SCSI record, NULL otherwise
+ *
+ *  @param   PtrData            Data stored with the record
+ *
+ *  @return  none
+ *
+ *  @brief   Appends one record to the trace, the caller holds the recorder lock.
+ *           A write failure ends the recording rather than leaving a torn trace.
+ *
+ */
+
+static VOID lrcWriteRecord (__IN__ PTR_LRC_RECORD_HEADER PtrRecord, __IN__ const U8 *PtrCdb, __IN__ const U8 *PtrData)
+{
+
+    SCRUTINY_STATUS status;
+
+    if (gLrcRecordFile == NULL)
+    {
+        return;
+    }
+
+    status = sosiFileWrite (gLrcRecordFile, (const U8 *) PtrRecord, sizeof (LRC_RECORD_HEADER));
+
+    if ((status == SCRUTINY_STATUS_SUCCESS) && (PtrRecord->CdbLength != 0))
+    {
+        status = sosiFileWrite (gLrcRecordFile, PtrCdb, PtrRecord->CdbLength);
+    }
+
+    if ((status == SCRUTINY_STATUS_SUCCESS) && (PtrRecord->StoredLength != 0))
+    {
+        status = sosiFileWrite (gLrcRecordFile, PtrData, PtrRecord->StoredLength);
+    }
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerGeneric->logiDebug ("Trace write failed, recording stopped (Status=%x)", status);
+
+        sosiFileClose (gLrcRecordFile);
+
+        gLrcRecordFile = NULL;
+        gLrcRecordFailed = TRUE;
+    }
+
+}
+
+/**
+ *
+ *  @method  lrcAllocateStream()
+ *
+ *  @param   Index              Stream number in the trace
+ *
+ *  @param   Replay             TRUE for a replayed device
+ *
+ *  @return  PTR_LRC_STREAM     New stream, NULL on allocation failure
+ *
+ */
+
+static PTR_LRC_STREAM lrcAllocateStream (__IN__ U32 Index, __IN__ BOOLEAN Replay)
+{
+
+    PTR_LRC_STREAM ptrStream;
+
+    ptrStream = (PTR_LRC_STREAM) sosiMemAlloc (sizeof (LRC_STREAM));
+
+    if (ptrStream == NULL)
+    {
+        return (NULL);
+    }
+
+    sosiMemSet (ptrStream, 0, sizeof (LRC_STREAM));
+
+    ptrStream->Index = Index;
+    ptrStream->Replay = Replay;
+
+#if defined (OS_LINUX)
+    pthread_mutex_init (&ptrStream->Lock, NULL);
+#endif
+
+    return (ptrStream);
+
+}
+
+/**
+ *
+ *  @method  lrciInitializeExchange()
+ *
+ *  @param   PtrExchange        Exchange to set up
+ *
+ *  @param   Type               LRC_RECORD_TYPE_* of the exchange
+ *
+ *  @param   Address            Memory address, configuration address or value tag
+ *
+ *  @param   PtrData            Data phase of the exchange
+ *
+ *  @param   Length             Bytes of the data phase
+ *
+ *  @param   DataIn             TRUE when the device fills PtrData
+ *
+ *  @return  none
+ *
+ */
+
+VOID lrciInitializeExchange (
+    __OUT__ PTR_LRC_EXCHANGE PtrExchange,
+    __IN__  U32 Type,
+    __IN__  U32 Address,
+    __IN__  PVOID PtrData,
+    __IN__  U32 Length,
+    __IN__  BOOLEAN DataIn
+    )
+{
+
+    sosiMemSet (PtrExchange, 0, sizeof (LRC_EXCHANGE));
+
+    PtrExchange->Type = Type;
+    PtrExchange->Address = Address;
+    PtrExchange->PtrData = PtrData;
+    PtrExchange->Length = Length;
+    PtrExchange->DataIn = DataIn;
+
+}
+
+/**
+ *
+ *  @method  lrcReplayExchange()
+ *
+ *  @param   PtrStream          Replay stream of the device, locked by the caller
+ *
+ *  @param   PtrExchange        Exchange to serve
+ *
+ *  @param   PtrMicroSeconds    Receives the time to hold the exchange for
+ *
+ *  @return  SCRUTINY_STATUS    Recorded status of the exchange, SCRUTINY_STATUS_FAILED
+ *                              when the next record is not this exchange
+ *
+ */
+
+static SCRUTINY_STATUS lrcReplayExchange (__IN__ PTR_LRC_STREAM PtrStream, __INOUT__ PTR_LRC_EXCHANGE PtrExchange, __OUT__ PU32 PtrMicroSeconds)
+{
+
+    LRC_RECORD_HEADER record;
+    PU8 ptrCdb;
+    PU8 ptrData;
+
+    *PtrMicroSeconds = 0;
+
+    if ((PtrStream->Size - PtrStream->Offset) < sizeof (LRC_RECORD_HEADER))
+    {
+        gPtrLoggerGeneric->logiDebug ("Replay stream %d exhausted (Type=%x, Address=%x)",
+                                      PtrStream->Index, PtrExchange->Type, PtrExchange->Address);
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    sosiMemCopy (&record, PtrStream->PtrRecords + PtrStream->Offset, sizeof (LRC_RECORD_HEADER));
+
+    ptrCdb = PtrStream->PtrRecords + PtrStream->Offset + sizeof (LRC_RECORD_HEADER);
+    ptrData = ptrCdb + record.CdbLength;
+
+    if ((record.Type != PtrExchange->Type) ||
+        (record.Address != PtrExchange->Address) ||
+        (record.Length != PtrExchange->Length) ||
+        (record.CdbLength != PtrExchange->CdbLength) ||
+        ((record.CdbLength != 0) && sosiMemCompare (ptrCdb, PtrExchange->PtrCdb, record.CdbLength)))
+    {
+        gPtrLoggerGeneric->logiDebug ("Replay stream %d diverged at offset %x, recorded Type=%x Address=%x Length=%x, requested Type=%x Address=%x Length=%x",
+                                      PtrStream->Index, PtrStream->Offset,
+                                      record.Type, record.Address, record.Length,
+                                      PtrExchange->Type, PtrExchange->Address, PtrExchange->Length);
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    if ((PtrExchange->DataIn) && (record.StoredLength != 0))
+    {
+        sosiMemCopy (PtrExchange->PtrData, ptrData, (record.StoredLength < PtrExchange->Length) ? record.StoredLength : PtrExchange->Length);
+    }
+
+    PtrExchange->Value = record.Value;
+
+    PtrStream->Offset += sizeof (LRC_RECORD_HEADER) + record.CdbLength + record.StoredLength;
+
+    if (PtrStream->RecordedSpeed)
+    {
+        *PtrMicroSeconds = record.MicroSeconds;
+    }
+
+    return ((SCRUTINY_STATUS) record.Status);
+
+}
+
+/**
+ *
+ *  @method  lrciBeginExchange()
+ *
+ *  @param   PtrDevice          Device the exchange goes to
+ *
+ *  @param   PtrExchange        Exchange set up by lrciInitializeExchange
+ *
+ *  @param   PtrStatus          Receives the status of a replayed exchange
+ *
+ *  @return  BOOLEAN            TRUE when the exchange was served from the trace
+ *                              and must not go to the transport
+ *
+ *  @brief   Called before an exchange goes to the transport. A recorded device
+ *           only takes the start time here.
+ *
+ */
+
+BOOLEAN lrciBeginExchange (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __INOUT__ PTR_LRC_EXCHANGE PtrExchange, __OUT__ SCRUTINY_STATUS *PtrStatus)
+{
+
+    PTR_LRC_STREAM ptrStream = (PTR_LRC_STREAM) PtrDevice->PtrRecordReplay;
+    U32 microSeconds = 0;
+
+    if ((ptrStream == NULL) || (!lrcIsTransportLevel (PtrDevice, PtrExchange->Type)))
+    {
+        return (FALSE);
+    }
+
+    if (!ptrStream->Replay)
+    {
+        PtrExchange->StartTime = sosiGetMicroSeconds ();
+        return (FALSE);
+    }
+
+#if defined (OS_LINUX)
+    pthread_mutex_lock (&ptrStream->Lock);
+#endif
+
+    *PtrStatus = lrcReplayExchange (ptrStream, PtrExchange, &microSeconds);
+
+#if defined (OS_LINUX)
+    pthread_mutex_unlock (&ptrStream->Lock);
+#endif
+
+    if (microSeconds != 0)
+    {
+        sosiMicroSleep (microSeconds);
+    }
+
+    return (TRUE);
+
+}
+
+/**
+ *
+ *  @method  lrciEndExchange()
+ *
+ *  @param   PtrDevice          Device the exchange went to
+ *
+ *  @param   PtrExchange        The exchange, Value set by the caller
+ *
+ *  @param   Status             Status the transport returned
+ *
+ *  @return  none
+ *
+ *  @brief   Appends the exchange to the trace when the device is recorded
+ *
+ */
+
+VOID lrciEndExchange (__IN__ PTR_SCRUTINY_DEVICE PtrDevice, __IN__ PTR_LRC_EXCHANGE PtrExchange, __IN__ SCRUTINY_STATUS Status)
+{
+
+    PTR_LRC_STREAM ptrStream = (PTR_LRC_STREAM) PtrDevice->PtrRecordReplay;
+    LRC_RECORD_HEADER record;
+
+    if ((ptrStream == NULL) || (ptrStream->Replay) || (!lrcIsTransportLevel (PtrDevice, PtrExchange->Type)))
+    {
+        return;
+    }
+
+    sosiMemSet (&record, 0, sizeof (LRC_RECORD_HEADER));
+
+    record.Type = (U8) PtrExchange->Type;
+    record.Stream = (U8) ptrStream->Index;
+    record.CdbLength = (U8) PtrExchange->CdbLength;
+    record.Address = PtrExchange->Address;
+    record.Value = PtrExchange->Value;
+    record.Status = (U32) Status;
+    record.MicroSeconds = sosiGetMicroSeconds () - PtrExchange->StartTime;
+    record.Length = PtrExchange->Length;
+
+    /* What went to the device is not needed to answer the same request again */
+    if ((PtrExchange->DataIn) && (Status == SCRUTINY_STATUS_SUCCESS))
+    {
+        record.StoredLength = PtrExchange->Length;
+    }
+
+    lrcLockRecorder (TRUE);
+
+    lrcWriteRecord (&record, PtrExchange->PtrCdb, (const U8 *) PtrExchange->PtrData);
+
+    lrcLockRecorder (FALSE);
+
+}
+
+/**
+ *
+ *  @method  lrciIsReplaying()
+ *
+ *  @param   PtrDevice          Device to check
+ *
+ *  @return  BOOLEAN            TRUE when the device is served from a trace
+ *
+ */
+
+BOOLEAN lrciIsReplaying (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    PTR_LRC_STREAM ptrStream = (PTR_LRC_STREAM) PtrDevice->PtrRecordReplay;
+
+    return (((ptrStream != NULL) && (ptrStream->Replay)) ? TRUE : FALSE);
+
+}
+
+/**
+ *
+ *  @method  lrciAttachDevice()
+ *
+ *  @param   PtrDevice          Device just added to the device manager
+ *
+ *  @return  none
+ *
+ *  @brief   Starts recording the device when RECORD_FILE is configured. The
+ *           trace file is created with the first device of the session, the
+ *           device record keeps what the replay needs to bring it back.
+ *
+ */
+
+VOID lrciAttachDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    LRC_FILE_HEADER header;
+    LRC_RECORD_HEADER record;
+    PTR_LRC_STREAM ptrStream;
+
+    if ((PtrDevice->PtrRecordReplay != NULL) ||
+        (gPtrLibraryConfigParams == NULL) ||
+        (gPtrLibraryConfigParams->PtrRecordFile == NULL))
+    {
+        return;
+    }
+
+    lrcLockRecorder (TRUE);
+
+    if ((gLrcRecordFile == NULL) && (!gLrcRecordFailed))
+    {
+        gLrcRecordFile = sosiFileOpen (gPtrLibraryConfigParams->PtrRecordFile, "wb");
+
+        sosiMemSet (&header, 0, sizeof (LRC_FILE_HEADER));
+
+        header.Signature = LRC_FILE_SIGNATURE;
+        header.Version = LRC_FILE_VERSION;
+        header.RecordHeaderSize = sizeof (LRC_RECORD_HEADER);
+
+        if ((gLrcRecordFile == NULL) ||
+            (sosiFileWrite (gLrcRecordFile, (const U8 *) &header, sizeof (LRC_FILE_HEADER)) != SCRUTINY_STATUS_SUCCESS))
+        {
+            gPtrLoggerGeneric->logiDebug ("Unable to create the trace %s", gPtrLibraryConfigParams->PtrRecordFile);
+
+            if (gLrcRecordFile != NULL)
+            {
+                sosiFileClose (gLrcRecordFile);
+            }
+
+            gLrcRecordFile = NULL;
+            gLrcRecordFailed = TRUE;
+        }
+    }
+
+    if ((gLrcRecordFile == NULL) || (gLrcStreamCount >= LRC_MAXIMUM_STREAMS))
+    {
+        lrcLockRecorder (FALSE);
+        return;
+    }
+
+    ptrStream = lrcAllocateStream (gLrcStreamCount, FALSE);
+
+    if (ptrStream == NULL)
+    {
+        lrcLockRecorder (FALSE);
+        return;
+    }
+
+    sosiMemSet (&record, 0, sizeof (LRC_RECORD_HEADER));
+
+    record.Type = LRC_RECORD_TYPE_DEVICE;
+    record.Stream = (U8) ptrStream->Index;
+    record.Address = (U32) PtrDevice->ProductFamily;
+    record.Value = (U32) PtrDevice->HandleType;
+    record.Length = sizeof (SCRUTINY_DEVICE_INFO);
+    record.StoredLength = sizeof (SCRUTINY_DEVICE_INFO);
+
+    lrcWriteRecord (&record, NULL, (const U8 *) &PtrDevice->DeviceInfo);
+
+    gLrcStreamCount++;
+
+    PtrDevice->PtrRecordReplay = ptrStream;
+
+    lrcLockRecorder (FALSE);
+
+    gPtrLoggerGeneric->logiDebug ("Recording device %x as stream %d", PtrDevice->DeviceInfo.ProductHandle, ptrStream->Index);
+
+}
+
+/**
+ *
+ *  @method  lrciFreeDevice()
+ *
+ *  @param   PtrDevice          Device being closed
+ *
+ *  @return  none
+ *
+ */
+
+VOID lrciFreeDevice (__IN__ PTR_SCRUTINY_DEVICE PtrDevice)
+{
+
+    PTR_LRC_STREAM ptrStream = (PTR_LRC_STREAM) PtrDevice->PtrRecordReplay;
+
+    if (ptrStream == NULL)
+    {
+        return;
+    }
+
+    if (ptrStream->Replay)
+    {
+        gPtrLoggerGeneric->logiDebug ("Replay stream %d closed at offset %x of %x",
+                                      ptrStream->Index, ptrStream->Offset, ptrStream->Size);
+    }
+
+#if defined (OS_LINUX)
+    pthread_mutex_destroy (&ptrStream->Lock);
+#endif
+
+    sosiMemFree (ptrStream->PtrRecords);
+    sosiMemFree (ptrStream);
+
+    PtrDevice->PtrRecordReplay = NULL;
+
+}
+
+/**
+ *
+ *  @method  lrciCloseRecording()
+ *
+ *  @return  none
+ *
+ *  @brief   Completes the trace, called when the library exits after the
+ *           devices are closed
+ *
+ */
+
+VOID lrciCloseRecording ()
+{
+
+    lrcLockRecorder (TRUE);
+
+    if (gLrcRecordFile != NULL)
+    {
+        sosiFileClose (gLrcRecordFile);
+    }
+
+    gLrcRecordFile = NULL;
+    gLrcStreamCount = 0;
+    gLrcRecordFailed = FALSE;
+
+    lrcLockRecorder (FALSE);
+
+}
+
+/**
+ *
+ *  @method  lrcNextRecord()
+ *
+ *  @param   PtrTrace           Trace contents
+ *
+ *  @param   Size               Bytes in the trace
+ *
+ *  @param   Offset             Offset of the record
+ *
+ *  @param   PtrRecord          Receives the record header
+ *
+ *  @return  U32                Bytes of the whole record, 0 when no complete
+ *                              record starts at Offset
+ *
+ */
+
+static U32 lrcNextRecord (__IN__ PU8 PtrTrace, __IN__ U32 Size, __IN__ U32 Offset, __OUT__ PTR_LRC_RECORD_HEADER PtrRecord)
+{
+
+    U32 recordSize;
+
+    if ((Size - Offset) < sizeof (LRC_RECORD_HEADER))
+    {
+        return (0);
+    }
+
+    sosiMemCopy (PtrRecord, PtrTrace + Offset, sizeof (LRC_RECORD_HEADER));
+
+    recordSize = sizeof (LRC_RECORD_HEADER) + PtrRecord->CdbLength;
+
+    if ((PtrRecord->StoredLength > (Size - Offset)) || ((Size - Offset) - PtrRecord->StoredLength < recordSize))
+    {
+        return (0);
+    }
+
+    return (recordSize + PtrRecord->StoredLength);
+
+}
+
+/**
+ *
+ *  @method  lrcCreateDevice()
+ *
+ *  @param   PtrRecord          Device record
+ *
+ *  @param   PtrDeviceInfo      Device info stored with the record
+ *
+ *  @param   StreamSize         Bytes of records the device has in the trace
+ *
+ *  @param   RecordedSpeed      TRUE to hold every exchange for the recorded time
+ *
+ *  @return  PTR_SCRUTINY_DEVICE    The replayed device, NULL on allocation failure
+ *
+ *  @brief   The device keeps its recorded handle type so the product code takes
+ *           the same paths, the handle itself is never opened
+ *
+ */
+
+static PTR_SCRUTINY_DEVICE lrcCreateDevice (
+    __IN__  PTR_LRC_RECORD_HEADER PtrRecord,
+    __IN__  PU8 PtrDeviceInfo,
+    __IN__  U32 StreamSize,
+    __IN__  BOOLEAN RecordedSpeed
+    )
+{
+
+    PTR_SCRUTINY_DEVICE ptrDevice;
+    PTR_LRC_STREAM ptrStream;
+
+    ptrDevice = (PTR_SCRUTINY_DEVICE) sosiMemAlloc (sizeof (SCRUTINY_DEVICE));
+    ptrStream = lrcAllocateStream (PtrRecord->Stream, TRUE);
+
+    if ((ptrDevice == NULL) || (ptrStream == NULL))
+    {
+        sosiMemFree (ptrDevice);
+        sosiMemFree (ptrStream);
+        return (NULL);
+    }
+
+    sosiMemSet (ptrDevice, 0, sizeof (SCRUTINY_DEVICE));
+
+    if (StreamSize != 0)
+    {
+        ptrStream->PtrRecords = (PU8) sosiMemAlloc (StreamSize);
+
+        if (ptrStream->PtrRecords == NULL)
+        {
+            sosiMemFree (ptrDevice);
+            sosiMemFree (ptrStream);
+            return (NULL);
+        }
+    }
+
+    ptrStream->RecordedSpeed = RecordedSpeed;
+
+    ptrDevice->HandleType = (SCRUTINY_HANDLE_TYPE) PtrRecord->Value;
+    ptrDevice->ProductFamily = (SCRUTINY_PRODUCT_FAMILY) PtrRecord->Address;
+
+    sosiMemCopy (&ptrDevice->DeviceInfo, PtrDeviceInfo,
+                 (PtrRecord->StoredLength < sizeof (SCRUTINY_DEVICE_INFO)) ? PtrRecord->StoredLength : sizeof (SCRUTINY_DEVICE_INFO));
+
+#if defined (OS_LINUX)
+    if (ptrDevice->HandleType & SCRUTINY_HANDLE_TYPE_MASK_SCSI)
+    {
+        ptrDevice->Handle.ScsiHandle.SgDeviceHandle = INVALID_HANDLE_VALUE;
+    }
+#endif
+
+    ptrDevice->PtrRecordReplay = ptrStream;
+
+    return (ptrDevice);
+
+}
+
+/**
+ *
+ *  @method  lrciDiscoverDevices()
+ *
+ *  @param   PtrDiscoveryParams     Discovery parameters holding the trace file
+ *
+ *  @return  SCRUTINY_STATUS        SCRUTINY_STATUS_SUCCESS when the trace was loaded,
+ *                                  SCRUTINY_STATUS_IGNORE when no trace is configured
+ *
+ *  @brief   Brings back the devices of a trace. The records are split per stream
+ *           so every device replays on its own. A trace cut short, e.g. by a crash
+ *           of the recording host, replays up to its last complete record.
+ *
+ */
+
+SCRUTINY_STATUS lrciDiscoverDevices (__IN__ PTR_SCRUTINY_DISCOVERY_PARAMS PtrDiscoveryParams)
+{
+
+    PU8 ptrTrace = NULL;
+    U32 size = 0;
+    U32 offset;
+    U32 recordSize;
+    U32 index;
+    U32 added = 0;
+    LRC_FILE_HEADER header;
+    LRC_RECORD_HEADER record;
+    PTR_LRC_STREAM ptrStream;
+    PU32 ptrStreamSize = NULL;
+    PTR_SCRUTINY_DEVICE *ptrDevices = NULL;
+    SCRUTINY_STATUS status;
+
+    gPtrLoggerGeneric->logiFunctionEntry ("lrciDiscoverDevices (PtrDiscoveryParams=%x)", PtrDiscoveryParams != NULL);
+
+    if (PtrDiscoveryParams == NULL)
+    {
+        gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Status=%x)", SCRUTINY_STATUS_INVALID_PARAMETER);
+        return (SCRUTINY_STATUS_INVALID_PARAMETER);
+    }
+
+    if ((PtrDiscoveryParams->u.SimulatorConfig.SimulatorType != SCRUTINY_SIMULATOR_TYPE_REPLAY) ||
+        (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile[0] == '\0'))
+    {
+        gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Status=%x)", SCRUTINY_STATUS_IGNORE);
+        return (SCRUTINY_STATUS_IGNORE);
+    }
+
+    status = sosiFileBufferRead (PtrDiscoveryParams->u.SimulatorConfig.SimulationFile, &ptrTrace, &size);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Read Status=%x)", status);
+        return (status);
+    }
+
+    if (size >= sizeof (LRC_FILE_HEADER))
+    {
+        sosiMemCopy (&header, ptrTrace, sizeof (LRC_FILE_HEADER));
+    }
+
+    if ((size < sizeof (LRC_FILE_HEADER)) ||
+        (header.Signature != LRC_FILE_SIGNATURE) ||
+        (header.Version != LRC_FILE_VERSION) ||
+        (header.RecordHeaderSize != sizeof (LRC_RECORD_HEADER)))
+    {
+        sosiMemFree (ptrTrace);
+
+        gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Not a trace)");
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    ptrStreamSize = (PU32) sosiMemAlloc (LRC_MAXIMUM_STREAMS * sizeof (U32));
+    ptrDevices = (PTR_SCRUTINY_DEVICE *) sosiMemAlloc (LRC_MAXIMUM_STREAMS * sizeof (PTR_SCRUTINY_DEVICE));
+
+    if ((ptrStreamSize == NULL) || (ptrDevices == NULL))
+    {
+        sosiMemFree (ptrStreamSize);
+        sosiMemFree (ptrDevices);
+        sosiMemFree (ptrTrace);
+
+        gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Memory Allocation)");
+        return (SCRUTINY_STATUS_NO_MEMORY);
+    }
+
+    sosiMemSet (ptrStreamSize, 0, LRC_MAXIMUM_STREAMS * sizeof (U32));
+    sosiMemSet (ptrDevices, 0, LRC_MAXIMUM_STREAMS * sizeof (PTR_SCRUTINY_DEVICE));
+
+    /* First size the streams so each gets its records in one allocation */
+    for (offset = sizeof (LRC_FILE_HEADER); (recordSize = lrcNextRecord (ptrTrace, size, offset, &record)) != 0; offset += recordSize)
+    {
+        if (record.Type != LRC_RECORD_TYPE_DEVICE)
+        {
+            ptrStreamSize[record.Stream] += recordSize;
+        }
+    }
+
+    if (offset != size)
+    {
+        gPtrLoggerGeneric->logiDebug ("Trace truncated at offset %x of %x", offset, size);
+    }
+
+    for (offset = sizeof (LRC_FILE_HEADER); (recordSize = lrcNextRecord (ptrTrace, size, offset, &record)) != 0; offset += recordSize)
+    {
+        if (record.Type == LRC_RECORD_TYPE_DEVICE)
+        {
+            if (ptrDevices[record.Stream] == NULL)
+            {
+                ptrDevices[record.Stream] = lrcCreateDevice (&record, ptrTrace + offset + sizeof (LRC_RECORD_HEADER) + record.CdbLength,
+                                                             ptrStreamSize[record.Stream],
+                                                             PtrDiscoveryParams->u.SimulatorConfig.ReplayRecordedLatency);
+            }
+
+            continue;
+        }
+
+        if (ptrDevices[record.Stream] == NULL)
+        {
+            /* Records of a device which could not be brought back */
+            continue;
+        }
+
+        ptrStream = (PTR_LRC_STREAM) ptrDevices[record.Stream]->PtrRecordReplay;
+
+        sosiMemCopy (ptrStream->PtrRecords + ptrStream->Size, ptrTrace + offset, recordSize);
+        ptrStream->Size += recordSize;
+    }
+
+    for (index = 0; index < LRC_MAXIMUM_STREAMS; index++)
+    {
+        if (ptrDevices[index] == NULL)
+        {
+            continue;
+        }
+
+        if (ldmiAddScrutinyDevice (gPtrScrutinyDeviceManager, ptrDevices[index]) != SCRUTINY_STATUS_SUCCESS)
+        {
+            lrciFreeDevice (ptrDevices[index]);
+            sosiMemFree (ptrDevices[index]);
+            continue;
+        }
+
+        gPtrLoggerGeneric->logiDebug ("Replaying stream %d as device %x, %x bytes of records",
+                                      index, ptrDevices[index]->DeviceInfo.ProductHandle, ptrStreamSize[index]);
+
+        added++;
+    }
+
+    sosiMemFree (ptrStreamSize);
+    sosiMemFree (ptrDevices);
+    sosiMemFree (ptrTrace);
+
+    gPtrLoggerGeneric->logiFunctionExit ("lrciDiscoverDevices (Devices=%d)", added);
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
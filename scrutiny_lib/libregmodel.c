@@ -0,0 +1,644 @@
+/*
+ *
+ * Copyright (C) 2019 - 2020 Broadcom.
+ * The term "Broadcom" refers to Broadcom Inc. and/or its subsidiaries.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.Redistributions of source code must retain the above copyright notice, 
+ *   this list of conditions and the following disclaimer.
+ *
+ * 2.Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * 3.Neither the name of the copyright holder nor the names of its contributors
+ *   may be used to endorse or promote products derived from this software without
+ *   specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS I " AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES 
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES ; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE 
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+
+
+
+
+#include "libincludes.h"
+
+/**
+ *
+ *  @method  lrmFindRegister()
+ *
+ *  @param   PtrModel           Register model
+ *
+ *  @param   Address            Register address to look for
+ *
+ *  @param   PtrPosition        Receives the index where the register is or
+ *                              has to be inserted
+ *
+ *  @return  PTR_LRM_REGISTER  The register, NULL when it is not populated
+ *
+ *  @brief   Binary search of the sorted register table
+ *
+ */
+
+static PTR_LRM_REGISTER lrmFindRegister (
+    __IN__  PTR_LRM_REGISTER_MODEL PtrModel,
+    __IN__  U32 Address,
+    __OUT__ PU32 PtrPosition
+)
+{
+
+    U32 low = 0;
+    U32 high = PtrModel->RegisterCount;
+    U32 middle;
+
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+
+        if (PtrModel->PtrRegisters[middle].Address == Address)
+        {
+            *PtrPosition = middle;
+            return (&PtrModel->PtrRegisters[middle]);
+        }
+
+        if (PtrModel->PtrRegisters[middle].Address < Address)
+        {
+            low = middle + 1;
+        }
+
+        else
+        {
+            high = middle;
+        }
+    }
+
+    *PtrPosition = low;
+
+    return (NULL);
+
+}
+
+/**
+ *
+ *  @method  lrmSetRegister()
+ *
+ *  @param   PtrModel           Register model
+ *
+ *  @param   Address            Register address
+ *
+ *  @param   Value              New contents of the register
+ *
+ *  @return  PTR_LRM_REGISTER  The register, NULL if it could not be added
+ *
+ *  @brief   Updates a register, populating it first when needed. Snapshots
+ *           are dumped in address order, so the insert is mostly an append.
+ *
+ */
+
+static PTR_LRM_REGISTER lrmSetRegister (
+    __IN__  PTR_LRM_REGISTER_MODEL PtrModel,
+    __IN__  U32 Address,
+    __IN__  U32 Value
+)
+{
+
+    U32 position = 0;
+    U32 index;
+    PTR_LRM_REGISTER ptrRegister;
+    PTR_LRM_REGISTER ptrTable;
+
+    ptrRegister = lrmFindRegister (PtrModel, Address, &position);
+
+    if (ptrRegister != NULL)
+    {
+        ptrRegister->Value = Value;
+        return (ptrRegister);
+    }
+
+    if (PtrModel->RegisterCount == PtrModel->RegisterCapacity)
+    {
+        ptrTable = (PTR_LRM_REGISTER) sosiMemRealloc (PtrModel->PtrRegisters,
+                                                       (PtrModel->RegisterCapacity + LRM_REGISTER_ALLOCATION_STEP) * sizeof (LRM_REGISTER),
+                                                       PtrModel->RegisterCapacity * sizeof (LRM_REGISTER));
+
+        if (ptrTable == NULL)
+        {
+            return (NULL);
+        }
+
+        PtrModel->PtrRegisters = ptrTable;
+        PtrModel->RegisterCapacity += LRM_REGISTER_ALLOCATION_STEP;
+    }
+
+    for (index = PtrModel->RegisterCount; index > position; index--)
+    {
+        PtrModel->PtrRegisters[index] = PtrModel->PtrRegisters[index - 1];
+    }
+
+    ptrRegister = &PtrModel->PtrRegisters[position];
+
+    ptrRegister->Address = Address;
+    ptrRegister->Value = Value;
+    ptrRegister->ScriptIndex = LRM_NO_SCRIPT;
+
+    PtrModel->RegisterCount++;
+
+    return (ptrRegister);
+
+}
+
+/**
+ *
+ *  @method  lrmAddScript()
+ *
+ *  @param   PtrModel           Register model
+ *
+ *  @param   Address            Register the script is attached to
+ *
+ *  @param   Loop               TRUE if the script starts over when done
+ *
+ *  @return  PTR_LRM_SCRIPT    The new empty script, NULL on allocation failure
+ *
+ *  @brief   Attaches a new script to a register, replacing any earlier one
+ *
+ */
+
+static PTR_LRM_SCRIPT lrmAddScript (
+    __IN__  PTR_LRM_REGISTER_MODEL PtrModel,
+    __IN__  U32 Address,
+    __IN__  BOOLEAN Loop
+)
+{
+
+    U32 position = 0;
+    PTR_LRM_REGISTER ptrRegister;
+    PTR_LRM_SCRIPT ptrTable;
+    PTR_LRM_SCRIPT ptrScript;
+
+    ptrRegister = lrmFindRegister (PtrModel, Address, &position);
+
+    if (ptrRegister == NULL)
+    {
+        ptrRegister = lrmSetRegister (PtrModel, Address, 0);
+
+        if (ptrRegister == NULL)
+        {
+            return (NULL);
+        }
+    }
+
+    if (PtrModel->ScriptCount == PtrModel->ScriptCapacity)
+    {
+        ptrTable = (PTR_LRM_SCRIPT) sosiMemRealloc (PtrModel->PtrScripts,
+                                                     (PtrModel->ScriptCapacity + LRM_SCRIPT_ALLOCATION_STEP) * sizeof (LRM_SCRIPT),
+                                                     PtrModel->ScriptCapacity * sizeof (LRM_SCRIPT));
+
+        if (ptrTable == NULL)
+        {
+            return (NULL);
+        }
+
+        PtrModel->PtrScripts = ptrTable;
+        PtrModel->ScriptCapacity += LRM_SCRIPT_ALLOCATION_STEP;
+    }
+
+    ptrScript = &PtrModel->PtrScripts[PtrModel->ScriptCount];
+
+    sosiMemSet (ptrScript, 0, sizeof (LRM_SCRIPT));
+    ptrScript->Loop = Loop;
+
+    ptrRegister->ScriptIndex = PtrModel->ScriptCount;
+    PtrModel->ScriptCount++;
+
+    return (ptrScript);
+
+}
+
+/**
+ *
+ *  @method  lrmAppendScriptValue()
+ *
+ *  @param   PtrScript          Script to extend
+ *
+ *  @param   Value              Value returned by the next read in the script
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS or SCRUTINY_STATUS_FAILED
+ *                              on allocation failure
+ *
+ *  @brief   Appends one value to a register script
+ *
+ */
+
+static SCRUTINY_STATUS lrmAppendScriptValue (
+    __IN__  PTR_LRM_SCRIPT PtrScript,
+    __IN__  U32 Value
+)
+{
+
+    PU32 ptrValues;
+
+    if (PtrScript->Count == PtrScript->Capacity)
+    {
+        ptrValues = (PU32) sosiMemRealloc (PtrScript->PtrValues,
+                                           (PtrScript->Capacity + LRM_REGISTER_ALLOCATION_STEP) * sizeof (U32),
+                                           PtrScript->Capacity * sizeof (U32));
+
+        if (ptrValues == NULL)
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        PtrScript->PtrValues = ptrValues;
+        PtrScript->Capacity += LRM_REGISTER_ALLOCATION_STEP;
+    }
+
+    PtrScript->PtrValues[PtrScript->Count] = Value;
+    PtrScript->Count++;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  lrmNextToken()
+ *
+ *  @param   PtrCursor          Position in the line, advanced past the token
+ *
+ *  @return  char*              The NULL terminated token or NULL at the end
+ *                              of the line
+ *
+ *  @brief   Splits a snapshot line on white space, in place
+ *
+ */
+
+static char* lrmNextToken (__INOUT__ char **PtrCursor)
+{
+
+    char *ptrToken;
+    char *ptrCursor = *PtrCursor;
+
+    while ((*ptrCursor != '\0') && sosiIsSpace (*ptrCursor))
+    {
+        ptrCursor++;
+    }
+
+    if (*ptrCursor == '\0')
+    {
+        *PtrCursor = ptrCursor;
+        return (NULL);
+    }
+
+    ptrToken = ptrCursor;
+
+    while ((*ptrCursor != '\0') && !sosiIsSpace (*ptrCursor))
+    {
+        ptrCursor++;
+    }
+
+    if (*ptrCursor != '\0')
+    {
+        *ptrCursor = '\0';
+        ptrCursor++;
+    }
+
+    *PtrCursor = ptrCursor;
+
+    return (ptrToken);
+
+}
+
+/**
+ *
+ *  @method  lrmParseSnapshot()
+ *
+ *  @param   PtrModel           Register model to populate
+ *
+ *  @param   PtrText            NULL terminated snapshot, modified while parsing
+ *
+ *  @param   PtrLatency         Receives the access latency, left untouched
+ *                              when the snapshot has none
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS or SCRUTINY_STATUS_FAILED
+ *                              on the first malformed line
+ *
+ *  @brief   Loads the register contents and scripts of a snapshot file
+ *
+ */
+
+static SCRUTINY_STATUS lrmParseSnapshot (
+    __IN__  PTR_LRM_REGISTER_MODEL PtrModel,
+    __IN__  char *PtrText,
+    __OUT__ PU32 PtrLatency
+)
+{
+
+    char *ptrLine = PtrText;
+    char *ptrNext;
+    char *ptrCursor;
+    char *ptrToken;
+    char *ptrValue;
+    U32 line = 0;
+    U32 address = 0;
+    U32 value = 0;
+    PTR_LRM_SCRIPT ptrScript;
+    BOOLEAN loop;
+
+    while (*ptrLine != '\0')
+    {
+        line++;
+
+        /* Cut the line and drop the comment */
+        for (ptrNext = ptrLine; (*ptrNext != '\0') && (*ptrNext != '\n'); ptrNext++)
+        {
+            if (*ptrNext == '#')
+            {
+                *ptrNext = '\0';
+            }
+        }
+
+        if (*ptrNext == '\n')
+        {
+            *ptrNext = '\0';
+            ptrNext++;
+        }
+
+        ptrCursor = ptrLine;
+        ptrLine = ptrNext;
+
+        ptrToken = lrmNextToken (&ptrCursor);
+
+        if (ptrToken == NULL)
+        {
+            continue;
+        }
+
+        if (sosiStringCompare (ptrToken, LRM_SNAPSHOT_KEYWORD_LATENCY) == SCRUTINY_STATUS_SUCCESS)
+        {
+            ptrValue = lrmNextToken (&ptrCursor);
+
+            if (ptrValue == NULL)
+            {
+                gPtrLoggerGeneric->logiDebug ("Snapshot line %d has no latency", line);
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            *PtrLatency = sosiAtoi (ptrValue);
+            continue;
+        }
+
+        if ((sosiStringCompare (ptrToken, LRM_SNAPSHOT_KEYWORD_SCRIPT) == SCRUTINY_STATUS_SUCCESS) ||
+            (sosiStringCompare (ptrToken, LRM_SNAPSHOT_KEYWORD_LOOP) == SCRUTINY_STATUS_SUCCESS))
+        {
+            loop = (sosiStringCompare (ptrToken, LRM_SNAPSHOT_KEYWORD_LOOP) == SCRUTINY_STATUS_SUCCESS);
+
+            ptrToken = lrmNextToken (&ptrCursor);
+
+            if ((ptrToken == NULL) || sosiHexToInt (ptrToken, &address) || (address & 0x3))
+            {
+                gPtrLoggerGeneric->logiDebug ("Snapshot line %d has no valid script address", line);
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            ptrScript = lrmAddScript (PtrModel, address, loop);
+
+            if (ptrScript == NULL)
+            {
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            while ((ptrValue = lrmNextToken (&ptrCursor)) != NULL)
+            {
+                if (sosiHexToInt (ptrValue, &value) || lrmAppendScriptValue (ptrScript, value))
+                {
+                    gPtrLoggerGeneric->logiDebug ("Snapshot line %d has an invalid script value '%s'", line, ptrValue);
+                    return (SCRUTINY_STATUS_FAILED);
+                }
+            }
+
+            if (ptrScript->Count == 0)
+            {
+                gPtrLoggerGeneric->logiDebug ("Snapshot line %d has an empty script", line);
+                return (SCRUTINY_STATUS_FAILED);
+            }
+
+            continue;
+        }
+
+        ptrValue = lrmNextToken (&ptrCursor);
+
+        if (sosiHexToInt (ptrToken, &address) || (address & 0x3) ||
+            (ptrValue == NULL) || sosiHexToInt (ptrValue, &value))
+        {
+            gPtrLoggerGeneric->logiDebug ("Snapshot line %d is not a valid register entry", line);
+            return (SCRUTINY_STATUS_FAILED);
+        }
+
+        if (lrmSetRegister (PtrModel, address, value) == NULL)
+        {
+            return (SCRUTINY_STATUS_FAILED);
+        }
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  lrmiFreeModel()
+ *
+ *  @param   PtrModel           Register model to release, can be NULL
+ *
+ *  @return  VOID               No return value
+ *
+ *  @brief   Frees the register table, the scripts and the model itself
+ *
+ */
+
+VOID lrmiFreeModel (__IN__ PTR_LRM_REGISTER_MODEL PtrModel)
+{
+
+    U32 index;
+
+    if (PtrModel == NULL)
+    {
+        return;
+    }
+
+    for (index = 0; index < PtrModel->ScriptCount; index++)
+    {
+        sosiMemFree (PtrModel->PtrScripts[index].PtrValues);
+    }
+
+    sosiMemFree (PtrModel->PtrScripts);
+    sosiMemFree (PtrModel->PtrRegisters);
+    sosiMemFree (PtrModel);
+
+}
+
+/**
+ *
+ *  @method  lrmiReadRegister()
+ *
+ *  @param   PtrModel           Register model
+ *
+ *  @param   Address            Register address
+ *
+ *  @return  U32                Register contents, zero when not populated
+ *
+ *  @brief   Reads one register. A scripted register hands out the next value
+ *           of its script and keeps it, so the value is stable once the
+ *           script is done.
+ *
+ */
+
+U32 lrmiReadRegister (__IN__ PTR_LRM_REGISTER_MODEL PtrModel, __IN__ U32 Address)
+{
+
+    U32 position = 0;
+    PTR_LRM_REGISTER ptrRegister;
+    PTR_LRM_SCRIPT ptrScript;
+
+    ptrRegister = lrmFindRegister (PtrModel, Address, &position);
+
+    if (ptrRegister == NULL)
+    {
+        return (0);
+    }
+
+    if (ptrRegister->ScriptIndex != LRM_NO_SCRIPT)
+    {
+        ptrScript = &PtrModel->PtrScripts[ptrRegister->ScriptIndex];
+
+        if (ptrScript->Next < ptrScript->Count)
+        {
+            ptrRegister->Value = ptrScript->PtrValues[ptrScript->Next];
+            ptrScript->Next++;
+
+            if (ptrScript->Loop && (ptrScript->Next == ptrScript->Count))
+            {
+                ptrScript->Next = 0;
+            }
+        }
+    }
+
+    return (ptrRegister->Value);
+
+}
+
+/**
+ *
+ *  @method  lrmiWriteRegister()
+ *
+ *  @param   PtrModel           Register model
+ *
+ *  @param   Address            Register address
+ *
+ *  @param   Value              Value to write
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS or SCRUTINY_STATUS_FAILED
+ *                              when the register could not be added
+ *
+ *  @brief   Writes one register. A pending script of the register is not
+ *           affected.
+ *
+ */
+
+SCRUTINY_STATUS lrmiWriteRegister (__IN__ PTR_LRM_REGISTER_MODEL PtrModel, __IN__ U32 Address, __IN__ U32 Value)
+{
+
+    if (lrmSetRegister (PtrModel, Address, Value) == NULL)
+    {
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
+
+/**
+ *
+ *  @method  lrmiLoadSnapshot()
+ *
+ *  @param   PtrFileName        Register snapshot file
+ *
+ *  @param   PtrPtrModel        Receives the model, released with lrmiFreeModel()
+ *
+ *  @param   PtrLatency         Receives the access latency of the snapshot,
+ *                              zero when it has none
+ *
+ *  @return  SCRUTINY_STATUS    SCRUTINY_STATUS_SUCCESS, SCRUTINY_STATUS_FILE_OPEN_FAILED
+ *                              or SCRUTINY_STATUS_FAILED on a malformed snapshot
+ *
+ *  @brief   Builds a register model from a snapshot file
+ *
+ */
+
+SCRUTINY_STATUS lrmiLoadSnapshot (__IN__ const char *PtrFileName, __OUT__ PTR_LRM_REGISTER_MODEL *PtrPtrModel, __OUT__ PU32 PtrLatency)
+{
+
+    PTR_LRM_REGISTER_MODEL ptrModel = NULL;
+    PU8 ptrFile = NULL;
+    char *ptrText = NULL;
+    U32 length = 0;
+    SCRUTINY_STATUS status;
+
+    *PtrPtrModel = NULL;
+    *PtrLatency = 0;
+
+    if (sosiFileBufferRead (PtrFileName, &ptrFile, &length))
+    {
+        gPtrLoggerGeneric->logiDebug ("Unable to read the register snapshot '%s'", PtrFileName);
+        return (SCRUTINY_STATUS_FILE_OPEN_FAILED);
+    }
+
+    /* The parser works on a terminated copy */
+    ptrText = (char *) sosiMemAlloc (length + 1);
+    ptrModel = (PTR_LRM_REGISTER_MODEL) sosiMemAlloc (sizeof (LRM_REGISTER_MODEL));
+
+    if ((ptrText == NULL) || (ptrModel == NULL))
+    {
+        sosiMemFree (ptrFile);
+        sosiMemFree (ptrText);
+        sosiMemFree (ptrModel);
+
+        return (SCRUTINY_STATUS_FAILED);
+    }
+
+    sosiMemCopy (ptrText, ptrFile, length);
+    ptrText[length] = '\0';
+    sosiMemFree (ptrFile);
+
+    sosiMemSet (ptrModel, 0, sizeof (LRM_REGISTER_MODEL));
+
+    status = lrmParseSnapshot (ptrModel, ptrText, PtrLatency);
+
+    sosiMemFree (ptrText);
+
+    if (status != SCRUTINY_STATUS_SUCCESS)
+    {
+        lrmiFreeModel (ptrModel);
+        return (status);
+    }
+
+    gPtrLoggerGeneric->logiDebug ("Register snapshot '%s' has %d registers and %d scripts",
+                                  PtrFileName, ptrModel->RegisterCount, ptrModel->ScriptCount);
+
+    *PtrPtrModel = ptrModel;
+
+    return (SCRUTINY_STATUS_SUCCESS);
+
+}
@@ -236,6 +236,12 @@ SCRUTINY_STATUS ScrutinyGetDeviceInfo (__IN__  U32 DeviceIndex, __IN__  U32 Size
 
     ptrDevice = gPtrScrutinyDeviceManager->PtrDeviceList[(DeviceIndex)];
 
+    if (ptrDevice == NULL)
+    {
+        /* Device went away on an incremental discovery */
+        return (SCRUTINY_STATUS_INVALID_HANDLE);
+    }
+
     sosiMemCopy (PtrDeviceInfo, &ptrDevice->DeviceInfo, sizeof (SCRUTINY_DEVICE_INFO));
 
     return (SCRUTINY_STATUS_SUCCESS);
@@ -349,8 +355,8 @@ SCRUTINY_STATUS ScrutinyOneTimeCaptureLogs (
 
 	    if (ptrDevice == NULL)
 	    {
-	    	//unable to get device details.
-	        return (SCRUTINY_STATUS_INVALID_HANDLE);
+	    	//device went away on an incremental discovery.
+	        continue;
 	    }
 
 		if (slibiCreateTargetFolder (ptrDevice, currentDirectoryPath, currentTargetPath) != SCRUTINY_STATUS_SUCCESS)
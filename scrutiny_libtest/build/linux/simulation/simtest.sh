@@ -0,0 +1,22 @@
+#!/bin/sh
+
+##### Discovers and reads through each simulated backend with the fixtures of this directory.
+##### Build the library and scrutinyLibTest first, expander_replay.rrc was recorded from expander.ini
+##### with RECORD_FILE set in scrutiny.ini.
+
+cd `dirname $0`
+TEST=../scrutinyLibTest
+RESULT=0
+
+run ()
+{
+    echo Simulator $1 - $2
+    ${TEST} -sim $1 $2 -addr $3 -size $4 || RESULT=1
+}
+
+run switch   switch_snapshot.txt  FFF00000  8
+run expander expander.ini         20000000  16
+run replay   expander_replay.rrc  20000000  16
+run sdb      sdb.ini              20000000  16
+
+exit ${RESULT}
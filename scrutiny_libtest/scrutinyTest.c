@@ -492,6 +492,159 @@ STATUS  scrtnySdb (U32 ArgumentCount, const char** PtrArguments, PU32 PtrCurrent
 }
 
 
+STATUS  scrtnySimulator (U32 ArgumentCount, const char** PtrArguments, PU32 PtrCurrentIndex)
+{
+	SCRUTINY_DISCOVERY_PARAMS   discoveryParam;
+	SCRUTINY_STATUS libStatus = SCRUTINY_STATUS_SUCCESS;
+	SCRUTINY_DEVICE_INFO		deviceInfo;
+	U32							numDevices = 0;
+	U32							deviceIndex = 0;
+	U32							address, count;
+	PU8							ptrBuffer;
+	
+	scrtnyLibOsiMemSet (&discoveryParam, 0, sizeof (discoveryParam));
+	
+	(*PtrCurrentIndex) += 1;
+	
+	if ((*PtrCurrentIndex + 1 >= ArgumentCount) || (PtrArguments[(*PtrCurrentIndex)][0] == '-') || (PtrArguments[(*PtrCurrentIndex) + 1][0] == '-'))
+	{
+		printf ("scrutinyLibTest -sim <switch|expander|replay|sdb> <file> [-addr <value> -size <value>]\n");
+		return (STATUS_FAILED);
+	}
+	
+	if (scrtnyLibOsiStringCompare ("switch", PtrArguments[(*PtrCurrentIndex)]) == 0)
+	{
+		discoveryParam.u.SimulatorConfig.SimulatorType = SCRUTINY_SIMULATOR_TYPE_SWITCH_SNAPSHOT;
+	}
+	else if (scrtnyLibOsiStringCompare ("expander", PtrArguments[(*PtrCurrentIndex)]) == 0)
+	{
+		discoveryParam.u.SimulatorConfig.SimulatorType = SCRUTINY_SIMULATOR_TYPE_EXPANDER_PROFILE;
+	}
+	else if (scrtnyLibOsiStringCompare ("replay", PtrArguments[(*PtrCurrentIndex)]) == 0)
+	{
+		discoveryParam.u.SimulatorConfig.SimulatorType = SCRUTINY_SIMULATOR_TYPE_REPLAY;
+	}
+	else if (scrtnyLibOsiStringCompare ("sdb", PtrArguments[(*PtrCurrentIndex)]) == 0)
+	{
+		discoveryParam.u.SimulatorConfig.SimulatorType = SCRUTINY_SIMULATOR_TYPE_SDB_PROFILE;
+	}
+	else
+	{
+		printf ("Unknown simulator type %s\n", PtrArguments[(*PtrCurrentIndex)]);
+		printf ("scrutinyLibTest -sim <switch|expander|replay|sdb> <file> [-addr <value> -size <value>]\n");
+		return (STATUS_FAILED);
+	}
+	
+	(*PtrCurrentIndex) += 1;
+	snprintf (discoveryParam.u.SimulatorConfig.SimulationFile, sizeof (discoveryParam.u.SimulatorConfig.SimulationFile), "%s", PtrArguments[(*PtrCurrentIndex)]);
+	
+	address = count = INVALID_PARAMETER;
+	(*PtrCurrentIndex) += 1;
+	while (*PtrCurrentIndex < ArgumentCount)
+	{
+		if ((scrtnyLibOsiStringCompare ("-addr", PtrArguments[(*PtrCurrentIndex)]) == 0) && (*PtrCurrentIndex + 1 < ArgumentCount))
+		{
+			(*PtrCurrentIndex) += 1;
+			address = scrtnyLibOsiStrToHex ((char *)PtrArguments[(*PtrCurrentIndex)]);
+		}
+		else if ((scrtnyLibOsiStringCompare ("-size", PtrArguments[(*PtrCurrentIndex)]) == 0) && (*PtrCurrentIndex + 1 < ArgumentCount))
+		{
+			(*PtrCurrentIndex) += 1;
+			count = atoi ((char *)PtrArguments[(*PtrCurrentIndex)]);
+		}
+		else
+		{
+			printf("Unknow parameter %s\n", PtrArguments[(*PtrCurrentIndex)]);
+			printf ("scrutinyLibTest -sim <switch|expander|replay|sdb> <file> [-addr <value> -size <value>]\n");
+			return (STATUS_FAILED);
+		}
+		
+		(*PtrCurrentIndex) += 1;
+	}
+	
+	libStatus = ScrutinyDiscoverDevices (SCRUTINY_DISCOVERY_TYPE_SIMULATED, &discoveryParam);
+	
+	if (libStatus != SCRUTINY_STATUS_SUCCESS)
+	{
+		printf ("ScrutinyDiscoverDevices ().. Failed Status -  %x \n", libStatus);
+		printf ("Unable to discover any devices \n");
+		
+		return (STATUS_FAILED);
+	}
+	
+	libStatus = ScrutinyGetDeviceCount (&numDevices);
+	
+	if ((libStatus != SCRUTINY_STATUS_SUCCESS) || (numDevices == 0))
+	{
+		printf ("ScrutinyGetDeviceCount ().. Failed Status -  %x, %d devices \n", libStatus, numDevices);
+		
+		return (STATUS_FAILED);
+	}
+	
+	printf ("  %-15s %-18s %-16s\n", "Index", "FwVersion", "Type");
+	
+	for (deviceIndex = 0; deviceIndex < numDevices; deviceIndex++)
+	{
+		libStatus = ScrutinyGetDeviceInfo (deviceIndex, sizeof (SCRUTINY_DEVICE_INFO), &deviceInfo);
+		
+		if (libStatus != SCRUTINY_STATUS_SUCCESS)
+		{
+			printf ("ScrutinyGetDeviceInfo ().. Failed Status -  %x \n", libStatus);
+			
+			return (STATUS_FAILED);
+		}
+		
+		#if defined (LIB_SUPPORT_EXPANDER)
+		if (deviceInfo.ProductFamily == SCRUTINY_PRODUCT_FAMILY_EXPANDER)
+		{
+			scrtnyExpanderDetails (deviceIndex, &deviceInfo);
+		}
+		#endif
+		
+		#if defined (LIB_SUPPORT_SWITCH)
+		if (deviceInfo.ProductFamily == SCRUTINY_PRODUCT_FAMILY_SWITCH)
+		{
+			scrtnySwitchDetails (deviceIndex, &deviceInfo);
+		}
+		#endif
+		
+		if ((address == INVALID_PARAMETER) || (count == INVALID_PARAMETER))
+		{
+			continue;
+		}
+		
+		/* Read through the simulated device like through a real one */
+		ptrBuffer = scrtnyLibOsiMemAlloc (count);
+		if (ptrBuffer == NULL)
+		{
+			printf("%s - unable to allocate buffer\n", __func__);
+			return (STATUS_FAILED);
+		}
+		
+		if (deviceInfo.ProductFamily == SCRUTINY_PRODUCT_FAMILY_SWITCH)
+		{
+			libStatus = ScrutinySwitchMemoryRead (&deviceInfo.ProductHandle, address, (PU32) ptrBuffer, count);
+		}
+		else
+		{
+			libStatus = ScrutinyExpanderMemoryRead (&deviceInfo.ProductHandle, address, (PU32) ptrBuffer, count);
+		}
+		
+		if (libStatus != SCRUTINY_STATUS_SUCCESS)
+		{
+			printf ("Memory read at 0x%08x failed with status %x\n", address, libStatus);
+			scrtnyLibOsiMemFree (ptrBuffer);
+			return (STATUS_FAILED);
+		}
+		
+		HexDump (stdout, ptrBuffer, count);
+		scrtnyLibOsiMemFree (ptrBuffer);
+	}
+	
+	return (STATUS_SUCCESS);
+}
+
+
 STATUS  scrtnySelectDevice (U32 ArgumentCount, const char** PtrArguments, PU32 PtrCurrentIndex)
 {
 	SCRUTINY_DEVICE_INFO        deviceInfo;
@@ -559,6 +712,7 @@ static SCRUTINY_LIBTEST_CLI_GLOBALCMDS sCliGlobalCmds[] = {
     { "-list",  &scrtnyListDevice       },
     { "-i",     &scrtnySelectDevice     },
 	{ "-sdb",   &scrtnySdb				},
+	{ "-sim",   &scrtnySimulator		},
 
     /*          NULL TERMINATORs        */
     { NULL,             NULL            }
@@ -568,7 +722,7 @@ static SCRUTINY_LIBTEST_CLI_GLOBALCMDS sCliGlobalCmds[] = {
 STATUS globalArgumentsParse (int argc, char **argv)
 {
 	U32 index = 0, currentOption = 1;
-	STATUS    funcStatus;
+	STATUS    funcStatus = STATUS_SUCCESS;
 	
 	for (index = 0; ; index++)
 	{
@@ -580,6 +734,7 @@ STATUS globalArgumentsParse (int argc, char **argv)
 		if (sCliGlobalCmds[index].PtrOption == NULL)
 		{
 			printf("invalid option %s\n", argv[currentOption]);
+			funcStatus = STATUS_FAILED;
 			break;
 		}
 		
@@ -599,7 +754,7 @@ STATUS globalArgumentsParse (int argc, char **argv)
 		}
 	}
 	
-	return (STATUS_SUCCESS);
+	return (funcStatus);
 }
 
 
@@ -625,8 +780,7 @@ int main (int argc, char **argv)
 
 	// parsing options
 	if (argc != 1) {
-		globalArgumentsParse (argc, argv);
-		return (0);
+		return (globalArgumentsParse (argc, argv) == STATUS_FAILED ? 1 : 0);
 	}
 	
     scrutinyTest (ptrDevNode);
@@ -3970,6 +4124,10 @@ STATUS scrtnySwitchDetails (__IN__ U32 Index, __IN__ PTR_SCRUTINY_DEVICE_INFO Pt
                                       PtrDeviceInfo->u.SwitchInfo.PciAddress.DeviceNumber,
                                       PtrDeviceInfo->u.SwitchInfo.PciAddress.FunctionNumber);
 
+    }
+	else if (PtrDeviceInfo->HandleType == SCRUTINY_HANDLE_TYPE_SIMULATED)
+    {
+        printf ("%3d)               %-18s Switch (SIM)\n", Index, buffer);
     }
 	else if (PtrDeviceInfo->HandleType == SCRUTINY_HANDLE_TYPE_SDB)
     {